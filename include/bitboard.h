@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess_representation.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Squares are numbered a1 = 0, b1 = 1, ..., h8 = 63 (rank * 8 + file)
+#define BITBOARD_SQUARE(sq) ((Bitboard)1 << (sq))
+#define BITBOARD_FILE_A 0x0101010101010101ULL
+#define BITBOARD_FILE_H 0x8080808080808080ULL
+#define BITBOARD_RANK_1 0x00000000000000FFULL
+#define BITBOARD_RANK_8 0xFF00000000000000ULL
+
+// Sliding attack lookup entry (magic multiply or PEXT index into a shared table)
+typedef struct {
+    Bitboard mask;       // Relevant occupancy (board edges excluded)
+    Bitboard magic;      // Magic multiplier (unused with PEXT)
+    Bitboard* attacks;   // Slice of the shared attack table for this square
+    unsigned shift;      // 64 - popcount(mask)
+} BitboardMagic;
+
+extern BitboardMagic bitboard_rook_magics[64];
+extern BitboardMagic bitboard_bishop_magics[64];
+extern Bitboard bitboard_knight_table[64];
+extern Bitboard bitboard_king_table[64];
+extern Bitboard bitboard_pawn_table[2][64];
+extern Bitboard bitboard_between_table[64][64];
+extern Bitboard bitboard_line_table[64][64];
+
+// Builds all lookup tables; safe to call repeatedly and from several threads
+void bitboard_init(void);
+
+static inline int bitboard_popcount(Bitboard b) {
+    return __builtin_popcountll(b);
+}
+
+static inline Square bitboard_lsb(Bitboard b) {
+    return (Square)__builtin_ctzll(b);
+}
+
+static inline Square bitboard_pop_lsb(Bitboard* b) {
+    Square sq = bitboard_lsb(*b);
+    *b &= *b - 1;
+    return sq;
+}
+
+// Building with -mbmi2 switches every lookup to PEXT; all translation units must agree on the flag
+static inline size_t bitboard_magic_index(const BitboardMagic* m, Bitboard occupied) {
+#if defined(__BMI2__)
+    return (size_t)_pext_u64(occupied, m->mask);
+#else
+    return (size_t)(((occupied & m->mask) * m->magic) >> m->shift);
+#endif
+}
+
+static inline Bitboard bitboard_rook_attacks(Square sq, Bitboard occupied) {
+    const BitboardMagic* m = &bitboard_rook_magics[sq];
+    return m->attacks[bitboard_magic_index(m, occupied)];
+}
+
+static inline Bitboard bitboard_bishop_attacks(Square sq, Bitboard occupied) {
+    const BitboardMagic* m = &bitboard_bishop_magics[sq];
+    return m->attacks[bitboard_magic_index(m, occupied)];
+}
+
+static inline Bitboard bitboard_queen_attacks(Square sq, Bitboard occupied) {
+    return bitboard_rook_attacks(sq, occupied) | bitboard_bishop_attacks(sq, occupied);
+}
+
+static inline Bitboard bitboard_knight_attacks(Square sq) {
+    return bitboard_knight_table[sq];
+}
+
+static inline Bitboard bitboard_king_attacks(Square sq) {
+    return bitboard_king_table[sq];
+}
+
+static inline Bitboard bitboard_pawn_attacks(Color color, Square sq) {
+    return bitboard_pawn_table[color][sq];
+}
+
+// Squares strictly between a and b when they share a rank, file or diagonal (else empty)
+static inline Bitboard bitboard_between(Square a, Square b) {
+    return bitboard_between_table[a][b];
+}
+
+// Full edge-to-edge line through a and b when aligned (else empty)
+static inline Bitboard bitboard_line(Square a, Square b) {
+    return bitboard_line_table[a][b];
+}
+
+// Attacks of any non-pawn piece type from a square given the board occupancy
+Bitboard bitboard_piece_attacks(PieceType piece, Square sq, Bitboard occupied);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BITBOARD_H
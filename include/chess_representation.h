@@ -6,6 +6,7 @@
 #define CHESS_REPRESENTATION_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -33,9 +34,12 @@ typedef enum {
     COLOR_BLACK = 1
 } Color;
 
-// Square representation (0-63)
+// Square representation (0-63, a1 = 0, h8 = 63)
 typedef unsigned char Square;
 
+// Set of squares, one bit per square (see bitboard.h for attack lookups)
+typedef uint64_t Bitboard;
+
 // Move representation
 typedef struct {
     Square from;
@@ -66,6 +70,7 @@ typedef struct {
 // Chess Position API
 ChessPosition* chess_position_create();
 void chess_position_destroy(ChessPosition* pos);
+ChessPosition* chess_position_clone(const ChessPosition* pos);  // Deep copy including move history
 ChessPosition* chess_position_from_fen(const char* fen);
 void chess_position_to_fen(ChessPosition* pos, FENString* fen);
 void chess_position_to_matrix(ChessPosition* pos, double* matrix);  // 8x8x12 output
@@ -77,11 +82,43 @@ bool chess_position_is_check(ChessPosition* pos, Color color);
 bool chess_position_is_checkmate(ChessPosition* pos, Color color);
 bool chess_position_is_stalemate(ChessPosition* pos);
 
-// Move generation
+// Zobrist hashing (key is updated incrementally by make/unmake; build with -DCHESS_DEBUG to verify every move)
+uint64_t chess_position_get_hash(const ChessPosition* pos);
+uint64_t chess_position_compute_hash(const ChessPosition* pos);  // Full recompute from the board
+bool chess_position_is_repetition(const ChessPosition* pos);     // Current key seen earlier since the last capture or pawn move
+
+// Incremental input features. Feature square * 12 + channel is the nonzero entry of
+// chess_position_to_matrix for a piece; make_move records the (at most two) features it
+// removes and adds so evaluators can update from the parent instead of re-encoding.
+typedef struct {
+    uint16_t removed[2];
+    uint16_t added[2];
+    uint8_t num_removed;
+    uint8_t num_added;
+} ChessFeatureDelta;
+
+size_t chess_position_get_ply(const ChessPosition* pos);                      // Moves in the history
+uint64_t chess_position_get_ply_hash(const ChessPosition* pos, size_t ply);    // Key before the move at ply; ply == get_ply gives the current key
+const ChessFeatureDelta* chess_position_get_feature_delta(const ChessPosition* pos, size_t ply);  // Changes made by the move at ply
+size_t chess_position_get_features(const ChessPosition* pos, uint16_t* features);  // Active features (at most 64); returns the count
+
+// Bitboard queries
+Bitboard chess_position_get_pieces(ChessPosition* pos, Color color, PieceType piece);
+Bitboard chess_position_get_color_occupancy(ChessPosition* pos, Color color);
+Bitboard chess_position_get_occupancy(ChessPosition* pos);
+Bitboard chess_position_attackers_to(ChessPosition* pos, Square square, Bitboard occupied);
+bool chess_position_is_square_attacked(ChessPosition* pos, Square square, Color by_color);
+
+// Move generation (legal moves only; CHESS_MAX_MOVES bounds any position)
+#define CHESS_MAX_MOVES 256
+Color chess_position_get_side_to_move(ChessPosition* pos);
+size_t chess_position_get_halfmove_clock(ChessPosition* pos);
 void chess_position_generate_moves(ChessPosition* pos, Color color, ChessMove* moves, size_t* num_moves);
 bool chess_position_is_legal_move(ChessPosition* pos, const ChessMove* move);
-void chess_position_make_move(ChessPosition* pos, const ChessMove* move);
+void chess_position_make_move(ChessPosition* pos, const ChessMove* move);  // History grows as needed, so games have no ply limit
 void chess_position_unmake_move(ChessPosition* pos);
+uint64_t chess_position_perft(ChessPosition* pos, size_t depth);  // Leaf node count of legal move tree
+void chess_move_to_uci(const ChessMove* move, char* buffer);      // e.g. "e2e4", "e7e8q"; buffer needs 6 bytes
 
 // Move sequence API
 MoveSequence* move_sequence_create(size_t capacity);
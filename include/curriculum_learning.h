@@ -6,6 +6,7 @@
 #define CURRICULUM_LEARNING_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -29,10 +30,17 @@ typedef enum {
     LEVEL_INFINITE            // Infinite chess variants
 } DifficultyLevelEnum;
 
-// Example structure
+// One nonzero output of a sparse target, e.g. a legal move (from * 64 + to) and its probability
+typedef struct {
+    uint32_t index;
+    float probability;
+} SparseTargetEntry;
+
+// Example structure. Start from training_example_init so fields added later (such as the sparse
+// target) begin null rather than as whatever was on the stack.
 typedef struct {
     double* input;            // Game state representation
-    double* target;           // Expected output
+    double* target;           // Expected output; null when the target is sparse
     double difficulty;        // Difficulty score (0.0 - 1.0)
     size_t input_size;
     size_t target_size;
@@ -41,8 +49,14 @@ typedef struct {
     size_t correct_streak;    // Consecutive correct answers
     double last_reviewed;     // Timestamp of last review
     double next_review;       // When to review next (spaced repetition)
+    SparseTargetEntry* sparse_target;  // Non-null: the target is these entries, sorted by index, and zero elsewhere
+    size_t num_sparse;                 // up to target_size; a chess policy lists its legal moves instead of 4096 doubles
 } TrainingExample;
 
+void training_example_init(TrainingExample* example);     // No arrays, zero sizes and counters
+void training_example_get_target(const TrainingExample* example, double* target, size_t width);  // Dense row, zero past the example's target
+void training_example_release(TrainingExample* example);  // Free the input and target arrays, not the struct
+
 // Curriculum structure
 typedef struct {
     DifficultyLevel* levels;
@@ -86,7 +100,7 @@ typedef struct {
 
 PuzzleGenerator* puzzle_generator_create(Curriculum* curriculum);
 void puzzle_generator_destroy(PuzzleGenerator* pg);
-TrainingExample* puzzle_generator_create_puzzle(PuzzleGenerator* pg, DifficultyLevelEnum level);
+TrainingExample* puzzle_generator_create_puzzle(PuzzleGenerator* pg, DifficultyLevelEnum level);  // Sparse target over a few candidate moves
 TrainingExample* puzzle_generator_create_progressive_puzzle(PuzzleGenerator* pg, double difficulty);
 
 #ifdef __cplusplus
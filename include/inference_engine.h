@@ -10,6 +10,9 @@
 #include "neural_network.h"
 #include "chess_representation.h"
 #include "multi_agent_game.h"
+#include "transposition_table.h"
+#include "search.h"
+#include "mcts.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,20 +27,50 @@ typedef struct {
     bool is_legal;
 } MoveEvaluation;
 
+struct EngineAccumulator;
+
 // Inference Engine
 typedef struct {
     NeuralNetwork* network;
     bool is_loaded;
-    double temperature;  // For sampling
-    size_t max_depth;    // For search
+    double temperature;  // For sampling (MCTS: 0 plays the most visited move)
+    size_t max_depth;    // Default search depth when SearchLimits.max_depth is zero
     bool use_mcts;       // Monte Carlo Tree Search
+    size_t tt_size_mb;   // Transposition table size (0 disables caching); applied on next lookup
+    TranspositionTable* tt;  // Shared eval/search cache keyed by position hash, owned by engine
+    size_t mcts_simulations; // Playouts per move when simulations argument is zero or use_mcts selects moves
+    double c_puct;           // MCTS exploration constant
+    size_t mcts_threads;     // MCTS worker threads sharing the tree
+    size_t mcts_batch_size;  // Leaves each MCTS worker gathers per batch_predict call
+    MCTSTree* mcts_tree;     // Search tree kept between consecutive moves, owned by engine
+    QuantizedNetwork* quantized;  // Int8 copy built by inference_engine_quantize, owned by engine
+    bool use_quantized;      // Evaluate with the int8 copy when present (clear the cache after toggling)
+    struct EngineAccumulator* accumulator;  // Incrementally updated first layer for position evaluation, owned by engine
+    uint64_t weight_version; // Network weight version the caches were filled from; a newer one clears them
 } InferenceEngine;
 
+// Accuracy of the int8 model against the network it was built from, measured on the calibration positions
+typedef struct {
+    size_t samples;
+    double value_max_error;   // Largest |int8 - network| of the value output
+    double value_mean_error;
+    double output_max_error;  // Largest deviation over every output
+    double policy_agreement;  // Fraction of samples whose highest policy output is unchanged
+    size_t network_bytes;     // Parameters as stored by the network
+    size_t quantized_bytes;   // Parameters of the int8 copy
+} QuantizationReport;
+
 // Inference Engine API
 InferenceEngine* inference_engine_create(NeuralNetwork* nn);
 void inference_engine_destroy(InferenceEngine* engine);
-void inference_engine_load_model(InferenceEngine* engine, const char* model_path);
-void inference_engine_save_model(InferenceEngine* engine, const char* model_path);
+bool inference_engine_load_model(InferenceEngine* engine, const char* model_path);  // Map a model file into the network (see nn_map_model); false leaves it unchanged
+bool inference_engine_save_model(InferenceEngine* engine, const char* model_path);
+void inference_engine_clear_cache(InferenceEngine* engine);  // Evaluation and search clear it themselves when the network's weights change
+
+// Build an int8 copy of the network calibrated on sample positions and switch evaluation to it.
+// Returns false (engine unchanged) without a loaded network or positions; report may be null
+bool inference_engine_quantize(InferenceEngine* engine, const ChessPosition* const* positions,
+                               size_t num_positions, QuantizationReport* report);
 
 // Position evaluation
 double inference_engine_evaluate_position(InferenceEngine* engine, const ChessPosition* pos);
@@ -61,12 +94,20 @@ GameAction* inference_engine_select_action(InferenceEngine* engine,
                                           size_t agent_id);
 
 // Search algorithms
+void inference_engine_search(InferenceEngine* engine,
+                             const ChessPosition* pos,
+                             const SearchLimits* limits,
+                             SearchResult* result);
 ChessMove* inference_engine_search_move(InferenceEngine* engine, 
                                        const ChessPosition* pos,
                                        size_t depth);
 ChessMove* inference_engine_mcts_search(InferenceEngine* engine,
                                        const ChessPosition* pos,
-                                       size_t simulations);
+                                       size_t simulations);  // 0 uses engine->mcts_simulations
+void inference_engine_run_mcts(InferenceEngine* engine,
+                               const ChessPosition* pos,
+                               size_t simulations,
+                               MCTSResult* result);
 
 // Batch inference
 void inference_engine_batch_predict(InferenceEngine* engine,
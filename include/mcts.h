@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess_representation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// AlphaZero-style PUCT Monte Carlo Tree Search. Nodes live in a chunked pool
+// owned by the tree; the pool is recycled between searches and the subtree
+// below the new root is kept when the next search starts one or two plies
+// further down the game. Several worker threads may descend the same tree:
+// node statistics are atomics, in-flight paths carry a virtual loss so
+// workers spread out, and leaves can be gathered into batches for one
+// network call.
+typedef struct MCTSTree MCTSTree;
+
+typedef struct {
+    size_t simulations;     // Playouts per search
+    double c_puct;          // Exploration constant
+    double temperature;     // Move selection: 0 picks most visited, 1 samples proportional to visits
+    size_t num_threads;     // Worker threads; 0 or 1 searches on the calling thread
+    size_t batch_size;      // Leaves gathered per evaluation per worker; 0 or 1 evaluates each leaf at once
+    double virtual_loss;    // Value charged to each in-flight visit; <= 0 uses 1.0
+} MCTSConfig;
+
+typedef struct {
+    ChessMove best_move;
+    bool has_move;          // False when the root has no legal moves
+    double value;           // Root value estimate from side-to-move's point of view, in [-1, 1]
+    size_t simulations;     // Playouts run by this search
+    size_t root_visits;     // Includes visits reused from the previous search
+    size_t tree_nodes;      // Nodes allocated in the pool
+    size_t collisions;      // Descents abandoned because another descent was already expanding the leaf
+    size_t batches;         // Evaluator calls made
+} MCTSResult;
+
+// Leaf evaluator: writes a prior for each legal move (need not be normalized)
+// and returns the position value for the side to move in [-1, 1].
+// Workers call it concurrently, so it must be thread-safe.
+typedef double (*MCTSEvaluator)(void* context, ChessPosition* pos,
+                                const ChessMove* moves, size_t num_moves, double* priors);
+
+// Batched network evaluator. encode() writes the input for a leaf while the
+// worker's position sits on it; evaluate() scores count encoded inputs together.
+// Both run on several workers at once with no lock: each worker passes evaluate()
+// the workspace it got from create_workspace() (e.g. an NNWorkspace), so forward
+// scratch is never shared. Without create_workspace the workspace is null.
+// Outputs use the engine layout: white-relative value at [0] and from * 64 + to
+// policy logits (softmaxed over legal moves).
+typedef struct {
+    size_t input_size;
+    size_t output_size;     // At least 64 * 64
+    void (*encode)(void* context, ChessPosition* pos, double* input);
+    void (*evaluate)(void* context, void* workspace, const double* inputs, size_t count, double* outputs);
+    void* context;
+    void* (*create_workspace)(void* context);                 // Optional; called once per worker
+    void (*destroy_workspace)(void* context, void* workspace);
+} MCTSBatchEvaluator;
+
+MCTSTree* mcts_tree_create(void);
+void mcts_tree_destroy(MCTSTree* tree);
+void mcts_tree_clear(MCTSTree* tree);  // Drop all statistics (e.g. after network weights change)
+
+// pos is modified during the search and restored before returning
+void mcts_search(MCTSTree* tree, ChessPosition* pos, const MCTSConfig* config,
+                 MCTSEvaluator evaluate, void* context, MCTSResult* result);
+void mcts_search_batched(MCTSTree* tree, ChessPosition* pos, const MCTSConfig* config,
+                         const MCTSBatchEvaluator* evaluator, MCTSResult* result);
+
+// Root visit fractions as a 64x64 from/to policy target (4096 doubles)
+void mcts_get_visit_distribution(const MCTSTree* tree, double* policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MCTS_H
@@ -7,6 +7,7 @@
 #define NEURAL_NETWORK_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -18,6 +19,10 @@ typedef struct NeuralNetwork NeuralNetwork;
 typedef struct BayesianLayer BayesianLayer;
 typedef struct LSTMLayer LSTMLayer;
 typedef struct Optimizer Optimizer;
+typedef struct QuantizedNetwork QuantizedNetwork;
+typedef struct NNQuantizedWorkspace NNQuantizedWorkspace;
+typedef struct NNAccumulator NNAccumulator;
+typedef struct NNWorkspace NNWorkspace;
 
 // Activation functions
 typedef enum {
@@ -36,32 +41,191 @@ typedef enum {
     OPTIMIZER_RMSPROP
 } OptimizerType;
 
+// Storage format of layer weights. Reduced precision halves (FP32) or quarters
+// (BF16) weight memory traffic; products accumulate in fp32 and biases,
+// activations and the public double API are unchanged.
+typedef enum {
+    NN_PRECISION_FP64,
+    NN_PRECISION_FP32,
+    NN_PRECISION_BF16
+} NNPrecision;
+
 // Neural Network API
 NeuralNetwork* nn_create_hybrid(size_t input_size, size_t hidden_size, size_t output_size);
+NeuralNetwork* nn_create_hybrid_with_precision(size_t input_size, size_t hidden_size, size_t output_size,
+                                               NNPrecision precision);
 void nn_destroy(NeuralNetwork* nn);
+void nn_set_precision(NeuralNetwork* nn, NNPrecision precision);  // Convert weights in place (rounds when narrowing)
+NNPrecision nn_get_precision(const NeuralNetwork* nn);
+size_t nn_get_parameter_bytes(const NeuralNetwork* nn);             // Weights and biases as stored
+size_t nn_get_input_size(const NeuralNetwork* nn);
+size_t nn_get_hidden_size(const NeuralNetwork* nn);
+size_t nn_get_output_size(const NeuralNetwork* nn);
+uint64_t nn_get_weight_version(const NeuralNetwork* nn);            // Changes whenever the weights may have (updates, restores, mapping, precision)
 
 // Bayesian Network Layer
 BayesianLayer* bayesian_layer_create(size_t num_nodes, size_t num_parents);
 void bayesian_layer_destroy(BayesianLayer* layer);
 void bayesian_layer_forward(BayesianLayer* layer, const double* input, double* output);
-void bayesian_layer_backward(BayesianLayer* layer, const double* gradient, double* input_gradient);
+void bayesian_layer_backward(BayesianLayer* layer, const double* gradient, double* input_gradient);  // Accumulates parameter gradients; input_gradient may be null
+void bayesian_layer_forward_batch(BayesianLayer* layer, const double* inputs,  // [batch x num_parents] -> [batch x num_nodes]; backward caches untouched
+                                  size_t batch_size, double* outputs);
 
 // LSTM Layer
 LSTMLayer* lstm_layer_create(size_t input_size, size_t hidden_size);
 void lstm_layer_destroy(LSTMLayer* layer);
-void lstm_layer_forward(LSTMLayer* layer, const double* input, double* output, double* hidden_state);
-void lstm_layer_backward(LSTMLayer* layer, const double* gradient, double* input_gradient);
+void lstm_layer_reset(LSTMLayer* layer);  // Zero hidden and cell state and start a new sequence
+void lstm_layer_forward(LSTMLayer* layer, const double* input, double* output, double* hidden_state);  // One step; cached for backward until the next reset
+void lstm_layer_backward(LSTMLayer* layer, const double* gradient,  // Backpropagation through time over the steps since the last reset:
+                         double* input_gradient);                  // gradient is [steps x hidden], input_gradient [steps x input] or null
+void lstm_layer_forward_batch(LSTMLayer* layer, const double* inputs,  // Each sample from zero state; layer state and caches untouched
+                              size_t batch_size, double* outputs);
 
 // Forward/Backward pass
 void nn_forward(NeuralNetwork* nn, const double* input, double* output);
-void nn_backward(NeuralNetwork* nn, const double* target, double* loss);
+void nn_forward_batch(NeuralNetwork* nn, const double* inputs, size_t input_stride,  // Sample b reads inputs + b * input_stride and
+                      size_t batch_size, double* outputs, size_t output_stride);    // writes output_size values at outputs + b * output_stride
+void nn_forward_sparse(NeuralNetwork* nn, const uint16_t* features, size_t count,  // Binary input given as the indices of its ones
+                       double* output);                                           // (e.g. chess_position_get_features); same result as nn_forward
+
+// Backward passes accumulate the loss gradient of every weight and bias into per-parameter
+// buffers until optimizer_update applies them. They follow the last nn_forward or
+// nn_forward_sequence; the batched, sparse and accumulator forwards cache nothing to backpropagate.
+void nn_forward_sequence(NeuralNetwork* nn, const double* inputs, size_t steps,  // inputs [steps x input_size] -> outputs [steps x output_size] (may be null);
+                         double* outputs);                                      // the LSTM carries its state from step to step, starting at zero
+void nn_backward(NeuralNetwork* nn, const double* target, double* loss);          // Loss on the final step, propagated back through all steps
+void nn_backward_sequence(NeuralNetwork* nn, const double* targets, double* loss);  // targets [steps x output_size], loss averaged over steps
+void nn_zero_gradients(NeuralNetwork* nn);
+
+// Mini-batch backward: forward and backward run as GEMMs over chunks of samples, each sample a
+// one-step sequence as in nn_forward. Accumulates the gradient of the loss averaged over the batch
+// (so one optimizer_update per mini-batch) and returns that mean loss. Targets are output_size wide;
+// outputs may be null. The single-sample caches used by nn_backward are untouched.
+double nn_backward_batch(NeuralNetwork* nn, const double* inputs, size_t input_stride,
+                         const double* targets, size_t target_stride, size_t batch_size,
+                         double* outputs, size_t output_stride);
+
+// Mini-batch targets as compressed sparse rows: row b lists its nonzero targets at
+// indices[offsets[b] .. offsets[b + 1]) with their values; every other output's target is zero.
+typedef struct {
+    const size_t* offsets;      // batch_size + 1 entries
+    const uint32_t* indices;    // Output indices, each below output_size and listed once per row
+    const double* values;
+} NNSparseTargets;
+
+// Same loss and gradients as nn_backward_batch on the zero-filled dense targets. Only the outputs
+// below min(hidden, output) size are nonzero, so per sample the loss touches those and the listed
+// entries rather than all output_size targets. Only those leading outputs are written to outputs;
+// the rest are zero and left as they were.
+double nn_backward_batch_sparse(NeuralNetwork* nn, const double* inputs, size_t input_stride,
+                                const NNSparseTargets* targets, size_t batch_size,
+                                double* outputs, size_t output_stride);
+
+// Data-parallel training: each thread owns a workspace with its own activation caches and a
+// gradient arena laid out like nn_get_gradients, and runs its shard of a mini-batch against the
+// shared weights, which it only reads. Shards scale by the size of the whole mini-batch
+// (batch_total), so the sum of the workspaces' gradients and of the returned losses is the
+// mini-batch mean that nn_backward_batch would give. nn_workspace_forward_batch is nn_forward_batch
+// on the workspace's scratch, so threads that each own a workspace can run inference concurrently.
+NNWorkspace* nn_workspace_create(NeuralNetwork* nn);
+void nn_workspace_destroy(NNWorkspace* ws);
+double* nn_workspace_get_gradients(NNWorkspace* ws, size_t* count);
+void nn_workspace_forward_batch(NNWorkspace* ws, const double* inputs, size_t input_stride,
+                                size_t batch_size, double* outputs, size_t output_stride);
+double nn_workspace_backward_batch(NNWorkspace* ws, const double* inputs, size_t input_stride,
+                                   const double* targets, size_t target_stride, size_t batch_size, size_t batch_total,
+                                   double* outputs, size_t output_stride);
+double nn_workspace_backward_batch_sparse(NNWorkspace* ws, const double* inputs, size_t input_stride,
+                                          const NNSparseTargets* targets, size_t batch_size, size_t batch_total,
+                                          double* outputs, size_t output_stride);
 
-// Optimizer
+// Hogwild steps: plain SGD from the workspace's gradients straight into the shared weights, clearing
+// the gradients they apply. The sparse step writes the first-layer weights in the columns of inputs
+// that were nonzero since the last step, which workers on sparse board encodings rarely share, and
+// takes no locks. The dense step writes everything else (first-layer biases, LSTM gate weights and
+// biases); every sample touches all of it, so concurrent dense steps would lose updates and callers
+// must serialize them. Dense gradients keep accumulating until applied, so a worker can defer its
+// dense step while another holds the lock. Weight decay applies only to the entries a step touches;
+// reduced-precision weights stay fixed.
+// Two kinds of race remain by design: sparse steps that share a column, and forward passes of other
+// workers reading dense weights while a dense step writes them. Both read torn-free doubles that are
+// at most one step stale, which asynchronous SGD tolerates.
+// nn_hogwild_begin switches the first layer to its column-major copy (input_size x hidden_size) for
+// the duration of a Hogwild run: workspace passes sum the active columns, gradients accumulate per
+// column, and each sparse step updates whole contiguous columns instead of one entry per weight row.
+// nn_hogwild_end transposes the columns back; until then other forward paths see stale first-layer rows.
+void nn_workspace_apply_sparse_sgd(NNWorkspace* ws, double learning_rate, double weight_decay);
+void nn_workspace_apply_dense_sgd(NNWorkspace* ws, double learning_rate, double weight_decay);
+void nn_hogwild_begin(NeuralNetwork* nn);
+void nn_hogwild_end(NeuralNetwork* nn);
+
+// Every weight and bias lives in one cache-line aligned arena, layer after layer (Bayesian weights
+// and biases, then LSTM gate weights and biases), with a parallel gradient arena of the same length.
+// The views stay valid for the network's lifetime; writes to parameters take effect on the next
+// forward. Reduced-precision networks mirror their rounded weights here but compute from their own copies.
+// A mapped network has no arena: nn_get_parameters detaches it first (nn_unmap_model), while
+// nn_read_parameters copies count values from arena position first without detaching.
+double* nn_get_parameters(NeuralNetwork* nn, size_t* count);
+double* nn_get_gradients(NeuralNetwork* nn, size_t* count);
+size_t nn_get_parameter_count(const NeuralNetwork* nn);
+void nn_read_parameters(const NeuralNetwork* nn, size_t first, size_t count, double* out);
+
+// Versioned model file: a header (magic, version, layer shapes, dtype, alignment, data size, checksum)
+// padded to a page boundary, then each layer's weights in the network's precision and its FP64
+// biases, every segment cache-line aligned. nn_save_model writes a temporary file and renames it over
+// path. nn_map_model maps the file read-only and points the layers at it in place, with no parsing,
+// copying or conversion, so processes serving one model share a single page-cached copy and pages
+// fault in as they are used; the file's dtype becomes the network's precision. It checks only the
+// header and returns false, leaving the network unchanged, when the file is missing, truncated or
+// shaped differently. nn_verify_model reads the whole data section against the header checksum.
+// Mapped weights are not trained: optimizer steps only clear gradients.
+bool nn_save_model(NeuralNetwork* nn, const char* path);
+bool nn_map_model(NeuralNetwork* nn, const char* path);
+bool nn_verify_model(const NeuralNetwork* nn);
+void nn_unmap_model(NeuralNetwork* nn);  // Copy mapped weights into a private, writable arena and release the file; no-op when not mapped
+
+// Incrementally updated first layer for sparse binary inputs (NNUE-style). Each of depth
+// slots holds the first layer's pre-activations; a child slot is its parent's minus the
+// weight columns of removed features plus those of added ones, so moving one piece costs
+// two vector adds instead of a full GEMV. Slots keep the weights they were computed with:
+// refresh them after training.
+NNAccumulator* nn_accumulator_create(NeuralNetwork* nn, size_t depth);
+void nn_accumulator_destroy(NNAccumulator* acc);
+void nn_accumulator_refresh(NNAccumulator* acc, size_t slot, const uint16_t* features, size_t count);  // Inputs with these entries at 1, rest 0
+void nn_accumulator_update(NNAccumulator* acc, size_t slot, size_t parent_slot,
+                           const uint16_t* removed, size_t num_removed,
+                           const uint16_t* added, size_t num_added);
+void nn_accumulator_forward(NNAccumulator* acc, size_t slot, double* output);  // Same result as nn_forward on the slot's input
+
+// Post-training int8 quantization: per-output-unit weight scales, per-layer activation
+// ranges calibrated from sample inputs. The copy is independent of the source network
+// (re-quantize after training) and its forward matches nn_forward up to quantization error.
+QuantizedNetwork* nn_quantize(NeuralNetwork* nn, const double* calibration_inputs,
+                              size_t input_stride, size_t num_samples);
+void nn_quantized_destroy(QuantizedNetwork* qnn);
+void nn_quantized_forward(QuantizedNetwork* qnn, const double* input, double* output);
+void nn_quantized_forward_batch(QuantizedNetwork* qnn, const double* inputs, size_t input_stride,
+                                size_t batch_size, double* outputs, size_t output_stride);
+NNQuantizedWorkspace* nn_quantized_workspace_create(QuantizedNetwork* qnn);  // Private scratch, so threads can forward concurrently
+void nn_quantized_workspace_destroy(NNQuantizedWorkspace* ws);
+void nn_quantized_workspace_forward_batch(NNQuantizedWorkspace* ws, const double* inputs, size_t input_stride,
+                                          size_t batch_size, double* outputs, size_t output_stride);
+size_t nn_quantized_get_parameter_bytes(const QuantizedNetwork* qnn);
+
+// Optimizer. Each update is one fused SIMD sweep per parameter block (see nn_kernel_adam and
+// friends); per-parameter state is a flat buffer allocated on the first update.
 Optimizer* optimizer_create(OptimizerType type, double learning_rate);
 void optimizer_destroy(Optimizer* opt);
-void optimizer_update(Optimizer* opt, NeuralNetwork* nn);
+void optimizer_set_momentum(Optimizer* opt, double momentum);          // SGD velocity decay (default 0.9; 0 is plain SGD)
+void optimizer_set_weight_decay(Optimizer* opt, double weight_decay);  // L2 coefficient added to every gradient (default 0)
+void optimizer_update(Optimizer* opt, NeuralNetwork* nn);  // Apply and clear accumulated gradients (reduced-precision weights stay fixed)
+
+// Optimizer state for checkpoints: the step count and the per-parameter moment buffers, laid out like
+// the parameter arena. Buffers the update rule does not keep are null; count is 0 before the first update.
+size_t optimizer_get_state(const Optimizer* opt, const double** first_moment, const double** second_moment, size_t* step);
+void optimizer_set_state(Optimizer* opt, size_t count, const double* first_moment, const double* second_moment, size_t step);
 
-// Training
+// Training: each epoch is one nn_backward_batch over all examples and one optimizer step
 void nn_train_batch(NeuralNetwork* nn, Optimizer* opt, 
                     const double* inputs, const double* targets, 
                     size_t batch_size, size_t epochs);
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef NN_KERNELS_H
+#define NN_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Dense kernels behind the network layers. The widest instruction set the
+// CPU supports is picked at first use (AVX-512, AVX2+FMA, or portable
+// scalar code), so the binary needs no -march flags to run anywhere.
+typedef enum {
+    NN_ISA_SCALAR = 0,
+    NN_ISA_AVX2,
+    NN_ISA_AVX512,
+    NN_ISA_AVX512_VNNI          // AVX-512 plus BW and VNNI integer dot products
+} NNKernelISA;
+
+NNKernelISA nn_kernels_isa(void);                      // Instruction set currently in use
+NNKernelISA nn_kernels_select(NNKernelISA isa);        // Force an ISA (clamped to what the CPU supports); returns the one chosen
+const char* nn_kernels_isa_name(NNKernelISA isa);
+
+// y[r] = bias[r] + sum_c W[r * cols + c] * x[c] for r < rows; bias may be null
+void nn_kernel_gemv(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols);
+
+// C[m * ldc + n] = bias[n] + sum_k A[m * lda + k] * W[n * ldw + k] for m < M, n < N, i.e. C = A W^T + bias.
+// A holds one sample per row and W one output unit per row, matching the layer weight layouts; bias may be null
+void nn_kernel_gemm(const double* A, size_t lda, const double* W, size_t ldw, const double* bias,
+                    double* C, size_t ldc, size_t M, size_t N, size_t K);
+
+// Same product with reduced-precision weights: A holds float activations and each
+// cache block of K accumulates in fp32 before being added to the double result
+void nn_kernel_gemm_f32(const float* A, size_t lda, const float* W, size_t ldw, const double* bias,
+                        double* C, size_t ldc, size_t M, size_t N, size_t K);
+void nn_kernel_gemm_bf16(const float* A, size_t lda, const uint16_t* W, size_t ldw, const double* bias,
+                         double* C, size_t ldc, size_t M, size_t N, size_t K);
+
+// Exact integer product for quantized layers: C[m * ldc + n] = sum_k A[m * lda + k] * W[n * ldw + k].
+// Activations must lie in [0, 127] so AVX2 maddubs pair sums cannot saturate 16 bits
+void nn_kernel_gemm_u8s8(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw,
+                         int32_t* C, size_t ldc, size_t M, size_t N, size_t K);
+
+// Transposed accumulate for weight gradients: G[n * ldg + k] += sum_m D[m * ldd + n] * X[m * ldx + k]
+// for n < N, k < K, i.e. G += D^T X with one sample per row of D (output gradients) and X (layer inputs)
+void nn_kernel_gemm_tn_acc(const double* D, size_t ldd, const double* X, size_t ldx,
+                           double* G, size_t ldg, size_t M, size_t N, size_t K);
+
+// bfloat16 is the upper half of an IEEE float; conversion rounds to nearest even
+static inline uint16_t nn_float_to_bf16(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) return (uint16_t)((bits >> 16) | 0x40);  // Keep NaN quiet
+    bits += 0x7FFFu + ((bits >> 16) & 1u);
+    return (uint16_t)(bits >> 16);
+}
+
+static inline float nn_bf16_to_float(uint16_t value) {
+    uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// In-place elementwise activations
+void nn_kernel_sigmoid(double* x, size_t n);
+void nn_kernel_tanh(double* x, size_t n);
+
+// Fused optimizer steps over a contiguous parameter block: one sweep reads each parameter,
+// its gradient and optimizer state, writes them back and clears the gradient. Weight decay
+// is L2 folded into the gradient (g + weight_decay * p) before the update rule.
+typedef struct {
+    double learning_rate;
+    double weight_decay;
+    double momentum;        // SGD velocity decay
+    double beta1;           // Adam first-moment decay
+    double beta2;           // Adam second-moment decay
+    double rho;             // RMSProp squared-gradient decay
+    double epsilon;
+    double correction1;     // Adam bias corrections 1 - beta^t for the current step
+    double correction2;
+} NNOptimizerStep;
+
+void nn_kernel_sgd(double* param, double* grad, double* velocity,  // velocity = momentum * velocity + g, p -= lr * velocity;
+                   size_t n, const NNOptimizerStep* step);           // velocity may be null for plain SGD
+void nn_kernel_adam(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step);
+void nn_kernel_rmsprop(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step);
+void nn_kernel_adagrad(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NN_KERNELS_H
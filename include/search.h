@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess_representation.h"
+#include "transposition_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEARCH_MAX_PLY 64
+#define SEARCH_MATE_SCORE 3.0      // Above any network evaluation; mate in n plies scores 3.0 - n/1000
+#define SEARCH_MATE_PLY_STEP 0.001
+
+// Static evaluation callback, from white's point of view
+typedef double (*SearchEvaluator)(void* context, const ChessPosition* pos);
+
+// Limits for one search; zero means unlimited (max_depth is clamped to SEARCH_MAX_PLY)
+typedef struct {
+    size_t max_depth;
+    uint64_t max_nodes;
+    double max_time_ms;
+} SearchLimits;
+
+// Result of the last completed iteration
+typedef struct {
+    ChessMove best_move;
+    bool has_move;                    // False when the root has no legal moves
+    double score;                     // From side-to-move's point of view
+    size_t depth;                     // Deepest fully completed iteration
+    uint64_t nodes;
+    ChessMove pv[SEARCH_MAX_PLY];     // Principal variation starting with best_move
+    size_t pv_length;
+} SearchResult;
+
+// Negamax principal variation search with iterative deepening, aspiration
+// windows, TT/MVV-LVA/killer/history move ordering and quiescence search.
+// pos is modified during the search and restored before returning; tt may be null.
+void search_run(ChessPosition* pos, const SearchLimits* limits, TranspositionTable* tt,
+                SearchEvaluator evaluate, void* context, SearchResult* result);
+bool search_is_mate_score(double score);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEARCH_H
@@ -6,10 +6,12 @@
 #define TRAINING_ENGINE_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "neural_network.h"
 #include "curriculum_learning.h"
 #include "pavlovian_learning.h"
+#include "training_shard.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,7 +23,7 @@ typedef struct {
     double learning_rate;
     double momentum;
     double weight_decay;
-    size_t batch_size;
+    size_t batch_size;        // Examples per optimizer step; 0 is treated as 1
     size_t max_epochs;
     double early_stopping_threshold;
     bool use_curriculum;
@@ -29,8 +31,24 @@ typedef struct {
     bool use_spaced_repetition;
     double mastery_threshold;
     size_t patience;  // Early stopping patience
+    size_t num_threads;       // Data-parallel workers sharing each mini-batch; 0 or 1 trains on the calling thread
+    uint64_t seed;            // Shuffle seed; a fixed seed and thread count reproduce a run bit for bit
+    bool hogwild;             // Epochs run asynchronous SGD: each worker trains its own mini-batches and writes the
+                              // shared weights directly (learning_rate, weight_decay; no optimizer state). Sparse first-layer
+                              // columns (held column-major for the epoch) are written lock-free and may collide; dense layers
+                              // are written under a lock, deferred while it is busy, and read unlocked by other workers' forwards
+    bool incremental_checkpoints;  // Saving over an existing checkpoint rewrites only the sections that changed
+    const char* checkpoint_path;   // training_engine_train_full checkpoints here every checkpoint_interval epochs (null: never)
+    size_t checkpoint_interval;
+    bool async_checkpoints;        // Snapshot the state and write it on a background thread while training continues
 } TrainingConfig;
 
+// Defaults for every field: Adam at 0.001 with momentum 0.9, weight decay 1e-4, batches of 32,
+// 100 epochs, early stop below 0.001, mastery 0.85, patience 10; single-threaded, seed 1, no
+// curriculum, Pavlovian or spaced-repetition components, no Hogwild and no checkpointing.
+// Start every config here so fields added later get a defined value.
+void training_config_init(TrainingConfig* config);
+
 // Training statistics
 typedef struct {
     double current_loss;
@@ -41,8 +59,16 @@ typedef struct {
     DifficultyLevelEnum current_level;
     double training_time;
     double validation_accuracy;
+    double validation_loss;        // Mean squared error of the last training_engine_evaluate_examples
+    double checkpoint_latency;     // Seconds the last checkpoint paused training (the snapshot copy when asynchronous)
+    double checkpoint_write_time;  // Seconds the last finished checkpoint took to write
+    size_t checkpoints_written;
+    size_t checkpoint_bytes_copied;  // Bytes the last asynchronous snapshot copied (0 after a synchronous save)
 } TrainingStats;
 
+typedef struct TrainingPool TrainingPool;
+typedef struct CheckpointWriter CheckpointWriter;
+
 // Training Engine
 typedef struct {
     NeuralNetwork* network;
@@ -53,31 +79,86 @@ typedef struct {
     TrainingConfig config;
     TrainingStats stats;
     bool is_training;
+    
+    // Mini-batch staging: examples are packed into contiguous rows sized to the network
+    double* batch_inputs;     // batch_size x input_size
+    double* batch_targets;    // batch_size x output_size
+    double* batch_outputs;    // batch_size x output_size
+    TrainingPool* pool;       // Worker threads and their gradient replicas; null when single-threaded
+    
+    // Dataset for training_engine_train_epoch (borrowed rows sized to the network)
+    const double* data_inputs;
+    const double* data_targets;
+    size_t data_size;
+    size_t* data_order;       // Example order of the current epoch
+    uint64_t shuffle_state;   // Shuffle generator state, seeded from config.seed
+    CheckpointWriter* checkpoint_writer;  // Background writer and its two snapshot buffers; null until the first asynchronous checkpoint
 } TrainingEngine;
 
 // Training Engine API
 TrainingEngine* training_engine_create(NeuralNetwork* nn, TrainingConfig* config);
 void training_engine_destroy(TrainingEngine* engine);
 
-// Training methods
-void training_engine_train_epoch(TrainingEngine* engine);
+// Training methods. Each mini-batch is sharded across config.num_threads workers; their gradients
+// are summed in a fixed tree order before one optimizer step, so results do not depend on scheduling.
+void training_engine_set_data(TrainingEngine* engine, const double* inputs,  // inputs [n x input_size], targets [n x output_size];
+                              const double* targets, size_t num_examples);  // borrowed until replaced
+void training_engine_train_epoch(TrainingEngine* engine);                    // One shuffled pass over the dataset
+// One pass over a shard sized to the network, decoding each mini-batch from the mapping straight into
+// the staging rows, so no dense copy of the data set is ever held. Records are read in file order:
+// write shards pre-shuffled. Returns false, without training, if the shard shape does not match.
+bool training_engine_train_shard(TrainingEngine* engine, ShardReader* shard);
 void training_engine_train_full(TrainingEngine* engine);
+// Trains on the current level's examples. A mini-batch whose examples all carry sparse targets
+// trains through nn_backward_batch_sparse; one mixing in dense targets expands them to dense rows.
 void training_engine_train_with_curriculum(TrainingEngine* engine);
 void training_engine_train_with_pavlovian(TrainingEngine* engine, 
                                           const ConditionedStimulus* cs,
                                           const UnconditionedStimulus* us);
 void training_engine_train_with_spaced_repetition(TrainingEngine* engine);
 
-// Evaluation
+// Evaluation. training_engine_evaluate takes dense rows (num_examples x output_size targets) and
+// compares every output, so each example costs the full output width; policy targets should go
+// through training_engine_evaluate_examples instead.
 double training_engine_evaluate(TrainingEngine* engine, 
                                const double* inputs, 
                                const double* targets, 
                                size_t num_examples);
+// Loss and accuracy over examples, reading sparse targets in place: a dense target is correct when
+// every output is within 0.1 of it, a sparse one (a policy) when the highest output among its entries
+// is its most probable entry, so only the listed moves are compared. A sparse example's loss reads
+// its entries and the outputs below min(hidden, output) size, the only ones that can be nonzero.
+// Sets stats.validation_loss and stats.validation_accuracy; returns the accuracy.
+double training_engine_evaluate_examples(TrainingEngine* engine, const TrainingExample* examples, size_t num_examples);
 TrainingStats* training_engine_get_stats(TrainingEngine* engine);
 
-// Checkpointing
-void training_engine_save_checkpoint(TrainingEngine* engine, const char* filepath);
+// Checkpointing. A checkpoint is a small manifest at filepath naming one file per section
+// (filepath.<section>.<generation>): training stats, shuffle generator state and epoch order;
+// network parameters; optimizer moments; curriculum level state and examples; spaced-repetition
+// schedule and examples. Each section carries a checksum. Section files are written and synced
+// before the manifest is replaced by rename, so a crash at any point leaves the previous checkpoint
+// intact; files only the old manifest named are removed afterwards. With
+// config.incremental_checkpoints, sections whose contents match the existing checkpoint keep their
+// files, so a save after a few optimizer steps rewrites parameters and moments but not the examples.
+bool training_engine_save_checkpoint(TrainingEngine* engine, const char* filepath);
+// Resume into an engine built for the same network shape. The engine keeps its own config (threads,
+// batch size, ...); the epoch order is restored when the same dataset is set beforehand. Returns false,
+// with the engine unchanged, when the checkpoint is missing, corrupt or shaped differently. Weights
+// mapped from a model file are replaced by a private copy (see nn_unmap_model).
+bool training_engine_restore_checkpoint(TrainingEngine* engine, const char* filepath);
+// New engine with the saved config around a new network of the saved shape. The caller owns
+// the network: destroy engine->network after the engine.
 TrainingEngine* training_engine_load_checkpoint(const char* filepath);
+// Checkpoint as configured. With config.async_checkpoints the engine copies its state (parameter
+// arena, optimizer moments, everything else a checkpoint holds) into one of two snapshot buffers and
+// returns; a background thread writes the snapshot while training goes on. With incremental
+// checkpoints, sections unchanged since the last background write to the same path (for example the
+// examples, between additions) are not copied and keep their files. If the previous snapshot
+// is still waiting to be written it is replaced by the newer one, so training never waits on disk.
+// Returns false only when a synchronous save fails; asynchronous failures show up in the next wait.
+bool training_engine_checkpoint(TrainingEngine* engine, const char* filepath);
+bool training_engine_wait_checkpoints(TrainingEngine* engine);  // Block until queued writes finish; false if any failed since the last wait
+bool training_engine_remove_checkpoint(const char* filepath);   // Delete the section files the manifest names, then the manifest
 
 // Progressive difficulty training
 void training_engine_train_progressive(TrainingEngine* engine, 
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef TRAINING_SHARD_H
+#define TRAINING_SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess_representation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On-disk training shards of packed position records. A record holds the active input features
+// (square * 12 + channel for chess, see chess_position_get_features), the policy target as sparse
+// output index / probability pairs, and the value target: about 200 bytes for a middlegame position
+// instead of 39 KB as dense doubles. Decoded rows use the engine layout: one-hot inputs, the value
+// at output 0 and each probability at its index (from * 64 + to). Probabilities are stored to 1/65535.
+//
+// File: a header, the records back to back, then an index of record offsets for random access.
+// A shard is written to a temporary file and renamed into place when closed.
+typedef struct ShardWriter ShardWriter;
+typedef struct ShardReader ShardReader;
+
+#define SHARD_MAX_FEATURES 255
+#define SHARD_MAX_MOVES 255
+
+ShardWriter* shard_writer_create(const char* path, size_t input_size, size_t output_size);  // Null if the file cannot be created
+bool shard_writer_add(ShardWriter* writer, const uint16_t* features, size_t num_features,   // False (nothing written) when an index is out of
+                      const uint16_t* moves, const double* probabilities, size_t num_moves,   // range, a move repeats or a count exceeds its SHARD_MAX_*
+                      double value);
+bool shard_writer_add_position(ShardWriter* writer, const ChessPosition* pos,
+                               const uint16_t* moves, const double* probabilities, size_t num_moves, double value);
+bool shard_writer_close(ShardWriter* writer);          // Write the index and header and publish the file; frees the writer
+size_t shard_writer_size(const ShardWriter* writer);   // Records added so far
+
+// Reader over a read-only mapping of the shard, so decoding touches only the pages of the records
+// it reads and the page cache is shared with other readers. Opening checks the header and index
+// bounds; shard_reader_verify also checks the checksum, which reads the whole file.
+ShardReader* shard_reader_open(const char* path);      // Null if the file is missing or malformed
+void shard_reader_close(ShardReader* reader);
+bool shard_reader_verify(ShardReader* reader);
+size_t shard_reader_size(const ShardReader* reader);
+size_t shard_reader_input_size(const ShardReader* reader);
+size_t shard_reader_output_size(const ShardReader* reader);
+
+// Decode records [first, first + count) into rows, zeroing each row first; returns the rows written
+size_t shard_reader_decode(ShardReader* reader, size_t first, size_t count,
+                           double* inputs, size_t input_stride, double* targets, size_t target_stride);
+// Streaming: decode the next records after the cursor; returns 0 at the end of the shard
+size_t shard_reader_next_batch(ShardReader* reader, size_t batch_size,
+                               double* inputs, size_t input_stride, double* targets, size_t target_stride);
+// Same, leaving the targets sparse in the NNSparseTargets layout: row b lists entries [offsets[b],
+// offsets[b + 1]) of indices and values, the value at index 0 and then the moves. offsets needs
+// batch_size + 1 entries, indices and values batch_size * (SHARD_MAX_MOVES + 1)
+size_t shard_reader_next_batch_sparse(ShardReader* reader, size_t batch_size, double* inputs, size_t input_stride,
+                                      size_t* offsets, uint32_t* indices, double* values);
+void shard_reader_rewind(ShardReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRAINING_SHARD_H
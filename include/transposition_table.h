@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess_representation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-size hash table keyed by chess_position_get_hash(). Each 64-byte bucket
+// holds two depth-preferred and two always-replace entries. Entries are stored
+// lock-free as (key ^ data, data) so torn writes from concurrent threads fail
+// verification instead of returning corrupt data.
+typedef struct TranspositionTable TranspositionTable;
+
+// Bound type of a stored search score
+typedef enum {
+    TT_BOUND_NONE = 0,   // Entry carries only a cached evaluation
+    TT_BOUND_UPPER = 1,  // Score failed low (true score <= score)
+    TT_BOUND_LOWER = 2,  // Score failed high (true score >= score)
+    TT_BOUND_EXACT = 3
+} TTBound;
+
+// Probe result (scores and evaluations are quantized to 1/8192 within +-3.99)
+typedef struct {
+    uint16_t move;       // Packed best move, 0 if none
+    double score;        // Search score from side-to-move's point of view
+    double eval;         // Cached network evaluation (valid if has_eval)
+    int depth;           // Remaining search depth the score was computed at
+    TTBound bound;
+    bool has_eval;
+} TTEntry;
+
+TranspositionTable* transposition_table_create(size_t size_mb);
+void transposition_table_destroy(TranspositionTable* tt);
+void transposition_table_clear(TranspositionTable* tt);
+size_t transposition_table_size_mb(const TranspositionTable* tt);
+void transposition_table_new_search(TranspositionTable* tt);  // Ages entries from earlier searches
+
+bool transposition_table_probe(TranspositionTable* tt, uint64_t key, TTEntry* entry);
+void transposition_table_store(TranspositionTable* tt, uint64_t key, uint16_t move,
+                               double score, int depth, TTBound bound);
+void transposition_table_store_eval(TranspositionTable* tt, uint64_t key, double eval);
+size_t transposition_table_hashfull(const TranspositionTable* tt);  // Permille of sampled entries used this search
+
+// Moves are packed as from | to << 6 | promotion << 12
+static inline uint16_t transposition_table_pack_move(const ChessMove* move) {
+    return (uint16_t)(move->from | (move->to << 6) | ((move->promotion & 7) << 12));
+}
+
+static inline bool transposition_table_move_matches(uint16_t packed, const ChessMove* move) {
+    return packed != 0 && packed == transposition_table_pack_move(move);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRANSPOSITION_TABLE_H
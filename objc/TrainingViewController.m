@@ -96,6 +96,7 @@
     
     // Create training config
     TrainingConfig config;
+    training_config_init(&config);                         // Defined values for every field, including threads and Hogwild
     config.optimizer_type = (OptimizerType)[self.optimizerPopup indexOfSelectedItem];
     config.learning_rate = [self.learningRateSlider doubleValue];
     config.momentum = 0.9;
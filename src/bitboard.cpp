@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/bitboard.h"
+#include <cstring>
+#include <cstdlib>
+
+BitboardMagic bitboard_rook_magics[64];
+BitboardMagic bitboard_bishop_magics[64];
+Bitboard bitboard_knight_table[64];
+Bitboard bitboard_king_table[64];
+Bitboard bitboard_pawn_table[2][64];
+Bitboard bitboard_between_table[64][64];
+Bitboard bitboard_line_table[64][64];
+
+// Shared sliding attack storage (fixed-shift magics need 102400 rook and 5248 bishop entries)
+static Bitboard rook_table[102400];
+static Bitboard bishop_table[5248];
+
+// Magic multipliers found offline by the search in init_magics; verified at startup and re-searched on mismatch
+static const Bitboard rook_seed_magics[64] = {
+    0x0A80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+    0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+    0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+};
+
+static const Bitboard bishop_seed_magics[64] = {
+    0x40106000A1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+    0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+    0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+    0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+    0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+};
+
+static const int rook_directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int bishop_directions[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+static Bitboard sliding_attacks(const int directions[4][2], int sq, Bitboard occupied) {  // Walk each ray until the board edge or first blocker
+    Bitboard attacks = 0;                                             // Initialize attack set to empty before walking rays
+    for (int d = 0; d < 4; d++) {                                     // Iterate through the four ray directions of this slider
+        int file = sq % 8 + directions[d][0];                         // Step one file along current ray direction
+        int rank = sq / 8 + directions[d][1];                         // Step one rank along current ray direction
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {      // Continue while the ray stays on the board
+            Bitboard bit = BITBOARD_SQUARE(rank * 8 + file);          // Get bit for square reached along the ray
+            attacks |= bit;                                           // Add reached square to attack set including blockers
+            if (occupied & bit) break;                                // Stop ray at first occupied square
+            file += directions[d][0];
+            rank += directions[d][1];
+        }
+    }
+    return attacks;                                                   // Return union of all ray attacks
+}
+
+static Bitboard relevant_mask(const int directions[4][2], int sq) {   // Occupancy bits that can change slider attacks from a square
+    Bitboard mask = 0;
+    for (int d = 0; d < 4; d++) {
+        int file = sq % 8 + directions[d][0];
+        int rank = sq / 8 + directions[d][1];
+        // Edge squares never block anything beyond themselves, so they are excluded from the mask
+        while (file + directions[d][0] >= 0 && file + directions[d][0] < 8 &&
+               rank + directions[d][1] >= 0 && rank + directions[d][1] < 8) {
+            mask |= BITBOARD_SQUARE(rank * 8 + file);
+            file += directions[d][0];
+            rank += directions[d][1];
+        }
+    }
+    return mask;
+}
+
+#if !defined(__BMI2__)
+static uint64_t xorshift_next(uint64_t* state) {                      // Deterministic xorshift64* generator for reproducible magic search
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+#endif
+
+static void init_magics(const int directions[4][2], const Bitboard* seed_magics, BitboardMagic* magics, Bitboard* table) {  // Build fancy magic tables for one slider type
+    Bitboard occupancies[4096];                                       // Every subset of the relevant mask for current square
+    Bitboard references[4096];                                        // Reference attacks computed by ray walking per subset
+    int epochs[4096];                                                 // Per-slot epoch so failed magic attempts need no clearing
+    memset(epochs, 0, sizeof(epochs));
+    static const uint64_t rank_seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};  // Seeds known to converge quickly per rank
+    int attempt = 0;
+    size_t offset = 0;
+
+    for (int sq = 0; sq < 64; sq++) {                                 // Find a collision-free magic for every square
+        BitboardMagic* m = &magics[sq];
+        m->mask = relevant_mask(directions, sq);
+        int bits = bitboard_popcount(m->mask);
+        m->shift = 64 - bits;
+        m->attacks = table + offset;
+        size_t size = 0;
+
+        Bitboard subset = 0;                                          // Enumerate subsets with the carry-rippler trick
+        do {
+            occupancies[size] = subset;
+            references[size] = sliding_attacks(directions, sq, subset);
+#if defined(__BMI2__)
+            m->attacks[_pext_u64(subset, m->mask)] = references[size];
+#endif
+            size++;
+            subset = (subset - m->mask) & m->mask;
+        } while (subset);
+        offset += size;
+
+#if !defined(__BMI2__)
+        uint64_t seed = rank_seeds[sq / 8];                           // Fixed seed so every process builds identical tables
+        bool use_seed_magic = true;                                   // Try the precomputed magic first so startup needs one pass
+        for (size_t i = 0; i < size; ) {                              // Retry random sparse candidates until all subsets map cleanly
+            if (use_seed_magic) {
+                m->magic = seed_magics[sq];
+                use_seed_magic = false;
+            } else {
+                do {
+                    m->magic = xorshift_next(&seed) & xorshift_next(&seed) & xorshift_next(&seed);
+                } while (bitboard_popcount((m->mask * m->magic) >> 56) < 6);
+            }
+
+            attempt++;
+            for (i = 0; i < size; i++) {
+                size_t idx = bitboard_magic_index(m, occupancies[i]);
+                if (epochs[idx] < attempt) {                          // Slot unused in this attempt so claim it
+                    epochs[idx] = attempt;
+                    m->attacks[idx] = references[i];
+                } else if (m->attacks[idx] != references[i]) {        // Destructive collision so reject this magic
+                    break;
+                }
+            }
+        }
+#else
+        (void)attempt;
+        (void)epochs;
+        (void)occupancies;
+        (void)rank_seeds;
+        (void)seed_magics;
+#endif
+    }
+}
+
+static Bitboard step_attacks(int sq, const int (*steps)[2], int num_steps) {  // Attack set of a leaper from its step offsets
+    Bitboard attacks = 0;
+    for (int i = 0; i < num_steps; i++) {
+        int file = sq % 8 + steps[i][0];
+        int rank = sq / 8 + steps[i][1];
+        if (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+            attacks |= BITBOARD_SQUARE(rank * 8 + file);
+        }
+    }
+    return attacks;
+}
+
+static bool build_tables() {                                          // Populate every lookup table once per process
+    static const int knight_steps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    static const int king_steps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    static const int white_pawn_steps[2][2] = {{-1, 1}, {1, 1}};
+    static const int black_pawn_steps[2][2] = {{-1, -1}, {1, -1}};
+
+    for (int sq = 0; sq < 64; sq++) {
+        bitboard_knight_table[sq] = step_attacks(sq, knight_steps, 8);
+        bitboard_king_table[sq] = step_attacks(sq, king_steps, 8);
+        bitboard_pawn_table[COLOR_WHITE][sq] = step_attacks(sq, white_pawn_steps, 2);
+        bitboard_pawn_table[COLOR_BLACK][sq] = step_attacks(sq, black_pawn_steps, 2);
+    }
+
+    init_magics(rook_directions, rook_seed_magics, bitboard_rook_magics, rook_table);
+    init_magics(bishop_directions, bishop_seed_magics, bitboard_bishop_magics, bishop_table);
+
+    for (int a = 0; a < 64; a++) {                                    // Precompute between and line masks used for pins and checks
+        for (int b = 0; b < 64; b++) {
+            bitboard_between_table[a][b] = 0;
+            bitboard_line_table[a][b] = 0;
+            if (a == b) continue;
+
+            Bitboard bb = BITBOARD_SQUARE(b);
+            if (sliding_attacks(rook_directions, a, 0) & bb) {
+                bitboard_line_table[a][b] = (sliding_attacks(rook_directions, a, 0) &
+                                             sliding_attacks(rook_directions, b, 0)) |
+                                            BITBOARD_SQUARE(a) | bb;
+                bitboard_between_table[a][b] = sliding_attacks(rook_directions, a, bb) &
+                                               sliding_attacks(rook_directions, b, BITBOARD_SQUARE(a));
+            } else if (sliding_attacks(bishop_directions, a, 0) & bb) {
+                bitboard_line_table[a][b] = (sliding_attacks(bishop_directions, a, 0) &
+                                             sliding_attacks(bishop_directions, b, 0)) |
+                                            BITBOARD_SQUARE(a) | bb;
+                bitboard_between_table[a][b] = sliding_attacks(bishop_directions, a, bb) &
+                                               sliding_attacks(bishop_directions, b, BITBOARD_SQUARE(a));
+            }
+        }
+    }
+    return true;
+}
+
+void bitboard_init(void) {
+    static const bool initialized = build_tables();                   // Function-local static gives thread-safe one-time init
+    (void)initialized;
+}
+
+Bitboard bitboard_piece_attacks(PieceType piece, Square sq, Bitboard occupied) {
+    switch (piece) {
+        case PIECE_KNIGHT: return bitboard_knight_attacks(sq);
+        case PIECE_BISHOP: return bitboard_bishop_attacks(sq, occupied);
+        case PIECE_ROOK: return bitboard_rook_attacks(sq, occupied);
+        case PIECE_QUEEN: return bitboard_queen_attacks(sq, occupied);
+        case PIECE_KING: return bitboard_king_attacks(sq);
+        default: return 0;
+    }
+}
@@ -3,14 +3,20 @@
  * All rights reserved.
  */
 #include "../include/chess_representation.h"
+#include "../include/bitboard.h"
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
+#include <cassert>
+#include <vector>
+
+#define CHESS_HISTORY_RESERVE 256   // Plies of move history allocated with each position
 
 // Chess Position Implementation
 struct ChessPosition {
-    PieceType board[64];  // 8x8 board
-    Color colors[64];
+    Bitboard by_type[7];       // Pieces of each type for both colors (index PIECE_NONE holds every piece)
+    Bitboard by_color[2];      // Pieces of each color
+    unsigned char board[64];   // Mailbox of packed piece codes (type | color << 3) kept in sync with bitboards
     bool white_to_move;
     bool white_castle_kingside;
     bool white_castle_queenside;
@@ -19,6 +25,7 @@ struct ChessPosition {
     Square en_passant_square;
     size_t halfmove_clock;
     size_t fullmove_number;
+    uint64_t hash;             // Zobrist key maintained incrementally by the board helpers and make/unmake
     
     // Move history for unmake
     struct MoveHistory {
@@ -30,14 +37,101 @@ struct ChessPosition {
         bool black_castle_kingside;
         bool black_castle_queenside;
         Square en_passant_square;
-    } move_history[1000];
-    size_t move_history_count;
+        size_t halfmove_clock;
+        uint64_t hash;
+        ChessFeatureDelta features;  // Input features changed by the move
+    };
+    std::vector<MoveHistory> move_history;  // One entry per ply played; grows with the game, so long games never run out
 };
 
+// Zobrist keys: one per piece/color/square, side to move, castling-rights mask and en passant file
+static uint64_t zobrist_piece[2][7][64];
+static uint64_t zobrist_side;
+static uint64_t zobrist_castling[16];
+static uint64_t zobrist_en_passant[8];
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static bool build_zobrist_keys() {                                     // Fill key tables from fixed seed so hashes are stable across runs
+    uint64_t state = 0x2545F4914F6CDD1DULL;                           // Fixed seed keeps keys identical between builds and processes
+    for (int color = 0; color < 2; color++) {
+        for (int piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            for (int square = 0; square < 64; square++) {
+                zobrist_piece[color][piece][square] = splitmix64(&state);
+            }
+        }
+    }
+    zobrist_side = splitmix64(&state);
+    zobrist_castling[0] = 0;                                           // No rights contributes nothing so empty key stays zero
+    for (int i = 1; i < 16; i++) zobrist_castling[i] = splitmix64(&state);
+    for (int i = 0; i < 8; i++) zobrist_en_passant[i] = splitmix64(&state);
+    return true;
+}
+
+static inline unsigned castling_mask(const ChessPosition* pos) {
+    return (pos->white_castle_kingside ? 1u : 0u) | (pos->white_castle_queenside ? 2u : 0u) |
+           (pos->black_castle_kingside ? 4u : 0u) | (pos->black_castle_queenside ? 8u : 0u);
+}
+
+static inline PieceType piece_at(const ChessPosition* pos, Square square) {
+    return (PieceType)(pos->board[square] & 7);
+}
+
+static inline Color color_at(const ChessPosition* pos, Square square) {
+    return (Color)(pos->board[square] >> 3);
+}
+
+static inline uint16_t feature_index(Square square, PieceType piece, Color color) {  // Matrix entry set by chess_position_to_matrix
+    return (uint16_t)(square * 12 + (piece - 1) * 2 + color);
+}
+
+static inline void put_piece(ChessPosition* pos, Square square, PieceType piece, Color color) {  // Place piece on empty square updating every board view
+    Bitboard bit = BITBOARD_SQUARE(square);                           // Get single bit mask for target square
+    pos->by_type[PIECE_NONE] |= bit;                                  // Mark square as occupied in combined occupancy
+    pos->by_type[piece] |= bit;                                       // Add square to bitboard of this piece type
+    pos->by_color[color] |= bit;                                      // Add square to bitboard of this color
+    pos->board[square] = (unsigned char)(piece | (color << 3));       // Store packed piece code in mailbox
+    pos->hash ^= zobrist_piece[color][piece][square];                 // Add piece to position key
+}
+
+static inline void remove_piece(ChessPosition* pos, Square square) {  // Clear occupied square updating every board view
+    Bitboard bit = BITBOARD_SQUARE(square);                           // Get single bit mask for cleared square
+    pos->hash ^= zobrist_piece[color_at(pos, square)][piece_at(pos, square)][square];  // Remove piece from position key
+    pos->by_type[PIECE_NONE] ^= bit;                                  // Remove square from combined occupancy
+    pos->by_type[piece_at(pos, square)] ^= bit;                       // Remove square from bitboard of its piece type
+    pos->by_color[color_at(pos, square)] ^= bit;                      // Remove square from bitboard of its color
+    pos->board[square] = 0;                                           // Mark mailbox square as empty
+}
+
+static inline void move_piece(ChessPosition* pos, Square from, Square to) {  // Move piece to empty square with one xor per bitboard
+    Bitboard from_to = BITBOARD_SQUARE(from) | BITBOARD_SQUARE(to);   // Mask toggling both origin and destination squares
+    const uint64_t* keys = zobrist_piece[color_at(pos, from)][piece_at(pos, from)];  // Get key row for moving piece
+    pos->hash ^= keys[from] ^ keys[to];                               // Move piece key from origin to destination
+    pos->by_type[PIECE_NONE] ^= from_to;                              // Move occupancy bit from origin to destination
+    pos->by_type[piece_at(pos, from)] ^= from_to;                     // Move piece type bit from origin to destination
+    pos->by_color[color_at(pos, from)] ^= from_to;                    // Move color bit from origin to destination
+    pos->board[to] = pos->board[from];                                // Copy packed piece code to destination square
+    pos->board[from] = 0;                                             // Clear origin square in mailbox
+}
+
+static void clear_board(ChessPosition* pos) {
+    memset(pos->by_type, 0, sizeof(pos->by_type));
+    memset(pos->by_color, 0, sizeof(pos->by_color));
+    memset(pos->board, 0, sizeof(pos->board));
+    pos->hash = 0;
+}
+
 ChessPosition* chess_position_create() {                               // Create new empty chess position with default initial state
+    bitboard_init();                                                   // Make sure attack lookup tables are built before first use
+    static const bool zobrist_ready = build_zobrist_keys();            // Function-local static gives thread-safe one-time key init
+    (void)zobrist_ready;
     ChessPosition* pos = new ChessPosition;                            // Allocate memory for new chess position structure
-    memset(pos->board, 0, 64 * sizeof(PieceType));                     // Initialize board array to empty squares for all sixty four squares
-    memset(pos->colors, 0, 64 * sizeof(Color));                       // Initialize color array to zero for all sixty four squares
+    clear_board(pos);                                                  // Initialize bitboards and mailbox to empty for all sixty four squares
     pos->white_to_move = true;                                         // Set active player to white for initial position
     pos->white_castle_kingside = true;                                 // Enable white kingside castling rights initially
     pos->white_castle_queenside = true;                                // Enable white queenside castling rights initially
@@ -46,34 +140,42 @@ ChessPosition* chess_position_create() {                               // Create
     pos->en_passant_square = 0;                                        // Initialize en passant target square to none
     pos->halfmove_clock = 0;                                           // Initialize halfmove clock for fifty move rule
     pos->fullmove_number = 1;                                         // Initialize fullmove counter starting at move one
-    pos->move_history_count = 0;                                      // Initialize move history counter to zero
+    pos->move_history.reserve(CHESS_HISTORY_RESERVE);                 // Searches and typical games never reallocate
+    pos->hash = chess_position_compute_hash(pos);                     // Key for empty board with initial side and rights
     
     return pos;                                                        // Return pointer to initialized chess position
 }
 
+ChessPosition* chess_position_clone(const ChessPosition* pos) {
+    return new ChessPosition(*pos);
+}
+
 void chess_position_destroy(ChessPosition* pos) {
     if (pos) {
         delete pos;
     }
 }
 
-// FEN parsing (simplified - full implementation would be more complex)
+// FEN parsing
 ChessPosition* chess_position_from_fen(const char* fen) {
     ChessPosition* pos = chess_position_create();
     
-    // Simplified FEN parsing (full implementation would parse all fields)
     // Format: "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
     
-    size_t square = 0;
+    // FEN lists rank 8 first, so start at a8 and walk down the board
+    int rank = 7;
+    int file = 0;
     const char* p = fen;
     
     // Parse board
     while (*p && *p != ' ') {
         if (*p == '/') {
             // Next rank
+            rank--;
+            file = 0;
         } else if (*p >= '1' && *p <= '8') {
             // Empty squares
-            square += (*p - '0');
+            file += (*p - '0');
         } else {
             // Piece
             PieceType piece = PIECE_NONE;
@@ -94,11 +196,10 @@ ChessPosition* chess_position_from_fen(const char* fen) {
                 case 'k': piece = PIECE_KING; color = COLOR_BLACK; break;
             }
             
-            if (square < 64) {
-                pos->board[square] = piece;
-                pos->colors[square] = color;
-                square++;
+            if (piece != PIECE_NONE && rank >= 0 && file < 8) {
+                put_piece(pos, (Square)(rank * 8 + file), piece, color);
             }
+            file++;
         }
         p++;
     }
@@ -108,11 +209,35 @@ ChessPosition* chess_position_from_fen(const char* fen) {
     if (*p == 'w') pos->white_to_move = true;
     else if (*p == 'b') pos->white_to_move = false;
     
-    // Parse castling rights (simplified)
+    // Parse castling rights
     while (*p && *p != ' ') p++;
     while (*p == ' ') p++;
-    // Full implementation would parse KQkq format
+    pos->white_castle_kingside = false;
+    pos->white_castle_queenside = false;
+    pos->black_castle_kingside = false;
+    pos->black_castle_queenside = false;
+    while (*p && *p != ' ') {
+        if (*p == 'K') pos->white_castle_kingside = true;
+        else if (*p == 'Q') pos->white_castle_queenside = true;
+        else if (*p == 'k') pos->black_castle_kingside = true;
+        else if (*p == 'q') pos->black_castle_queenside = true;
+        p++;
+    }
+    
+    // Parse en passant target square
+    while (*p == ' ') p++;
+    if (p[0] >= 'a' && p[0] <= 'h' && p[1] >= '1' && p[1] <= '8') {
+        pos->en_passant_square = (Square)((p[1] - '1') * 8 + (p[0] - 'a'));
+    }
+    while (*p && *p != ' ') p++;
+    
+    // Parse halfmove clock and fullmove number (optional in abbreviated FENs)
+    while (*p == ' ') p++;
+    if (*p >= '0' && *p <= '9') pos->halfmove_clock = (size_t)strtoul(p, (char**)&p, 10);
+    while (*p == ' ') p++;
+    if (*p >= '1' && *p <= '9') pos->fullmove_number = (size_t)strtoul(p, (char**)&p, 10);
     
+    pos->hash = chess_position_compute_hash(pos);
     return pos;
 }
 
@@ -125,7 +250,7 @@ void chess_position_to_fen(ChessPosition* pos, FENString* fen) {
         int empty_count = 0;
         for (int file = 0; file < 8; file++) {
             int square = rank * 8 + file;
-            PieceType piece = pos->board[square];
+            PieceType piece = piece_at(pos, square);
             
             if (piece == PIECE_NONE) {
                 empty_count++;
@@ -136,7 +261,7 @@ void chess_position_to_fen(ChessPosition* pos, FENString* fen) {
                 }
                 
                 char piece_char = ' ';
-                Color color = pos->colors[square];
+                Color color = color_at(pos, square);
                 switch (piece) {
                     case PIECE_PAWN: piece_char = color == COLOR_WHITE ? 'P' : 'p'; break;
                     case PIECE_ROOK: piece_char = color == COLOR_WHITE ? 'R' : 'r'; break;
@@ -191,20 +316,20 @@ void chess_position_to_fen(ChessPosition* pos, FENString* fen) {
 void chess_position_to_matrix(ChessPosition* pos, double* matrix) {     // Convert chess position to eight by eight by twelve tensor representation
     memset(matrix, 0, 8 * 8 * 12 * sizeof(double));                    // Initialize entire matrix to zero for all squares and channels
     
-    for (size_t square = 0; square < 64; square++) {                   // Iterate through each square on eight by eight board
-        PieceType piece = pos->board[square];                           // Get piece type at current square
-        if (piece == PIECE_NONE) continue;                              // Skip empty squares with no piece present
-        
-        Color color = pos->colors[square];                              // Get color of piece at current square
-        size_t channel = (piece - 1) * 2 + color;                      // Calculate channel index from piece type and color
-        
-        matrix[square * 12 + channel] = 1.0;                           // Set matrix value to one indicating piece presence
+    for (int color = COLOR_WHITE; color <= COLOR_BLACK; color++) {     // Visit pieces of each color through bitboards instead of scanning squares
+        for (int piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {   // Visit each piece type of current color
+            size_t channel = (piece - 1) * 2 + color;                  // Calculate channel index from piece type and color
+            Bitboard bb = pos->by_type[piece] & pos->by_color[color];  // Get set of squares holding this piece type and color
+            while (bb) {                                               // Iterate through occupied squares of this set
+                Square square = bitboard_pop_lsb(&bb);                 // Extract lowest square and clear it from set
+                matrix[square * 12 + channel] = 1.0;                   // Set matrix value to one indicating piece presence
+            }
+        }
     }
 }
 
 void chess_position_from_matrix(ChessPosition* pos, const double* matrix) {
-    memset(pos->board, 0, 64 * sizeof(PieceType));
-    memset(pos->colors, 0, 64 * sizeof(Color));
+    clear_board(pos);
     
     for (size_t square = 0; square < 64; square++) {
         double max_val = 0.0;
@@ -220,20 +345,52 @@ void chess_position_from_matrix(ChessPosition* pos, const double* matrix) {
         if (max_val > 0.5) {  // Threshold
             PieceType piece = (PieceType)((best_channel / 2) + 1);
             Color color = (Color)(best_channel % 2);
-            pos->board[square] = piece;
-            pos->colors[square] = color;
+            put_piece(pos, (Square)square, piece, color);
         }
     }
+    pos->hash = chess_position_compute_hash(pos);
 }
 
 PieceType chess_position_get_piece(ChessPosition* pos, Square square) {
     if (square >= 64) return PIECE_NONE;
-    return pos->board[square];
+    return piece_at(pos, square);
 }
 
 Color chess_position_get_color(ChessPosition* pos, Square square) {
     if (square >= 64) return COLOR_WHITE;
-    return pos->colors[square];
+    return color_at(pos, square);
+}
+
+Bitboard chess_position_get_pieces(ChessPosition* pos, Color color, PieceType piece) {
+    return pos->by_type[piece] & pos->by_color[color];
+}
+
+Bitboard chess_position_get_color_occupancy(ChessPosition* pos, Color color) {
+    return pos->by_color[color];
+}
+
+Bitboard chess_position_get_occupancy(ChessPosition* pos) {
+    return pos->by_type[PIECE_NONE];
+}
+
+Bitboard chess_position_attackers_to(ChessPosition* pos, Square square, Bitboard occupied) {  // Collect pieces of both colors attacking a square
+    return (bitboard_pawn_attacks(COLOR_WHITE, square) & pos->by_type[PIECE_PAWN] & pos->by_color[COLOR_BLACK]) |  // Black pawns attack upward squares
+           (bitboard_pawn_attacks(COLOR_BLACK, square) & pos->by_type[PIECE_PAWN] & pos->by_color[COLOR_WHITE]) |  // White pawns attack downward squares
+           (bitboard_knight_attacks(square) & pos->by_type[PIECE_KNIGHT]) |                                         // Knights reaching square by leaping
+           (bitboard_king_attacks(square) & pos->by_type[PIECE_KING]) |                                             // Kings adjacent to square
+           (bitboard_rook_attacks(square, occupied) & (pos->by_type[PIECE_ROOK] | pos->by_type[PIECE_QUEEN])) |      // Orthogonal sliders with clear ray
+           (bitboard_bishop_attacks(square, occupied) & (pos->by_type[PIECE_BISHOP] | pos->by_type[PIECE_QUEEN]));  // Diagonal sliders with clear ray
+}
+
+bool chess_position_is_square_attacked(ChessPosition* pos, Square square, Color by_color) {  // Check if any piece of given color attacks square
+    Bitboard them = pos->by_color[by_color];                          // Get pieces of attacking side
+    Bitboard occupied = pos->by_type[PIECE_NONE];                     // Get full occupancy for slider ray blocking
+    
+    if (bitboard_pawn_attacks((Color)(by_color ^ 1), square) & pos->by_type[PIECE_PAWN] & them) return true;  // Reverse pawn lookup from target square
+    if (bitboard_knight_attacks(square) & pos->by_type[PIECE_KNIGHT] & them) return true;  // Knights attacking target square
+    if (bitboard_king_attacks(square) & pos->by_type[PIECE_KING] & them) return true;      // Enemy king adjacent to target square
+    if (bitboard_bishop_attacks(square, occupied) & (pos->by_type[PIECE_BISHOP] | pos->by_type[PIECE_QUEEN]) & them) return true;  // Diagonal sliders
+    return (bitboard_rook_attacks(square, occupied) & (pos->by_type[PIECE_ROOK] | pos->by_type[PIECE_QUEEN]) & them) != 0;  // Orthogonal sliders
 }
 
 bool chess_position_is_valid(ChessPosition* pos) {
@@ -242,72 +399,423 @@ bool chess_position_is_valid(ChessPosition* pos) {
 }
 
 bool chess_position_is_check(ChessPosition* pos, Color color) {
-    // Simplified - full implementation would check if king is under attack
-    return false;
+    Bitboard king = pos->by_type[PIECE_KING] & pos->by_color[color];
+    if (!king) return false;
+    return chess_position_is_square_attacked(pos, bitboard_lsb(king), (Color)(color ^ 1));
 }
 
 bool chess_position_is_checkmate(ChessPosition* pos, Color color) {
-    // Simplified - full implementation would check checkmate conditions
-    return false;
+    if (!chess_position_is_check(pos, color)) return false;
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, color, moves, &num_moves);
+    return num_moves == 0;
 }
 
 bool chess_position_is_stalemate(ChessPosition* pos) {
-    // Simplified - full implementation would check stalemate conditions
-    return false;
+    Color color = chess_position_get_side_to_move(pos);
+    if (chess_position_is_check(pos, color)) return false;
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, color, moves, &num_moves);
+    return num_moves == 0;
 }
 
-void chess_position_generate_moves(ChessPosition* pos, Color color, ChessMove* moves, size_t* num_moves) {
-    *num_moves = 0;
-    // Simplified move generation - full implementation would generate all legal moves
+Color chess_position_get_side_to_move(ChessPosition* pos) {
+    return pos->white_to_move ? COLOR_WHITE : COLOR_BLACK;
 }
 
-bool chess_position_is_legal_move(ChessPosition* pos, const ChessMove* move) {
-    // Simplified - full implementation would check move legality
-    return true;
+size_t chess_position_get_halfmove_clock(ChessPosition* pos) {
+    return pos->halfmove_clock;
+}
+
+static inline void add_move(ChessMove* moves, size_t* num_moves, Square from, Square to,
+                            PieceType piece, PieceType promotion, bool is_capture) {
+    ChessMove* move = &moves[(*num_moves)++];
+    move->from = from;
+    move->to = to;
+    move->piece = piece;
+    move->promotion = promotion;
+    move->is_castle = false;
+    move->is_en_passant = false;
+    move->is_capture = is_capture;
+}
+
+static inline void add_pawn_moves(ChessMove* moves, size_t* num_moves, Square from, Square to, bool is_capture) {
+    Bitboard promotion_ranks = BITBOARD_RANK_1 | BITBOARD_RANK_8;
+    if (BITBOARD_SQUARE(to) & promotion_ranks) {
+        add_move(moves, num_moves, from, to, PIECE_PAWN, PIECE_QUEEN, is_capture);
+        add_move(moves, num_moves, from, to, PIECE_PAWN, PIECE_ROOK, is_capture);
+        add_move(moves, num_moves, from, to, PIECE_PAWN, PIECE_BISHOP, is_capture);
+        add_move(moves, num_moves, from, to, PIECE_PAWN, PIECE_KNIGHT, is_capture);
+    } else {
+        add_move(moves, num_moves, from, to, PIECE_PAWN, PIECE_NONE, is_capture);
+    }
 }
 
-void chess_position_make_move(ChessPosition* pos, const ChessMove* move) {
-    if (pos->move_history_count >= 1000) return;
+// Attack test against an arbitrary occupancy, used for king moves where the king itself must not block rays
+static inline bool attacked_with_occupancy(const ChessPosition* pos, Square square, Color by_color, Bitboard occupied) {
+    Bitboard them = pos->by_color[by_color];
+    return ((bitboard_pawn_attacks((Color)(by_color ^ 1), square) & pos->by_type[PIECE_PAWN]) |
+            (bitboard_knight_attacks(square) & pos->by_type[PIECE_KNIGHT]) |
+            (bitboard_king_attacks(square) & pos->by_type[PIECE_KING]) |
+            (bitboard_rook_attacks(square, occupied) & (pos->by_type[PIECE_ROOK] | pos->by_type[PIECE_QUEEN])) |
+            (bitboard_bishop_attacks(square, occupied) & (pos->by_type[PIECE_BISHOP] | pos->by_type[PIECE_QUEEN]))) & them;
+}
+
+static void generate_castling(ChessPosition* pos, Color us, ChessMove* moves, size_t* num_moves) {  // Add castling moves when king is not in check
+    Color them = (Color)(us ^ 1);                                     // Get opponent color for attack tests
+    Bitboard occupied = pos->by_type[PIECE_NONE];                     // Get occupancy for emptiness tests
+    Bitboard rooks = pos->by_type[PIECE_ROOK] & pos->by_color[us];    // Get own rooks so stale rights are never used
+    Square king = us == COLOR_WHITE ? 4 : 60;                         // King home square e1 or e8
+    bool kingside = us == COLOR_WHITE ? pos->white_castle_kingside : pos->black_castle_kingside;
+    bool queenside = us == COLOR_WHITE ? pos->white_castle_queenside : pos->black_castle_queenside;
     
-    auto* hist = &pos->move_history[pos->move_history_count];
-    hist->move = *move;
-    hist->captured_piece = pos->board[move->to];
-    hist->captured_color = pos->colors[move->to];
-    hist->white_castle_kingside = pos->white_castle_kingside;
+    if (kingside && (rooks & BITBOARD_SQUARE(king + 3)) &&            // Rook still on h-file corner
+        !(occupied & (BITBOARD_SQUARE(king + 1) | BITBOARD_SQUARE(king + 2))) &&  // f and g squares empty
+        !chess_position_is_square_attacked(pos, king + 1, them) &&    // King does not pass through check
+        !chess_position_is_square_attacked(pos, king + 2, them)) {    // King does not land in check
+        add_move(moves, num_moves, king, king + 2, PIECE_KING, PIECE_NONE, false);
+        moves[*num_moves - 1].is_castle = true;                       // Flag move so make_move also moves rook
+    }
+    if (queenside && (rooks & BITBOARD_SQUARE(king - 4)) &&           // Rook still on a-file corner
+        !(occupied & (BITBOARD_SQUARE(king - 1) | BITBOARD_SQUARE(king - 2) | BITBOARD_SQUARE(king - 3))) &&  // b, c and d squares empty
+        !chess_position_is_square_attacked(pos, king - 1, them) &&    // King does not pass through check
+        !chess_position_is_square_attacked(pos, king - 2, them)) {    // King does not land in check
+        add_move(moves, num_moves, king, king - 2, PIECE_KING, PIECE_NONE, false);
+        moves[*num_moves - 1].is_castle = true;                       // Flag move so make_move also moves rook
+    }
+}
+
+void chess_position_generate_moves(ChessPosition* pos, Color color, ChessMove* moves, size_t* num_moves) {  // Generate all legal moves for color using pin and check masks
+    *num_moves = 0;                                                    // Start with empty move list
+    Color us = color;                                                  // Side generating moves
+    Color them = (Color)(color ^ 1);                                   // Opponent side
+    Bitboard occupied = pos->by_type[PIECE_NONE];                      // Get full board occupancy
+    Bitboard ours = pos->by_color[us];                                 // Get own pieces which can never be captured
+    Bitboard theirs = pos->by_color[them];                             // Get opponent pieces available for capture
+    Bitboard king_bb = pos->by_type[PIECE_KING] & ours;                // Locate own king
+    
+    Bitboard target = ~ours;                                           // Squares non-king pieces may move to
+    Bitboard pinned = 0;                                               // Own pieces pinned against king
+    Square king = 0;                                                   // King square when present
+    
+    if (king_bb) {                                                     // Positions without a king skip legality masks
+        king = bitboard_lsb(king_bb);                                  // Get king square
+        Bitboard checkers = chess_position_attackers_to(pos, king, occupied) & theirs;  // Find pieces giving check
+        
+        Bitboard without_king = occupied ^ king_bb;                    // Remove king so it cannot hide behind itself on slider rays
+        Bitboard king_targets = bitboard_king_attacks(king) & ~ours;   // Candidate king destinations
+        while (king_targets) {                                         // Keep only destinations not attacked by opponent
+            Square to = bitboard_pop_lsb(&king_targets);
+            if (!attacked_with_occupancy(pos, to, them, without_king)) {
+                add_move(moves, num_moves, king, to, PIECE_KING, PIECE_NONE, (theirs & BITBOARD_SQUARE(to)) != 0);
+            }
+        }
+        
+        if (bitboard_popcount(checkers) > 1) return;                  // Double check allows only king moves
+        if (checkers) {                                                // Single check must be captured or blocked
+            target &= bitboard_between(king, bitboard_lsb(checkers)) | checkers;
+        } else {
+            generate_castling(pos, us, moves, num_moves);             // Castling only possible when not in check
+        }
+        
+        Bitboard snipers = ((bitboard_rook_attacks(king, 0) & (pos->by_type[PIECE_ROOK] | pos->by_type[PIECE_QUEEN])) |
+                            (bitboard_bishop_attacks(king, 0) & (pos->by_type[PIECE_BISHOP] | pos->by_type[PIECE_QUEEN]))) & theirs;
+        while (snipers) {                                              // Own piece alone between slider and king is pinned
+            Bitboard blockers = bitboard_between(king, bitboard_pop_lsb(&snipers)) & occupied;
+            if (bitboard_popcount(blockers) == 1) pinned |= blockers & ours;
+        }
+    }
+    
+    // Knights (a pinned knight can never move)
+    Bitboard knights = pos->by_type[PIECE_KNIGHT] & ours & ~pinned;
+    while (knights) {
+        Square from = bitboard_pop_lsb(&knights);
+        Bitboard attacks = bitboard_knight_attacks(from) & target;
+        while (attacks) {
+            Square to = bitboard_pop_lsb(&attacks);
+            add_move(moves, num_moves, from, to, PIECE_KNIGHT, PIECE_NONE, (theirs & BITBOARD_SQUARE(to)) != 0);
+        }
+    }
+    
+    // Sliders (pinned ones stay on the line through their king)
+    Bitboard sliders = (pos->by_type[PIECE_BISHOP] | pos->by_type[PIECE_ROOK] | pos->by_type[PIECE_QUEEN]) & ours;
+    while (sliders) {
+        Square from = bitboard_pop_lsb(&sliders);
+        PieceType piece = piece_at(pos, from);
+        Bitboard attacks = bitboard_piece_attacks(piece, from, occupied) & target;
+        if (pinned & BITBOARD_SQUARE(from)) attacks &= bitboard_line(king, from);
+        while (attacks) {
+            Square to = bitboard_pop_lsb(&attacks);
+            add_move(moves, num_moves, from, to, piece, PIECE_NONE, (theirs & BITBOARD_SQUARE(to)) != 0);
+        }
+    }
+    
+    // Pawns
+    int forward = us == COLOR_WHITE ? 8 : -8;
+    Bitboard start_rank = us == COLOR_WHITE ? (BITBOARD_RANK_1 << 8) : (BITBOARD_RANK_8 >> 8);
+    Bitboard pawns = pos->by_type[PIECE_PAWN] & ours;
+    while (pawns) {
+        Square from = bitboard_pop_lsb(&pawns);
+        Bitboard allowed = target;
+        if (pinned & BITBOARD_SQUARE(from)) allowed &= bitboard_line(king, from);
+        
+        Square push = (Square)(from + forward);
+        if (!(occupied & BITBOARD_SQUARE(push))) {
+            if (allowed & BITBOARD_SQUARE(push)) add_pawn_moves(moves, num_moves, from, push, false);
+            Square double_push = (Square)(push + forward);
+            if ((start_rank & BITBOARD_SQUARE(from)) && !(occupied & BITBOARD_SQUARE(double_push)) &&
+                (allowed & BITBOARD_SQUARE(double_push))) {
+                add_move(moves, num_moves, from, double_push, PIECE_PAWN, PIECE_NONE, false);
+            }
+        }
+        
+        Bitboard captures = bitboard_pawn_attacks(us, from) & theirs & allowed;
+        while (captures) {
+            add_pawn_moves(moves, num_moves, from, bitboard_pop_lsb(&captures), true);
+        }
+        
+        // En passant removes two pieces from one rank, so test the resulting position directly
+        Square ep = pos->en_passant_square;
+        if (ep && (bitboard_pawn_attacks(us, from) & BITBOARD_SQUARE(ep))) {
+            Square captured = (Square)(ep - forward);
+            Bitboard after = (occupied ^ BITBOARD_SQUARE(from) ^ BITBOARD_SQUARE(captured)) | BITBOARD_SQUARE(ep);
+            if (!king_bb || !(chess_position_attackers_to(pos, king, after) & theirs & ~BITBOARD_SQUARE(captured))) {
+                add_move(moves, num_moves, from, ep, PIECE_PAWN, PIECE_NONE, true);
+                moves[*num_moves - 1].is_en_passant = true;
+            }
+        }
+    }
+}
+
+bool chess_position_is_legal_move(ChessPosition* pos, const ChessMove* move) {
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+    
+    bool promotion_given = move->promotion >= PIECE_ROOK && move->promotion <= PIECE_QUEEN;
+    for (size_t i = 0; i < num_moves; i++) {
+        if (moves[i].from != move->from || moves[i].to != move->to) continue;
+        if (moves[i].promotion == PIECE_NONE || !promotion_given || moves[i].promotion == move->promotion) return true;
+    }
+    return false;
+}
+
+static inline void clear_castling_rights(ChessPosition* pos, Square square) {  // Drop rights when king or rook leaves or rook is captured
+    switch (square) {
+        case 0:  pos->white_castle_queenside = false; break;
+        case 4:  pos->white_castle_kingside = false; pos->white_castle_queenside = false; break;
+        case 7:  pos->white_castle_kingside = false; break;
+        case 56: pos->black_castle_queenside = false; break;
+        case 60: pos->black_castle_kingside = false; pos->black_castle_queenside = false; break;
+        case 63: pos->black_castle_kingside = false; break;
+        default: break;
+    }
+}
+
+void chess_position_make_move(ChessPosition* pos, const ChessMove* move) {  // Apply move deriving castle, en passant and promotion from board
+    auto* hist = &pos->move_history.emplace_back();                   // History slot for this move
+    hist->white_castle_kingside = pos->white_castle_kingside;         // Save castling rights for unmake
     hist->white_castle_queenside = pos->white_castle_queenside;
     hist->black_castle_kingside = pos->black_castle_kingside;
     hist->black_castle_queenside = pos->black_castle_queenside;
-    hist->en_passant_square = pos->en_passant_square;
+    hist->en_passant_square = pos->en_passant_square;                 // Save en passant square for unmake
+    hist->halfmove_clock = pos->halfmove_clock;                       // Save fifty move counter for unmake
+    hist->hash = pos->hash;                                           // Save position key so unmake restores it without recomputation
+    pos->hash ^= zobrist_castling[castling_mask(pos)];                // Remove old castling rights from key
+    if (pos->en_passant_square) pos->hash ^= zobrist_en_passant[pos->en_passant_square & 7];  // Remove old en passant file from key
     
-    // Make move
-    pos->board[move->to] = pos->board[move->from];
-    pos->colors[move->to] = pos->colors[move->from];
-    pos->board[move->from] = PIECE_NONE;
+    Square from = move->from;
+    Square to = move->to;
+    PieceType piece = piece_at(pos, from);                            // Trust the board rather than caller supplied flags
+    Color us = color_at(pos, from);
+    
+    ChessMove* played = &hist->move;                                  // Normalized copy used by unmake
+    *played = *move;
+    played->piece = piece;
+    played->is_castle = piece == PIECE_KING && (from > to ? from - to : to - from) == 2;
+    played->is_en_passant = piece == PIECE_PAWN && to == pos->en_passant_square && to != 0 &&
+                            (from & 7) != (to & 7) && piece_at(pos, to) == PIECE_NONE;
+    played->promotion = PIECE_NONE;
+    if (piece == PIECE_PAWN && (BITBOARD_SQUARE(to) & (BITBOARD_RANK_1 | BITBOARD_RANK_8))) {  // Pawn reaching last rank must promote
+        bool valid = move->promotion >= PIECE_ROOK && move->promotion <= PIECE_QUEEN;
+        played->promotion = valid ? move->promotion : PIECE_QUEEN;    // Default to queen when caller left promotion unset
+    }
     
-    pos->white_to_move = !pos->white_to_move;
-    pos->move_history_count++;
+    Square captured_square = played->is_en_passant ? (Square)(us == COLOR_WHITE ? to - 8 : to + 8) : to;
+    hist->captured_piece = piece_at(pos, captured_square);
+    hist->captured_color = color_at(pos, captured_square);
+    played->is_capture = hist->captured_piece != PIECE_NONE;
+    
+    ChessFeatureDelta* delta = &hist->features;                       // Record feature changes for incremental evaluation
+    delta->num_removed = 0;
+    delta->num_added = 0;
+    if (hist->captured_piece != PIECE_NONE) {
+        delta->removed[delta->num_removed++] = feature_index(captured_square, hist->captured_piece, hist->captured_color);
+    }
+    if (piece != PIECE_NONE) {
+        delta->removed[delta->num_removed++] = feature_index(from, piece, us);
+        delta->added[delta->num_added++] = feature_index(to, played->promotion != PIECE_NONE ? played->promotion : piece, us);
+        if (played->is_castle) {                                      // Castling never captures, so the rook fits in the second slots
+            Square rook_from = to > from ? (Square)(from + 3) : (Square)(from - 4);
+            Square rook_to = to > from ? (Square)(from + 1) : (Square)(from - 1);
+            delta->removed[delta->num_removed++] = feature_index(rook_from, PIECE_ROOK, us);
+            delta->added[delta->num_added++] = feature_index(rook_to, PIECE_ROOK, us);
+        }
+    }
+    
+    if (hist->captured_piece != PIECE_NONE) remove_piece(pos, captured_square);  // Remove captured piece first so destination is empty
+    if (piece != PIECE_NONE) {
+        move_piece(pos, from, to);                                    // Move piece to destination square
+        if (played->promotion != PIECE_NONE) {                        // Replace pawn with promoted piece
+            remove_piece(pos, to);
+            put_piece(pos, to, played->promotion, us);
+        }
+        if (played->is_castle) {                                      // Move rook across king
+            if (to > from) move_piece(pos, (Square)(from + 3), (Square)(from + 1));
+            else move_piece(pos, (Square)(from - 4), (Square)(from - 1));
+        }
+    }
+    
+    clear_castling_rights(pos, from);                                 // Moving king or rook loses rights
+    clear_castling_rights(pos, to);                                   // Capturing rook removes opponent rights
+    pos->hash ^= zobrist_castling[castling_mask(pos)];                // Add new castling rights to key
+    
+    // Record skipped square only when an enemy pawn could capture, so equal positions hash equally
+    bool double_push = piece == PIECE_PAWN && (from > to ? from - to : to - from) == 16;
+    Square skipped = (Square)((from + to) / 2);
+    Bitboard enemy_pawns = pos->by_type[PIECE_PAWN] & pos->by_color[us ^ 1];
+    pos->en_passant_square = (double_push && (bitboard_pawn_attacks(us, skipped) & enemy_pawns)) ? skipped : 0;
+    if (pos->en_passant_square) pos->hash ^= zobrist_en_passant[pos->en_passant_square & 7];
+    pos->halfmove_clock = (piece == PIECE_PAWN || played->is_capture) ? 0 : pos->halfmove_clock + 1;
+    if (!pos->white_to_move) pos->fullmove_number++;                  // Fullmove counter advances after black moves
+    
+    pos->white_to_move = !pos->white_to_move;                          // Switch side to move
+    pos->hash ^= zobrist_side;                                        // Toggle side to move in key
+#ifdef CHESS_DEBUG
+    assert(pos->hash == chess_position_compute_hash(pos) && "incremental Zobrist key diverged");
+#endif
 }
 
-void chess_position_unmake_move(ChessPosition* pos) {
-    if (pos->move_history_count == 0) return;
+void chess_position_unmake_move(ChessPosition* pos) {                  // Restore position before last move using saved history
+    if (pos->move_history.empty()) return;                             // Nothing to undo
     
-    auto* hist = &pos->move_history[pos->move_history_count - 1];
-    ChessMove* move = &hist->move;
+    auto* hist = &pos->move_history.back();                           // Get history slot of last move
+    ChessMove* move = &hist->move;                                    // Normalized move recorded by make_move
+    pos->white_to_move = !pos->white_to_move;                          // Switch back to side that moved
+    Color us = pos->white_to_move ? COLOR_WHITE : COLOR_BLACK;
     
-    // Restore position
-    pos->board[move->from] = pos->board[move->to];
-    pos->colors[move->from] = pos->colors[move->to];
-    pos->board[move->to] = hist->captured_piece;
-    pos->colors[move->to] = hist->captured_color;
+    if (move->piece != PIECE_NONE) {
+        if (move->is_castle) {                                        // Return rook to its corner
+            if (move->to > move->from) move_piece(pos, (Square)(move->from + 1), (Square)(move->from + 3));
+            else move_piece(pos, (Square)(move->from - 1), (Square)(move->from - 4));
+        }
+        if (move->promotion != PIECE_NONE) {                          // Turn promoted piece back into pawn
+            remove_piece(pos, move->to);
+            put_piece(pos, move->to, PIECE_PAWN, us);
+        }
+        move_piece(pos, move->to, move->from);                        // Move piece back to origin square
+    }
+    if (hist->captured_piece != PIECE_NONE) {                         // Put captured piece back on its square
+        Square captured_square = move->is_en_passant ? (Square)(us == COLOR_WHITE ? move->to - 8 : move->to + 8) : move->to;
+        put_piece(pos, captured_square, hist->captured_piece, hist->captured_color);
+    }
     
     pos->white_castle_kingside = hist->white_castle_kingside;
     pos->white_castle_queenside = hist->white_castle_queenside;
     pos->black_castle_kingside = hist->black_castle_kingside;
     pos->black_castle_queenside = hist->black_castle_queenside;
     pos->en_passant_square = hist->en_passant_square;
+    pos->halfmove_clock = hist->halfmove_clock;
+    pos->hash = hist->hash;                                           // Piece helpers toggled the key; saved value is authoritative
+    if (!pos->white_to_move) pos->fullmove_number--;
     
-    pos->white_to_move = !pos->white_to_move;
-    pos->move_history_count--;
+    pos->move_history.pop_back();                                     // Capacity stays, so replaying the line does not allocate
+#ifdef CHESS_DEBUG
+    assert(pos->hash == chess_position_compute_hash(pos) && "Zobrist key not restored by unmake");
+#endif
+}
+
+uint64_t chess_position_get_hash(const ChessPosition* pos) {
+    return pos->hash;
+}
+
+size_t chess_position_get_ply(const ChessPosition* pos) {
+    return pos->move_history.size();
+}
+
+uint64_t chess_position_get_ply_hash(const ChessPosition* pos, size_t ply) {
+    return ply < pos->move_history.size() ? pos->move_history[ply].hash : pos->hash;
+}
+
+const ChessFeatureDelta* chess_position_get_feature_delta(const ChessPosition* pos, size_t ply) {
+    return ply < pos->move_history.size() ? &pos->move_history[ply].features : nullptr;
+}
+
+size_t chess_position_get_features(const ChessPosition* pos, uint16_t* features) {  // Sparse form of chess_position_to_matrix
+    size_t count = 0;
+    Bitboard occupied = pos->by_type[PIECE_NONE];
+    while (occupied) {
+        Square square = bitboard_pop_lsb(&occupied);
+        features[count++] = feature_index(square, piece_at(pos, square), color_at(pos, square));
+    }
+    return count;
+}
+
+uint64_t chess_position_compute_hash(const ChessPosition* pos) {      // Rebuild Zobrist key from scratch for initialization and debug checks
+    uint64_t hash = 0;
+    Bitboard occupied = pos->by_type[PIECE_NONE];
+    while (occupied) {
+        Square square = bitboard_pop_lsb(&occupied);
+        hash ^= zobrist_piece[color_at(pos, square)][piece_at(pos, square)][square];
+    }
+    if (!pos->white_to_move) hash ^= zobrist_side;
+    hash ^= zobrist_castling[castling_mask(pos)];
+    if (pos->en_passant_square) hash ^= zobrist_en_passant[pos->en_passant_square & 7];
+    return hash;
+}
+
+bool chess_position_is_repetition(const ChessPosition* pos) {        // Check whether current position occurred earlier since last irreversible move
+    size_t plies = pos->move_history.size();
+    size_t reversible = pos->halfmove_clock < plies ? pos->halfmove_clock : plies;
+    for (size_t back = 4; back <= reversible; back += 2) {            // Same side to move can only repeat every second ply, and at least four plies apart
+        if (pos->move_history[plies - back].hash == pos->hash) return true;
+    }
+    return false;
+}
+
+uint64_t chess_position_perft(ChessPosition* pos, size_t depth) {      // Count leaf nodes of legal move tree to given depth
+    if (depth == 0) return 1;                                          // Root itself is the only node at depth zero
+    
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+    if (depth == 1) return num_moves;                                  // Bulk count last ply since generator is fully legal
+    
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < num_moves; i++) {                           // Recurse through every legal move
+        chess_position_make_move(pos, &moves[i]);
+        nodes += chess_position_perft(pos, depth - 1);
+        chess_position_unmake_move(pos);
+    }
+    return nodes;
+}
+
+void chess_move_to_uci(const ChessMove* move, char* buffer) {
+    buffer[0] = (char)('a' + (move->from & 7));
+    buffer[1] = (char)('1' + (move->from >> 3));
+    buffer[2] = (char)('a' + (move->to & 7));
+    buffer[3] = (char)('1' + (move->to >> 3));
+    size_t idx = 4;
+    switch (move->promotion) {
+        case PIECE_QUEEN: buffer[idx++] = 'q'; break;
+        case PIECE_ROOK: buffer[idx++] = 'r'; break;
+        case PIECE_BISHOP: buffer[idx++] = 'b'; break;
+        case PIECE_KNIGHT: buffer[idx++] = 'n'; break;
+        default: break;
+    }
+    buffer[idx] = '\0';
 }
 
 // Move Sequence Implementation
@@ -29,6 +29,53 @@ struct CurriculumImpl {
     size_t examples_per_level;
 };
 
+void training_example_init(TrainingExample* example) {
+    memset(example, 0, sizeof(*example));
+}
+
+void training_example_get_target(const TrainingExample* example, double* target, size_t width) {  // Expand a sparse target or copy a dense one
+    size_t n = std::min(example->target_size, width);
+    if (example->sparse_target) {
+        memset(target, 0, width * sizeof(double));
+        for (size_t k = 0; k < example->num_sparse; k++) {
+            const SparseTargetEntry* entry = &example->sparse_target[k];
+            if (entry->index < n) target[entry->index] = entry->probability;
+        }
+    } else {
+        memcpy(target, example->target, n * sizeof(double));
+        memset(target + n, 0, (width - n) * sizeof(double));
+    }
+}
+
+void training_example_release(TrainingExample* example) {
+    delete[] example->input;
+    delete[] example->target;
+    delete[] example->sparse_target;
+    example->input = nullptr;
+    example->target = nullptr;
+    example->sparse_target = nullptr;
+    example->num_sparse = 0;
+}
+
+static void copy_example_data(TrainingExample* ex, const TrainingExample* example) {  // Deep copy of input and target, keeping a sparse target sparse
+    ex->input_size = example->input_size;
+    ex->target_size = example->target_size;
+    ex->difficulty = example->difficulty;
+    ex->input = new double[example->input_size];
+    memcpy(ex->input, example->input, example->input_size * sizeof(double));
+    ex->target = nullptr;
+    ex->sparse_target = nullptr;
+    ex->num_sparse = 0;
+    if (example->sparse_target) {
+        ex->num_sparse = example->num_sparse;
+        ex->sparse_target = new SparseTargetEntry[example->num_sparse];
+        memcpy(ex->sparse_target, example->sparse_target, example->num_sparse * sizeof(SparseTargetEntry));
+    } else {
+        ex->target = new double[example->target_size];
+        memcpy(ex->target, example->target, example->target_size * sizeof(double));
+    }
+}
+
 Curriculum* curriculum_create(size_t num_levels) {                    // Create curriculum learning system with specified number of difficulty levels
     CurriculumImpl* curriculum = new CurriculumImpl;                          // Allocate memory for new curriculum structure
     curriculum->num_levels = num_levels;                             // Set total number of difficulty levels in curriculum
@@ -55,8 +102,7 @@ void curriculum_destroy(Curriculum* curriculum) {
         CurriculumImpl* impl = (CurriculumImpl*)curriculum;
         for (size_t i = 0; i < impl->num_levels; i++) {
             for (size_t j = 0; j < impl->levels[i].num_examples; j++) {
-                delete[] impl->levels[i].examples[j].input;
-                delete[] impl->levels[i].examples[j].target;
+                training_example_release(&impl->levels[i].examples[j]);
             }
             delete[] impl->levels[i].examples;
         }
@@ -80,13 +126,7 @@ void curriculum_add_example(Curriculum* curriculum, TrainingExample* example, Di
     }
     
     TrainingExample* ex = &dl->examples[dl->num_examples];            // Get pointer to next available example slot
-    ex->input_size = example->input_size;                            // Copy input vector size from source example
-    ex->target_size = example->target_size;                           // Copy target vector size from source example
-    ex->difficulty = example->difficulty;                              // Copy difficulty score from source example
-    ex->input = new double[example->input_size];                     // Allocate memory for input vector
-    ex->target = new double[example->target_size];                   // Allocate memory for target vector
-    memcpy(ex->input, example->input, example->input_size * sizeof(double));  // Copy input data to new memory
-    memcpy(ex->target, example->target, example->target_size * sizeof(double));  // Copy target data to new memory
+    copy_example_data(ex, example);                                   // Copy sizes, difficulty, input and target into new memory
     ex->is_correct = false;                                           // Initialize correctness flag to false
     ex->attempts = 0;                                                 // Initialize attempt counter to zero
     ex->correct_streak = 0;                                          // Initialize consecutive correct counter to zero
@@ -143,8 +183,7 @@ void spaced_repetition_destroy(SpacedRepetition* sr) {
     if (sr) {
         SpacedRepetitionImpl* impl = (SpacedRepetitionImpl*)sr;
         for (size_t i = 0; i < impl->num_examples; i++) {
-            delete[] impl->examples[i].input;
-            delete[] impl->examples[i].target;
+            training_example_release(&impl->examples[i]);
         }
         delete[] impl->examples;
         delete impl;
@@ -165,13 +204,7 @@ void spaced_repetition_add_example(SpacedRepetition* sr, TrainingExample* exampl
     }
     
     TrainingExample* ex = &impl->examples[impl->num_examples];
-    ex->input_size = example->input_size;
-    ex->target_size = example->target_size;
-    ex->difficulty = example->difficulty;
-    ex->input = new double[example->input_size];
-    ex->target = new double[example->target_size];
-    memcpy(ex->input, example->input, example->input_size * sizeof(double));
-    memcpy(ex->target, example->target, example->target_size * sizeof(double));
+    copy_example_data(ex, example);
     ex->is_correct = false;
     ex->attempts = 0;
     ex->correct_streak = 0;
@@ -254,6 +287,7 @@ void puzzle_generator_destroy(PuzzleGenerator* pg) {
 // Generate puzzle based on difficulty level
 TrainingExample* puzzle_generator_create_puzzle(PuzzleGenerator* pg, DifficultyLevelEnum level) {
     TrainingExample* puzzle = new TrainingExample;
+    training_example_init(puzzle);
     
     // Determine puzzle characteristics based on level
     size_t input_size = 64 * 12;  // 8x8 board, 12 channels
@@ -285,16 +319,33 @@ TrainingExample* puzzle_generator_create_puzzle(PuzzleGenerator* pg, DifficultyL
     puzzle->input_size = input_size;
     puzzle->target_size = output_size;
     puzzle->input = new double[input_size];
-    puzzle->target = new double[output_size];
     puzzle->difficulty = (double)level / (double)LEVEL_INFINITE;
     
     // Initialize with random values (in real implementation, would generate actual chess positions)
     for (size_t i = 0; i < input_size; i++) {
         puzzle->input[i] = ((double)rand() / RAND_MAX) * 0.1;
     }
-    for (size_t i = 0; i < output_size; i++) {
-        puzzle->target[i] = ((double)rand() / RAND_MAX) * 0.1;
+    
+    // Target: a move distribution over a few candidates, more of them at higher levels, stored sparsely
+    size_t num_moves = std::min(output_size, (size_t)(4 + 4 * level));
+    puzzle->sparse_target = new SparseTargetEntry[num_moves];
+    puzzle->num_sparse = num_moves;
+    double total = 0.0;
+    for (size_t k = 0; k < num_moves; k++) {
+        uint32_t index;
+        bool taken;
+        do {                                                           // Distinct outputs
+            index = (uint32_t)(rand() % output_size);
+            taken = false;
+            for (size_t j = 0; j < k && !taken; j++) taken = puzzle->sparse_target[j].index == index;
+        } while (taken);
+        puzzle->sparse_target[k].index = index;
+        puzzle->sparse_target[k].probability = (float)((double)rand() / RAND_MAX + 1e-3);
+        total += puzzle->sparse_target[k].probability;
     }
+    for (size_t k = 0; k < num_moves; k++) puzzle->sparse_target[k].probability = (float)(puzzle->sparse_target[k].probability / total);
+    std::sort(puzzle->sparse_target, puzzle->sparse_target + num_moves,
+              [](const SparseTargetEntry& a, const SparseTargetEntry& b) { return a.index < b.index; });
     
     puzzle->is_correct = false;
     puzzle->attempts = 0;
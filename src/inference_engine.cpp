@@ -7,6 +7,19 @@
 #include <cstring>
 #include <cstdlib>
 #include <algorithm>
+#include <cstdint>
+
+#define ACCUMULATOR_SLOTS 128       // Plies of pre-activations kept; the slot of ply p is p % ACCUMULATOR_SLOTS
+#define ACCUMULATOR_MAX_REPLAY 8    // Replaying more moves than this costs about as much as a refresh
+
+// First-layer accumulator stack for inference_engine_evaluate_position. Each slot is tagged with
+// the ply and Zobrist key of the position it holds, so a search descending one move at a time
+// finds its parent's slot and pays only for the move's feature delta.
+struct EngineAccumulator {
+    NNAccumulator* acc;
+    size_t ply[ACCUMULATOR_SLOTS];   // SIZE_MAX marks an empty slot
+    uint64_t key[ACCUMULATOR_SLOTS];
+};
 
 InferenceEngine* inference_engine_create(NeuralNetwork* nn) {           // Create inference engine with neural network for chess evaluation
     InferenceEngine* engine = new InferenceEngine;                     // Allocate memory for new inference engine structure
@@ -15,34 +28,210 @@ InferenceEngine* inference_engine_create(NeuralNetwork* nn) {           // Creat
     engine->temperature = 1.0;                                        // Set temperature to one for deterministic move selection
     engine->max_depth = 3;                                            // Set maximum search depth to three for minimax algorithm
     engine->use_mcts = false;                                         // Disable Monte Carlo tree search by default
+    engine->tt_size_mb = 16;                                          // Default transposition table size in megabytes
+    engine->tt = nullptr;                                             // Table is allocated lazily on first lookup
+    engine->mcts_simulations = 800;                                   // Default playouts per MCTS move
+    engine->c_puct = 1.5;                                             // Default PUCT exploration constant
+    engine->mcts_threads = 1;                                         // Search on the calling thread by default
+    engine->mcts_batch_size = 8;                                      // Leaves per network batch for each MCTS worker
+    engine->mcts_tree = nullptr;                                      // Tree is allocated on first MCTS search
+    engine->quantized = nullptr;                                      // Full-precision evaluation until quantized
+    engine->use_quantized = false;
+    engine->accumulator = nullptr;                                    // Built on first position evaluation
+    engine->weight_version = nn ? nn_get_weight_version(nn) : 0;
     return engine;                                                     // Return pointer to initialized inference engine
 }
 
 void inference_engine_destroy(InferenceEngine* engine) {
     if (engine) {
+        transposition_table_destroy(engine->tt);
+        mcts_tree_destroy(engine->mcts_tree);
+        nn_quantized_destroy(engine->quantized);
+        if (engine->accumulator) nn_accumulator_destroy(engine->accumulator->acc);
+        delete engine->accumulator;
         delete engine;
     }
 }
 
-void inference_engine_load_model(InferenceEngine* engine, const char* model_path) {
-    // Model loading (simplified - would deserialize network weights)
+bool inference_engine_load_model(InferenceEngine* engine, const char* model_path) {  // Use a model file's weights in place, shared with other processes mapping it
+    if (!engine->network || !nn_map_model(engine->network, model_path)) return false;
+    nn_quantized_destroy(engine->quantized);                          // Int8 copy was built from the old weights
+    engine->quantized = nullptr;
+    engine->use_quantized = false;
     engine->is_loaded = true;
+    inference_engine_clear_cache(engine);                             // Cached evaluations came from the old weights
+    return true;
+}
+
+bool inference_engine_save_model(InferenceEngine* engine, const char* model_path) {
+    return engine->network && nn_save_model(engine->network, model_path);
+}
+
+void inference_engine_clear_cache(InferenceEngine* engine) {
+    if (engine->tt) transposition_table_clear(engine->tt);
+    if (engine->mcts_tree) mcts_tree_clear(engine->mcts_tree);
+    if (engine->accumulator) {                                        // Accumulator holds a copy of the first-layer weights
+        nn_accumulator_destroy(engine->accumulator->acc);
+        delete engine->accumulator;
+        engine->accumulator = nullptr;
+    }
+    if (engine->network) engine->weight_version = nn_get_weight_version(engine->network);
+}
+
+static void engine_sync_weights(InferenceEngine* engine) {           // Drop cached evaluations once training or a restore changed the weights
+    if (engine->network && nn_get_weight_version(engine->network) != engine->weight_version) {
+        inference_engine_clear_cache(engine);
+    }
+}
+
+static inline bool accumulator_slot_matches(const EngineAccumulator* ea, const ChessPosition* pos, size_t ply) {
+    size_t slot = ply % ACCUMULATOR_SLOTS;
+    return ea->ply[slot] == ply && ea->key[slot] == chess_position_get_ply_hash(pos, ply);
+}
+
+static void accumulator_forward(InferenceEngine* engine, const ChessPosition* pos, double* output) {  // Network output with the first layer updated from the nearest cached ancestor
+    EngineAccumulator* ea = engine->accumulator;
+    if (!ea) {
+        ea = new EngineAccumulator;
+        ea->acc = nn_accumulator_create(engine->network, ACCUMULATOR_SLOTS);
+        for (size_t i = 0; i < ACCUMULATOR_SLOTS; i++) ea->ply[i] = SIZE_MAX;
+        engine->accumulator = ea;
+    }
+    
+    size_t ply = chess_position_get_ply(pos);
+    size_t start = ply;                                               // Deepest ancestor whose slot is current
+    while (!accumulator_slot_matches(ea, pos, start)) {
+        if (start == 0 || ply - start >= ACCUMULATOR_MAX_REPLAY) {    // Nothing close enough: rebuild from the board
+            uint16_t features[64];
+            size_t count = chess_position_get_features(pos, features);
+            nn_accumulator_refresh(ea->acc, ply % ACCUMULATOR_SLOTS, features, count);
+            start = ply;
+            break;
+        }
+        start--;
+    }
+    for (size_t p = start; p < ply; p++) {                            // Apply each move's feature delta down to this position
+        const ChessFeatureDelta* delta = chess_position_get_feature_delta(pos, p);
+        nn_accumulator_update(ea->acc, (p + 1) % ACCUMULATOR_SLOTS, p % ACCUMULATOR_SLOTS,
+                              delta->removed, delta->num_removed, delta->added, delta->num_added);
+        ea->ply[(p + 1) % ACCUMULATOR_SLOTS] = p + 1;
+        ea->key[(p + 1) % ACCUMULATOR_SLOTS] = chess_position_get_ply_hash(pos, p + 1);
+    }
+    ea->ply[ply % ACCUMULATOR_SLOTS] = ply;
+    ea->key[ply % ACCUMULATOR_SLOTS] = chess_position_get_hash(pos);
+    
+    nn_accumulator_forward(ea->acc, ply % ACCUMULATOR_SLOTS, output);
+}
+
+static void engine_forward(InferenceEngine* engine, const double* input, double* output) {  // Active model: int8 copy when quantized
+    if (engine->use_quantized && engine->quantized) {
+        nn_quantized_forward(engine->quantized, input, output);
+    } else {
+        nn_forward(engine->network, input, output);
+    }
+}
+
+static void engine_forward_position(InferenceEngine* engine, const ChessPosition* pos, double* output) {  // Board goes in as sparse features unless the int8 copy is active
+    if ((engine->use_quantized && engine->quantized) || nn_get_input_size(engine->network) != 64 * 12) {
+        double input[64 * 12];
+        chess_position_to_matrix((ChessPosition*)pos, input);
+        engine_forward(engine, input, output);
+        return;
+    }
+    uint16_t features[64];
+    size_t count = chess_position_get_features(pos, features);        // At most 32 of the 768 inputs are set
+    nn_forward_sparse(engine->network, features, count, output);
+}
+
+static size_t policy_argmax(const double* output, size_t output_size) {  // Highest move entry; index 0 holds the value
+    size_t end = std::min(output_size, (size_t)(64 * 64));
+    size_t best = 1;
+    for (size_t i = 2; i < end; i++) {
+        if (output[i] > output[best]) best = i;
+    }
+    return best;
+}
+
+bool inference_engine_quantize(InferenceEngine* engine, const ChessPosition* const* positions,  // Calibrate, build int8 copy and report drift
+                               size_t num_positions, QuantizationReport* report) {
+    if (!engine->is_loaded || !engine->network || num_positions == 0) return false;
+    
+    const size_t input_size = 64 * 12;
+    size_t output_size = nn_get_output_size(engine->network);
+    double* inputs = new double[num_positions * input_size];
+    double* reference = new double[num_positions * output_size];
+    double* outputs = new double[num_positions * output_size];
+    for (size_t i = 0; i < num_positions; i++) {
+        chess_position_to_matrix((ChessPosition*)positions[i], inputs + i * input_size);
+    }
+    
+    nn_quantized_destroy(engine->quantized);
+    engine->quantized = nn_quantize(engine->network, inputs, input_size, num_positions);
+    engine->use_quantized = true;
+    inference_engine_clear_cache(engine);                             // Cached evaluations came from the previous model
+    
+    if (report) {
+        nn_forward_batch(engine->network, inputs, input_size, num_positions, reference, output_size);
+        nn_quantized_forward_batch(engine->quantized, inputs, input_size, num_positions, outputs, output_size);
+        memset(report, 0, sizeof(*report));
+        report->samples = num_positions;
+        size_t agree = 0;
+        for (size_t i = 0; i < num_positions; i++) {
+            const double* ref = reference + i * output_size;
+            const double* out = outputs + i * output_size;
+            double value_error = fabs(out[0] - ref[0]);
+            report->value_max_error = std::max(report->value_max_error, value_error);
+            report->value_mean_error += value_error / num_positions;
+            for (size_t j = 0; j < output_size; j++) {
+                report->output_max_error = std::max(report->output_max_error, fabs(out[j] - ref[j]));
+            }
+            if (output_size > 1 && policy_argmax(out, output_size) == policy_argmax(ref, output_size)) agree++;
+        }
+        report->policy_agreement = (double)agree / num_positions;
+        report->network_bytes = nn_get_parameter_bytes(engine->network);
+        report->quantized_bytes = nn_quantized_get_parameter_bytes(engine->quantized);
+    }
+    
+    delete[] inputs;
+    delete[] reference;
+    delete[] outputs;
+    return true;
 }
 
-void inference_engine_save_model(InferenceEngine* engine, const char* model_path) {
-    // Model saving (simplified - would serialize network weights)
+// Returns the engine's table, (re)allocating it when tt_size_mb changed; null when caching is disabled
+static TranspositionTable* engine_tt(InferenceEngine* engine) {
+    if (engine->tt && transposition_table_size_mb(engine->tt) != engine->tt_size_mb) {
+        transposition_table_destroy(engine->tt);
+        engine->tt = nullptr;
+    }
+    if (!engine->tt && engine->tt_size_mb > 0) {
+        engine->tt = transposition_table_create(engine->tt_size_mb);
+    }
+    return engine->tt;
 }
 
 double inference_engine_evaluate_position(InferenceEngine* engine, const ChessPosition* pos) {  // Evaluate chess position using neural network
     if (!engine->is_loaded) return 0.0;                              // Return zero if network is not loaded or available
     
-    double input[64 * 12];                                            // Allocate input buffer for eight by eight by twelve tensor
-    chess_position_to_matrix((ChessPosition*)pos, input);             // Convert chess position to matrix representation for network
+    engine_sync_weights(engine);
+    TranspositionTable* tt = engine_tt(engine);                       // Get evaluation cache if enabled
+    uint64_t key = chess_position_get_hash(pos);                      // Position key shared by all transpositions
+    TTEntry entry;
+    if (tt && transposition_table_probe(tt, key, &entry) && entry.has_eval) {
+        return entry.eval;                                            // Reuse evaluation computed for this position earlier
+    }
     
-    double output[1];                                                // Allocate output buffer for single evaluation score
-    nn_forward(engine->network, input, output);                       // Forward pass through network to compute position evaluation
+    double output[64 * 64];                                           // Network writes its full output vector, first element is the score
+    if (!engine->use_quantized && nn_get_input_size(engine->network) == 64 * 12) {
+        accumulator_forward(engine, pos, output);                     // First layer follows make/unmake instead of re-encoding the board
+    } else {
+        engine_forward_position(engine, pos, output);                 // Forward pass through network to compute position evaluation
+    }
     
-    return output[0];                                                 // Return position evaluation score from network output
+    if (!tt) return output[0];                                        // Return raw evaluation when caching is disabled
+    transposition_table_store_eval(tt, key, output[0]);               // Cache evaluation for later transpositions
+    transposition_table_probe(tt, key, &entry);                       // Read back so hits and misses return identical quantized value
+    return entry.has_eval ? entry.eval : output[0];
 }
 
 void inference_engine_evaluate_position_vector(InferenceEngine* engine, 
@@ -52,17 +241,14 @@ void inference_engine_evaluate_position_vector(InferenceEngine* engine,
                                               size_t output_size) {
     if (!engine->is_loaded) return;
     
-    nn_forward(engine->network, position_vector, output);
+    engine_forward(engine, position_vector, output);
 }
 
 MoveEvaluation* inference_engine_predict_move(InferenceEngine* engine, const ChessPosition* pos) {  // Predict best move from position using neural network
     if (!engine->is_loaded) return nullptr;                           // Return null if network is not loaded or available
     
-    double input[64 * 12];                                            // Allocate input buffer for position matrix representation
-    chess_position_to_matrix((ChessPosition*)pos, input);              // Convert chess position to matrix for network input
-    
     double output[64 * 64];                                           // Allocate output buffer for move probability distribution
-    nn_forward(engine->network, input, output);                        // Forward pass computing move probabilities for all moves
+    engine_forward_position(engine, pos, output);                     // Forward pass computing move probabilities for all moves
     
     double max_prob = 0.0;                                            // Initialize maximum probability to zero for search
     size_t best_from = 0, best_to = 0;                                // Initialize best move squares to zero
@@ -79,6 +265,7 @@ MoveEvaluation* inference_engine_predict_move(InferenceEngine* engine, const Che
     }
     
     MoveEvaluation* eval = new MoveEvaluation;                        // Allocate memory for move evaluation structure
+    eval->move = ChessMove();                                         // Clear piece, promotion and flag fields of predicted move
     eval->move.from = (Square)best_from;                              // Set move from square to best from square found
     eval->move.to = (Square)best_to;                                 // Set move to square to best to square found
     eval->score = max_prob;                                           // Set evaluation score to maximum probability value
@@ -98,11 +285,8 @@ void inference_engine_predict_moves(InferenceEngine* engine,
         return;
     }
     
-    double input[64 * 12];
-    chess_position_to_matrix((ChessPosition*)pos, input);
-    
     double output[64 * 64];
-    nn_forward(engine->network, input, output);
+    engine_forward_position(engine, pos, output);
     
     // Get top moves
     *num_moves = 0;
@@ -113,6 +297,7 @@ void inference_engine_predict_moves(InferenceEngine* engine,
             size_t idx = from * 64 + to;
             if (output[idx] > 0.01) {  // Threshold
                 MoveEvaluation* eval = &evaluations[*num_moves];
+                eval->move = ChessMove();
                 eval->move.from = (Square)from;
                 eval->move.to = (Square)to;
                 eval->score = output[idx];
@@ -126,6 +311,8 @@ void inference_engine_predict_moves(InferenceEngine* engine,
 }
 
 ChessMove* inference_engine_select_best_move(InferenceEngine* engine, const ChessPosition* pos) {
+    if (engine->use_mcts) return inference_engine_mcts_search(engine, pos, engine->mcts_simulations);
+    
     MoveEvaluation* eval = inference_engine_predict_move(engine, pos);
     if (!eval) return nullptr;
     
@@ -142,7 +329,7 @@ GameAction* inference_engine_select_action(InferenceEngine* engine,
     if (!engine->is_loaded) return nullptr;
     
     double output[1000];
-    nn_forward(engine->network, state->state_vector, output);
+    engine_forward(engine, state->state_vector, output);
     
     GameAction* action = new GameAction;
     action->agent_id = agent_id;
@@ -156,48 +343,123 @@ GameAction* inference_engine_select_action(InferenceEngine* engine,
     return action;
 }
 
+static double engine_evaluator(void* context, const ChessPosition* pos) {
+    return inference_engine_evaluate_position((InferenceEngine*)context, pos);
+}
+
+void inference_engine_search(InferenceEngine* engine,                  // Run principal variation search using network evaluation at leaves
+                             const ChessPosition* pos,
+                             const SearchLimits* limits,
+                             SearchResult* result) {
+    SearchLimits effective = *limits;                                  // Copy limits so defaults can be filled in
+    if (effective.max_depth == 0) effective.max_depth = engine->max_depth;  // Fall back to engine search depth
+    engine_sync_weights(engine);
+    search_run((ChessPosition*)pos, &effective, engine_tt(engine), engine_evaluator, engine, result);  // Search shares engine transposition table
+}
+
 ChessMove* inference_engine_search_move(InferenceEngine* engine, 
                                        const ChessPosition* pos,
                                        size_t depth) {
-    // Minimax search (simplified)
+    // Depth zero uses the raw network move prediction
     if (depth == 0) {
         return inference_engine_select_best_move(engine, pos);
     }
     
-    // Generate moves and search (use white as default since we can't access white_to_move)
-    ChessMove moves[256];
-    size_t num_moves = 0;
-    chess_position_generate_moves((ChessPosition*)pos, COLOR_WHITE, moves, &num_moves);
+    SearchLimits limits = {depth, 0, 0.0};
+    SearchResult result;
+    inference_engine_search(engine, pos, &limits, &result);
     
-    double best_score = -1e10;
-    ChessMove* best_move = nullptr;
-    
-    for (size_t i = 0; i < num_moves; i++) {
-        chess_position_make_move((ChessPosition*)pos, &moves[i]);
-        double score = inference_engine_evaluate_position(engine, pos);
-        chess_position_unmake_move((ChessPosition*)pos);
-        
-        if (score > best_score) {
-            best_score = score;
-            best_move = &moves[i];
-        }
-    }
-    
-    if (best_move) {
-        ChessMove* result = new ChessMove;
-        *result = *best_move;
-        return result;
+    if (result.has_move) {
+        ChessMove* move = new ChessMove;
+        *move = result.best_move;
+        return move;
     }
     
     return inference_engine_select_best_move(engine, pos);
 }
 
+static void mcts_encode_position(void* context, ChessPosition* pos, double* input) {
+    (void)context;                                                    // Encoding needs only the position
+    chess_position_to_matrix(pos, input);
+}
+
+// Forward scratch of one MCTS worker, for whichever network batch inference uses
+struct MCTSWorkerScratch {
+    NNWorkspace* network;
+    NNQuantizedWorkspace* quantized;
+};
+
+static void* mcts_create_workspace(void* context) {
+    InferenceEngine* engine = (InferenceEngine*)context;
+    MCTSWorkerScratch* scratch = new MCTSWorkerScratch{nullptr, nullptr};
+    if (!engine->is_loaded) return scratch;
+    if (engine->use_quantized && engine->quantized) {
+        scratch->quantized = nn_quantized_workspace_create(engine->quantized);
+    } else {
+        scratch->network = nn_workspace_create(engine->network);
+    }
+    return scratch;
+}
+
+static void mcts_destroy_workspace(void* context, void* workspace) {
+    (void)context;
+    MCTSWorkerScratch* scratch = (MCTSWorkerScratch*)workspace;
+    nn_workspace_destroy(scratch->network);
+    nn_quantized_workspace_destroy(scratch->quantized);
+    delete scratch;
+}
+
+static void mcts_evaluate_batch(void* context, void* workspace, const double* inputs, size_t count, double* outputs) {  // Policy logits and white-relative value for a batch of leaves
+    InferenceEngine* engine = (InferenceEngine*)context;
+    MCTSWorkerScratch* scratch = (MCTSWorkerScratch*)workspace;
+    if (!scratch->network && !scratch->quantized) return;             // Unloaded engine: outputs stay zeroed
+    size_t output_size = nn_get_output_size(engine->network);
+    size_t stride = output_size > 64 * 64 ? output_size : 64 * 64;
+    if (scratch->quantized) {                                          // Same paths as inference_engine_batch_predict, on this worker's scratch
+        nn_quantized_workspace_forward_batch(scratch->quantized, inputs, 64 * 12, count, outputs, stride);
+    } else if (scratch->network) {
+        nn_workspace_forward_batch(scratch->network, inputs, 64 * 12, count, outputs, stride);
+    }
+}
+
+void inference_engine_run_mcts(InferenceEngine* engine,                // Run PUCT search reusing engine tree from previous move
+                               const ChessPosition* pos,
+                               size_t simulations,
+                               MCTSResult* result) {
+    engine_sync_weights(engine);                                       // Reused tree holds values from the old weights
+    if (!engine->mcts_tree) engine->mcts_tree = mcts_tree_create();    // Allocate tree on first use
+    
+    MCTSConfig config;
+    config.simulations = simulations > 0 ? simulations : engine->mcts_simulations;
+    config.c_puct = engine->c_puct;
+    config.temperature = engine->temperature;
+    config.num_threads = engine->mcts_threads;
+    config.batch_size = engine->mcts_batch_size;
+    config.virtual_loss = 1.0;
+    
+    MCTSBatchEvaluator evaluator;                                      // Leaves are scored through batch inference
+    evaluator.input_size = 64 * 12;
+    evaluator.output_size = engine->network ? nn_get_output_size(engine->network) : 0;
+    if (evaluator.output_size < 64 * 64) evaluator.output_size = 64 * 64;  // Policy plane is read even from smaller networks
+    evaluator.encode = mcts_encode_position;
+    evaluator.evaluate = mcts_evaluate_batch;
+    evaluator.context = engine;                                        // Unloaded engine leaves outputs zeroed: uniform priors, neutral value
+    evaluator.create_workspace = mcts_create_workspace;                // Workers evaluate their batches concurrently
+    evaluator.destroy_workspace = mcts_destroy_workspace;
+    
+    mcts_search_batched(engine->mcts_tree, (ChessPosition*)pos, &config, &evaluator, result);
+}
+
 ChessMove* inference_engine_mcts_search(InferenceEngine* engine,
                                        const ChessPosition* pos,
                                        size_t simulations) {
-    // Monte Carlo Tree Search (simplified placeholder)
-    // Full MCTS implementation would be more complex
-    return inference_engine_select_best_move(engine, pos);
+    MCTSResult result;
+    inference_engine_run_mcts(engine, pos, simulations, &result);
+    if (!result.has_move) return nullptr;
+    
+    ChessMove* move = new ChessMove;
+    *move = result.best_move;
+    return move;
 }
 
 void inference_engine_batch_predict(InferenceEngine* engine,
@@ -208,10 +470,10 @@ void inference_engine_batch_predict(InferenceEngine* engine,
                                    size_t output_size) {
     if (!engine->is_loaded) return;
     
-    for (size_t i = 0; i < num_inputs; i++) {
-        const double* input = inputs + i * input_size;
-        double* output = outputs + i * output_size;
-        nn_forward(engine->network, input, output);
+    if (engine->use_quantized && engine->quantized) {                 // One GEMM per layer instead of a GEMV per input
+        nn_quantized_forward_batch(engine->quantized, inputs, input_size, num_inputs, outputs, output_size);
+    } else {
+        nn_forward_batch(engine->network, inputs, input_size, num_inputs, outputs, output_size);
     }
 }
 
@@ -220,11 +482,8 @@ double inference_engine_get_confidence(InferenceEngine* engine,
                                       const ChessMove* move) {
     if (!engine->is_loaded) return 0.0;
     
-    double input[64 * 12];
-    chess_position_to_matrix((ChessPosition*)pos, input);
-    
     double output[64 * 64];
-    nn_forward(engine->network, input, output);
+    engine_forward_position(engine, pos, output);
     
     size_t idx = move->from * 64 + move->to;
     return output[idx];
@@ -235,11 +494,8 @@ bool inference_engine_detect_uncertainty(InferenceEngine* engine,
                                         double threshold) {
     if (!engine->is_loaded) return true;
     
-    double input[64 * 12];
-    chess_position_to_matrix((ChessPosition*)pos, input);
-    
     double output[64 * 64];
-    nn_forward(engine->network, input, output);
+    engine_forward_position(engine, pos, output);
     
     // Check variance/entropy of output distribution
     double sum = 0.0, sum_sq = 0.0;
@@ -11,6 +11,10 @@
 #include "../include/multi_agent_game.h"
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
 
 void print_usage(const char* program_name) {
     printf("Usage: %s [command] [options]\n", program_name);
@@ -19,6 +23,7 @@ void print_usage(const char* program_name) {
     printf("  infer          - Run inference on a position\n");
     printf("  puzzle         - Generate and solve puzzles\n");
     printf("  interactive    - Interactive chess game\n");
+    printf("  perft          - Count move generator leaf nodes (nodes/sec)\n");
     printf("  test           - Run tests\n");
     printf("\nOptions:\n");
     printf("  --model <path>     - Model file path\n");
@@ -27,9 +32,84 @@ void print_usage(const char* program_name) {
     printf("  --epochs <n>       - Number of training epochs\n");
     printf("  --lr <rate>        - Learning rate\n");
     printf("  --optimizer <type> - Optimizer (sgd, adam, adagrad, rmsprop)\n");
+    printf("  --depth <n>        - Search depth (infer) or perft depth\n");
+    printf("  --mcts <n>         - Infer: run MCTS with n simulations\n");
+    printf("  --threads <n>      - Train: data-parallel workers; Infer: MCTS worker threads\n");
+    printf("  --hogwild          - Train: lock-free asynchronous SGD across the workers\n");
+    printf("  --resume           - Train: continue from checkpoint.bin\n");
+    printf("  --batch <n>        - Infer: MCTS leaves per network batch\n");
+    printf("  --int8             - Infer: evaluate with an int8 copy calibrated on the position and its children\n");
+    printf("  --divide           - Perft: print node count below each root move\n");
+    printf("  --bench            - Perft: run the standard position suite; Train: synchronous vs Hogwild throughput\n");
+}
+
+// Synthetic sparse positions: 32 of the 768 one-hot inputs set, one policy target per example
+static void bench_train_data(double* inputs, double* targets, size_t n) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    memset(inputs, 0, n * 768 * sizeof(double));
+    memset(targets, 0, n * 4096 * sizeof(double));
+    for (size_t i = 0; i < n; i++) {
+        for (int k = 0; k < 32; k++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            inputs[i * 768 + (state >> 33) % 768] = 1.0;
+        }
+        targets[i * 4096 + (state >> 20) % 4096] = 1.0;
+    }
+}
+
+static int bench_train(size_t threads) {                              // Examples/sec of both data-parallel modes on the same data
+    const size_t examples = 2048;
+    double* inputs = new double[examples * 768];
+    double* targets = new double[examples * 4096];
+    bench_train_data(inputs, targets, examples);
+    
+    for (int hogwild = 0; hogwild < 2; hogwild++) {
+        NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
+        TrainingConfig config;
+        training_config_init(&config);
+        config.optimizer_type = OPTIMIZER_SGD;
+        config.learning_rate = 0.01;
+        config.batch_size = 32;
+        config.num_threads = threads;
+        config.seed = 1;
+        config.hogwild = hogwild != 0;
+        TrainingEngine* engine = training_engine_create(nn, &config);
+        training_engine_set_data(engine, inputs, targets, examples);
+        training_engine_train_epoch(engine);                          // Warm up workspaces and optimizer state
+        
+        const int epochs = 3;
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < epochs; e++) training_engine_train_epoch(engine);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-12s %zu threads: %8.0f examples/sec, loss %.6f\n", hogwild ? "hogwild" : "synchronous", threads,
+               elapsed > 0.0 ? epochs * examples / elapsed : 0.0, training_engine_get_stats(engine)->current_loss);
+        training_engine_destroy(engine);
+        nn_destroy(nn);
+    }
+    
+    delete[] inputs;
+    delete[] targets;
+    return 0;
 }
 
 int cmd_train(int argc, char* argv[]) {
+    bool bench = false;
+    size_t threads = 1;
+    bool hogwild = false;
+    bool resume = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hogwild") == 0) {
+            hogwild = true;
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        }
+    }
+    if (bench) return bench_train(threads);
+    
     printf("Starting training...\n");
     
     // Create neural network
@@ -37,21 +117,24 @@ int cmd_train(int argc, char* argv[]) {
     
     // Training configuration
     TrainingConfig config;
-    config.optimizer_type = OPTIMIZER_ADAM;
-    config.learning_rate = 0.001;
-    config.momentum = 0.9;
-    config.weight_decay = 0.0001;
-    config.batch_size = 32;
-    config.max_epochs = 100;
-    config.early_stopping_threshold = 0.001;
+    training_config_init(&config);                                    // Adam at 0.001, batches of 32, 100 epochs, no checkpoint thread
     config.use_curriculum = true;
     config.use_pavlovian = true;
     config.use_spaced_repetition = true;
-    config.mastery_threshold = 0.85;
-    config.patience = 10;
+    config.num_threads = threads;
+    config.hogwild = hogwild;
+    config.incremental_checkpoints = true;
+    config.async_checkpoints = true;                                  // Periodic checkpoints are written while training goes on
     
     // Create training engine
     TrainingEngine* engine = training_engine_create(nn, &config);
+    if (resume) {
+        if (training_engine_restore_checkpoint(engine, "checkpoint.bin")) {
+            printf("Resumed from checkpoint.bin at level %d\n", (int)training_engine_get_stats(engine)->current_level);
+        } else {
+            printf("No usable checkpoint.bin, starting fresh\n");
+        }
+    }
     
     printf("Training with curriculum learning...\n");
     printf("Level progression: Preschool -> Kindergarten -> ... -> Infinite\n");
@@ -66,6 +149,7 @@ int cmd_train(int argc, char* argv[]) {
             printf("Epoch %zu: Loss=%.6f, Accuracy=%.2f%%, Level=%zu\n",
                    stats->epoch, stats->current_loss, 
                    stats->accuracy * 100.0, stats->current_level);
+            training_engine_checkpoint(engine, "checkpoint.bin");     // Snapshot of the changed sections, written in the background
         }
         
         // Check for early stopping
@@ -76,8 +160,16 @@ int cmd_train(int argc, char* argv[]) {
     }
     
     // Save model
-    training_engine_save_checkpoint(engine, "checkpoint.bin");
-    printf("Model saved to checkpoint.bin\n");
+    if (training_engine_save_checkpoint(engine, "checkpoint.bin")) {  // Waits for the background writes, then saves the final state
+        printf("Checkpoint saved to checkpoint.bin\n");
+    } else {
+        printf("Failed to save checkpoint.bin\n");
+    }
+    if (nn_save_model(nn, "model.bin")) {
+        printf("Model saved to model.bin\n");
+    } else {
+        printf("Failed to save model.bin\n");
+    }
     
     training_engine_destroy(engine);
     return 0;
@@ -85,7 +177,12 @@ int cmd_train(int argc, char* argv[]) {
 
 int cmd_infer(int argc, char* argv[]) {
     const char* fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    const char* model_path = "checkpoint.bin";
+    const char* model_path = "model.bin";
+    size_t depth = 0;
+    size_t simulations = 0;
+    size_t threads = 1;
+    size_t batch = 8;
+    bool quantize = false;
     
     // Parse arguments
     for (int i = 2; i < argc; i++) {
@@ -93,6 +190,16 @@ int cmd_infer(int argc, char* argv[]) {
             fen = argv[++i];
         } else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
             model_path = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mcts") == 0 && i + 1 < argc) {
+            simulations = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--int8") == 0) {
+            quantize = true;
         }
     }
     
@@ -101,11 +208,36 @@ int cmd_infer(int argc, char* argv[]) {
     // Create network and load model
     NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
     InferenceEngine* engine = inference_engine_create(nn);
-    inference_engine_load_model(engine, model_path);
+    if (!inference_engine_load_model(engine, model_path)) {
+        printf("No model at %s, using untrained network\n", model_path);
+    }
     
     printf("Loading position from FEN: %s\n", fen);
     ChessPosition* pos = chess_position_from_fen(fen);
     
+    // Quantize the network, calibrating on the root and every position one move away
+    if (quantize) {
+        ChessMove moves[CHESS_MAX_MOVES];
+        size_t num_moves = 0;
+        chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+        ChessPosition** sample = new ChessPosition*[num_moves + 1];
+        sample[0] = pos;
+        for (size_t i = 0; i < num_moves; i++) {
+            sample[i + 1] = chess_position_clone(pos);
+            chess_position_make_move(sample[i + 1], &moves[i]);
+        }
+        
+        QuantizationReport report;
+        if (inference_engine_quantize(engine, sample, num_moves + 1, &report)) {
+            printf("Int8 model: %zu calibration positions, value error max %.4f mean %.4f, "
+                   "policy agreement %.1f%%, %zu -> %zu parameter bytes\n",
+                   report.samples, report.value_max_error, report.value_mean_error,
+                   100.0 * report.policy_agreement, report.network_bytes, report.quantized_bytes);
+        }
+        for (size_t i = 1; i <= num_moves; i++) chess_position_destroy(sample[i]);
+        delete[] sample;
+    }
+    
     // Evaluate position
     double eval = inference_engine_evaluate_position(engine, pos);
     printf("Position evaluation: %.4f\n", eval);
@@ -118,6 +250,49 @@ int cmd_infer(int argc, char* argv[]) {
         delete move_eval;
     }
     
+    // Search with network evaluation at the leaves
+    if (depth > 0) {
+        SearchLimits limits = {depth, 0, 0.0};
+        SearchResult result;
+        clock_t start = clock();
+        inference_engine_search(engine, pos, &limits, &result);
+        double elapsed = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+        
+        if (result.has_move) {
+            char uci[6];
+            chess_move_to_uci(&result.best_move, uci);
+            printf("Search depth %zu: best %s score %.4f nodes %llu (%.3fs)\nPV:", result.depth, uci,
+                   result.score, (unsigned long long)result.nodes, elapsed);
+            for (size_t i = 0; i < result.pv_length; i++) {
+                chess_move_to_uci(&result.pv[i], uci);
+                printf(" %s", uci);
+            }
+            printf("\n");
+        } else {
+            printf("No legal moves (score %.4f)\n", result.score);
+        }
+    }
+    
+    // Monte Carlo tree search with network priors
+    if (simulations > 0) {
+        MCTSResult result;
+        engine->temperature = 0.0;
+        engine->mcts_threads = threads;
+        engine->mcts_batch_size = batch;
+        auto start = std::chrono::steady_clock::now();                // Wall time: CPU clock would sum all workers
+        inference_engine_run_mcts(engine, pos, simulations, &result);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (result.has_move) {
+            char uci[6];
+            chess_move_to_uci(&result.best_move, uci);
+            printf("MCTS %zu simulations: best %s value %.4f nodes %zu (%.3fs)\n", result.simulations, uci,
+                   result.value, result.tree_nodes, elapsed);
+            printf("Threads %zu, batch %zu: %zu batches, %zu collisions\n", threads, batch,
+                   result.batches, result.collisions);
+        }
+    }
+    
     chess_position_destroy(pos);
     inference_engine_destroy(engine);
     return 0;
@@ -144,12 +319,11 @@ int cmd_puzzle(int argc, char* argv[]) {
     
     TrainingExample* puzzle = puzzle_generator_create_puzzle(generator, level);
     if (puzzle) {
-        printf("Puzzle generated: difficulty=%.2f, input_size=%zu, target_size=%zu\n",
-               puzzle->difficulty, puzzle->input_size, puzzle->target_size);
+        printf("Puzzle generated: difficulty=%.2f, input_size=%zu, target_size=%zu, candidate_moves=%zu\n",
+               puzzle->difficulty, puzzle->input_size, puzzle->target_size, puzzle->num_sparse);
         
         // Clean up
-        delete[] puzzle->input;
-        delete[] puzzle->target;
+        training_example_release(puzzle);
         delete puzzle;
     }
     
@@ -168,11 +342,8 @@ int cmd_interactive(int argc, char* argv[]) {
     NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
     InferenceEngine* engine = inference_engine_create(nn);
     
-    const char* model_path = "checkpoint.bin";
-    FILE* f = fopen(model_path, "r");
-    if (f) {
-        fclose(f);
-        inference_engine_load_model(engine, model_path);
+    const char* model_path = "model.bin";
+    if (inference_engine_load_model(engine, model_path)) {
         printf("Model loaded from %s\n", model_path);
     } else {
         printf("No model found, using untrained network\n");
@@ -200,6 +371,97 @@ int cmd_interactive(int argc, char* argv[]) {
     return 0;
 }
 
+// Standard perft positions with published node counts
+struct PerftBenchPosition {
+    const char* name;
+    const char* fen;
+    size_t depth;
+    uint64_t expected_nodes;
+};
+
+static const PerftBenchPosition perft_bench_positions[] = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609ULL},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL},
+    {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ULL},
+    {"promotions", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ULL},
+    {"talkchess", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL},
+    {"middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL},
+};
+
+int cmd_perft(int argc, char* argv[]) {
+    const char* fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    size_t depth = 5;
+    bool divide = false;
+    bool bench = false;
+    
+    // Parse arguments
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--fen") == 0 && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--divide") == 0) {
+            divide = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        }
+    }
+    
+    if (bench) {
+        uint64_t total_nodes = 0;
+        double total_time = 0.0;
+        int failures = 0;
+        
+        for (const PerftBenchPosition& entry : perft_bench_positions) {
+            ChessPosition* pos = chess_position_from_fen(entry.fen);
+            clock_t start = clock();
+            uint64_t nodes = chess_position_perft(pos, entry.depth);
+            double elapsed = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+            chess_position_destroy(pos);
+            
+            bool ok = nodes == entry.expected_nodes;
+            if (!ok) failures++;
+            total_nodes += nodes;
+            total_time += elapsed;
+            printf("%-11s depth %zu: %12llu nodes %8.3fs %12.0f nps %s\n",
+                   entry.name, entry.depth, (unsigned long long)nodes, elapsed,
+                   elapsed > 0.0 ? nodes / elapsed : 0.0, ok ? "ok" : "MISMATCH");
+        }
+        
+        printf("Total: %llu nodes in %.3fs, %.0f nodes/sec\n", (unsigned long long)total_nodes,
+               total_time, total_time > 0.0 ? total_nodes / total_time : 0.0);
+        return failures == 0 ? 0 : 1;
+    }
+    
+    ChessPosition* pos = chess_position_from_fen(fen);
+    clock_t start = clock();
+    uint64_t nodes = 0;
+    
+    if (divide && depth > 0) {
+        ChessMove moves[CHESS_MAX_MOVES];
+        size_t num_moves = 0;
+        chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+        for (size_t i = 0; i < num_moves; i++) {
+            char uci[6];
+            chess_move_to_uci(&moves[i], uci);
+            chess_position_make_move(pos, &moves[i]);
+            uint64_t count = chess_position_perft(pos, depth - 1);
+            chess_position_unmake_move(pos);
+            printf("%s: %llu\n", uci, (unsigned long long)count);
+            nodes += count;
+        }
+    } else {
+        nodes = chess_position_perft(pos, depth);
+    }
+    
+    double elapsed = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+    printf("Perft depth %zu: %llu nodes in %.3fs (%.0f nodes/sec)\n", depth,
+           (unsigned long long)nodes, elapsed, elapsed > 0.0 ? nodes / elapsed : 0.0);
+    
+    chess_position_destroy(pos);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         print_usage(argv[0]);
@@ -216,6 +478,8 @@ int main(int argc, char* argv[]) {
         return cmd_puzzle(argc, argv);
     } else if (strcmp(command, "interactive") == 0) {
         return cmd_interactive(argc, argv);
+    } else if (strcmp(command, "perft") == 0) {
+        return cmd_perft(argc, argv);
     } else if (strcmp(command, "test") == 0) {
         printf("Running tests...\n");
         // Test code would go here
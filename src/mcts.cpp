@@ -0,0 +1,548 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/mcts.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define MCTS_CHUNK_BITS 16
+#define MCTS_CHUNK_SIZE (1u << MCTS_CHUNK_BITS)
+#define MCTS_MAX_CHUNKS 4096
+#define MCTS_NONE 0xFFFFFFFFu
+#define MCTS_MAX_DEPTH 512
+
+enum {
+    NODE_UNEXPANDED = 0,
+    NODE_EXPANDED = 1,
+    NODE_TERMINAL = 2,
+    NODE_EXPANDING = 3       // Claimed by a descent whose evaluation is in flight
+};
+
+// Statistics are atomics so workers can update them without locks. A node's
+// children, key and terminal value are written only by the descent that
+// claimed it (UNEXPANDED -> EXPANDING) and published by the release store of
+// EXPANDED or TERMINAL.
+struct MCTSNode {
+    ChessMove move;          // Move leading from parent to this node
+    uint64_t key;            // Position hash, set on expansion (used to find reusable subtrees)
+    std::atomic<double> value_sum;  // Sum of backed-up values from the view of the side that played move
+    float prior;             // Policy prior of move
+    float terminal_value;    // Value for side to move when node is terminal
+    std::atomic<uint32_t> visits;   // Includes in-flight visits carrying virtual loss
+    uint32_t first_child;    // Children occupy a contiguous range of the pool
+    uint16_t num_children;
+    std::atomic<uint8_t> state;
+};
+
+// Chunked arena: indices stay valid as it grows, and chunks are kept for reuse after reset
+struct MCTSNodePool {
+    MCTSNode* chunks[MCTS_MAX_CHUNKS];
+    size_t num_chunks;
+    uint32_t next;
+};
+
+struct MCTSTree {
+    MCTSNodePool pools[2];   // Active pool plus spare used when compacting a reused subtree
+    int active;
+    uint32_t root;
+    std::mt19937_64 rng;
+    std::mutex alloc_mutex;  // Serializes pool_alloc between workers
+};
+
+static inline MCTSNode* pool_node(const MCTSNodePool* pool, uint32_t index) {
+    return &pool->chunks[index >> MCTS_CHUNK_BITS][index & (MCTS_CHUNK_SIZE - 1)];
+}
+
+static uint32_t pool_alloc(MCTSNodePool* pool, size_t count) {         // Reserve contiguous node range that never straddles a chunk
+    uint32_t offset = pool->next & (MCTS_CHUNK_SIZE - 1);
+    if (offset + count > MCTS_CHUNK_SIZE) {                            // Skip to next chunk when range would not fit
+        pool->next = (pool->next | (MCTS_CHUNK_SIZE - 1)) + 1;
+    }
+    size_t chunk = pool->next >> MCTS_CHUNK_BITS;
+    if (chunk >= MCTS_MAX_CHUNKS) return MCTS_NONE;                    // Pool exhausted
+    while (pool->num_chunks <= chunk) {                                // Allocate chunk on first use
+        pool->chunks[pool->num_chunks++] = new MCTSNode[MCTS_CHUNK_SIZE];
+    }
+    uint32_t index = pool->next;
+    pool->next += (uint32_t)count;
+    return index;
+}
+
+static void pool_free_all(MCTSNodePool* pool) {
+    for (size_t i = 0; i < pool->num_chunks; i++) delete[] pool->chunks[i];
+    pool->num_chunks = 0;
+    pool->next = 0;
+}
+
+static inline void init_node(MCTSNode* node, const ChessMove* move, float prior) {
+    if (move) node->move = *move;
+    else memset(&node->move, 0, sizeof(node->move));
+    node->key = 0;
+    node->value_sum.store(0.0, std::memory_order_relaxed);
+    node->prior = prior;
+    node->terminal_value = 0.0f;
+    node->visits.store(0, std::memory_order_relaxed);
+    node->first_child = MCTS_NONE;
+    node->num_children = 0;
+    node->state.store(NODE_UNEXPANDED, std::memory_order_relaxed);
+}
+
+static inline void copy_node(MCTSNode* to, const MCTSNode* from) {
+    to->move = from->move;
+    to->key = from->key;
+    to->value_sum.store(from->value_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to->prior = from->prior;
+    to->terminal_value = from->terminal_value;
+    to->visits.store(from->visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to->first_child = from->first_child;
+    to->num_children = from->num_children;
+    to->state.store(from->state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+static inline void atomic_add(std::atomic<double>& target, double delta) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+MCTSTree* mcts_tree_create(void) {
+    MCTSTree* tree = new MCTSTree;
+    for (int p = 0; p < 2; p++) {
+        tree->pools[p].num_chunks = 0;
+        tree->pools[p].next = 0;
+    }
+    tree->active = 0;
+    tree->root = MCTS_NONE;
+    tree->rng.seed(std::random_device{}());
+    return tree;
+}
+
+void mcts_tree_destroy(MCTSTree* tree) {
+    if (tree) {
+        pool_free_all(&tree->pools[0]);
+        pool_free_all(&tree->pools[1]);
+        delete tree;
+    }
+}
+
+void mcts_tree_clear(MCTSTree* tree) {
+    tree->pools[tree->active].next = 0;
+    tree->root = MCTS_NONE;
+}
+
+// Copies subtree rooted at src into dst pool keeping sibling ranges contiguous; returns new index
+static uint32_t copy_subtree(const MCTSNodePool* src, uint32_t src_index, MCTSNodePool* dst, uint32_t dst_index) {
+    const MCTSNode* from = pool_node(src, src_index);
+    MCTSNode* to = pool_node(dst, dst_index);
+    copy_node(to, from);
+    if (from->first_child == MCTS_NONE || from->num_children == 0) return dst_index;
+
+    uint32_t children = pool_alloc(dst, from->num_children);
+    if (children == MCTS_NONE) {                                       // Out of space: keep node but drop its children
+        to = pool_node(dst, dst_index);
+        to->first_child = MCTS_NONE;
+        to->num_children = 0;
+        to->state.store(NODE_UNEXPANDED, std::memory_order_relaxed);
+        return dst_index;
+    }
+    pool_node(dst, dst_index)->first_child = children;
+    for (uint16_t i = 0; i < from->num_children; i++) {
+        copy_subtree(src, from->first_child + i, dst, children + i);
+    }
+    return dst_index;
+}
+
+static uint32_t find_reusable(const MCTSNodePool* pool, uint32_t node_index, uint64_t key, int depth) {  // Search one or two plies below root for position key
+    const MCTSNode* node = pool_node(pool, node_index);
+    uint8_t state = node->state.load(std::memory_order_relaxed);
+    if (state == NODE_UNEXPANDED || state == NODE_EXPANDING) return MCTS_NONE;
+    if (node->key == key) return node_index;
+    if (depth == 0 || state != NODE_EXPANDED) return MCTS_NONE;
+    for (uint16_t i = 0; i < node->num_children; i++) {
+        uint32_t found = find_reusable(pool, node->first_child + i, key, depth - 1);
+        if (found != MCTS_NONE) return found;
+    }
+    return MCTS_NONE;
+}
+
+static void prepare_root(MCTSTree* tree, ChessPosition* pos) {         // Re-root onto matching subtree from previous search or start fresh
+    uint64_t key = chess_position_get_hash(pos);
+    MCTSNodePool* pool = &tree->pools[tree->active];
+
+    if (tree->root != MCTS_NONE) {
+        uint32_t found = find_reusable(pool, tree->root, key, 2);      // New position is usually our move plus opponent reply
+        if (found != MCTS_NONE && pool_node(pool, found)->state.load(std::memory_order_relaxed) != NODE_EXPANDED) found = MCTS_NONE;  // Draw-terminal nodes cannot be roots
+        if (found == tree->root) return;                               // Same position as last search: keep whole tree
+        if (found != MCTS_NONE) {
+            MCTSNodePool* spare = &tree->pools[tree->active ^ 1];
+            spare->next = 0;
+            uint32_t root = pool_alloc(spare, 1);
+            copy_subtree(pool, found, spare, root);                    // Compact surviving subtree into spare pool
+            tree->active ^= 1;
+            tree->root = root;
+            return;
+        }
+    }
+
+    pool->next = 0;                                                    // No reusable subtree: recycle whole pool
+    tree->root = pool_alloc(pool, 1);
+    init_node(pool_node(pool, tree->root), nullptr, 1.0f);
+}
+
+// Leaf claimed by a worker and waiting for its batch to be evaluated
+struct PendingLeaf {
+    uint32_t path[MCTS_MAX_DEPTH];
+    size_t length;
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves;
+    bool white_to_move;
+};
+
+// State shared by the workers of one search
+struct SearchShared {
+    MCTSTree* tree;
+    double c_puct;
+    double virtual_loss;
+    size_t batch_size;
+    MCTSEvaluator evaluate;                  // Immediate evaluation (mcts_search)
+    void* context;
+    const MCTSBatchEvaluator* batch;         // Batched evaluation (mcts_search_batched)
+    size_t total;
+    std::atomic<size_t> claimed;
+    std::atomic<size_t> collisions;
+    std::atomic<size_t> batches;
+};
+
+enum {
+    LEAF_DONE,
+    LEAF_PENDING,
+    LEAF_COLLISION
+};
+
+static bool claim_simulation(SearchShared* shared) {
+    size_t claimed = shared->claimed.load(std::memory_order_relaxed);
+    while (claimed < shared->total) {
+        if (shared->claimed.compare_exchange_weak(claimed, claimed + 1, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+static uint32_t select_child(const MCTSNodePool* pool, const MCTSNode* node, double c_puct) {  // Pick child maximizing Q + U
+    uint32_t parent_visits = node->visits.load(std::memory_order_relaxed);
+    double sqrt_visits = sqrt((double)(parent_visits > 0 ? parent_visits : 1));
+    uint32_t best = node->first_child;
+    double best_score = -1e300;
+    for (uint16_t i = 0; i < node->num_children; i++) {
+        const MCTSNode* child = pool_node(pool, node->first_child + i);
+        uint32_t visits = child->visits.load(std::memory_order_relaxed);
+        double q = visits ? child->value_sum.load(std::memory_order_relaxed) / visits : 0.0;
+        double u = c_puct * child->prior * sqrt_visits / (1.0 + visits);
+        if (q + u > best_score) {
+            best_score = q + u;
+            best = node->first_child + i;
+        }
+    }
+    return best;
+}
+
+static void descend(SearchShared* shared, ChessPosition* pos, PendingLeaf* leaf) {  // Follow PUCT choices charging virtual loss on every node
+    MCTSTree* tree = shared->tree;
+    MCTSNodePool* pool = &tree->pools[tree->active];
+    uint32_t index = tree->root;
+    leaf->length = 0;
+    for (;;) {
+        MCTSNode* node = pool_node(pool, index);
+        node->visits.fetch_add(1, std::memory_order_relaxed);           // Counted now so concurrent descents see it in flight
+        atomic_add(node->value_sum, -shared->virtual_loss);
+        leaf->path[leaf->length++] = index;
+        if (node->state.load(std::memory_order_acquire) != NODE_EXPANDED || leaf->length >= MCTS_MAX_DEPTH) break;
+        index = select_child(pool, node, shared->c_puct);
+        chess_position_make_move(pos, &pool_node(pool, index)->move);
+    }
+}
+
+static void backup(SearchShared* shared, const PendingLeaf* leaf, double value) {  // Replace virtual loss with value, alternating perspective toward root
+    MCTSNodePool* pool = &shared->tree->pools[shared->tree->active];
+    for (size_t i = leaf->length; i-- > 0;) {
+        value = -value;                                                // Node stores value for side that moved into it
+        atomic_add(pool_node(pool, leaf->path[i])->value_sum, value + shared->virtual_loss);
+    }
+}
+
+static void revert_virtual_loss(SearchShared* shared, const PendingLeaf* leaf) {
+    MCTSNodePool* pool = &shared->tree->pools[shared->tree->active];
+    for (size_t i = 0; i < leaf->length; i++) {
+        MCTSNode* node = pool_node(pool, leaf->path[i]);
+        node->visits.fetch_sub(1, std::memory_order_relaxed);
+        atomic_add(node->value_sum, shared->virtual_loss);
+    }
+}
+
+static void publish_terminal(MCTSNode* node, double value) {
+    node->terminal_value = (float)value;
+    node->state.store(NODE_TERMINAL, std::memory_order_release);
+}
+
+static void finish_expansion(SearchShared* shared, uint32_t node_index, const ChessMove* moves, size_t num_moves,  // Attach children with normalized priors and publish node
+                             double* priors) {
+    MCTSTree* tree = shared->tree;
+    MCTSNodePool* pool = &tree->pools[tree->active];
+
+    double total = 0.0;                                                // Normalize priors, falling back to uniform
+    for (size_t i = 0; i < num_moves; i++) {
+        if (!std::isfinite(priors[i]) || priors[i] < 0.0) priors[i] = 0.0;
+        total += priors[i];
+    }
+
+    uint32_t children;
+    {
+        std::lock_guard<std::mutex> lock(tree->alloc_mutex);
+        children = pool_alloc(pool, num_moves);
+    }
+    MCTSNode* node = pool_node(pool, node_index);
+    if (children == MCTS_NONE) {                                       // Pool full: leave unexpanded so it is only evaluated
+        node->state.store(NODE_UNEXPANDED, std::memory_order_release);
+        return;
+    }
+    for (size_t i = 0; i < num_moves; i++) {
+        float prior = total > 0.0 ? (float)(priors[i] / total) : 1.0f / (float)num_moves;
+        init_node(pool_node(pool, children + (uint32_t)i), &moves[i], prior);
+    }
+    node->first_child = children;
+    node->num_children = (uint16_t)num_moves;
+    node->state.store(NODE_EXPANDED, std::memory_order_release);      // Children become visible to other workers
+}
+
+static inline double clamp_value(double value) {
+    if (!std::isfinite(value)) return 0.0;
+    return fmax(-1.0, fmin(1.0, value));
+}
+
+// Claims and expands the leaf at the end of the path. Terminal and directly
+// evaluated leaves are backed up at once; batched leaves are encoded into
+// input and left pending. Returns LEAF_COLLISION when another descent owns it.
+static int visit_leaf(SearchShared* shared, ChessPosition* pos, PendingLeaf* leaf, double* input) {
+    MCTSNodePool* pool = &shared->tree->pools[shared->tree->active];
+    uint32_t index = leaf->path[leaf->length - 1];
+    MCTSNode* node = pool_node(pool, index);
+
+    uint8_t state = node->state.load(std::memory_order_acquire);
+    if (state == NODE_TERMINAL) {
+        backup(shared, leaf, node->terminal_value);
+        return LEAF_DONE;
+    }
+    if (state == NODE_EXPANDED) {                                      // Depth cap reached
+        backup(shared, leaf, 0.0);
+        return LEAF_DONE;
+    }
+    uint8_t expected = NODE_UNEXPANDED;
+    if (!node->state.compare_exchange_strong(expected, NODE_EXPANDING, std::memory_order_acquire)) {
+        revert_virtual_loss(shared, leaf);                             // Another descent got here first
+        return LEAF_COLLISION;
+    }
+
+    node->key = chess_position_get_hash(pos);
+    if (leaf->length > 1 && (chess_position_is_repetition(pos) || chess_position_get_halfmove_clock(pos) >= 100)) {
+        publish_terminal(node, 0.0);                                   // Draw by repetition or fifty move rule
+        backup(shared, leaf, 0.0);
+        return LEAF_DONE;
+    }
+
+    Color us = chess_position_get_side_to_move(pos);
+    chess_position_generate_moves(pos, us, leaf->moves, &leaf->num_moves);
+    if (leaf->num_moves == 0) {                                        // Checkmate loses, stalemate draws
+        double value = chess_position_is_check(pos, us) ? -1.0 : 0.0;
+        publish_terminal(node, value);
+        backup(shared, leaf, value);
+        return LEAF_DONE;
+    }
+
+    if (!shared->batch) {
+        double priors[CHESS_MAX_MOVES];
+        double value = shared->evaluate(shared->context, pos, leaf->moves, leaf->num_moves, priors);
+        shared->batches.fetch_add(1, std::memory_order_relaxed);
+        finish_expansion(shared, index, leaf->moves, leaf->num_moves, priors);
+        backup(shared, leaf, clamp_value(value));
+        return LEAF_DONE;
+    }
+
+    leaf->white_to_move = us == COLOR_WHITE;
+    shared->batch->encode(shared->batch->context, pos, input);
+    return LEAF_PENDING;
+}
+
+static void flush_batch(SearchShared* shared, void* workspace, PendingLeaf* leaves, size_t count,  // Evaluate pending leaves together, expand them and back up values
+                        const double* inputs, double* outputs) {
+    if (count == 0) return;
+    const MCTSBatchEvaluator* batch = shared->batch;
+    memset(outputs, 0, count * batch->output_size * sizeof(double));
+    batch->evaluate(batch->context, workspace, inputs, count, outputs);  // Worker's own scratch: no lock
+    shared->batches.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t b = 0; b < count; b++) {
+        PendingLeaf* leaf = &leaves[b];
+        const double* out = outputs + b * batch->output_size;
+        double value = clamp_value(leaf->white_to_move ? out[0] : -out[0]);  // Network value is from white's view
+
+        double priors[CHESS_MAX_MOVES];                                // Softmax over legal move logits
+        double max_logit = -1e300;
+        for (size_t i = 0; i < leaf->num_moves; i++) {
+            double logit = out[leaf->moves[i].from * 64 + leaf->moves[i].to];
+            priors[i] = std::isfinite(logit) ? logit : -1e300;
+            if (priors[i] > max_logit) max_logit = priors[i];
+        }
+        for (size_t i = 0; i < leaf->num_moves; i++) {
+            priors[i] = priors[i] > -1e300 ? exp(priors[i] - max_logit) : 0.0;
+        }
+
+        finish_expansion(shared, leaf->path[leaf->length - 1], leaf->moves, leaf->num_moves, priors);
+        backup(shared, leaf, value);
+    }
+}
+
+static void run_worker(SearchShared* shared, ChessPosition* pos) {     // Claim simulations until the budget is spent, batching leaves when configured
+    size_t capacity = shared->batch ? shared->batch_size : 1;
+    std::vector<PendingLeaf> leaves(capacity);
+    std::vector<double> inputs(shared->batch ? capacity * shared->batch->input_size : 0);
+    std::vector<double> outputs(shared->batch ? capacity * shared->batch->output_size : 0);
+    const MCTSBatchEvaluator* batch = shared->batch;
+    void* workspace = batch && batch->create_workspace ? batch->create_workspace(batch->context) : nullptr;
+    size_t count = 0;
+
+    while (claim_simulation(shared)) {
+        PendingLeaf* leaf = &leaves[count];
+        descend(shared, pos, leaf);
+        double* input = shared->batch ? &inputs[count * shared->batch->input_size] : nullptr;
+        int status = visit_leaf(shared, pos, leaf, input);
+        for (size_t i = 1; i < leaf->length; i++) chess_position_unmake_move(pos);
+
+        if (status == LEAF_PENDING) {
+            if (++count == capacity) {
+                flush_batch(shared, workspace, leaves.data(), count, inputs.data(), outputs.data());
+                count = 0;
+            }
+        } else if (status == LEAF_COLLISION) {
+            shared->claimed.fetch_sub(1, std::memory_order_relaxed);   // Give the simulation back
+            shared->collisions.fetch_add(1, std::memory_order_relaxed);
+            if (count > 0) {                                           // Our own pending leaves may be what blocks us
+                flush_batch(shared, workspace, leaves.data(), count, inputs.data(), outputs.data());
+                count = 0;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    flush_batch(shared, workspace, leaves.data(), count, inputs.data(), outputs.data());
+    if (workspace && batch->destroy_workspace) batch->destroy_workspace(batch->context, workspace);
+}
+
+static void run_search(MCTSTree* tree, ChessPosition* pos, const MCTSConfig* config,  // Run playouts on worker threads and choose move
+                       SearchShared* shared, MCTSResult* result) {
+    memset(result, 0, sizeof(*result));
+    prepare_root(tree, pos);                                           // Reuse subtree from previous move when possible
+    MCTSNodePool* pool = &tree->pools[tree->active];
+
+    shared->tree = tree;
+    shared->c_puct = config->c_puct;
+    shared->virtual_loss = config->virtual_loss > 0.0 ? config->virtual_loss : 1.0;
+    shared->batch_size = config->batch_size > 1 ? config->batch_size : 1;
+    shared->total = config->simulations > 0 ? config->simulations : 1;  // Always expand the root at least once
+    shared->claimed.store(0, std::memory_order_relaxed);
+    shared->collisions.store(0, std::memory_order_relaxed);
+    shared->batches.store(0, std::memory_order_relaxed);
+
+    size_t num_threads = config->num_threads > 1 ? config->num_threads : 1;
+    std::vector<ChessPosition*> positions;                             // Each extra worker descends its own copy of the position
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < num_threads; t++) {
+        positions.push_back(chess_position_clone(pos));
+        workers.emplace_back(run_worker, shared, positions.back());
+    }
+    run_worker(shared, pos);
+    for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+    for (size_t t = 0; t < positions.size(); t++) chess_position_destroy(positions[t]);
+
+    result->simulations = shared->total;
+    result->collisions = shared->collisions.load(std::memory_order_relaxed);
+    result->batches = shared->batches.load(std::memory_order_relaxed);
+
+    const MCTSNode* root = pool_node(pool, tree->root);
+    uint32_t root_visits = root->visits.load(std::memory_order_relaxed);
+    result->root_visits = root_visits;
+    result->value = root_visits ? -root->value_sum.load(std::memory_order_relaxed) / root_visits : 0.0;  // Root sum is stored from opponent's view
+    result->tree_nodes = pool->next;
+    if (root->state.load(std::memory_order_relaxed) != NODE_EXPANDED || root->num_children == 0) return;
+
+    uint32_t chosen = root->first_child;
+    if (config->temperature <= 1e-3) {                                 // Greedy: most visits, prior breaks ties
+        for (uint16_t i = 1; i < root->num_children; i++) {
+            const MCTSNode* child = pool_node(pool, root->first_child + i);
+            const MCTSNode* best = pool_node(pool, chosen);
+            uint32_t child_visits = child->visits.load(std::memory_order_relaxed);
+            uint32_t best_visits = best->visits.load(std::memory_order_relaxed);
+            if (child_visits > best_visits || (child_visits == best_visits && child->prior > best->prior)) {
+                chosen = root->first_child + i;
+            }
+        }
+    } else {                                                           // Sample proportional to visits^(1/temperature)
+        double weights[CHESS_MAX_MOVES];
+        double total = 0.0;
+        for (uint16_t i = 0; i < root->num_children; i++) {
+            weights[i] = pow((double)pool_node(pool, root->first_child + i)->visits.load(std::memory_order_relaxed),
+                             1.0 / config->temperature);
+            total += weights[i];
+        }
+        if (total > 0.0) {
+            double r = std::uniform_real_distribution<double>(0.0, total)(tree->rng);
+            for (uint16_t i = 0; i < root->num_children; i++) {
+                chosen = root->first_child + i;
+                if (r < weights[i]) break;
+                r -= weights[i];
+            }
+        }
+    }
+    result->best_move = pool_node(pool, chosen)->move;
+    result->has_move = true;
+}
+
+void mcts_search(MCTSTree* tree, ChessPosition* pos, const MCTSConfig* config,  // Run PUCT playouts evaluating each leaf as it is reached
+                 MCTSEvaluator evaluate, void* context, MCTSResult* result) {
+    SearchShared shared;
+    shared.evaluate = evaluate;
+    shared.context = context;
+    shared.batch = nullptr;
+    run_search(tree, pos, config, &shared, result);
+}
+
+void mcts_search_batched(MCTSTree* tree, ChessPosition* pos, const MCTSConfig* config,  // Run PUCT playouts evaluating leaves in batches
+                         const MCTSBatchEvaluator* evaluator, MCTSResult* result) {
+    SearchShared shared;
+    shared.evaluate = nullptr;
+    shared.context = nullptr;
+    shared.batch = evaluator;
+    run_search(tree, pos, config, &shared, result);
+}
+
+void mcts_get_visit_distribution(const MCTSTree* tree, double* policy) {
+    memset(policy, 0, 64 * 64 * sizeof(double));
+    if (tree->root == MCTS_NONE) return;
+    const MCTSNodePool* pool = &tree->pools[tree->active];
+    const MCTSNode* root = pool_node(pool, tree->root);
+    if (root->state.load(std::memory_order_relaxed) != NODE_EXPANDED) return;
+
+    double total = 0.0;
+    for (uint16_t i = 0; i < root->num_children; i++) {
+        total += pool_node(pool, root->first_child + i)->visits.load(std::memory_order_relaxed);
+    }
+    if (total <= 0.0) return;
+    for (uint16_t i = 0; i < root->num_children; i++) {
+        const MCTSNode* child = pool_node(pool, root->first_child + i);
+        policy[child->move.from * 64 + child->move.to] += child->visits.load(std::memory_order_relaxed) / total;  // Under-promotions share the queen's slot
+    }
+}
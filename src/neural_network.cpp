@@ -3,11 +3,22 @@
  * All rights reserved.
  */
 #include "../include/neural_network.h"
+#include "../include/nn_kernels.h"
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <new>
 #include <random>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NN_BATCH_CHUNK 64  // Samples per batched GEMM pass; bounds the batch workspace
+#define NN_ARENA_ALIGNMENT 64  // Parameter arenas start on a cache line
+#define MAX_PARAMETER_BLOCKS 4  // Weights and biases of the Bayesian and LSTM layers
 
 // Random number generator
 static std::mt19937 rng(std::random_device{}());
@@ -18,28 +29,14 @@ static double sigmoid(double x) {                                    // Compute
     return 1.0 / (1.0 + exp(-x));                                    // Return normalized value between zero and one using exponential
 }
 
-static double sigmoid_derivative(double x) {                           // Calculate derivative of sigmoid function for backpropagation gradient
-    double s = sigmoid(x);                                             // Get sigmoid value to compute derivative efficiently
-    return s * (1.0 - s);                                             // Return derivative using sigmoid property s'(x) = s(x)(1-s(x))
-}
-
 static double tanh_activation(double x) {                              // Compute hyperbolic tangent activation function for neural layers
     return tanh(x);                                                    // Return value between negative one and positive one
 }
 
-static double tanh_derivative(double x) {                              // Calculate derivative of tanh function for gradient computation
-    double t = tanh(x);                                                // Get tanh value to compute derivative using identity
-    return 1.0 - t * t;                                               // Return derivative using tanh property t'(x) = 1 - t²(x)
-}
-
 static double relu(double x) {                                        // Compute rectified linear unit activation for deep networks
     return x > 0 ? x : 0.0;                                            // Return input if positive otherwise return zero threshold
 }
 
-static double relu_derivative(double x) {                             // Calculate derivative of ReLU function for backpropagation
-    return x > 0 ? 1.0 : 0.0;                                         // Return one if positive otherwise return zero for gradient
-}
-
 static void softmax(double* x, size_t n) {                           // Normalize vector to probability distribution using softmax function
     double max_val = x[0];                                            // Find maximum value to prevent numerical overflow in exponent
     for (size_t i = 1; i < n; i++) {                                  // Iterate through all elements to find global maximum value
@@ -57,29 +54,212 @@ static void softmax(double* x, size_t n) {                           // Normaliz
     }
 }
 
+static double* arena_alloc(size_t count) {                           // Zeroed, cache-line aligned block of doubles
+    double* arena = static_cast<double*>(::operator new[](std::max<size_t>(count, 1) * sizeof(double),
+                                                          std::align_val_t(NN_ARENA_ALIGNMENT)));
+    memset(arena, 0, count * sizeof(double));
+    return arena;
+}
+
+static void arena_free(double* arena) {
+    if (arena) ::operator delete[](arena, std::align_val_t(NN_ARENA_ALIGNMENT));
+}
+
+// Weight matrix held in the network's storage precision. The double-precision values live in a
+// parameter arena slot owned by the layer or network; reduced-precision copies are allocated here.
+// Weights mapped from a model file point into the file instead, in its dtype, with no arena slot
+struct WeightMatrix {
+    NNPrecision precision;
+    size_t rows;
+    size_t cols;
+    double* storage;      // Arena slot of rows x cols doubles; null for mapped reduced-precision weights
+    double* f64;          // storage while the precision is FP64, otherwise null
+    float* f32;
+    uint16_t* bf16;
+    float* input_f32;     // NN_BATCH_CHUNK x cols activations converted for reduced-precision products
+    bool read_only;       // Weights point into a mapped model file: never written or freed
+};
+
+static void weight_matrix_init(WeightMatrix* w, size_t rows, size_t cols, double* storage) {
+    w->precision = NN_PRECISION_FP64;
+    w->rows = rows;
+    w->cols = cols;
+    w->storage = storage;
+    w->f64 = storage;
+    w->f32 = nullptr;
+    w->bf16 = nullptr;
+    w->input_f32 = nullptr;
+    w->read_only = false;
+}
+
+static void weight_matrix_free(WeightMatrix* w) {
+    if (!w->read_only) {
+        delete[] w->f32;
+        delete[] w->bf16;
+    }
+    delete[] w->input_f32;
+}
+
+static inline double weight_matrix_get(const WeightMatrix* w, size_t i) {
+    switch (w->precision) {
+        case NN_PRECISION_FP32: return w->f32[i];
+        case NN_PRECISION_BF16: return nn_bf16_to_float(w->bf16[i]);
+        default: return w->f64[i];
+    }
+}
+
+static void weight_matrix_convert(WeightMatrix* w, NNPrecision precision) {  // Re-store weights in another precision, rounding once; never mapped weights
+    if (precision == w->precision) return;
+    size_t count = w->rows * w->cols;
+    double* f64 = nullptr;
+    float* f32 = nullptr;
+    uint16_t* bf16 = nullptr;
+    switch (precision) {
+        case NN_PRECISION_FP32:
+            f32 = new float[count];
+            for (size_t i = 0; i < count; i++) f32[i] = (float)weight_matrix_get(w, i);
+            break;
+        case NN_PRECISION_BF16:
+            bf16 = new uint16_t[count];
+            for (size_t i = 0; i < count; i++) bf16[i] = nn_float_to_bf16((float)weight_matrix_get(w, i));
+            break;
+        default:
+            f64 = w->storage;                                          // Back into the arena slot
+            for (size_t i = 0; i < count; i++) f64[i] = weight_matrix_get(w, i);
+            break;
+    }
+    delete[] w->f32;
+    delete[] w->bf16;
+    if (f32) for (size_t i = 0; i < count; i++) w->storage[i] = f32[i];  // Arena mirrors the values forward passes see
+    if (bf16) for (size_t i = 0; i < count; i++) w->storage[i] = nn_bf16_to_float(bf16[i]);
+    w->f64 = f64;
+    w->f32 = f32;
+    w->bf16 = bf16;
+    w->precision = precision;
+    if (precision != NN_PRECISION_FP64 && !w->input_f32) w->input_f32 = new float[NN_BATCH_CHUNK * w->cols];
+}
+
+static size_t precision_bytes(NNPrecision precision) {              // Bytes per stored weight
+    switch (precision) {
+        case NN_PRECISION_FP32: return sizeof(float);
+        case NN_PRECISION_BF16: return sizeof(uint16_t);
+        default: return sizeof(double);
+    }
+}
+
+static size_t weight_matrix_bytes(const WeightMatrix* w) {
+    return w->rows * w->cols * precision_bytes(w->precision);
+}
+
+// C = A W[:, 0:K]^T + bias over the leading K columns of the weight rows; reduced-precision weights
+// see the activations rounded to float into scratch (NN_BATCH_CHUNK x K), chunk by chunk, and accumulate in fp32 inside the kernel
+static void weight_matrix_gemm_scratch(const WeightMatrix* w, float* scratch, const double* A, size_t lda, const double* bias,
+                                       double* C, size_t ldc, size_t M, size_t N, size_t K) {
+    if (w->precision == NN_PRECISION_FP64) {
+        nn_kernel_gemm(A, lda, w->f64, w->cols, bias, C, ldc, M, N, K);
+        return;
+    }
+    for (size_t m0 = 0; m0 < M; m0 += NN_BATCH_CHUNK) {
+        size_t mb = M - m0 < NN_BATCH_CHUNK ? M - m0 : NN_BATCH_CHUNK;
+        for (size_t m = 0; m < mb; m++) {
+            const double* a = A + (m0 + m) * lda;
+            float* x = scratch + m * K;
+            for (size_t k = 0; k < K; k++) x[k] = (float)a[k];
+        }
+        if (w->precision == NN_PRECISION_FP32) {
+            nn_kernel_gemm_f32(scratch, K, w->f32, w->cols, bias, C + m0 * ldc, ldc, mb, N, K);
+        } else {
+            nn_kernel_gemm_bf16(scratch, K, w->bf16, w->cols, bias, C + m0 * ldc, ldc, mb, N, K);
+        }
+    }
+}
+
+static void weight_matrix_gemm(WeightMatrix* w, const double* A, size_t lda, const double* bias,  // Single-threaded paths share the matrix's own scratch
+                               double* C, size_t ldc, size_t M, size_t N, size_t K) {
+    weight_matrix_gemm_scratch(w, w->input_f32, A, lda, bias, C, ldc, M, N, K);
+}
+
+// Adds alpha times the leading n entries of weight row r to y; used by the transposed products in backward passes
+static void weight_matrix_row_axpy(const WeightMatrix* w, size_t r, double alpha, double* y, size_t n) {
+    switch (w->precision) {
+        case NN_PRECISION_FP32: {
+            const float* row = w->f32 + r * w->cols;
+            for (size_t c = 0; c < n; c++) y[c] += alpha * row[c];
+            break;
+        }
+        case NN_PRECISION_BF16: {
+            const uint16_t* row = w->bf16 + r * w->cols;
+            for (size_t c = 0; c < n; c++) y[c] += alpha * nn_bf16_to_float(row[c]);
+            break;
+        }
+        default: {
+            const double* row = w->f64 + r * w->cols;
+            for (size_t c = 0; c < n; c++) y[c] += alpha * row[c];
+        }
+    }
+}
+
+static void grow_step_cache(double** cache, size_t capacity, size_t new_capacity, size_t row) {  // Reallocate a per-step cache keeping the rows already stored
+    double* grown = new double[new_capacity * row];
+    memcpy(grown, *cache, capacity * row * sizeof(double));
+    memset(grown + capacity * row, 0, (new_capacity - capacity) * row * sizeof(double));
+    delete[] *cache;
+    *cache = grown;
+}
+
+static size_t grown_capacity(size_t capacity, size_t steps) {          // Geometric growth so long sequences reallocate rarely
+    return std::max(steps, 2 * capacity);
+}
+
+static double activation_derivative(ActivationType activation, double output) {  // Derivative expressed through the activation's output
+    switch (activation) {
+        case ACTIVATION_SIGMOID: return output * (1.0 - output);
+        case ACTIVATION_TANH: return 1.0 - output * output;
+        case ACTIVATION_RELU: return output > 0.0 ? 1.0 : 0.0;
+        default: return 1.0;
+    }
+}
+
 // Bayesian Layer Implementation
 struct BayesianLayer {
     size_t num_nodes;
     size_t num_parents;
-    double* weights;      // Conditional probability tables
+    WeightMatrix weights; // Conditional probability tables (num_nodes x num_parents)
     double* biases;
-    double* activations;
-    double* input_cache;
+    double* weight_gradients;  // Loss gradient of each weight, accumulated until applied (num_nodes x num_parents)
+    double* bias_gradients;
+    double* owned_parameters;  // Arenas of a standalone layer; null when the network owns them
+    double* owned_gradients;
+    double* activations;       // Outputs of each cached step (capacity x num_nodes)
+    double* input_cache;       // Inputs of each cached step (capacity x num_parents)
+    size_t* active_inputs;     // Indices of the nonzero inputs of that step
+    size_t capacity;           // Steps the caches hold
     ActivationType activation;
 };
 
-BayesianLayer* bayesian_layer_create(size_t num_nodes, size_t num_parents) {  // Allocate and initialize Bayesian network layer with nodes and parents
+static size_t bayesian_parameter_count(size_t num_nodes, size_t num_parents) {  // Weights followed by biases
+    return num_nodes * num_parents + num_nodes;
+}
+
+static BayesianLayer* bayesian_layer_build(size_t num_nodes, size_t num_parents,  // Lay the layer's parameters out at the given arena slots
+                                           double* parameters, double* gradients) {
     BayesianLayer* layer = new BayesianLayer;                          // Allocate memory for new Bayesian layer structure
     layer->num_nodes = num_nodes;                                      // Set number of output nodes in this Bayesian layer
     layer->num_parents = num_parents;                                // Set number of input parent nodes for conditional probabilities
-    layer->weights = new double[num_nodes * num_parents];             // Allocate weight matrix for conditional probability tables
-    layer->biases = new double[num_nodes];                             // Allocate bias vector for each output node activation
+    weight_matrix_init(&layer->weights, num_nodes, num_parents, parameters);  // Conditional probability tables open the slot
+    layer->biases = parameters + num_nodes * num_parents;             // Bias vector follows the weights
+    layer->weight_gradients = gradients;                               // Gradient slot mirrors the parameter slot
+    layer->bias_gradients = gradients + num_nodes * num_parents;
+    layer->owned_parameters = nullptr;
+    layer->owned_gradients = nullptr;
+    layer->capacity = 1;                                               // Single-sample passes need one cached step
     layer->activations = new double[num_nodes];                        // Allocate activation cache for backward pass computation
     layer->input_cache = new double[num_parents];                     // Allocate input cache to store values for gradient computation
+    layer->active_inputs = new size_t[num_parents];                    // Allocate backward workspace once
     layer->activation = ACTIVATION_SIGMOID;                           // Set default activation function to sigmoid for probabilities
     
     for (size_t i = 0; i < num_nodes * num_parents; i++) {             // Initialize all weight values with small random numbers
-        layer->weights[i] = dist(rng);                                 // Sample from uniform distribution for weight initialization
+        layer->weights.f64[i] = dist(rng);                             // Sample from uniform distribution for weight initialization
     }
     for (size_t i = 0; i < num_nodes; i++) {                          // Initialize all bias values with small random numbers
         layer->biases[i] = dist(rng);                                  // Sample from uniform distribution for bias initialization
@@ -88,24 +268,45 @@ BayesianLayer* bayesian_layer_create(size_t num_nodes, size_t num_parents) {  //
     return layer;                                                      // Return pointer to initialized Bayesian layer structure
 }
 
+BayesianLayer* bayesian_layer_create(size_t num_nodes, size_t num_parents) {  // Allocate and initialize Bayesian network layer with nodes and parents
+    size_t count = bayesian_parameter_count(num_nodes, num_parents);
+    double* parameters = arena_alloc(count);
+    double* gradients = arena_alloc(count);
+    BayesianLayer* layer = bayesian_layer_build(num_nodes, num_parents, parameters, gradients);
+    layer->owned_parameters = parameters;                              // Standalone layers free their own arenas
+    layer->owned_gradients = gradients;
+    return layer;
+}
+
 void bayesian_layer_destroy(BayesianLayer* layer) {
     if (layer) {
-        delete[] layer->weights;
-        delete[] layer->biases;
+        weight_matrix_free(&layer->weights);
+        arena_free(layer->owned_parameters);
+        arena_free(layer->owned_gradients);
         delete[] layer->activations;
         delete[] layer->input_cache;
+        delete[] layer->active_inputs;
         delete layer;
     }
 }
 
-void bayesian_layer_forward(BayesianLayer* layer, const double* input, double* output) {  // Forward pass through Bayesian layer computing conditional probabilities
-    memcpy(layer->input_cache, input, layer->num_parents * sizeof(double));  // Cache input values for backward pass gradient computation
+static void bayesian_reserve(BayesianLayer* layer, size_t steps) {     // Make room for a sequence of steps
+    if (steps <= layer->capacity) return;
+    size_t capacity = grown_capacity(layer->capacity, steps);
+    grow_step_cache(&layer->activations, layer->capacity, capacity, layer->num_nodes);
+    grow_step_cache(&layer->input_cache, layer->capacity, capacity, layer->num_parents);
+    layer->capacity = capacity;
+}
+
+static const double* bayesian_forward_step(BayesianLayer* layer, const double* input, size_t step) {  // Forward one sample into cache slot step; returns the cached output
+    double* x = layer->input_cache + step * layer->num_parents;
+    double* output = layer->activations + step * layer->num_nodes;
+    memcpy(x, input, layer->num_parents * sizeof(double));            // Cache input values for backward pass gradient computation
     
+    weight_matrix_gemm(&layer->weights, x, layer->num_parents, layer->biases,  // Weighted sums of all parents plus bias, in storage precision
+                       output, layer->num_nodes, 1, layer->num_nodes, layer->num_parents);
     for (size_t i = 0; i < layer->num_nodes; i++) {                    // Iterate through each output node to compute activation
-        double sum = layer->biases[i];                                 // Initialize sum with bias term for this output node
-        for (size_t j = 0; j < layer->num_parents; j++) {             // Sum weighted contributions from all parent input nodes
-            sum += layer->weights[i * layer->num_parents + j] * input[j];  // Add product of weight and input to accumulated sum
-        }
+        double sum = output[i];                                        // Weighted sum for this output node
         
         switch (layer->activation) {                                   // Apply activation function based on layer configuration
             case ACTIVATION_SIGMOID:                                    // Use sigmoid for probability-like outputs between zero and one
@@ -120,221 +321,319 @@ void bayesian_layer_forward(BayesianLayer* layer, const double* input, double* o
             default:                                                    // Use linear activation if no specific function specified
                 output[i] = sum;                                       // Pass through weighted sum without transformation
         }
-        layer->activations[i] = output[i];                             // Cache activation value for backward pass derivative
     }
+    return output;
 }
 
-void bayesian_layer_backward(BayesianLayer* layer, const double* gradient, double* input_gradient) {  // Backward pass computing gradients for input layer from output gradients
-    memset(input_gradient, 0, layer->num_parents * sizeof(double));  // Initialize input gradient array to zero before accumulation
+void bayesian_layer_forward(BayesianLayer* layer, const double* input, double* output) {  // Forward pass through Bayesian layer computing conditional probabilities
+    const double* cached = bayesian_forward_step(layer, input, 0);    // Single samples use the first cache slot
+    memcpy(output, cached, layer->num_nodes * sizeof(double));
+}
+
+static void bayesian_backward_step(BayesianLayer* layer, size_t step, const double* gradient, double* input_gradient) {  // Accumulate parameter gradients of one cached step
+    size_t P = layer->num_parents;
+    const double* x = layer->input_cache + step * P;
+    const double* y = layer->activations + step * layer->num_nodes;
+    
+    size_t active = 0;                                                 // One-hot board inputs touch only a few weight columns
+    for (size_t j = 0; j < P; j++) {
+        if (x[j] != 0.0) layer->active_inputs[active++] = j;
+    }
     
+    if (input_gradient) memset(input_gradient, 0, P * sizeof(double));  // Initialize input gradient array to zero before accumulation
     for (size_t i = 0; i < layer->num_nodes; i++) {                    // Iterate through each output node to backpropagate gradients
-        double grad = gradient[i];                                     // Get gradient from next layer for this output node
-        
-        switch (layer->activation) {                                   // Multiply gradient by activation function derivative
-            case ACTIVATION_SIGMOID:                                    // Apply sigmoid derivative to gradient for correct chain rule
-                grad *= sigmoid_derivative(layer->activations[i]);     // Multiply by sigmoid derivative using cached activation value
-                break;
-            case ACTIVATION_TANH:                                       // Apply tanh derivative to gradient for chain rule computation
-                grad *= tanh_derivative(layer->activations[i]);        // Multiply by tanh derivative using cached activation value
-                break;
-            case ACTIVATION_RELU:                                       // Apply ReLU derivative to gradient for chain rule computation
-                grad *= relu_derivative(layer->activations[i]);       // Multiply by ReLU derivative using cached activation value
-                break;
-            default:                                                    // No derivative multiplication needed for linear activation
-                break;
-        }
-        
-        for (size_t j = 0; j < layer->num_parents; j++) {             // Propagate gradient back to each input parent node
-            input_gradient[j] += layer->weights[i * layer->num_parents + j] * grad;  // Accumulate weighted gradient contribution
+        double grad = gradient[i] * activation_derivative(layer->activation, y[i]);  // Chain rule through the activation
+        if (grad == 0.0) continue;
+        layer->bias_gradients[i] += grad;
+        double* row = layer->weight_gradients + i * P;
+        for (size_t a = 0; a < active; a++) {                          // Weight gradient is the outer product with the input
+            size_t j = layer->active_inputs[a];
+            row[j] += grad * x[j];
         }
+        if (input_gradient) weight_matrix_row_axpy(&layer->weights, i, grad, input_gradient, P);  // Propagate through the transposed weights
     }
 }
 
+void bayesian_layer_backward(BayesianLayer* layer, const double* gradient, double* input_gradient) {  // Backward pass for the last bayesian_layer_forward
+    bayesian_backward_step(layer, 0, gradient, input_gradient);
+}
+
+static void activate_in_place(ActivationType activation, double* values, size_t n) {  // Vectorized activation over a contiguous block
+    switch (activation) {
+        case ACTIVATION_SIGMOID:
+            nn_kernel_sigmoid(values, n);
+            break;
+        case ACTIVATION_TANH:
+            nn_kernel_tanh(values, n);
+            break;
+        case ACTIVATION_RELU:
+            for (size_t i = 0; i < n; i++) values[i] = relu(values[i]);
+            break;
+        default:
+            break;
+    }
+}
+
+static void bayesian_forward_rows(BayesianLayer* layer, const double* inputs, size_t input_stride,  // Batched forward over strided input rows
+                                  size_t batch_size, double* outputs) {
+    weight_matrix_gemm(&layer->weights, inputs, input_stride, layer->biases,  // [batch x parents] x [nodes x parents]^T
+                       outputs, layer->num_nodes, batch_size, layer->num_nodes, layer->num_parents);
+    activate_in_place(layer->activation, outputs, batch_size * layer->num_nodes);
+}
+
+void bayesian_layer_forward_batch(BayesianLayer* layer, const double* inputs, size_t batch_size, double* outputs) {
+    bayesian_forward_rows(layer, inputs, layer->num_parents, batch_size, outputs);
+}
+
 // LSTM Layer Implementation
 struct LSTMLayer {
     size_t input_size;
     size_t hidden_size;
     
-    // Weight matrices
-    double* Wf;  // Forget gate
-    double* Wi;  // Input gate
-    double* Wo;  // Output gate
-    double* Wc;  // Cell candidate
-    double* Uf, *Ui, *Uo, *Uc;  // Hidden state weights
-    double* bf, *bi, *bo, *bc;  // Biases
+    // Packed gate weights: rows [0,H) forget, [H,2H) input, [2H,3H) output, [3H,4H) cell candidate;
+    // each row holds the input weights followed by the recurrent weights, so all gates are one GEMV over [x; h]
+    WeightMatrix weights; // 4H x (input_size + hidden_size)
+    double* biases;      // 4H
+    double* weight_gradients;  // Same layout as weights, accumulated until applied
+    double* bias_gradients;    // 4H
+    double* owned_parameters;  // Arenas of a standalone layer; null when the network owns them
+    double* owned_gradients;
     
     // States
     double* hidden_state;
     double* cell_state;
-    double* previous_hidden;
-    double* previous_cell;
-    
-    // Caches for backward pass
-    double* input_cache;
-    double* forget_gate;
-    double* input_gate;
-    double* output_gate;
-    double* cell_candidate;
-    double* cell_state_cache;
+    
+    // Per-step caches for backpropagation through time, one row per step since the last reset
+    size_t capacity;       // Steps the caches hold
+    size_t steps;          // Steps cached
+    bool zero_start;       // Sequence started from a zero hidden state, so step 0 skips the recurrent columns
+    double* concat_input;  // [x; h_prev] fed to the gate GEMV (capacity x (input_size + hidden_size))
+    double* gates;         // Gate activations laid out like the weight rows (capacity x 4H)
+    double* cells;         // Cell state after each step (capacity x H)
+    double* initial_cell;  // Cell state the sequence started from
+    
+    // Backward workspace
+    double* gate_gradient;   // 4H gradient at the gate pre-activations
+    double* concat_gradient; // Gradient of [x; h_prev]
+    double* cell_gradient;   // Gradient carried into the previous cell state
+    double* hidden_gradient; // Gradient carried into the previous hidden state
+    
+    double* batch_gates;   // NN_BATCH_CHUNK x 4H gate workspace for batched forward
 };
 
-LSTMLayer* lstm_layer_create(size_t input_size, size_t hidden_size) {  // Create LSTM layer with specified input and hidden state dimensions
+static size_t lstm_parameter_count(size_t input_size, size_t hidden_size) {  // Packed gate weights followed by gate biases
+    return 4 * hidden_size * (input_size + hidden_size) + 4 * hidden_size;
+}
+
+static LSTMLayer* lstm_layer_build(size_t input_size, size_t hidden_size,  // Lay the layer's parameters out at the given arena slots
+                                   double* parameters, double* gradients) {
     LSTMLayer* layer = new LSTMLayer;                                  // Allocate memory for new LSTM layer structure
     layer->input_size = input_size;                                    // Set input vector dimension for this LSTM layer
     layer->hidden_size = hidden_size;                                  // Set hidden state dimension for this LSTM layer
     
-    size_t total_weights = hidden_size * (input_size + hidden_size);   // Calculate total number of weight parameters needed
-    
-    layer->Wf = new double[hidden_size * input_size];                  // Allocate weight matrix for forget gate input transformation
-    layer->Wi = new double[hidden_size * input_size];                 // Allocate weight matrix for input gate input transformation
-    layer->Wo = new double[hidden_size * input_size];                 // Allocate weight matrix for output gate input transformation
-    layer->Wc = new double[hidden_size * input_size];                 // Allocate weight matrix for cell candidate input transformation
-    layer->Uf = new double[hidden_size * hidden_size];                // Allocate weight matrix for forget gate hidden transformation
-    layer->Ui = new double[hidden_size * hidden_size];                // Allocate weight matrix for input gate hidden transformation
-    layer->Uo = new double[hidden_size * hidden_size];                // Allocate weight matrix for output gate hidden transformation
-    layer->Uc = new double[hidden_size * hidden_size];                // Allocate weight matrix for cell candidate hidden transformation
+    size_t row_size = input_size + hidden_size;                        // Each gate row sees input and previous hidden state
+    size_t total_weights = 4 * hidden_size * row_size;                 // Calculate total number of weight parameters needed
     
-    layer->bf = new double[hidden_size];                               // Allocate bias vector for forget gate computation
-    layer->bi = new double[hidden_size];                               // Allocate bias vector for input gate computation
-    layer->bo = new double[hidden_size];                               // Allocate bias vector for output gate computation
-    layer->bc = new double[hidden_size];                               // Allocate bias vector for cell candidate computation
+    weight_matrix_init(&layer->weights, 4 * hidden_size, row_size, parameters);  // Packed weight block for all four gates opens the slot
+    layer->biases = parameters + total_weights;                        // Packed bias vector for all four gates follows
+    layer->weight_gradients = gradients;                               // Gradient slot mirrors the parameter slot
+    layer->bias_gradients = gradients + total_weights;
+    layer->owned_parameters = nullptr;
+    layer->owned_gradients = nullptr;
     
     layer->hidden_state = new double[hidden_size];                     // Allocate current hidden state vector storage
     layer->cell_state = new double[hidden_size];                       // Allocate current cell state vector storage
-    layer->previous_hidden = new double[hidden_size];                  // Allocate previous hidden state for temporal memory
-    layer->previous_cell = new double[hidden_size];                    // Allocate previous cell state for temporal memory
     
-    layer->input_cache = new double[input_size];                       // Allocate cache for input values in backward pass
-    layer->forget_gate = new double[hidden_size];                      // Allocate cache for forget gate activations
-    layer->input_gate = new double[hidden_size];                       // Allocate cache for input gate activations
-    layer->output_gate = new double[hidden_size];                     // Allocate cache for output gate activations
-    layer->cell_candidate = new double[hidden_size];                   // Allocate cache for cell candidate values
-    layer->cell_state_cache = new double[hidden_size];                // Allocate cache for cell state in backward pass
+    layer->capacity = 1;                                               // Single-step passes need one cached step
+    layer->steps = 0;
+    layer->zero_start = true;
+    layer->concat_input = new double[row_size];                        // Allocate concatenated input and hidden state
+    layer->gates = new double[4 * hidden_size];                        // Allocate cache for all gate activations
+    layer->cells = new double[hidden_size];                            // Allocate cache for cell state in backward pass
+    layer->initial_cell = new double[hidden_size];
+    layer->gate_gradient = new double[4 * hidden_size];                // Allocate backward workspace once
+    layer->concat_gradient = new double[row_size];
+    layer->cell_gradient = new double[hidden_size];
+    layer->hidden_gradient = new double[hidden_size];
+    layer->batch_gates = new double[NN_BATCH_CHUNK * 4 * hidden_size]; // Allocate gate workspace for batched forward once
     
     double scale = sqrt(2.0 / (input_size + hidden_size));            // Calculate Xavier initialization scale factor
     std::uniform_real_distribution<double> init_dist(-scale, scale);   // Create uniform distribution for weight initialization
+    for (size_t i = 0; i < total_weights; i++) {                       // Initialize every gate weight with random values
+        layer->weights.f64[i] = init_dist(rng);                        // Sample random value from uniform distribution
+    }
     
-    auto init_weights = [&](double* w, size_t n) {                     // Lambda function to initialize weight array with random values
-        for (size_t i = 0; i < n; i++) {                               // Iterate through each weight in array
-            w[i] = init_dist(rng);                                     // Sample random value from uniform distribution
-        }
-    };
-    
-    init_weights(layer->Wf, hidden_size * input_size);                 // Initialize forget gate input weights with random values
-    init_weights(layer->Wi, hidden_size * input_size);                 // Initialize input gate input weights with random values
-    init_weights(layer->Wo, hidden_size * input_size);                // Initialize output gate input weights with random values
-    init_weights(layer->Wc, hidden_size * input_size);                 // Initialize cell candidate input weights with random values
-    init_weights(layer->Uf, hidden_size * hidden_size);                // Initialize forget gate hidden weights with random values
-    init_weights(layer->Ui, hidden_size * hidden_size);                // Initialize input gate hidden weights with random values
-    init_weights(layer->Uo, hidden_size * hidden_size);                // Initialize output gate hidden weights with random values
-    init_weights(layer->Uc, hidden_size * hidden_size);                // Initialize cell candidate hidden weights with random values
-    
-    memset(layer->bf, 0, hidden_size * sizeof(double));                // Initialize forget gate biases to zero
-    memset(layer->bi, 0, hidden_size * sizeof(double));                // Initialize input gate biases to zero
-    memset(layer->bo, 0, hidden_size * sizeof(double));                // Initialize output gate biases to zero
-    memset(layer->bc, 0, hidden_size * sizeof(double));                // Initialize cell candidate biases to zero
+    memset(layer->biases, 0, 4 * hidden_size * sizeof(double));        // Initialize all gate biases to zero
     
-    memset(layer->hidden_state, 0, hidden_size * sizeof(double));      // Initialize hidden state vector to zero
-    memset(layer->cell_state, 0, hidden_size * sizeof(double));        // Initialize cell state vector to zero
-    memset(layer->previous_hidden, 0, hidden_size * sizeof(double));   // Initialize previous hidden state to zero
-    memset(layer->previous_cell, 0, hidden_size * sizeof(double));     // Initialize previous cell state to zero
+    lstm_layer_reset(layer);                                           // Start from zero hidden and cell state
     
     return layer;                                                       // Return pointer to initialized LSTM layer
 }
 
+LSTMLayer* lstm_layer_create(size_t input_size, size_t hidden_size) {  // Create LSTM layer with specified input and hidden state dimensions
+    size_t count = lstm_parameter_count(input_size, hidden_size);
+    double* parameters = arena_alloc(count);
+    double* gradients = arena_alloc(count);
+    LSTMLayer* layer = lstm_layer_build(input_size, hidden_size, parameters, gradients);
+    layer->owned_parameters = parameters;                              // Standalone layers free their own arenas
+    layer->owned_gradients = gradients;
+    return layer;
+}
+
 void lstm_layer_destroy(LSTMLayer* layer) {
     if (layer) {
-        delete[] layer->Wf;
-        delete[] layer->Wi;
-        delete[] layer->Wo;
-        delete[] layer->Wc;
-        delete[] layer->Uf;
-        delete[] layer->Ui;
-        delete[] layer->Uo;
-        delete[] layer->Uc;
-        delete[] layer->bf;
-        delete[] layer->bi;
-        delete[] layer->bo;
-        delete[] layer->bc;
+        weight_matrix_free(&layer->weights);
+        arena_free(layer->owned_parameters);
+        arena_free(layer->owned_gradients);
         delete[] layer->hidden_state;
         delete[] layer->cell_state;
-        delete[] layer->previous_hidden;
-        delete[] layer->previous_cell;
-        delete[] layer->input_cache;
-        delete[] layer->forget_gate;
-        delete[] layer->input_gate;
-        delete[] layer->output_gate;
-        delete[] layer->cell_candidate;
-        delete[] layer->cell_state_cache;
+        delete[] layer->concat_input;
+        delete[] layer->gates;
+        delete[] layer->cells;
+        delete[] layer->initial_cell;
+        delete[] layer->gate_gradient;
+        delete[] layer->concat_gradient;
+        delete[] layer->cell_gradient;
+        delete[] layer->hidden_gradient;
+        delete[] layer->batch_gates;
         delete layer;
     }
 }
 
+void lstm_layer_reset(LSTMLayer* layer) {                              // Zero the recurrent state and start a new cached sequence
+    memset(layer->hidden_state, 0, layer->hidden_size * sizeof(double));
+    memset(layer->cell_state, 0, layer->hidden_size * sizeof(double));
+    layer->steps = 0;
+}
+
+static void lstm_reserve(LSTMLayer* layer, size_t steps) {             // Make room for steps cached steps, keeping those already stored
+    if (steps <= layer->capacity) return;
+    size_t H = layer->hidden_size;
+    size_t capacity = grown_capacity(layer->capacity, steps);
+    grow_step_cache(&layer->concat_input, layer->capacity, capacity, layer->input_size + H);
+    grow_step_cache(&layer->gates, layer->capacity, capacity, 4 * H);
+    grow_step_cache(&layer->cells, layer->capacity, capacity, H);
+    layer->capacity = capacity;
+}
+
 void lstm_layer_forward(LSTMLayer* layer, const double* input, double* output, double* hidden_state) {  // Forward pass through LSTM layer computing gates and updating states
-    memcpy(layer->input_cache, input, layer->input_size * sizeof(double));  // Cache input values for backward pass gradient computation
+    size_t H = layer->hidden_size;
+    size_t row_size = layer->input_size + H;
+    size_t step = layer->steps;
+    lstm_reserve(layer, step + 1);
+    double* concat = layer->concat_input + step * row_size;
+    double* gates = layer->gates + step * 4 * H;
+    double* cell = layer->cells + step * H;
+    const double* forget_gate = gates;                                 // Views into the packed gate block
+    const double* input_gate = gates + H;
+    const double* output_gate = gates + 2 * H;
+    double* cell_candidate = gates + 3 * H;
     
-    memcpy(layer->previous_hidden, hidden_state, layer->hidden_size * sizeof(double));  // Save previous hidden state before update
-    memcpy(layer->previous_cell, layer->cell_state, layer->hidden_size * sizeof(double));  // Save previous cell state before update
+    memcpy(concat, input, layer->input_size * sizeof(double));        // Gate input is [x; h_prev], cached for backward
+    memcpy(concat + layer->input_size, hidden_state, H * sizeof(double));
     
-    for (size_t i = 0; i < layer->hidden_size; i++) {                  // Iterate through each hidden state dimension
-        double f_sum = layer->bf[i];                                   // Initialize forget gate sum with bias term
-        for (size_t j = 0; j < layer->input_size; j++) {               // Add weighted input contributions to forget gate
-            f_sum += layer->Wf[i * layer->input_size + j] * input[j];  // Multiply input weight by input value and accumulate
-        }
-        for (size_t j = 0; j < layer->hidden_size; j++) {             // Add weighted hidden state contributions to forget gate
-            f_sum += layer->Uf[i * layer->hidden_size + j] * hidden_state[j];  // Multiply hidden weight by state value and accumulate
-        }
-        layer->forget_gate[i] = sigmoid(f_sum);                        // Apply sigmoid to get forget gate activation between zero and one
-        
-        double i_sum = layer->bi[i];                                   // Initialize input gate sum with bias term
-        for (size_t j = 0; j < layer->input_size; j++) {               // Add weighted input contributions to input gate
-            i_sum += layer->Wi[i * layer->input_size + j] * input[j];  // Multiply input weight by input value and accumulate
-        }
-        for (size_t j = 0; j < layer->hidden_size; j++) {             // Add weighted hidden state contributions to input gate
-            i_sum += layer->Ui[i * layer->hidden_size + j] * hidden_state[j];  // Multiply hidden weight by state value and accumulate
-        }
-        layer->input_gate[i] = sigmoid(i_sum);                        // Apply sigmoid to get input gate activation between zero and one
-        
-        double o_sum = layer->bo[i];                                   // Initialize output gate sum with bias term
-        for (size_t j = 0; j < layer->input_size; j++) {               // Add weighted input contributions to output gate
-            o_sum += layer->Wo[i * layer->input_size + j] * input[j];  // Multiply input weight by input value and accumulate
-        }
-        for (size_t j = 0; j < layer->hidden_size; j++) {            // Add weighted hidden state contributions to output gate
-            o_sum += layer->Uo[i * layer->hidden_size + j] * hidden_state[j];  // Multiply hidden weight by state value and accumulate
-        }
-        layer->output_gate[i] = sigmoid(o_sum);                        // Apply sigmoid to get output gate activation between zero and one
+    size_t K = row_size;                                               // Gate inputs that can contribute
+    bool zero_state = true;
+    for (size_t i = 0; i < H && zero_state; i++) zero_state = hidden_state[i] == 0.0;
+    if (zero_state) K = layer->input_size;                             // Recurrent columns would multiply zeros
+    if (step == 0) {
+        layer->zero_start = zero_state;
+        memcpy(layer->initial_cell, layer->cell_state, H * sizeof(double));  // Save previous cell state before update
+    }
+    if (layer->weights.precision == NN_PRECISION_FP64 && !zero_state) {  // All four gate pre-activations in one pass over the weights
+        nn_kernel_gemv(layer->weights.f64, concat, layer->biases, gates, 4 * H, K);
+    } else {
+        weight_matrix_gemm(&layer->weights, concat, row_size, layer->biases, gates, 4 * H, 1, 4 * H, K);
+    }
+    nn_kernel_sigmoid(gates, 3 * H);                                   // Forget, input and output gates squash to (0, 1)
+    nn_kernel_tanh(cell_candidate, H);                                 // Cell candidate squashes to (-1, 1)
+    
+    for (size_t i = 0; i < H; i++) {                                   // Update cell state using forget gate and previous cell
+        layer->cell_state[i] = forget_gate[i] * layer->cell_state[i] + input_gate[i] * cell_candidate[i];
+        hidden_state[i] = layer->cell_state[i];
+    }
+    memcpy(cell, layer->cell_state, H * sizeof(double));              // Cache cell state for backward pass computation
+    
+    nn_kernel_tanh(hidden_state, H);                                   // Hidden state is output gate times tanh of cell state
+    for (size_t i = 0; i < H; i++) {
+        hidden_state[i] *= output_gate[i];
+        output[i] = hidden_state[i];                                   // Copy hidden state to output vector
+    }
+    
+    memcpy(layer->hidden_state, hidden_state, H * sizeof(double));    // Save final hidden state for next forward pass
+    layer->steps = step + 1;
+}
+
+void lstm_layer_forward_batch(LSTMLayer* layer, const double* inputs, size_t batch_size, double* outputs) {  // Independent samples from zero state as one GEMM per chunk
+    size_t H = layer->hidden_size;
+    size_t I = layer->input_size;
+    for (size_t b0 = 0; b0 < batch_size; b0 += NN_BATCH_CHUNK) {
+        size_t mb = batch_size - b0 < NN_BATCH_CHUNK ? batch_size - b0 : NN_BATCH_CHUNK;
+        double* gates = layer->batch_gates;
+        double* out = outputs + b0 * H;
         
-        double c_sum = layer->bc[i];                                   // Initialize cell candidate sum with bias term
-        for (size_t j = 0; j < layer->input_size; j++) {              // Add weighted input contributions to cell candidate
-            c_sum += layer->Wc[i * layer->input_size + j] * input[j];  // Multiply input weight by input value and accumulate
+        weight_matrix_gemm(&layer->weights, inputs + b0 * I, I, layer->biases,  // Zero previous state: only input columns contribute
+                           gates, 4 * H, mb, 4 * H, I);
+        for (size_t b = 0; b < mb; b++) {
+            double* g = gates + b * 4 * H;
+            nn_kernel_sigmoid(g, 3 * H);                               // Forget, input and output gates
+            nn_kernel_tanh(g + 3 * H, H);                              // Cell candidate
+            for (size_t i = 0; i < H; i++) out[b * H + i] = g[H + i] * g[3 * H + i];  // Cell state is input gate times candidate
         }
-        for (size_t j = 0; j < layer->hidden_size; j++) {            // Add weighted hidden state contributions to cell candidate
-            c_sum += layer->Uc[i * layer->hidden_size + j] * hidden_state[j];  // Multiply hidden weight by state value and accumulate
+        nn_kernel_tanh(out, mb * H);
+        for (size_t b = 0; b < mb; b++) {
+            const double* o = gates + b * 4 * H + 2 * H;
+            for (size_t i = 0; i < H; i++) out[b * H + i] *= o[i];     // Hidden state is output gate times tanh of cell state
         }
-        layer->cell_candidate[i] = tanh_activation(c_sum);            // Apply tanh to get cell candidate value between negative one and one
-        
-        layer->cell_state[i] = layer->forget_gate[i] * layer->previous_cell[i] +   // Update cell state using forget gate and previous cell
-                              layer->input_gate[i] * layer->cell_candidate[i];      // Add input gate and cell candidate contribution
-        layer->cell_state_cache[i] = layer->cell_state[i];             // Cache cell state for backward pass computation
-        
-        hidden_state[i] = layer->output_gate[i] * tanh_activation(layer->cell_state[i]);  // Update hidden state using output gate and cell state
-        output[i] = hidden_state[i];                                   // Copy hidden state to output vector
     }
-    
-    memcpy(layer->hidden_state, hidden_state, layer->hidden_size * sizeof(double));  // Save final hidden state for next forward pass
 }
 
-void lstm_layer_backward(LSTMLayer* layer, const double* gradient, double* input_gradient) {
-    // Simplified backward pass (full implementation would be more complex)
-    // This is a placeholder - full LSTM backprop requires careful handling of gates
-    memset(input_gradient, 0, layer->input_size * sizeof(double));
+void lstm_layer_backward(LSTMLayer* layer, const double* gradient, double* input_gradient) {  // Backpropagation through time over the cached sequence
+    size_t H = layer->hidden_size;
+    size_t I = layer->input_size;
+    size_t row_size = I + H;
+    double* da = layer->gate_gradient;
+    double* dc = layer->cell_gradient;
+    double* dh = layer->hidden_gradient;
+    memset(dc, 0, H * sizeof(double));                                 // Nothing flows back from beyond the last step
+    memset(dh, 0, H * sizeof(double));
     
-    // Basic gradient propagation (simplified)
-    for (size_t i = 0; i < layer->hidden_size; i++) {
-        double grad = gradient[i] * layer->output_gate[i];
-        for (size_t j = 0; j < layer->input_size; j++) {
-            input_gradient[j] += layer->Wc[i * layer->input_size + j] * grad;
+    for (size_t t = layer->steps; t-- > 0;) {                          // Walk the sequence backwards, carrying state gradients
+        const double* gates = layer->gates + t * 4 * H;
+        const double* f = gates;
+        const double* in = gates + H;
+        const double* o = gates + 2 * H;
+        const double* g = gates + 3 * H;
+        const double* c = layer->cells + t * H;
+        const double* c_prev = t > 0 ? layer->cells + (t - 1) * H : layer->initial_cell;
+        const double* dh_out = gradient + t * H;
+        
+        for (size_t i = 0; i < H; i++) {                               // Gate pre-activation gradients from h = o tanh(c), c = f c_prev + i g
+            double tc = tanh(c[i]);
+            double dh_i = dh_out[i] + dh[i];
+            double dc_i = dc[i] + dh_i * o[i] * (1.0 - tc * tc);
+            da[i] = dc_i * c_prev[i] * f[i] * (1.0 - f[i]);
+            da[H + i] = dc_i * g[i] * in[i] * (1.0 - in[i]);
+            da[2 * H + i] = dh_i * tc * o[i] * (1.0 - o[i]);
+            da[3 * H + i] = dc_i * in[i] * (1.0 - g[i] * g[i]);
+            dc[i] = dc_i * f[i];                                       // Cell gradient reaching the previous step
         }
+        
+        bool first = t == 0;
+        size_t K = first && layer->zero_start ? I : row_size;          // A zero initial hidden state contributes no recurrent gradient
+        size_t needed = first ? (input_gradient ? I : 0) : row_size;   // The initial state is a constant, so step 0 stops at the input
+        const double* concat = layer->concat_input + t * row_size;
+        memset(layer->concat_gradient, 0, needed * sizeof(double));
+        for (size_t r = 0; r < 4 * H; r++) {
+            double grad = da[r];
+            if (grad == 0.0) continue;
+            layer->bias_gradients[r] += grad;
+            double* row = layer->weight_gradients + r * row_size;
+            for (size_t k = 0; k < K; k++) row[k] += grad * concat[k];  // Outer product with [x; h_prev]
+            if (needed) weight_matrix_row_axpy(&layer->weights, r, grad, layer->concat_gradient, needed);  // Transposed gate weights
+        }
+        if (input_gradient) memcpy(input_gradient + t * I, layer->concat_gradient, I * sizeof(double));
+        if (!first) memcpy(dh, layer->concat_gradient + I, H * sizeof(double));
     }
 }
 
@@ -343,14 +642,35 @@ struct NeuralNetwork {
     size_t input_size;
     size_t hidden_size;
     size_t output_size;
+    NNPrecision precision;            // Storage format of layer weights
     
     BayesianLayer** bayesian_layers;  // Array of pointers to Bayesian layers
     LSTMLayer** lstm_layers;         // Array of pointers to LSTM layers
     size_t num_bayesian_layers;
     size_t num_lstm_layers;
     
-    double* output;
+    double* parameters;         // Every weight and bias, layer after layer (parameter_count doubles)
+    void* mapping;              // Read-only model file the parameters point into (nn_map_model); null when they are an owned arena
+    size_t mapping_size;
+    double* gradients;          // Matching gradient of every parameter
+    size_t parameter_count;
+    
+    double* outputs;            // Outputs of the steps recorded for backward (capacity x output_size)
     double* hidden_buffer;
+    size_t capacity;            // Steps the per-step buffers hold
+    size_t steps;               // Steps recorded by the last nn_forward or nn_forward_sequence; 0 after other forwards
+    
+    // Scratch reused by every forward/backward pass so steady state never touches the heap
+    double* layer_buffer;       // Bayesian layer output feeding the LSTM (hidden_size)
+    double* hidden_gradients;   // Loss gradient at the LSTM output of each step (capacity x hidden_size)
+    double* layer_gradients;    // Loss gradient at the Bayesian output of each step (capacity x hidden_size)
+    double* batch_hidden;       // Bayesian outputs for one batch chunk (NN_BATCH_CHUNK x hidden_size)
+    double* batch_lstm;         // LSTM outputs for one batch chunk (NN_BATCH_CHUNK x hidden_size)
+    NNWorkspace* workspace;     // Mini-batch backward workspace accumulating into gradients; allocated on first use
+    double* input_columns;      // First-layer weights column-major (input_size x hidden_size) for sparse inputs; built on first use
+    bool columns_stale;         // Weights changed since input_columns was filled
+    bool columns_primary;       // Between nn_hogwild_begin and nn_hogwild_end: input_columns holds the first-layer weights
+    uint64_t weight_version;    // Bumped on every weight change so caches built from the weights can tell they are stale
 };
 
 NeuralNetwork* nn_create_hybrid(size_t input_size, size_t hidden_size, size_t output_size) {  // Create hybrid neural network combining Bayesian and LSTM layers
@@ -358,6 +678,7 @@ NeuralNetwork* nn_create_hybrid(size_t input_size, size_t hidden_size, size_t ou
     nn->input_size = input_size;                                      // Set input vector dimension for network
     nn->hidden_size = hidden_size;                                    // Set hidden layer dimension for network
     nn->output_size = output_size;                                    // Set output vector dimension for network
+    nn->precision = NN_PRECISION_FP64;                                // Weights start in double precision
     
     nn->num_bayesian_layers = 1;                                      // Set number of Bayesian layers in hybrid network
     nn->num_lstm_layers = 1;                                         // Set number of LSTM layers in hybrid network
@@ -365,11 +686,32 @@ NeuralNetwork* nn_create_hybrid(size_t input_size, size_t hidden_size, size_t ou
     nn->bayesian_layers = new BayesianLayer*[nn->num_bayesian_layers];  // Allocate array of pointers to Bayesian layers
     nn->lstm_layers = new LSTMLayer*[nn->num_lstm_layers];           // Allocate array of pointers to LSTM layers
     
-    nn->bayesian_layers[0] = bayesian_layer_create(hidden_size, input_size);  // Create first Bayesian layer transforming input to hidden
-    nn->lstm_layers[0] = lstm_layer_create(hidden_size, hidden_size);  // Create first LSTM layer processing hidden state sequences
+    size_t bayesian_count = bayesian_parameter_count(hidden_size, input_size);
+    nn->parameter_count = bayesian_count + lstm_parameter_count(hidden_size, hidden_size);
+    nn->parameters = arena_alloc(nn->parameter_count);                // One arena for all parameters and one for their gradients
+    nn->gradients = arena_alloc(nn->parameter_count);
+    nn->mapping = nullptr;                                            // Parameters start in the owned arena
+    nn->mapping_size = 0;
+    nn->bayesian_layers[0] = bayesian_layer_build(hidden_size, input_size,  // Create first Bayesian layer transforming input to hidden
+                                                  nn->parameters, nn->gradients);
+    nn->lstm_layers[0] = lstm_layer_build(hidden_size, hidden_size,   // Create first LSTM layer processing hidden state sequences
+                                          nn->parameters + bayesian_count, nn->gradients + bayesian_count);
     
-    nn->output = new double[output_size];                             // Allocate output buffer for network predictions
+    nn->capacity = 1;                                                 // Grown when a longer sequence arrives
+    nn->steps = 0;
+    nn->outputs = new double[output_size];                            // Allocate output buffer for network predictions
     nn->hidden_buffer = new double[hidden_size];                      // Allocate hidden state buffer for layer communication
+    nn->layer_buffer = new double[hidden_size];                       // Allocate workspace for intermediate layer outputs once
+    nn->hidden_gradients = new double[hidden_size];                   // Allocate gradient workspace once
+    nn->layer_gradients = new double[hidden_size];
+    nn->batch_hidden = new double[NN_BATCH_CHUNK * hidden_size];      // Allocate batched forward workspace once
+    nn->batch_lstm = new double[NN_BATCH_CHUNK * hidden_size];
+    nn->workspace = nullptr;                                          // Mini-batch training workspace is allocated when first needed
+    nn->input_columns = nullptr;                                      // Column copy is built when a sparse input first arrives
+    nn->columns_stale = false;
+    nn->columns_primary = false;
+    nn->weight_version = 0;
+    memset(nn->outputs, 0, output_size * sizeof(double));             // Backward before any forward sees a defined prediction
     
     return nn;                                                         // Return pointer to initialized hybrid neural network
 }
@@ -384,41 +726,1174 @@ void nn_destroy(NeuralNetwork* nn) {
         }
         delete[] nn->bayesian_layers;
         delete[] nn->lstm_layers;
-        delete[] nn->output;
+        if (nn->mapping) {
+            munmap(nn->mapping, nn->mapping_size);
+        } else {
+            arena_free(nn->parameters);
+        }
+        arena_free(nn->gradients);
+        delete[] nn->outputs;
         delete[] nn->hidden_buffer;
+        delete[] nn->layer_buffer;
+        delete[] nn->hidden_gradients;
+        delete[] nn->layer_gradients;
+        delete[] nn->batch_hidden;
+        delete[] nn->batch_lstm;
+        nn_workspace_destroy(nn->workspace);
+        delete[] nn->input_columns;
         delete nn;
     }
 }
 
+NeuralNetwork* nn_create_hybrid_with_precision(size_t input_size, size_t hidden_size, size_t output_size,  // Create hybrid network storing weights in the given precision
+                                               NNPrecision precision) {
+    NeuralNetwork* nn = nn_create_hybrid(input_size, hidden_size, output_size);  // Initialize in double precision so every mode draws the same weights
+    nn_set_precision(nn, precision);                                  // Round once into the requested storage format
+    return nn;
+}
+
+void nn_set_precision(NeuralNetwork* nn, NNPrecision precision) {
+    if (precision != nn->precision) nn_unmap_model(nn);                // Mapped weights are converted from a private copy
+    for (size_t i = 0; i < nn->num_bayesian_layers; i++) {
+        weight_matrix_convert(&nn->bayesian_layers[i]->weights, precision);
+    }
+    for (size_t i = 0; i < nn->num_lstm_layers; i++) {
+        weight_matrix_convert(&nn->lstm_layers[i]->weights, precision);
+    }
+    nn->precision = precision;
+    delete[] nn->input_columns;                                       // Rebuild from the rounded weights on next sparse use
+    nn->input_columns = nullptr;
+    nn->weight_version++;
+}
+
+NNPrecision nn_get_precision(const NeuralNetwork* nn) {
+    return nn->precision;
+}
+
+size_t nn_get_parameter_bytes(const NeuralNetwork* nn) {              // Resident size of weights and biases in their storage formats
+    size_t bytes = 0;
+    for (size_t i = 0; i < nn->num_bayesian_layers; i++) {
+        const BayesianLayer* layer = nn->bayesian_layers[i];
+        bytes += weight_matrix_bytes(&layer->weights) + layer->num_nodes * sizeof(double);
+    }
+    for (size_t i = 0; i < nn->num_lstm_layers; i++) {
+        const LSTMLayer* layer = nn->lstm_layers[i];
+        bytes += weight_matrix_bytes(&layer->weights) + 4 * layer->hidden_size * sizeof(double);
+    }
+    return bytes;
+}
+
+size_t nn_get_input_size(const NeuralNetwork* nn) {
+    return nn->input_size;
+}
+
+size_t nn_get_hidden_size(const NeuralNetwork* nn) {
+    return nn->hidden_size;
+}
+
+uint64_t nn_get_weight_version(const NeuralNetwork* nn) {
+    return nn->weight_version;
+}
+
+size_t nn_get_output_size(const NeuralNetwork* nn) {
+    return nn->output_size;
+}
+
+static void lstm_output_step(NeuralNetwork* nn, const double* hidden, double* output) {  // One LSTM step on a Bayesian output, continuing the current sequence
+    lstm_layer_forward(nn->lstm_layers[0], hidden, nn->hidden_buffer, nn->hidden_buffer);  // Pass through LSTM layer updating hidden state
+    
+    size_t copied = std::min(nn->hidden_size, nn->output_size);      // Hidden state fills the leading outputs
+    memcpy(output, nn->hidden_buffer, copied * sizeof(double));       // Copy hidden state to output buffer
+    memset(output + copied, 0, (nn->output_size - copied) * sizeof(double));  // Remaining outputs are defined as zero rather than left stale
+}
+
+static void start_sequence(NeuralNetwork* nn) {                       // Every forward starts from zero hidden and cell state
+    memset(nn->hidden_buffer, 0, nn->hidden_size * sizeof(double));
+    lstm_layer_reset(nn->lstm_layers[0]);
+}
+
+static void forward_from_layer_buffer(NeuralNetwork* nn, double* output) {  // LSTM and output stage of the single-sample paths that bypass the Bayesian cache
+    start_sequence(nn);
+    nn->steps = 0;                                                    // The cached first-layer input does not match, so nothing to backpropagate
+    lstm_output_step(nn, nn->layer_buffer, output);
+}
+
+static void reserve_steps(NeuralNetwork* nn, size_t steps) {          // Grow every per-step buffer to hold a sequence
+    bayesian_reserve(nn->bayesian_layers[0], steps);
+    lstm_reserve(nn->lstm_layers[0], steps);
+    if (steps <= nn->capacity) return;
+    size_t capacity = grown_capacity(nn->capacity, steps);
+    grow_step_cache(&nn->outputs, nn->capacity, capacity, nn->output_size);
+    grow_step_cache(&nn->hidden_gradients, nn->capacity, capacity, nn->hidden_size);
+    grow_step_cache(&nn->layer_gradients, nn->capacity, capacity, nn->hidden_size);
+    nn->capacity = capacity;
+}
+
+void nn_forward_sequence(NeuralNetwork* nn, const double* inputs, size_t steps, double* outputs) {  // Run a sequence through the network, caching every step for backward
+    reserve_steps(nn, steps);
+    start_sequence(nn);
+    for (size_t t = 0; t < steps; t++) {
+        const double* hidden = bayesian_forward_step(nn->bayesian_layers[0], inputs + t * nn->input_size, t);
+        double* output = nn->outputs + t * nn->output_size;
+        lstm_output_step(nn, hidden, output);
+        if (outputs && outputs != nn->outputs) memcpy(outputs + t * nn->output_size, output, nn->output_size * sizeof(double));
+    }
+    nn->steps = steps;
+}
+
 void nn_forward(NeuralNetwork* nn, const double* input, double* output) {  // Forward pass through hybrid network computing output from input
-    double* current = const_cast<double*>(input);                     // Get pointer to input for first layer processing
-    double* temp_buffer = new double[nn->hidden_size];               // Allocate temporary buffer for intermediate layer outputs
+    nn_forward_sequence(nn, input, 1, output);                        // A single sample is a sequence of one step
+}
+
+static const double* input_columns(NeuralNetwork* nn) {             // First-layer weight column of input j starts at j * hidden_size
+    if (!nn->input_columns || (nn->columns_stale && !nn->columns_primary)) {
+        BayesianLayer* layer = nn->bayesian_layers[0];
+        size_t H = layer->num_nodes;
+        if (!nn->input_columns) nn->input_columns = new double[layer->num_parents * H];
+        for (size_t i = 0; i < H; i++) {
+            for (size_t j = 0; j < layer->num_parents; j++) {
+                nn->input_columns[j * H + i] = weight_matrix_get(&layer->weights, i * layer->num_parents + j);
+            }
+        }
+        nn->columns_stale = false;
+    }
+    return nn->input_columns;
+}
+
+static void forward_from_preactivations(NeuralNetwork* nn, const double* pre, double* output) {  // Finish a forward pass from first-layer weighted sums
+    BayesianLayer* layer = nn->bayesian_layers[0];
+    for (size_t i = 0; i < layer->num_nodes; i++) {                    // Same activation as bayesian_layer_forward
+        switch (layer->activation) {
+            case ACTIVATION_SIGMOID: nn->layer_buffer[i] = sigmoid(pre[i]); break;
+            case ACTIVATION_TANH: nn->layer_buffer[i] = tanh_activation(pre[i]); break;
+            case ACTIVATION_RELU: nn->layer_buffer[i] = relu(pre[i]); break;
+            default: nn->layer_buffer[i] = pre[i];
+        }
+    }
+    forward_from_layer_buffer(nn, output);
+}
+
+void nn_forward_sparse(NeuralNetwork* nn, const uint16_t* features, size_t count, double* output) {  // First layer as a sum of the active inputs' weight columns
+    size_t H = nn->hidden_size;
+    const double* columns = input_columns(nn);
+    double* pre = nn->batch_hidden;                                   // Batch workspace is free during a single-sample pass
+    memcpy(pre, nn->bayesian_layers[0]->biases, H * sizeof(double));
+    for (size_t f = 0; f < count; f++) {
+        const double* col = columns + (size_t)features[f] * H;
+        for (size_t i = 0; i < H; i++) pre[i] += col[i];
+    }
+    forward_from_preactivations(nn, pre, output);
+}
+
+void nn_forward_batch(NeuralNetwork* nn, const double* inputs, size_t input_stride,  // Batched forward: same result as nn_forward per sample, one GEMM per layer per chunk
+                      size_t batch_size, double* outputs, size_t output_stride) {
+    size_t H = nn->hidden_size;
+    size_t copied = std::min(H, nn->output_size);                     // Hidden state fills the leading outputs
+    for (size_t b0 = 0; b0 < batch_size; b0 += NN_BATCH_CHUNK) {
+        size_t mb = batch_size - b0 < NN_BATCH_CHUNK ? batch_size - b0 : NN_BATCH_CHUNK;
+        bayesian_forward_rows(nn->bayesian_layers[0], inputs + b0 * input_stride, input_stride, mb, nn->batch_hidden);
+        lstm_layer_forward_batch(nn->lstm_layers[0], nn->batch_hidden, mb, nn->batch_lstm);
+        for (size_t b = 0; b < mb; b++) {
+            double* out = outputs + (b0 + b) * output_stride;
+            memcpy(out, nn->batch_lstm + b * H, copied * sizeof(double));
+            memset(out + copied, 0, (nn->output_size - copied) * sizeof(double));
+        }
+    }
+}
+
+static void backward_through_layers(NeuralNetwork* nn) {              // Propagate hidden_gradients through the LSTM in time, then into the Bayesian layer
+    size_t H = nn->hidden_size;
+    lstm_layer_backward(nn->lstm_layers[0], nn->hidden_gradients, nn->layer_gradients);
+    for (size_t t = 0; t < nn->steps; t++) {
+        bayesian_backward_step(nn->bayesian_layers[0], t, nn->layer_gradients + t * H, nullptr);  // Network inputs need no gradient
+    }
+}
+
+static double output_loss(NeuralNetwork* nn, size_t step, const double* target, double scale) {  // Squared error of one step; its output gradient goes to hidden_gradients
+    const double* output = nn->outputs + step * nn->output_size;
+    double* gradient = nn->hidden_gradients + step * nn->hidden_size;
+    size_t copied = std::min(nn->hidden_size, nn->output_size);      // Only the leading outputs depend on the weights
+    memset(gradient + copied, 0, (nn->hidden_size - copied) * sizeof(double));  // Hidden units past the outputs get no direct gradient
+    double loss = 0.0;
+    for (size_t i = 0; i < nn->output_size; i++) {                   // Iterate through each output dimension
+        double diff = output[i] - target[i];                          // Compute difference between prediction and target
+        loss += diff * diff;                                          // Accumulate squared difference for mean squared error
+        if (i < copied) gradient[i] = 2.0 * diff * scale;             // MSE gradient is two times difference divided by size
+    }
+    return loss;
+}
+
+void nn_backward(NeuralNetwork* nn, const double* target, double* loss) {  // Backward pass computing loss and gradients for weight updates
+    size_t H = nn->hidden_size;
+    size_t last = nn->steps > 0 ? nn->steps - 1 : 0;
+    if (nn->steps > 0) memset(nn->hidden_gradients, 0, nn->steps * H * sizeof(double));  // Earlier steps only receive gradient through time
+    *loss = output_loss(nn, last, target, 1.0 / nn->output_size) / nn->output_size;  // Mean squared error of the final step
+    if (nn->steps > 0) backward_through_layers(nn);
+}
+
+void nn_backward_sequence(NeuralNetwork* nn, const double* targets, double* loss) {  // Mean squared error over every step of the last sequence
+    size_t steps = nn->steps;
+    double scale = 1.0 / ((double)nn->output_size * (double)std::max<size_t>(steps, 1));
+    *loss = 0.0;
+    for (size_t t = 0; t < steps; t++) *loss += output_loss(nn, t, targets + t * nn->output_size, scale);
+    *loss *= scale;
+    if (steps > 0) backward_through_layers(nn);
+}
+
+// Mini-batch workspace: activations of one batch chunk and the gradient arena they backpropagate into.
+// Each data-parallel worker owns one, so workers share the network's weights but nothing they write
+struct NNWorkspace {
+    NeuralNetwork* nn;
+    double* gradients;         // Laid out like the network's gradient arena
+    bool owns_gradients;       // False for the network's own workspace, which accumulates into nn->gradients
+    float* input_f32;          // Reduced-precision activations (NN_BATCH_CHUNK x max(input, hidden))
+    double* hidden;            // Bayesian outputs (NN_BATCH_CHUNK x H)
+    double* gates;             // Gate activations (NN_BATCH_CHUNK x 4H)
+    double* cells;             // tanh of the cell states (NN_BATCH_CHUNK x H)
+    double* gate_grads;        // Gate pre-activation gradients (NN_BATCH_CHUNK x 4H) and their transpose
+    double* gate_grads_t;
+    double* grads;             // Gradient at the LSTM and then the Bayesian outputs (NN_BATCH_CHUNK x H)
+    size_t* active_columns;    // Inputs that were nonzero in some sample since the last nn_workspace_apply_sparse_sgd
+    size_t num_active;
+    uint8_t* column_active;    // Membership flags for active_columns (input_size)
+};
+
+static NNWorkspace* workspace_build(NeuralNetwork* nn, double* gradients) {
+    size_t H = nn->hidden_size;
+    NNWorkspace* ws = new NNWorkspace;
+    ws->nn = nn;
+    ws->owns_gradients = gradients == nullptr;
+    ws->gradients = gradients ? gradients : arena_alloc(nn->parameter_count);
+    ws->input_f32 = new float[NN_BATCH_CHUNK * std::max(nn->input_size, H)];
+    ws->hidden = new double[NN_BATCH_CHUNK * H];
+    ws->gates = new double[NN_BATCH_CHUNK * 4 * H];
+    ws->cells = new double[NN_BATCH_CHUNK * H];
+    ws->gate_grads = new double[NN_BATCH_CHUNK * 4 * H];
+    ws->gate_grads_t = new double[4 * H * NN_BATCH_CHUNK];
+    ws->grads = new double[NN_BATCH_CHUNK * H];
+    ws->active_columns = new size_t[nn->input_size];
+    ws->num_active = 0;
+    ws->column_active = new uint8_t[nn->input_size]();
+    return ws;
+}
+
+NNWorkspace* nn_workspace_create(NeuralNetwork* nn) {
+    return workspace_build(nn, nullptr);
+}
+
+void nn_workspace_destroy(NNWorkspace* ws) {
+    if (ws) {
+        if (ws->owns_gradients) arena_free(ws->gradients);
+        delete[] ws->input_f32;
+        delete[] ws->hidden;
+        delete[] ws->gates;
+        delete[] ws->cells;
+        delete[] ws->gate_grads;
+        delete[] ws->gate_grads_t;
+        delete[] ws->grads;
+        delete[] ws->active_columns;
+        delete[] ws->column_active;
+        delete ws;
+    }
+}
+
+double* nn_workspace_get_gradients(NNWorkspace* ws, size_t* count) {
+    if (count) *count = ws->nn->parameter_count;
+    return ws->gradients;
+}
+
+static void workspace_forward_chunk(NNWorkspace* ws, const double* x, size_t input_stride, size_t mb) {  // Hidden, gates and tanh of the cells of one chunk
+    NeuralNetwork* nn = ws->nn;
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    LSTMLayer* lstm = nn->lstm_layers[0];
+    size_t H = nn->hidden_size;
+    size_t I = lstm->input_size;
+    if (nn->columns_primary) {                                         // Sum the columns of the active inputs, as nn_forward_sparse does
+        for (size_t b = 0; b < mb; b++) {
+            const double* row = x + b * input_stride;
+            double* h = ws->hidden + b * H;
+            memcpy(h, bayes->biases, H * sizeof(double));
+            for (size_t j = 0; j < nn->input_size; j++) {
+                if (row[j] == 0.0) continue;
+                const double* col = nn->input_columns + j * H;
+                for (size_t i = 0; i < H; i++) h[i] += row[j] * col[i];
+            }
+        }
+    } else {
+        weight_matrix_gemm_scratch(&bayes->weights, ws->input_f32, x, input_stride, bayes->biases,
+                                   ws->hidden, H, mb, H, nn->input_size);
+    }
+    activate_in_place(bayes->activation, ws->hidden, mb * H);
+    weight_matrix_gemm_scratch(&lstm->weights, ws->input_f32, ws->hidden, I, lstm->biases,  // Every sample starts from zero state
+                               ws->gates, 4 * H, mb, 4 * H, I);
+    for (size_t b = 0; b < mb; b++) {
+        double* g = ws->gates + b * 4 * H;
+        nn_kernel_sigmoid(g, 3 * H);
+        nn_kernel_tanh(g + 3 * H, H);
+        for (size_t i = 0; i < H; i++) ws->cells[b * H + i] = g[H + i] * g[3 * H + i];  // Cell state is input gate times candidate
+    }
+    nn_kernel_tanh(ws->cells, mb * H);
+}
+
+void nn_workspace_forward_batch(NNWorkspace* ws, const double* inputs, size_t input_stride,  // nn_forward_batch on the workspace's own scratch
+                                size_t batch_size, double* outputs, size_t output_stride) {
+    const NeuralNetwork* nn = ws->nn;
+    size_t H = nn->hidden_size;
+    size_t copied = std::min(H, nn->output_size);                     // Hidden state fills the leading outputs
+    for (size_t b0 = 0; b0 < batch_size; b0 += NN_BATCH_CHUNK) {
+        size_t mb = batch_size - b0 < NN_BATCH_CHUNK ? batch_size - b0 : NN_BATCH_CHUNK;
+        workspace_forward_chunk(ws, inputs + b0 * input_stride, input_stride, mb);
+        for (size_t b = 0; b < mb; b++) {
+            const double* o = ws->gates + b * 4 * H + 2 * H;
+            const double* c = ws->cells + b * H;
+            double* out = outputs + (b0 + b) * output_stride;
+            for (size_t i = 0; i < copied; i++) out[i] = o[i] * c[i];  // Hidden state is output gate times tanh of cell state
+            memset(out + copied, 0, (nn->output_size - copied) * sizeof(double));
+        }
+    }
+}
+
+static double workspace_backward(NNWorkspace* ws, const double* inputs, size_t input_stride,  // Forward and backward of a mini-batch as GEMMs over [batch x features] chunks;
+                                 const double* targets, size_t target_stride, const NNSparseTargets* sparse,  // targets are dense rows or, with sparse, its rows
+                                 size_t batch_size, size_t batch_total, double* outputs, size_t output_stride) {
+    if (batch_size == 0) return 0.0;
+    NeuralNetwork* nn = ws->nn;
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    LSTMLayer* lstm = nn->lstm_layers[0];
+    size_t P = nn->input_size;
+    size_t H = nn->hidden_size;
+    size_t O = nn->output_size;
+    size_t I = lstm->input_size;
+    size_t row_size = I + H;
+    size_t copied = std::min(H, O);                                   // Hidden state fills the leading outputs
+    double scale = 2.0 / ((double)O * (double)batch_total);           // Gradient of the mean squared error over the whole mini-batch
+    double loss = 0.0;
+    double* bayes_weight_grads = ws->gradients + (bayes->weight_gradients - nn->gradients);  // Same offsets as the network's arena
+    double* bayes_bias_grads = ws->gradients + (bayes->bias_gradients - nn->gradients);
+    double* lstm_weight_grads = ws->gradients + (lstm->weight_gradients - nn->gradients);
+    double* lstm_bias_grads = ws->gradients + (lstm->bias_gradients - nn->gradients);
     
-    bayesian_layer_forward(nn->bayesian_layers[0], current, temp_buffer);  // Pass input through Bayesian layer to get hidden representation
-    current = temp_buffer;                                            // Update current pointer to Bayesian layer output
+    for (size_t b0 = 0; b0 < batch_size; b0 += NN_BATCH_CHUNK) {
+        size_t mb = batch_size - b0 < NN_BATCH_CHUNK ? batch_size - b0 : NN_BATCH_CHUNK;
+        const double* x = inputs + b0 * input_stride;
+        double* hidden = ws->hidden;
+        double* gates = ws->gates;
+        double* tc = ws->cells;
+        double* da = ws->gate_grads;
+        double* da_t = ws->gate_grads_t;
+        double* grads = ws->grads;
+        
+        workspace_forward_chunk(ws, x, input_stride, mb);             // Same forward as nn_forward_batch, keeping the intermediates
+        
+        for (size_t b = 0; b < mb; b++) {                             // Output loss and gate gradients, sample by sample
+            const double* g = gates + b * 4 * H;
+            const double* in = g + H;
+            const double* o = g + 2 * H;
+            const double* cand = g + 3 * H;
+            const double* c = tc + b * H;
+            double* dh = grads + b * H;
+            double* d = da + b * 4 * H;
+            double* out = outputs ? outputs + (b0 + b) * output_stride : nullptr;
+            if (sparse) {                                              // Zero target on the live outputs, then correct the listed entries
+                for (size_t i = 0; i < copied; i++) {
+                    double y = o[i] * c[i];
+                    loss += y * y;
+                    dh[i] = scale * y;
+                    if (out) out[i] = y;
+                }
+                for (size_t k = sparse->offsets[b0 + b]; k < sparse->offsets[b0 + b + 1]; k++) {
+                    size_t j = sparse->indices[k];
+                    double t = sparse->values[k];
+                    if (j < copied) {
+                        double y = o[j] * c[j];
+                        loss += (y - t) * (y - t) - y * y;
+                        dh[j] = scale * (y - t);
+                    } else if (j < O) {
+                        loss += t * t;                                 // Outputs past the hidden state are always zero
+                    }
+                }
+            } else {
+                const double* t = targets + (b0 + b) * target_stride;
+                for (size_t i = 0; i < O; i++) {
+                    double y = i < copied ? o[i] * c[i] : 0.0;
+                    double diff = y - t[i];
+                    loss += diff * diff;
+                    if (i < copied) dh[i] = scale * diff;
+                    if (out) out[i] = y;
+                }
+            }
+            for (size_t i = copied; i < H; i++) dh[i] = 0.0;             // Hidden units past the outputs get no gradient
+            for (size_t i = 0; i < H; i++) {                           // h = o tanh(c) with c = i g, since the previous cell is zero
+                double dc = dh[i] * o[i] * (1.0 - c[i] * c[i]);
+                d[i] = 0.0;                                            // Forget gate multiplies a zero cell state
+                d[H + i] = dc * cand[i] * in[i] * (1.0 - in[i]);
+                d[2 * H + i] = dh[i] * c[i] * o[i] * (1.0 - o[i]);
+                d[3 * H + i] = dc * in[i] * (1.0 - cand[i] * cand[i]);
+            }
+            for (size_t r = H; r < 4 * H; r++) {
+                lstm_bias_grads[r] += d[r];
+                da_t[r * mb + b] = d[r];
+            }
+        }
+        
+        nn_kernel_gemm_tn_acc(da + H, 4 * H, hidden, H,                // Gate weight gradients over the input columns; forget rows stay zero
+                              lstm_weight_grads + H * row_size, row_size, mb, 3 * H, I);
+        memset(grads, 0, mb * H * sizeof(double));                    // Gradient at the Bayesian outputs through the transposed gate weights
+        if (lstm->weights.storage) {
+            nn_kernel_gemm_tn_acc(da_t + H * mb, mb, lstm->weights.storage + H * row_size, row_size,  // Arena mirrors reduced-precision weights
+                                  grads, H, 3 * H, mb, I);
+        } else {                                                       // Mapped reduced-precision weights have no FP64 mirror
+            for (size_t b = 0; b < mb; b++) {
+                for (size_t r = H; r < 4 * H; r++) weight_matrix_row_axpy(&lstm->weights, r, da[b * 4 * H + r], grads + b * H, I);
+            }
+        }
+        for (size_t b = 0; b < mb; b++) {                             // Chain rule through the Bayesian activation
+            double* dg = grads + b * H;
+            const double* y = hidden + b * H;
+            for (size_t i = 0; i < H; i++) {
+                dg[i] *= activation_derivative(bayes->activation, y[i]);
+                bayes_bias_grads[i] += dg[i];
+            }
+        }
+        if (!nn->columns_primary) nn_kernel_gemm_tn_acc(grads, H, x, input_stride, bayes_weight_grads, P, mb, H, P);
+        
+        for (size_t b = 0; b < mb; b++) {                             // First-layer gradient columns this chunk can have touched
+            const double* row = x + b * input_stride;
+            const double* dg = grads + b * H;
+            for (size_t j = 0; j < P; j++) {
+                if (row[j] == 0.0) continue;
+                if (nn->columns_primary) {                             // Column-major gradient: one contiguous run per active input
+                    double* g = bayes_weight_grads + j * H;
+                    for (size_t i = 0; i < H; i++) g[i] += row[j] * dg[i];
+                }
+                if (!ws->column_active[j]) {
+                    ws->column_active[j] = 1;
+                    ws->active_columns[ws->num_active++] = j;
+                }
+            }
+        }
+    }
+    return loss / ((double)O * (double)batch_total);
+}
+
+double nn_workspace_backward_batch(NNWorkspace* ws, const double* inputs, size_t input_stride,
+                                   const double* targets, size_t target_stride, size_t batch_size, size_t batch_total,
+                                   double* outputs, size_t output_stride) {
+    return workspace_backward(ws, inputs, input_stride, targets, target_stride, nullptr, batch_size, batch_total, outputs, output_stride);
+}
+
+double nn_workspace_backward_batch_sparse(NNWorkspace* ws, const double* inputs, size_t input_stride,
+                                          const NNSparseTargets* targets, size_t batch_size, size_t batch_total,
+                                          double* outputs, size_t output_stride) {
+    return workspace_backward(ws, inputs, input_stride, nullptr, 0, targets, batch_size, batch_total, outputs, output_stride);
+}
+
+void nn_workspace_apply_sparse_sgd(NNWorkspace* ws, double learning_rate, double weight_decay) {  // Racing step: active first-layer columns only, no locks
+    NeuralNetwork* nn = ws->nn;
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    size_t P = nn->input_size;
+    size_t H = nn->hidden_size;
+    double* bayes_weight_grads = ws->gradients + (bayes->weight_gradients - nn->gradients);
     
-    memset(nn->hidden_buffer, 0, nn->hidden_size * sizeof(double));  // Initialize hidden state buffer to zero for LSTM processing
-    lstm_layer_forward(nn->lstm_layers[0], current, nn->hidden_buffer, nn->hidden_buffer);  // Pass through LSTM layer updating hidden state
+    if (nn->columns_primary) {                                          // Each active column is one contiguous run of H weights
+        for (size_t a = 0; a < ws->num_active; a++) {
+            size_t j = ws->active_columns[a];
+            double* w = nn->input_columns + j * H;
+            double* g = bayes_weight_grads + j * H;
+            for (size_t i = 0; i < H; i++) {
+                w[i] -= learning_rate * (g[i] + weight_decay * w[i]);
+                g[i] = 0.0;
+            }
+        }
+    } else if (bayes->weights.f64 && !nn->mapping) {                   // Mapped model weights are read-only
+        for (size_t i = 0; i < H; i++) {
+            double* w = bayes->weights.f64 + i * P;
+            double* g = bayes_weight_grads + i * P;
+            for (size_t a = 0; a < ws->num_active; a++) {
+                size_t j = ws->active_columns[a];
+                w[j] -= learning_rate * (g[j] + weight_decay * w[j]);
+                g[j] = 0.0;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < H; i++) {
+            for (size_t a = 0; a < ws->num_active; a++) bayes_weight_grads[i * P + ws->active_columns[a]] = 0.0;
+        }
+    }
+    for (size_t a = 0; a < ws->num_active; a++) ws->column_active[ws->active_columns[a]] = 0;
+    ws->num_active = 0;
+}
+
+void nn_workspace_apply_dense_sgd(NNWorkspace* ws, double learning_rate, double weight_decay) {  // Serialized step: biases and LSTM gates, which every sample writes
+    NeuralNetwork* nn = ws->nn;
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    LSTMLayer* lstm = nn->lstm_layers[0];
+    size_t H = nn->hidden_size;
+    size_t I = lstm->input_size;
+    size_t row_size = I + H;
+    double* bayes_bias_grads = ws->gradients + (bayes->bias_gradients - nn->gradients);
+    double* lstm_weight_grads = ws->gradients + (lstm->weight_gradients - nn->gradients);
+    double* lstm_bias_grads = ws->gradients + (lstm->bias_gradients - nn->gradients);
+    NNOptimizerStep step = {};
+    step.learning_rate = learning_rate;
+    step.weight_decay = weight_decay;
     
-    memcpy(output, nn->hidden_buffer, std::min(nn->hidden_size, nn->output_size) * sizeof(double));  // Copy hidden state to output buffer
+    if (nn->mapping) {                                                 // Mapped model weights are read-only
+        memset(bayes_bias_grads, 0, H * sizeof(double));
+        memset(lstm_weight_grads, 0, 4 * H * row_size * sizeof(double));
+        memset(lstm_bias_grads, 0, 4 * H * sizeof(double));
+        return;
+    }
+    nn_kernel_sgd(bayes->biases, bayes_bias_grads, nullptr, H, &step);
+    for (size_t r = H; r < 4 * H; r++) {                               // Mini-batch samples start from zero state: the forget rows
+        double* g = lstm_weight_grads + r * row_size;                  // and recurrent columns have no gradient to apply
+        if (lstm->weights.f64) {
+            nn_kernel_sgd(lstm->weights.f64 + r * row_size, g, nullptr, I, &step);
+        } else {
+            memset(g, 0, I * sizeof(double));
+        }
+    }
+    nn_kernel_sgd(lstm->biases + H, lstm_bias_grads + H, nullptr, 3 * H, &step);
+}
+
+void nn_hogwild_begin(NeuralNetwork* nn) {                            // Make the column copy the first layer's weights
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    if (nn->columns_primary || !bayes->weights.f64 || nn->mapping) return;  // Only trainable FP64 weights
+    input_columns(nn);
+    nn->columns_primary = true;
+}
+
+void nn_hogwild_end(NeuralNetwork* nn) {                              // Transpose the trained columns back into the weight rows
+    nn->weight_version++;                                             // One bump for the whole run's racing workspace steps
+    if (!nn->columns_primary) return;
+    BayesianLayer* bayes = nn->bayesian_layers[0];
+    size_t H = nn->hidden_size;
+    size_t P = nn->input_size;
+    for (size_t j = 0; j < P; j++) {
+        const double* col = nn->input_columns + j * H;
+        for (size_t i = 0; i < H; i++) bayes->weights.f64[i * P + j] = col[i];
+    }
+    nn->columns_primary = false;
+    nn->columns_stale = false;                                        // Rows and columns agree again
+}
+
+double nn_backward_batch(NeuralNetwork* nn, const double* inputs, size_t input_stride,  // Whole mini-batch on the calling thread into the network's gradients
+                         const double* targets, size_t target_stride, size_t batch_size,
+                         double* outputs, size_t output_stride) {
+    if (!nn->workspace) nn->workspace = workspace_build(nn, nn->gradients);
+    return nn_workspace_backward_batch(nn->workspace, inputs, input_stride, targets, target_stride,
+                                       batch_size, batch_size, outputs, output_stride);
+}
+
+double nn_backward_batch_sparse(NeuralNetwork* nn, const double* inputs, size_t input_stride,  // Same, reading targets as sparse rows
+                                const NNSparseTargets* targets, size_t batch_size,
+                                double* outputs, size_t output_stride) {
+    if (!nn->workspace) nn->workspace = workspace_build(nn, nn->gradients);
+    return nn_workspace_backward_batch_sparse(nn->workspace, inputs, input_stride, targets, batch_size, batch_size,
+                                              outputs, output_stride);
+}
+
+void nn_zero_gradients(NeuralNetwork* nn) {                           // Clear accumulated gradients without touching weights
+    memset(nn->gradients, 0, nn->parameter_count * sizeof(double));
+}
+
+double* nn_get_parameters(NeuralNetwork* nn, size_t* count) {     // Writable view, so a mapped network copies its weights first
+    nn_unmap_model(nn);
+    if (count) *count = nn->parameter_count;
+    nn->columns_stale = true;                                         // Caller may write through the view
+    nn->weight_version++;
+    return nn->parameters;
+}
+
+double* nn_get_gradients(NeuralNetwork* nn, size_t* count) {
+    if (count) *count = nn->parameter_count;
+    return nn->gradients;
+}
+
+size_t nn_get_parameter_count(const NeuralNetwork* nn) {
+    return nn->parameter_count;
+}
+
+// Parameters in arena order: each layer's weight matrix, then its biases
+struct ParameterSegment {
+    WeightMatrix* weights;   // Null for a bias vector
+    double** biases;         // The layer's bias pointer, for bias vectors
+    size_t count;
+};
+
+static size_t parameter_segments(const NeuralNetwork* nn, ParameterSegment* segments) {
+    size_t n = 0;
+    for (size_t i = 0; i < nn->num_bayesian_layers; i++) {
+        BayesianLayer* layer = nn->bayesian_layers[i];
+        segments[n++] = {&layer->weights, nullptr, layer->num_nodes * layer->num_parents};
+        segments[n++] = {nullptr, &layer->biases, layer->num_nodes};
+    }
+    for (size_t i = 0; i < nn->num_lstm_layers; i++) {
+        LSTMLayer* layer = nn->lstm_layers[i];
+        segments[n++] = {&layer->weights, nullptr, layer->weights.rows * layer->weights.cols};
+        segments[n++] = {nullptr, &layer->biases, 4 * layer->hidden_size};
+    }
+    return n;
+}
+
+void nn_read_parameters(const NeuralNetwork* nn, size_t first, size_t count, double* out) {  // Copy from every segment overlapping [first, first + count)
+    ParameterSegment segments[MAX_PARAMETER_BLOCKS];
+    size_t n = parameter_segments(nn, segments);
+    size_t offset = 0;
+    for (size_t s = 0; s < n && count > 0; offset += segments[s].count, s++) {
+        const ParameterSegment* segment = &segments[s];
+        if (first >= offset + segment->count) continue;
+        size_t lo = first - offset;
+        size_t take = std::min(count, segment->count - lo);
+        if (!segment->weights) {
+            memcpy(out, *segment->biases + lo, take * sizeof(double));
+        } else if (segment->weights->precision == NN_PRECISION_FP64) {
+            memcpy(out, segment->weights->f64 + lo, take * sizeof(double));
+        } else {
+            for (size_t k = 0; k < take; k++) out[k] = weight_matrix_get(segment->weights, lo + k);
+        }
+        out += take;
+        first += take;
+        count -= take;
+    }
+}
+
+// Model file: a fixed header, zero padding up to a page boundary, then the data section: each layer's
+// weights in the file's dtype followed by its FP64 biases, every segment starting on a cache line.
+// Mapping the file gives the layers their weights in place with no parsing, copying or conversion,
+// and processes mapping the same file share its page-cached copy.
+#define NN_MODEL_MAGIC "CCNNMDL"
+#define NN_MODEL_VERSION 2           // 2: weights stored in the declared dtype
+#define NN_MODEL_ALIGNMENT 4096      // Data section offset; a multiple of any page size mmap uses
+#define NN_MODEL_SEGMENT_ALIGNMENT 64
+#define NN_MODEL_BYTE_ORDER 0x01020304u
+
+struct NNModelHeader {
+    char magic[8];                   // NN_MODEL_MAGIC, NUL terminated
+    uint32_t version;
+    uint32_t header_size;            // sizeof(NNModelHeader)
+    uint32_t byte_order;             // NN_MODEL_BYTE_ORDER as stored by the writer
+    uint32_t dtype;                  // NNPrecision of the weight segments; biases are always FP64
+    uint32_t alignment;              // data_offset is a multiple of this
+    uint32_t num_layers;
+    uint64_t input_size;
+    uint64_t hidden_size;
+    uint64_t output_size;
+    uint64_t layer_shapes[2][2];     // Rows and columns of the Bayesian and LSTM weight matrices
+    uint64_t parameter_count;
+    uint64_t data_offset;
+    uint64_t data_size;              // Segments and their padding
+    uint64_t checksum;               // model_checksum of the data section, checked by nn_verify_model
+    uint64_t reserved;
+};
+static_assert(sizeof(NNModelHeader) == 128, "model header layout is part of the file format");
+
+static uint64_t model_checksum(const unsigned char* data, size_t words) {  // Four interleaved multiply-xor lanes over 64-bit words, then folded
+    uint64_t lanes[4] = {0x9E3779B97F4A7C15ull, 0xBF58476D1CE4E5B9ull, 0x94D049BB133111EBull, 0x2545F4914F6CDD1Dull};
+    for (size_t i = 0; i < words; i++) {
+        uint64_t bits;
+        memcpy(&bits, data + i * sizeof(bits), sizeof(bits));
+        uint64_t h = lanes[i & 3] ^ (bits * 0x9E3779B97F4A7C15ull);
+        lanes[i & 3] = ((h << 31) | (h >> 33)) * 0xBF58476D1CE4E5B9ull;
+    }
+    uint64_t h = words;
+    for (int l = 0; l < 4; l++) {
+        h ^= lanes[l];
+        h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27; h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+static size_t model_layout(const NeuralNetwork* nn, NNPrecision dtype, size_t* offsets) {  // Offset of each segment in the data section; returns its size
+    ParameterSegment segments[MAX_PARAMETER_BLOCKS];
+    size_t n = parameter_segments(nn, segments);
+    size_t size = 0;
+    for (size_t s = 0; s < n; s++) {
+        offsets[s] = size;
+        size_t bytes = segments[s].count * (segments[s].weights ? precision_bytes(dtype) : sizeof(double));
+        size += (bytes + NN_MODEL_SEGMENT_ALIGNMENT - 1) / NN_MODEL_SEGMENT_ALIGNMENT * NN_MODEL_SEGMENT_ALIGNMENT;
+    }
+    return size;
+}
+
+static void model_header_fill(const NeuralNetwork* nn, NNPrecision dtype, NNModelHeader* header) {  // Header for nn's shapes stored in dtype; checksum left zero
+    size_t offsets[MAX_PARAMETER_BLOCKS];
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, NN_MODEL_MAGIC, sizeof(NN_MODEL_MAGIC));
+    header->version = NN_MODEL_VERSION;
+    header->header_size = sizeof(NNModelHeader);
+    header->byte_order = NN_MODEL_BYTE_ORDER;
+    header->dtype = (uint32_t)dtype;
+    header->alignment = NN_MODEL_ALIGNMENT;
+    header->num_layers = 2;
+    header->input_size = nn->input_size;
+    header->hidden_size = nn->hidden_size;
+    header->output_size = nn->output_size;
+    header->layer_shapes[0][0] = nn->bayesian_layers[0]->weights.rows;
+    header->layer_shapes[0][1] = nn->bayesian_layers[0]->weights.cols;
+    header->layer_shapes[1][0] = nn->lstm_layers[0]->weights.rows;
+    header->layer_shapes[1][1] = nn->lstm_layers[0]->weights.cols;
+    header->parameter_count = nn->parameter_count;
+    header->data_offset = NN_MODEL_ALIGNMENT;
+    header->data_size = model_layout(nn, dtype, offsets);
+}
+
+bool nn_save_model(NeuralNetwork* nn, const char* path) {            // Write header, padding and data section to a temporary file, then rename it into place
+    NNModelHeader header;
+    model_header_fill(nn, nn->precision, &header);
+    size_t offsets[MAX_PARAMETER_BLOCKS];
+    model_layout(nn, nn->precision, offsets);
+    ParameterSegment segments[MAX_PARAMETER_BLOCKS];
+    size_t n = parameter_segments(nn, segments);
+    unsigned char* data = new unsigned char[header.data_size]();     // Segments exactly as they will be mapped, padding zeroed
+    for (size_t s = 0; s < n; s++) {
+        const WeightMatrix* w = segments[s].weights;
+        const void* source = !w ? (const void*)*segments[s].biases :
+                             w->precision == NN_PRECISION_FP32 ? (const void*)w->f32 :
+                             w->precision == NN_PRECISION_BF16 ? (const void*)w->bf16 : (const void*)w->f64;
+        memcpy(data + offsets[s], source, segments[s].count * (w ? precision_bytes(w->precision) : sizeof(double)));
+    }
+    header.checksum = model_checksum(data, header.data_size / sizeof(uint64_t));
+    size_t path_length = strlen(path);
+    char* temp_path = new char[path_length + 5];
+    memcpy(temp_path, path, path_length);
+    memcpy(temp_path + path_length, ".tmp", 5);
     
-    delete[] temp_buffer;                                             // Free temporary buffer memory
+    bool ok = false;
+    FILE* file = fopen(temp_path, "wb");
+    if (file) {
+        static const char padding[NN_MODEL_ALIGNMENT] = {};
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(padding, 1, header.data_offset - sizeof(header), file) == header.data_offset - sizeof(header) &&
+             fwrite(data, 1, header.data_size, file) == header.data_size &&
+             fflush(file) == 0 && fsync(fileno(file)) == 0;
+        ok = fclose(file) == 0 && ok;
+        ok = ok && rename(temp_path, path) == 0;                       // Readers see the old file or the new one, never a torn write
+        if (!ok) remove(temp_path);
+    }
+    delete[] temp_path;
+    delete[] data;
+    return ok;
 }
 
-void nn_backward(NeuralNetwork* nn, const double* target, double* loss) {  // Backward pass computing loss and gradients for weight updates
-    *loss = 0.0;                                                      // Initialize loss accumulator to zero
-    for (size_t i = 0; i < nn->output_size; i++) {                   // Iterate through each output dimension
-        double diff = nn->output[i] - target[i];                      // Compute difference between prediction and target
-        *loss += diff * diff;                                         // Accumulate squared difference for mean squared error
+static bool model_header_valid(const NeuralNetwork* nn, const NNModelHeader* header, size_t file_size) {
+    if (header->dtype > NN_PRECISION_BF16) return false;
+    NNModelHeader expected;
+    model_header_fill(nn, (NNPrecision)header->dtype, &expected);     // Same shapes as this network, whatever its current weights
+    return memcmp(header->magic, expected.magic, sizeof(header->magic)) == 0 &&
+           header->version == NN_MODEL_VERSION &&
+           header->header_size == sizeof(NNModelHeader) &&
+           header->byte_order == NN_MODEL_BYTE_ORDER &&
+           header->alignment == NN_MODEL_ALIGNMENT &&
+           header->num_layers == expected.num_layers &&
+           header->input_size == expected.input_size &&
+           header->hidden_size == expected.hidden_size &&
+           header->output_size == expected.output_size &&
+           memcmp(header->layer_shapes, expected.layer_shapes, sizeof(header->layer_shapes)) == 0 &&
+           header->parameter_count == expected.parameter_count &&
+           header->data_size == expected.data_size &&
+           header->data_offset % NN_MODEL_ALIGNMENT == 0 &&
+           header->data_offset >= sizeof(NNModelHeader) &&
+           header->data_offset <= file_size &&
+           file_size - header->data_offset >= header->data_size;
+}
+
+static void attach_parameters(NeuralNetwork* nn, double* parameters, bool read_only) {  // Point every layer at its slot of a new parameter arena
+    size_t offset = 0;
+    for (size_t i = 0; i < nn->num_bayesian_layers; i++) {
+        BayesianLayer* layer = nn->bayesian_layers[i];
+        layer->weights.storage = parameters + offset;
+        layer->weights.f64 = layer->weights.precision == NN_PRECISION_FP64 ? layer->weights.storage : nullptr;
+        layer->weights.read_only = read_only;
+        offset += layer->num_nodes * layer->num_parents;
+        layer->biases = parameters + offset;
+        offset += layer->num_nodes;
+    }
+    for (size_t i = 0; i < nn->num_lstm_layers; i++) {
+        LSTMLayer* layer = nn->lstm_layers[i];
+        layer->weights.storage = parameters + offset;
+        layer->weights.f64 = layer->weights.precision == NN_PRECISION_FP64 ? layer->weights.storage : nullptr;
+        layer->weights.read_only = read_only;
+        offset += layer->weights.rows * layer->weights.cols;
+        layer->biases = parameters + offset;
+        offset += 4 * layer->hidden_size;
+    }
+    nn->parameters = parameters;
+    nn->columns_stale = true;                                         // Sparse-input column copy must follow the new weights
+    nn->weight_version++;
+}
+
+bool nn_map_model(NeuralNetwork* nn, const char* path) {             // Map a model file read-only and compute straight from its pages
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(NNModelHeader)) {
+        close(fd);
+        return false;
     }
-    *loss /= nn->output_size;                                         // Divide by output size to get mean squared error
+    size_t size = (size_t)info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);                                                        // The mapping keeps the file open
+    if (mapping == MAP_FAILED) return false;
     
-    double* output_gradient = new double[nn->output_size];           // Allocate gradient buffer for output layer
-    for (size_t i = 0; i < nn->output_size; i++) {                   // Compute gradient for each output dimension
-        output_gradient[i] = 2.0 * (nn->output[i] - target[i]) / nn->output_size;  // MSE gradient is two times difference divided by size
+    const NNModelHeader* header = static_cast<const NNModelHeader*>(mapping);
+    if (!model_header_valid(nn, header, size)) {                      // Only the header page is read; data pages fault in as they are used
+        munmap(mapping, size);
+        return false;
     }
     
-    delete[] output_gradient;                                         // Free gradient buffer memory
+    NNPrecision precision = (NNPrecision)header->dtype;
+    unsigned char* data = static_cast<unsigned char*>(mapping) + header->data_offset;
+    void* old_mapping = nn->mapping;
+    size_t old_size = nn->mapping_size;
+    double* old_parameters = nn->parameters;
+    size_t offsets[MAX_PARAMETER_BLOCKS];
+    model_layout(nn, precision, offsets);
+    ParameterSegment segments[MAX_PARAMETER_BLOCKS];
+    size_t n = parameter_segments(nn, segments);
+    for (size_t s = 0; s < n; s++) {                                   // Point every layer at its segment, in the file's dtype
+        unsigned char* segment = data + offsets[s];
+        WeightMatrix* w = segments[s].weights;
+        if (!w) {
+            *segments[s].biases = reinterpret_cast<double*>(segment);
+            continue;
+        }
+        if (!w->read_only) {                                           // Reduced-precision copies of the old weights
+            delete[] w->f32;
+            delete[] w->bf16;
+        }
+        w->precision = precision;
+        w->storage = precision == NN_PRECISION_FP64 ? reinterpret_cast<double*>(segment) : nullptr;
+        w->f64 = w->storage;
+        w->f32 = precision == NN_PRECISION_FP32 ? reinterpret_cast<float*>(segment) : nullptr;
+        w->bf16 = precision == NN_PRECISION_BF16 ? reinterpret_cast<uint16_t*>(segment) : nullptr;
+        w->read_only = true;
+        if (precision != NN_PRECISION_FP64 && !w->input_f32) w->input_f32 = new float[NN_BATCH_CHUNK * w->cols];
+    }
+    nn->parameters = nullptr;                                         // No arena until something asks to write the weights
+    nn->precision = precision;
+    nn->mapping = mapping;
+    nn->mapping_size = size;
+    nn->columns_stale = true;                                         // Sparse-input column copy must follow the new weights
+    nn->weight_version++;
+    if (old_mapping) {
+        munmap(old_mapping, old_size);
+    } else {
+        arena_free(old_parameters);                                   // The private copy is no longer needed
+    }
+    return true;
+}
+
+bool nn_verify_model(const NeuralNetwork* nn) {                      // Checksum the whole mapped data section, touching every page
+    if (!nn->mapping) return false;
+    const NNModelHeader* header = static_cast<const NNModelHeader*>(nn->mapping);
+    const unsigned char* data = static_cast<const unsigned char*>(nn->mapping) + header->data_offset;
+    return model_checksum(data, header->data_size / sizeof(uint64_t)) == header->checksum;
+}
+
+void nn_unmap_model(NeuralNetwork* nn) {                            // Detach from the file: private arena and copies first, then unmap
+    if (!nn->mapping) return;
+    double* parameters = arena_alloc(nn->parameter_count);
+    nn_read_parameters(nn, 0, nn->parameter_count, parameters);       // Weights as forward passes see them, biases as stored
+    ParameterSegment segments[MAX_PARAMETER_BLOCKS];
+    size_t n = parameter_segments(nn, segments);
+    for (size_t s = 0; s < n; s++) {                                   // Reduced-precision weights keep their exact values in owned copies
+        WeightMatrix* w = segments[s].weights;
+        if (!w) continue;
+        size_t count = w->rows * w->cols;
+        if (w->f32) w->f32 = static_cast<float*>(memcpy(new float[count], w->f32, count * sizeof(float)));
+        if (w->bf16) w->bf16 = static_cast<uint16_t*>(memcpy(new uint16_t[count], w->bf16, count * sizeof(uint16_t)));
+    }
+    attach_parameters(nn, parameters, false);
+    munmap(nn->mapping, nn->mapping_size);
+    nn->mapping = nullptr;
+    nn->mapping_size = 0;
+}
+
+// Quantized Network Implementation
+// Weights are symmetric int8 with one scale per output unit; activations are asymmetric
+// 7-bit (zero point plus scale per layer) with ranges calibrated from sample inputs
+struct QuantizedLayer {
+    size_t rows;
+    size_t cols;
+    int8_t* weights;        // rows x cols
+    double* weight_scale;   // Per output unit
+    int32_t* row_sums;      // Sum of each quantized row, cancels the activation zero point
+    double* biases;
+    double input_scale;
+    int32_t input_zero;
+};
+
+struct QuantizedNetwork {
+    size_t input_size;
+    size_t hidden_size;
+    size_t output_size;
+    ActivationType bayesian_activation;
+    QuantizedLayer bayesian;    // hidden x input
+    QuantizedLayer lstm;        // 4H x hidden: gate input columns only, since every forward starts from zero state
+    NNQuantizedWorkspace* workspace;  // Scratch of the single-threaded forward paths
+};
+
+// Activations of one batch chunk; concurrent callers each own one
+struct NNQuantizedWorkspace {
+    QuantizedNetwork* qnn;
+    uint8_t* input_q;           // NN_BATCH_CHUNK x max(input, hidden) quantized activations
+    int32_t* accum;             // NN_BATCH_CHUNK x 4H integer sums
+    double* batch_hidden;       // NN_BATCH_CHUNK x hidden Bayesian outputs
+    double* batch_gates;        // NN_BATCH_CHUNK x 4H gate values
+};
+
+#define QUANT_ACTIVATION_MAX 127  // 7-bit activations: maddubs pair sums stay below int16 saturation
+
+static void quantized_layer_init(QuantizedLayer* q, const WeightMatrix* w, size_t cols,  // Quantize the leading cols of each weight row
+                                 const double* biases, double input_min, double input_max) {
+    q->rows = w->rows;
+    q->cols = cols;
+    q->weights = new int8_t[w->rows * cols];
+    q->weight_scale = new double[w->rows];
+    q->row_sums = new int32_t[w->rows];
+    q->biases = new double[w->rows];
+    memcpy(q->biases, biases, w->rows * sizeof(double));
+    
+    for (size_t r = 0; r < w->rows; r++) {
+        double max_abs = 0.0;
+        for (size_t c = 0; c < cols; c++) max_abs = std::max(max_abs, fabs(weight_matrix_get(w, r * w->cols + c)));
+        double scale = max_abs > 0.0 ? max_abs / 127.0 : 1.0;
+        int32_t sum = 0;
+        for (size_t c = 0; c < cols; c++) {
+            long v = lround(weight_matrix_get(w, r * w->cols + c) / scale);
+            v = std::max(-127L, std::min(127L, v));
+            q->weights[r * cols + c] = (int8_t)v;
+            sum += (int32_t)v;
+        }
+        q->weight_scale[r] = scale;
+        q->row_sums[r] = sum;
+    }
+    
+    input_min = std::min(input_min, 0.0);                              // Range includes zero so zero inputs quantize exactly
+    input_max = std::max(input_max, 0.0);
+    q->input_scale = input_max > input_min ? (input_max - input_min) / QUANT_ACTIVATION_MAX : 1.0;
+    q->input_zero = (int32_t)lround(-input_min / q->input_scale);
+}
+
+static void quantized_layer_free(QuantizedLayer* q) {
+    delete[] q->weights;
+    delete[] q->weight_scale;
+    delete[] q->row_sums;
+    delete[] q->biases;
+}
+
+static void quantized_layer_forward(QuantizedLayer* q, uint8_t* input_q, int32_t* accum,  // outputs = dequantized A W^T + bias for at most NN_BATCH_CHUNK rows
+                                    const double* inputs, size_t input_stride, size_t batch_size,
+                                    double* outputs, size_t output_stride) {
+    double inv_scale = 1.0 / q->input_scale;
+    for (size_t b = 0; b < batch_size; b++) {
+        const double* x = inputs + b * input_stride;
+        uint8_t* xq = input_q + b * q->cols;
+        for (size_t c = 0; c < q->cols; c++) {
+            long v = lround(x[c] * inv_scale) + q->input_zero;
+            xq[c] = (uint8_t)std::max(0L, std::min((long)QUANT_ACTIVATION_MAX, v));
+        }
+    }
+    nn_kernel_gemm_u8s8(input_q, q->cols, q->weights, q->cols, accum, q->rows, batch_size, q->rows, q->cols);
+    for (size_t b = 0; b < batch_size; b++) {
+        const int32_t* acc = accum + b * q->rows;
+        double* y = outputs + b * output_stride;
+        for (size_t r = 0; r < q->rows; r++) {
+            y[r] = q->biases[r] + q->input_scale * q->weight_scale[r] * (double)(acc[r] - q->input_zero * q->row_sums[r]);
+        }
+    }
+}
+
+QuantizedNetwork* nn_quantize(NeuralNetwork* nn, const double* calibration_inputs,  // Post-training int8 copy calibrated on sample inputs
+                              size_t input_stride, size_t num_samples) {
+    size_t H = nn->hidden_size;
+    double input_min = 0.0, input_max = 0.0;                           // Observed activation ranges entering each layer
+    double hidden_min = 0.0, hidden_max = 0.0;
+    for (size_t b0 = 0; b0 < num_samples; b0 += NN_BATCH_CHUNK) {
+        size_t mb = num_samples - b0 < NN_BATCH_CHUNK ? num_samples - b0 : NN_BATCH_CHUNK;
+        const double* inputs = calibration_inputs + b0 * input_stride;
+        for (size_t b = 0; b < mb; b++) {
+            for (size_t i = 0; i < nn->input_size; i++) {
+                input_min = std::min(input_min, inputs[b * input_stride + i]);
+                input_max = std::max(input_max, inputs[b * input_stride + i]);
+            }
+        }
+        bayesian_forward_rows(nn->bayesian_layers[0], inputs, input_stride, mb, nn->batch_hidden);
+        for (size_t i = 0; i < mb * H; i++) {
+            hidden_min = std::min(hidden_min, nn->batch_hidden[i]);
+            hidden_max = std::max(hidden_max, nn->batch_hidden[i]);
+        }
+    }
+    
+    QuantizedNetwork* qnn = new QuantizedNetwork;
+    qnn->input_size = nn->input_size;
+    qnn->hidden_size = H;
+    qnn->output_size = nn->output_size;
+    qnn->bayesian_activation = nn->bayesian_layers[0]->activation;
+    quantized_layer_init(&qnn->bayesian, &nn->bayesian_layers[0]->weights, nn->input_size,
+                         nn->bayesian_layers[0]->biases, input_min, input_max);
+    quantized_layer_init(&qnn->lstm, &nn->lstm_layers[0]->weights, H,
+                         nn->lstm_layers[0]->biases, hidden_min, hidden_max);
+    qnn->workspace = nn_quantized_workspace_create(qnn);
+    return qnn;
+}
+
+void nn_quantized_destroy(QuantizedNetwork* qnn) {
+    if (qnn) {
+        quantized_layer_free(&qnn->bayesian);
+        quantized_layer_free(&qnn->lstm);
+        nn_quantized_workspace_destroy(qnn->workspace);
+        delete qnn;
+    }
+}
+
+NNQuantizedWorkspace* nn_quantized_workspace_create(QuantizedNetwork* qnn) {
+    size_t H = qnn->hidden_size;
+    NNQuantizedWorkspace* ws = new NNQuantizedWorkspace;
+    ws->qnn = qnn;
+    ws->input_q = new uint8_t[NN_BATCH_CHUNK * std::max(qnn->input_size, H)];
+    ws->accum = new int32_t[NN_BATCH_CHUNK * 4 * H];
+    ws->batch_hidden = new double[NN_BATCH_CHUNK * H];
+    ws->batch_gates = new double[NN_BATCH_CHUNK * 4 * H];
+    return ws;
+}
+
+void nn_quantized_workspace_destroy(NNQuantizedWorkspace* ws) {
+    if (ws) {
+        delete[] ws->input_q;
+        delete[] ws->accum;
+        delete[] ws->batch_hidden;
+        delete[] ws->batch_gates;
+        delete ws;
+    }
+}
+
+void nn_quantized_forward_batch(QuantizedNetwork* qnn, const double* inputs, size_t input_stride,  // Same layout and semantics as nn_forward_batch
+                                size_t batch_size, double* outputs, size_t output_stride) {
+    nn_quantized_workspace_forward_batch(qnn->workspace, inputs, input_stride, batch_size, outputs, output_stride);
+}
+
+void nn_quantized_workspace_forward_batch(NNQuantizedWorkspace* ws, const double* inputs, size_t input_stride,
+                                          size_t batch_size, double* outputs, size_t output_stride) {
+    QuantizedNetwork* qnn = ws->qnn;
+    size_t H = qnn->hidden_size;
+    size_t copied = std::min(H, qnn->output_size);
+    for (size_t b0 = 0; b0 < batch_size; b0 += NN_BATCH_CHUNK) {
+        size_t mb = batch_size - b0 < NN_BATCH_CHUNK ? batch_size - b0 : NN_BATCH_CHUNK;
+        quantized_layer_forward(&qnn->bayesian, ws->input_q, ws->accum, inputs + b0 * input_stride, input_stride, mb,
+                                ws->batch_hidden, H);
+        activate_in_place(qnn->bayesian_activation, ws->batch_hidden, mb * H);
+        quantized_layer_forward(&qnn->lstm, ws->input_q, ws->accum, ws->batch_hidden, H, mb, ws->batch_gates, 4 * H);
+        for (size_t b = 0; b < mb; b++) {
+            double* g = ws->batch_gates + b * 4 * H;
+            double* out = outputs + (b0 + b) * output_stride;
+            nn_kernel_sigmoid(g, 3 * H);                               // Forget, input and output gates
+            nn_kernel_tanh(g + 3 * H, H);                              // Cell candidate
+            for (size_t i = 0; i < H; i++) g[3 * H + i] *= g[H + i];   // Cell state from zero previous cell
+            nn_kernel_tanh(g + 3 * H, H);
+            for (size_t i = 0; i < copied; i++) out[i] = g[2 * H + i] * g[3 * H + i];
+            memset(out + copied, 0, (qnn->output_size - copied) * sizeof(double));
+        }
+    }
+}
+
+void nn_quantized_forward(QuantizedNetwork* qnn, const double* input, double* output) {
+    nn_quantized_forward_batch(qnn, input, qnn->input_size, 1, output, qnn->output_size);
+}
+
+size_t nn_quantized_get_parameter_bytes(const QuantizedNetwork* qnn) {
+    const QuantizedLayer* layers[2] = {&qnn->bayesian, &qnn->lstm};
+    size_t bytes = 0;
+    for (const QuantizedLayer* q : layers) {
+        bytes += q->rows * q->cols * sizeof(int8_t) + q->rows * (2 * sizeof(double) + sizeof(int32_t));
+    }
+    return bytes;
+}
+
+// First-Layer Accumulator Implementation
+struct NNAccumulator {
+    NeuralNetwork* nn;
+    size_t input_size;
+    size_t hidden_size;
+    size_t depth;
+    double* biases;
+    double* stack;        // depth x hidden_size pre-activations
+};
+
+NNAccumulator* nn_accumulator_create(NeuralNetwork* nn, size_t depth) {  // Slot stack over the network's column-major first layer
+    BayesianLayer* layer = nn->bayesian_layers[0];
+    size_t H = layer->num_nodes;
+    NNAccumulator* acc = new NNAccumulator;
+    acc->nn = nn;
+    acc->input_size = layer->num_parents;
+    acc->hidden_size = H;
+    acc->depth = depth;
+    acc->biases = new double[H];
+    acc->stack = new double[depth * H];
+    memcpy(acc->biases, layer->biases, H * sizeof(double));
+    memset(acc->stack, 0, depth * H * sizeof(double));
+    return acc;
+}
+
+void nn_accumulator_destroy(NNAccumulator* acc) {
+    if (acc) {
+        delete[] acc->biases;
+        delete[] acc->stack;
+        delete acc;
+    }
+}
+
+void nn_accumulator_refresh(NNAccumulator* acc, size_t slot, const uint16_t* features, size_t count) {  // Bias plus the column of every active feature
+    size_t H = acc->hidden_size;
+    const double* columns = input_columns(acc->nn);
+    double* dst = acc->stack + slot * H;
+    memcpy(dst, acc->biases, H * sizeof(double));
+    for (size_t f = 0; f < count; f++) {
+        const double* col = columns + (size_t)features[f] * H;
+        for (size_t i = 0; i < H; i++) dst[i] += col[i];
+    }
+}
+
+void nn_accumulator_update(NNAccumulator* acc, size_t slot, size_t parent_slot,  // Child = parent - removed columns + added columns, one pass
+                           const uint16_t* removed, size_t num_removed,
+                           const uint16_t* added, size_t num_added) {
+    size_t H = acc->hidden_size;
+    const double* columns = input_columns(acc->nn);
+    const double* src = acc->stack + parent_slot * H;
+    double* dst = acc->stack + slot * H;
+    if (num_removed == 2 && num_added == 2) {                          // Castling and capture-promotions
+        const double* r0 = columns + (size_t)removed[0] * H;
+        const double* r1 = columns + (size_t)removed[1] * H;
+        const double* a0 = columns + (size_t)added[0] * H;
+        const double* a1 = columns + (size_t)added[1] * H;
+        for (size_t i = 0; i < H; i++) dst[i] = src[i] - r0[i] - r1[i] + a0[i] + a1[i];
+    } else if (num_removed == 2 && num_added == 1) {                   // Captures
+        const double* r0 = columns + (size_t)removed[0] * H;
+        const double* r1 = columns + (size_t)removed[1] * H;
+        const double* a0 = columns + (size_t)added[0] * H;
+        for (size_t i = 0; i < H; i++) dst[i] = src[i] - r0[i] - r1[i] + a0[i];
+    } else if (num_removed == 1 && num_added == 1) {                   // Quiet moves
+        const double* r0 = columns + (size_t)removed[0] * H;
+        const double* a0 = columns + (size_t)added[0] * H;
+        for (size_t i = 0; i < H; i++) dst[i] = src[i] - r0[i] + a0[i];
+    } else {
+        if (dst != src) memcpy(dst, src, H * sizeof(double));
+        for (size_t f = 0; f < num_removed; f++) {
+            const double* col = columns + (size_t)removed[f] * H;
+            for (size_t i = 0; i < H; i++) dst[i] -= col[i];
+        }
+        for (size_t f = 0; f < num_added; f++) {
+            const double* col = columns + (size_t)added[f] * H;
+            for (size_t i = 0; i < H; i++) dst[i] += col[i];
+        }
+    }
+}
+
+void nn_accumulator_forward(NNAccumulator* acc, size_t slot, double* output) {  // Activate stored pre-activations and run the rest of the network
+    forward_from_preactivations(acc->nn, acc->stack + slot * acc->hidden_size, output);
 }
 
 // Optimizer Implementation
@@ -427,13 +1902,50 @@ struct Optimizer {
     double learning_rate;
     double momentum;
     double beta1, beta2;  // For Adam
+    double rho;           // For RMSprop
     double epsilon;
-    double* momentum_buffer;
-    double* velocity_buffer;  // For Adam/Adagrad
+    double weight_decay;
+    double* momentum_buffer;  // SGD velocity or Adam first moment, one entry per parameter
+    double* velocity_buffer;  // For Adam/Adagrad/RMSprop: squared-gradient statistics
     size_t buffer_size;
     size_t step;
 };
 
+// Runs of the parameter arena with their gradients; optimizer state follows the arena order
+struct ParameterBlock {
+    double* params;     // Null when the weights are stored in reduced precision and not trained
+    double* gradients;
+    size_t count;
+};
+
+static void add_parameter_block(ParameterBlock* blocks, size_t* n, double* params, double* gradients, size_t count) {
+    ParameterBlock* last = *n > 0 ? &blocks[*n - 1] : nullptr;
+    if (last && params && last->params && last->params + last->count == params) {  // Neighbours in the arena merge into one sweep
+        last->count += count;
+        return;
+    }
+    blocks[(*n)++] = {params, gradients, count};
+}
+
+static size_t parameter_blocks(NeuralNetwork* nn, ParameterBlock* blocks) {  // Trainable runs of the arena; a fully FP64 network is one block
+    size_t n = 0;
+    bool trainable = nn->mapping == nullptr;                          // Mapped model files are read-only
+    for (size_t i = 0; i < nn->num_bayesian_layers; i++) {
+        BayesianLayer* layer = nn->bayesian_layers[i];
+        add_parameter_block(blocks, &n, trainable ? layer->weights.f64 : nullptr, layer->weight_gradients,
+                            layer->num_nodes * layer->num_parents);
+        add_parameter_block(blocks, &n, trainable ? layer->biases : nullptr, layer->bias_gradients, layer->num_nodes);
+    }
+    for (size_t i = 0; i < nn->num_lstm_layers; i++) {
+        LSTMLayer* layer = nn->lstm_layers[i];
+        add_parameter_block(blocks, &n, trainable ? layer->weights.f64 : nullptr, layer->weight_gradients,
+                            layer->weights.rows * layer->weights.cols);
+        add_parameter_block(blocks, &n, trainable ? layer->biases : nullptr, layer->bias_gradients, 4 * layer->hidden_size);
+    }
+    return n;
+}
+
+
 Optimizer* optimizer_create(OptimizerType type, double learning_rate) {  // Create optimizer with specified type and learning rate
     Optimizer* opt = new Optimizer;                                   // Allocate memory for new optimizer structure
     opt->type = type;                                                 // Set optimizer algorithm type SGD Adam Adagrad or RMSprop
@@ -441,7 +1953,9 @@ Optimizer* optimizer_create(OptimizerType type, double learning_rate) {  // Crea
     opt->momentum = 0.9;                                             // Set momentum coefficient for SGD momentum updates
     opt->beta1 = 0.9;                                                 // Set first moment decay rate for Adam optimizer
     opt->beta2 = 0.999;                                               // Set second moment decay rate for Adam optimizer
+    opt->rho = 0.9;                                                   // Set squared-gradient decay rate for RMSprop
     opt->epsilon = 1e-8;                                              // Set small epsilon value to prevent division by zero
+    opt->weight_decay = 0.0;                                          // No L2 penalty unless configured
     opt->momentum_buffer = nullptr;                                   // Initialize momentum buffer pointer to null
     opt->velocity_buffer = nullptr;                                   // Initialize velocity buffer pointer to null for Adam
     opt->buffer_size = 0;                                            // Initialize buffer size to zero not yet allocated
@@ -457,27 +1971,95 @@ void optimizer_destroy(Optimizer* opt) {
     }
 }
 
-void optimizer_update(Optimizer* opt, NeuralNetwork* nn) {
-    // Optimizer update logic (simplified placeholder)
-    // Full implementation would update all weights based on gradients
+void optimizer_set_momentum(Optimizer* opt, double momentum) {
+    opt->momentum = momentum;
+}
+
+void optimizer_set_weight_decay(Optimizer* opt, double weight_decay) {
+    opt->weight_decay = weight_decay;
+}
+
+static void optimizer_reserve(Optimizer* opt, size_t count) {          // State for count parameters, zeroed on first use or when the network changes
+    if (opt->buffer_size == count) return;
+    delete[] opt->momentum_buffer;
+    delete[] opt->velocity_buffer;
+    bool first_moment = opt->type == OPTIMIZER_ADAM || (opt->type == OPTIMIZER_SGD && opt->momentum != 0.0);
+    bool second_moment = opt->type != OPTIMIZER_SGD;
+    opt->momentum_buffer = first_moment ? new double[count]() : nullptr;
+    opt->velocity_buffer = second_moment ? new double[count]() : nullptr;
+    opt->buffer_size = count;
+    opt->step = 0;
+}
+
+void optimizer_update(Optimizer* opt, NeuralNetwork* nn) {            // Apply and clear the gradients accumulated since the last update
+    ParameterBlock blocks[MAX_PARAMETER_BLOCKS];
+    size_t num_blocks = parameter_blocks(nn, blocks);
+    size_t total = nn->parameter_count;                               // Optimizer state is laid out like the arena
+    optimizer_reserve(opt, total);
+    if (opt->type == OPTIMIZER_SGD && opt->momentum != 0.0 && !opt->momentum_buffer) {  // Momentum switched on after the first update
+        opt->momentum_buffer = new double[total]();
+    }
     opt->step++;
+    
+    NNOptimizerStep step;
+    step.learning_rate = opt->learning_rate;
+    step.weight_decay = opt->weight_decay;
+    step.momentum = opt->momentum;
+    step.beta1 = opt->beta1;
+    step.beta2 = opt->beta2;
+    step.rho = opt->rho;
+    step.epsilon = opt->epsilon;
+    step.correction1 = 1.0 - pow(opt->beta1, (double)opt->step);
+    step.correction2 = 1.0 - pow(opt->beta2, (double)opt->step);
+    
+    size_t offset = 0;
+    for (size_t b = 0; b < num_blocks; b++) {                          // Fused sweep over parameter, gradient and state; FP64 networks take one
+        ParameterBlock* block = &blocks[b];
+        if (!block->params) {                                          // Reduced-precision and mapped weights are inference copies and stay fixed
+            memset(block->gradients, 0, block->count * sizeof(double));
+        } else {
+            double* m = opt->momentum_buffer ? opt->momentum_buffer + offset : nullptr;
+            double* v = opt->velocity_buffer ? opt->velocity_buffer + offset : nullptr;
+            switch (opt->type) {
+                case OPTIMIZER_ADAM: nn_kernel_adam(block->params, block->gradients, m, v, block->count, &step); break;
+                case OPTIMIZER_ADAGRAD: nn_kernel_adagrad(block->params, block->gradients, v, block->count, &step); break;
+                case OPTIMIZER_RMSPROP: nn_kernel_rmsprop(block->params, block->gradients, v, block->count, &step); break;
+                default: nn_kernel_sgd(block->params, block->gradients, opt->momentum != 0.0 ? m : nullptr, block->count, &step); break;
+            }
+        }
+        offset += block->count;
+    }
+    nn->columns_stale = true;                                         // Sparse-input column copy must follow the new weights
+    nn->weight_version++;
+}
+
+size_t optimizer_get_state(const Optimizer* opt, const double** first_moment, const double** second_moment, size_t* step) {
+    if (first_moment) *first_moment = opt->momentum_buffer;
+    if (second_moment) *second_moment = opt->velocity_buffer;
+    if (step) *step = opt->step;
+    return opt->buffer_size;
+}
+
+void optimizer_set_state(Optimizer* opt, size_t count, const double* first_moment, const double* second_moment, size_t step) {  // Resume where a saved optimizer stopped
+    optimizer_reserve(opt, count);                                    // Buffers this rule keeps, zeroed
+    if (count > 0 && first_moment && !opt->momentum_buffer) opt->momentum_buffer = new double[count];  // e.g. SGD momentum saved after being switched on
+    if (opt->momentum_buffer) {
+        if (first_moment) memcpy(opt->momentum_buffer, first_moment, count * sizeof(double));
+        else memset(opt->momentum_buffer, 0, count * sizeof(double));
+    }
+    if (opt->velocity_buffer) {
+        if (second_moment) memcpy(opt->velocity_buffer, second_moment, count * sizeof(double));
+        else memset(opt->velocity_buffer, 0, count * sizeof(double));
+    }
+    opt->step = step;
 }
 
 void nn_train_batch(NeuralNetwork* nn, Optimizer* opt,                  // Train neural network on batch of examples for multiple epochs
                     const double* inputs, const double* targets, 
                     size_t batch_size, size_t epochs) {
     for (size_t epoch = 0; epoch < epochs; epoch++) {                  // Iterate through specified number of training epochs
-        double total_loss = 0.0;                                       // Initialize loss accumulator for epoch averaging
-        for (size_t i = 0; i < batch_size; i++) {                      // Iterate through each example in batch
-            const double* input = inputs + i * nn->input_size;         // Get pointer to input vector for current example
-            const double* target = targets + i * nn->output_size;     // Get pointer to target vector for current example
-            
-            nn_forward(nn, input, nn->output);                         // Forward pass computing network output from input
-            double loss;                                               // Variable to store computed loss value
-            nn_backward(nn, target, &loss);                            // Backward pass computing gradients and loss
-            total_loss += loss;                                        // Accumulate loss for epoch average computation
-            
-            optimizer_update(opt, nn);                                 // Update network weights using optimizer algorithm
-        }
+        nn_backward_batch(nn, inputs, nn->input_size, targets, nn->output_size,  // Gradient of the mean loss over the whole batch
+                          batch_size, nullptr, 0);
+        optimizer_update(opt, nn);                                     // One optimizer step per mini-batch
     }
 }
@@ -0,0 +1,1134 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/nn_kernels.h"
+#include <atomic>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NN_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// exp() range kept finite and normal: 2^n stays representable for n in [-1022, 1023]
+#define EXP_MAX 709.0
+#define EXP_MIN -708.0
+#define LOG2E 1.4426950408889634
+#define LN2_HI 6.93145751953125e-1      // ln 2 split so n * LN2_HI is exact
+#define LN2_LO 1.42860682030941723212e-6
+
+// GEMM cache blocking: a GEMM_NC x GEMM_KC panel of W (128 KB) stays in L2 while every sample streams past it
+#define GEMM_KC 256
+#define GEMM_KC_F32 512     // Same panel bytes for float weights
+#define GEMM_KC_I8 1024     // Half the panel bytes for int8 weights
+#define GEMM_NC 64
+
+struct KernelTable {
+    NNKernelISA isa;
+    void (*gemv)(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols);
+    void (*sigmoid)(double* x, size_t n);
+    void (*tanh)(double* x, size_t n);
+    double (*dot)(const double* a, const double* b, size_t n);
+    void (*gemm_tile)(const double* A, size_t lda, const double* W, size_t ldw,  // C[mr x nr] += A[mr x kc] W[nr x kc]^T
+                      double* C, size_t ldc, size_t kc);
+    size_t gemm_mr;      // Samples per register tile
+    size_t gemm_nr;      // Output units per register tile
+    
+    // Reduced-precision weights with float activations and fp32 accumulation (same tile shape)
+    double (*dot_f32)(const float* a, const float* b, size_t n);
+    void (*gemm_tile_f32)(const float* A, size_t lda, const float* W, size_t ldw, double* C, size_t ldc, size_t kc);
+    double (*dot_bf16)(const float* a, const uint16_t* b, size_t n);
+    void (*gemm_tile_bf16)(const float* A, size_t lda, const uint16_t* W, size_t ldw, double* C, size_t ldc, size_t kc);
+    
+    // Quantized products: unsigned 7-bit activations times signed 8-bit weights, exact int32 sums
+    int32_t (*dot_u8s8)(const uint8_t* a, const int8_t* b, size_t n);
+    void (*gemm_tile_u8s8)(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw, int32_t* C, size_t ldc, size_t kc);
+    size_t u8s8_mr;
+    size_t u8s8_nr;
+    
+    // Transposed accumulation for weight gradients: G[nr x kc] += D[M x nr]^T X[M x kc]
+    void (*gemm_tn_tile)(const double* D, size_t ldd, const double* X, size_t ldx, double* G, size_t ldg, size_t M, size_t kc);
+    size_t gemm_tn_nr;   // Rows of G per register tile
+    
+    // Fused optimizer sweeps
+    void (*sgd)(double* param, double* grad, double* velocity, size_t n, const NNOptimizerStep* step);
+    void (*adam)(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step);
+    void (*rmsprop)(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step);
+    void (*adagrad)(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step);
+};
+
+static inline float weight_value(const float* W, size_t i) { return W[i]; }
+static inline float weight_value(const uint16_t* W, size_t i) { return nn_bf16_to_float(W[i]); }
+
+// Portable kernels
+static void gemv_scalar(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; r++) {
+        const double* row = W + r * cols;
+        double sum = bias ? bias[r] : 0.0;
+        for (size_t c = 0; c < cols; c++) sum += row[c] * x[c];
+        y[r] = sum;
+    }
+}
+
+static void sigmoid_scalar(double* x, size_t n) {
+    for (size_t i = 0; i < n; i++) x[i] = 1.0 / (1.0 + exp(-x[i]));
+}
+
+static void tanh_scalar(double* x, size_t n) {
+    for (size_t i = 0; i < n; i++) x[i] = tanh(x[i]);
+}
+
+static double dot_scalar(const double* a, const double* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+static void gemm_tile_scalar(const double* A, size_t lda, const double* W, size_t ldw, double* C, size_t ldc, size_t kc) {
+    (void)lda;
+    (void)ldw;
+    (void)ldc;
+    C[0] += dot_scalar(A, W, kc);
+}
+
+template <typename WT>
+static double dot_lp_scalar(const float* a, const WT* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) sum += a[i] * weight_value(b, i);
+    return sum;
+}
+
+template <typename WT>
+static void gemm_tile_lp_scalar(const float* A, size_t lda, const WT* W, size_t ldw, double* C, size_t ldc, size_t kc) {
+    (void)lda;
+    (void)ldw;
+    (void)ldc;
+    C[0] += dot_lp_scalar(A, W, kc);
+}
+
+static int32_t dot_u8s8_scalar(const uint8_t* a, const int8_t* b, size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += (int32_t)a[i] * (int32_t)b[i];
+    return sum;
+}
+
+static void gemm_tile_u8s8_scalar(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw, int32_t* C, size_t ldc, size_t kc) {
+    (void)lda;
+    (void)ldw;
+    (void)ldc;
+    C[0] += dot_u8s8_scalar(A, W, kc);
+}
+
+static void gemm_tn_tile_scalar(const double* D, size_t ldd, const double* X, size_t ldx, double* G, size_t ldg, size_t M, size_t kc) {
+    (void)ldg;
+    for (size_t m = 0; m < M; m++) {
+        double d = D[m * ldd];
+        if (d == 0.0) continue;                                        // Gradients of inactive units are often exactly zero
+        const double* x = X + m * ldx;
+        for (size_t k = 0; k < kc; k++) G[k] += d * x[k];
+    }
+}
+
+static void sgd_scalar(double* param, double* grad, double* velocity, size_t n, const NNOptimizerStep* step) {
+    for (size_t i = 0; i < n; i++) {
+        double g = grad[i] + step->weight_decay * param[i];
+        if (velocity) g = velocity[i] = step->momentum * velocity[i] + g;
+        param[i] -= step->learning_rate * g;
+        grad[i] = 0.0;
+    }
+}
+
+static void adam_scalar(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step) {
+    for (size_t i = 0; i < n; i++) {
+        double g = grad[i] + step->weight_decay * param[i];
+        m[i] = step->beta1 * m[i] + (1.0 - step->beta1) * g;
+        v[i] = step->beta2 * v[i] + (1.0 - step->beta2) * g * g;
+        param[i] -= step->learning_rate * (m[i] / step->correction1) / (sqrt(v[i] / step->correction2) + step->epsilon);
+        grad[i] = 0.0;
+    }
+}
+
+static void rmsprop_scalar(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    for (size_t i = 0; i < n; i++) {
+        double g = grad[i] + step->weight_decay * param[i];
+        v[i] = step->rho * v[i] + (1.0 - step->rho) * g * g;
+        param[i] -= step->learning_rate * g / (sqrt(v[i]) + step->epsilon);
+        grad[i] = 0.0;
+    }
+}
+
+static void adagrad_scalar(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    for (size_t i = 0; i < n; i++) {
+        double g = grad[i] + step->weight_decay * param[i];
+        v[i] += g * g;
+        param[i] -= step->learning_rate * g / (sqrt(v[i]) + step->epsilon);
+        grad[i] = 0.0;
+    }
+}
+
+static const KernelTable scalar_kernels = {NN_ISA_SCALAR, gemv_scalar, sigmoid_scalar, tanh_scalar,
+                                           dot_scalar, gemm_tile_scalar, 1, 1,
+                                           dot_lp_scalar<float>, gemm_tile_lp_scalar<float>,
+                                           dot_lp_scalar<uint16_t>, gemm_tile_lp_scalar<uint16_t>,
+                                           dot_u8s8_scalar, gemm_tile_u8s8_scalar, 1, 1,
+                                           gemm_tn_tile_scalar, 1,
+                                           sgd_scalar, adam_scalar, rmsprop_scalar, adagrad_scalar};
+
+#ifdef NN_KERNELS_X86
+
+// AVX2 + FMA kernels (4 doubles per vector)
+__attribute__((target("avx2,fma")))
+static inline __m256d exp_avx2(__m256d x) {                            // exp via 2^n * e^r with |r| <= ln2/2 and degree-12 Taylor polynomial
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_HI), x);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_LO), r);
+
+    __m256d p = _mm256_set1_pd(1.0 / 479001600.0);                     // 1/12!
+    static const double coefficients[12] = {1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0,
+                                            1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0};
+    for (int k = 0; k < 12; k++) p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(coefficients[k]));
+
+    __m256i exponent = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));  // Build 2^n directly in the exponent field
+    exponent = _mm256_slli_epi64(_mm256_add_epi64(exponent, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d hsum4_avx2(__m256d a, __m256d b, __m256d c, __m256d d) {  // Lane k of result is the sum of the k-th argument
+    __m256d t0 = _mm256_hadd_pd(a, b);
+    __m256d t1 = _mm256_hadd_pd(c, d);
+    return _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20), _mm256_permute2f128_pd(t0, t1, 0x31));
+}
+
+__attribute__((target("avx2,fma")))
+static void gemv_avx2(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols) {  // Four rows per pass share each load of x
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const double* w0 = W + r * cols;
+        const double* w1 = w0 + cols;
+        const double* w2 = w1 + cols;
+        const double* w3 = w2 + cols;
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+        size_t c = 0;
+        for (; c + 4 <= cols; c += 4) {
+            __m256d xv = _mm256_loadu_pd(x + c);
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w0 + c), xv, acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(w1 + c), xv, acc1);
+            acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(w2 + c), xv, acc2);
+            acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(w3 + c), xv, acc3);
+        }
+        double out[4];
+        _mm256_storeu_pd(out, hsum4_avx2(acc0, acc1, acc2, acc3));      // Reduce the four accumulators into row sums
+        for (; c < cols; c++) {
+            out[0] += w0[c] * x[c];
+            out[1] += w1[c] * x[c];
+            out[2] += w2[c] * x[c];
+            out[3] += w3[c] * x[c];
+        }
+        for (int k = 0; k < 4; k++) y[r + k] = out[k] + (bias ? bias[r + k] : 0.0);
+    }
+    if (r < rows) gemv_scalar(W + r * cols, x, bias ? bias + r : nullptr, y + r, rows - r, cols);
+}
+
+__attribute__((target("avx2,fma")))
+static void sigmoid_avx2(double* x, size_t n) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d e = exp_avx2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(x + i)));
+        _mm256_storeu_pd(x + i, _mm256_div_pd(one, _mm256_add_pd(one, e)));
+    }
+    sigmoid_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+static void tanh_avx2(double* x, size_t n) {                           // tanh(x) = 1 - 2 / (e^2x + 1)
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d e = exp_avx2(_mm256_mul_pd(two, _mm256_loadu_pd(x + i)));
+        _mm256_storeu_pd(x + i, _mm256_sub_pd(one, _mm256_div_pd(two, _mm256_add_pd(e, one))));
+    }
+    tanh_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_avx2(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    if (i + 4 <= n) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        i += 4;
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void gemm_tile_avx2(const double* A, size_t lda, const double* W, size_t ldw,  // 2 samples x 4 units: 8 accumulators plus 6 operands fit the 16 ymm registers
+                           double* C, size_t ldc, size_t kc) {
+    const double* a0 = A;
+    const double* a1 = A + lda;
+    const double* w0 = W;
+    const double* w1 = W + ldw;
+    const double* w2 = W + 2 * ldw;
+    const double* w3 = W + 3 * ldw;
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(), c02 = _mm256_setzero_pd(), c03 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd(), c12 = _mm256_setzero_pd(), c13 = _mm256_setzero_pd();
+    size_t k = 0;
+    for (; k + 4 <= kc; k += 4) {
+        __m256d x0 = _mm256_loadu_pd(a0 + k);
+        __m256d x1 = _mm256_loadu_pd(a1 + k);
+        __m256d v = _mm256_loadu_pd(w0 + k);
+        c00 = _mm256_fmadd_pd(x0, v, c00);
+        c10 = _mm256_fmadd_pd(x1, v, c10);
+        v = _mm256_loadu_pd(w1 + k);
+        c01 = _mm256_fmadd_pd(x0, v, c01);
+        c11 = _mm256_fmadd_pd(x1, v, c11);
+        v = _mm256_loadu_pd(w2 + k);
+        c02 = _mm256_fmadd_pd(x0, v, c02);
+        c12 = _mm256_fmadd_pd(x1, v, c12);
+        v = _mm256_loadu_pd(w3 + k);
+        c03 = _mm256_fmadd_pd(x0, v, c03);
+        c13 = _mm256_fmadd_pd(x1, v, c13);
+    }
+    double s0[4], s1[4];
+    _mm256_storeu_pd(s0, hsum4_avx2(c00, c01, c02, c03));
+    _mm256_storeu_pd(s1, hsum4_avx2(c10, c11, c12, c13));
+    for (; k < kc; k++) {
+        s0[0] += a0[k] * w0[k]; s0[1] += a0[k] * w1[k]; s0[2] += a0[k] * w2[k]; s0[3] += a0[k] * w3[k];
+        s1[0] += a1[k] * w0[k]; s1[1] += a1[k] * w1[k]; s1[2] += a1[k] * w2[k]; s1[3] += a1[k] * w3[k];
+    }
+    _mm256_storeu_pd(C, _mm256_add_pd(_mm256_loadu_pd(C), _mm256_loadu_pd(s0)));
+    _mm256_storeu_pd(C + ldc, _mm256_add_pd(_mm256_loadu_pd(C + ldc), _mm256_loadu_pd(s1)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline float hsum_ps_avx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 load_weights_avx2(const float* p) { return _mm256_loadu_ps(p); }
+
+__attribute__((target("avx2,fma")))
+static inline __m256 load_weights_avx2(const uint16_t* p) {            // bfloat16 is the top half of a float
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p)), 16));
+}
+
+template <typename WT>
+__attribute__((target("avx2,fma")))
+static double dot_lp_avx2(const float* a, const WT* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), load_weights_avx2(b + i), acc);
+    float sum = hsum_ps_avx2(acc);
+    for (; i < n; i++) sum += a[i] * weight_value(b, i);
+    return sum;
+}
+
+template <typename WT>
+__attribute__((target("avx2,fma")))
+static void gemm_tile_lp_avx2(const float* A, size_t lda, const WT* W, size_t ldw,  // 2 samples x 4 units, 8 floats per lane
+                              double* C, size_t ldc, size_t kc) {
+    const float* a0 = A;
+    const float* a1 = A + lda;
+    const WT* w0 = W;
+    const WT* w1 = W + ldw;
+    const WT* w2 = W + 2 * ldw;
+    const WT* w3 = W + 3 * ldw;
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c02 = _mm256_setzero_ps(), c03 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps(), c12 = _mm256_setzero_ps(), c13 = _mm256_setzero_ps();
+    size_t k = 0;
+    for (; k + 8 <= kc; k += 8) {
+        __m256 x0 = _mm256_loadu_ps(a0 + k);
+        __m256 x1 = _mm256_loadu_ps(a1 + k);
+        __m256 v = load_weights_avx2(w0 + k);
+        c00 = _mm256_fmadd_ps(x0, v, c00);
+        c10 = _mm256_fmadd_ps(x1, v, c10);
+        v = load_weights_avx2(w1 + k);
+        c01 = _mm256_fmadd_ps(x0, v, c01);
+        c11 = _mm256_fmadd_ps(x1, v, c11);
+        v = load_weights_avx2(w2 + k);
+        c02 = _mm256_fmadd_ps(x0, v, c02);
+        c12 = _mm256_fmadd_ps(x1, v, c12);
+        v = load_weights_avx2(w3 + k);
+        c03 = _mm256_fmadd_ps(x0, v, c03);
+        c13 = _mm256_fmadd_ps(x1, v, c13);
+    }
+    float s0[4] = {hsum_ps_avx2(c00), hsum_ps_avx2(c01), hsum_ps_avx2(c02), hsum_ps_avx2(c03)};
+    float s1[4] = {hsum_ps_avx2(c10), hsum_ps_avx2(c11), hsum_ps_avx2(c12), hsum_ps_avx2(c13)};
+    const WT* w[4] = {w0, w1, w2, w3};
+    for (; k < kc; k++) {
+        for (int j = 0; j < 4; j++) {
+            float wv = weight_value(w[j], k);
+            s0[j] += a0[k] * wv;
+            s1[j] += a1[k] * wv;
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        C[j] += s0[j];
+        C[ldc + j] += s1[j];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline int32_t hsum_epi32_avx2(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256i madd_u8s8_avx2(__m256i a, __m256i w, __m256i acc) {  // 7-bit activations keep maddubs pair sums below int16 saturation
+    __m256i pairs = _mm256_maddubs_epi16(a, w);
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+}
+
+__attribute__((target("avx2,fma")))
+static int32_t dot_u8s8_avx2(const uint8_t* a, const int8_t* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc = madd_u8s8_avx2(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)), acc);
+    }
+    int32_t sum = hsum_epi32_avx2(acc);
+    for (; i < n; i++) sum += (int32_t)a[i] * (int32_t)b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void gemm_tile_u8s8_avx2(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw,  // 2 samples x 4 units, 32 bytes per step
+                                int32_t* C, size_t ldc, size_t kc) {
+    const uint8_t* a0 = A;
+    const uint8_t* a1 = A + lda;
+    const int8_t* w[4] = {W, W + ldw, W + 2 * ldw, W + 3 * ldw};
+    __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256(), c02 = _mm256_setzero_si256(), c03 = _mm256_setzero_si256();
+    __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256(), c12 = _mm256_setzero_si256(), c13 = _mm256_setzero_si256();
+    size_t k = 0;
+    for (; k + 32 <= kc; k += 32) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i*)(a0 + k));
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)(a1 + k));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(w[0] + k));
+        c00 = madd_u8s8_avx2(x0, v, c00);
+        c10 = madd_u8s8_avx2(x1, v, c10);
+        v = _mm256_loadu_si256((const __m256i*)(w[1] + k));
+        c01 = madd_u8s8_avx2(x0, v, c01);
+        c11 = madd_u8s8_avx2(x1, v, c11);
+        v = _mm256_loadu_si256((const __m256i*)(w[2] + k));
+        c02 = madd_u8s8_avx2(x0, v, c02);
+        c12 = madd_u8s8_avx2(x1, v, c12);
+        v = _mm256_loadu_si256((const __m256i*)(w[3] + k));
+        c03 = madd_u8s8_avx2(x0, v, c03);
+        c13 = madd_u8s8_avx2(x1, v, c13);
+    }
+    int32_t s0[4] = {hsum_epi32_avx2(c00), hsum_epi32_avx2(c01), hsum_epi32_avx2(c02), hsum_epi32_avx2(c03)};
+    int32_t s1[4] = {hsum_epi32_avx2(c10), hsum_epi32_avx2(c11), hsum_epi32_avx2(c12), hsum_epi32_avx2(c13)};
+    for (; k < kc; k++) {
+        for (int j = 0; j < 4; j++) {
+            s0[j] += (int32_t)a0[k] * (int32_t)w[j][k];
+            s1[j] += (int32_t)a1[k] * (int32_t)w[j][k];
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        C[j] += s0[j];
+        C[ldc + j] += s1[j];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void gemm_tn_tile_avx2(const double* D, size_t ldd, const double* X, size_t ldx,  // 4 rows x 8 columns: 8 accumulators plus 2 operands and a broadcast
+                              double* G, size_t ldg, size_t M, size_t kc) {
+    size_t k = 0;
+    for (; k + 8 <= kc; k += 8) {
+        __m256d c[4][2];
+        for (int j = 0; j < 4; j++) c[j][0] = c[j][1] = _mm256_setzero_pd();
+        for (size_t m = 0; m < M; m++) {
+            const double* x = X + m * ldx + k;
+            const double* d = D + m * ldd;
+            __m256d x0 = _mm256_loadu_pd(x);
+            __m256d x1 = _mm256_loadu_pd(x + 4);
+            for (int j = 0; j < 4; j++) {
+                __m256d dj = _mm256_broadcast_sd(d + j);
+                c[j][0] = _mm256_fmadd_pd(dj, x0, c[j][0]);
+                c[j][1] = _mm256_fmadd_pd(dj, x1, c[j][1]);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            double* g = G + j * ldg + k;
+            _mm256_storeu_pd(g, _mm256_add_pd(_mm256_loadu_pd(g), c[j][0]));
+            _mm256_storeu_pd(g + 4, _mm256_add_pd(_mm256_loadu_pd(g + 4), c[j][1]));
+        }
+    }
+    if (k < kc) {
+        for (int j = 0; j < 4; j++) gemm_tn_tile_scalar(D + j, ldd, X + k, ldx, G + j * ldg + k, ldg, M, kc - k);
+    }
+}
+
+// Optimizer sweeps: every element is independent, so four lanes update four parameters
+__attribute__((target("avx2,fma")))
+static void sgd_avx2(double* param, double* grad, double* velocity, size_t n, const NNOptimizerStep* step) {
+    const __m256d lr = _mm256_set1_pd(step->learning_rate);
+    const __m256d decay = _mm256_set1_pd(step->weight_decay);
+    const __m256d mu = _mm256_set1_pd(step->momentum);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d p = _mm256_loadu_pd(param + i);
+        __m256d g = _mm256_fmadd_pd(decay, p, _mm256_loadu_pd(grad + i));
+        if (velocity) {
+            g = _mm256_fmadd_pd(mu, _mm256_loadu_pd(velocity + i), g);
+            _mm256_storeu_pd(velocity + i, g);
+        }
+        _mm256_storeu_pd(param + i, _mm256_fnmadd_pd(lr, g, p));
+        _mm256_storeu_pd(grad + i, _mm256_setzero_pd());
+    }
+    sgd_scalar(param + i, grad + i, velocity ? velocity + i : nullptr, n - i, step);
+}
+
+__attribute__((target("avx2,fma")))
+static void adam_avx2(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m256d lr = _mm256_set1_pd(step->learning_rate / step->correction1);
+    const __m256d decay = _mm256_set1_pd(step->weight_decay);
+    const __m256d b1 = _mm256_set1_pd(step->beta1);
+    const __m256d b1c = _mm256_set1_pd(1.0 - step->beta1);
+    const __m256d b2 = _mm256_set1_pd(step->beta2);
+    const __m256d b2c = _mm256_set1_pd(1.0 - step->beta2);
+    const __m256d c2 = _mm256_set1_pd(1.0 / step->correction2);
+    const __m256d eps = _mm256_set1_pd(step->epsilon);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d p = _mm256_loadu_pd(param + i);
+        __m256d g = _mm256_fmadd_pd(decay, p, _mm256_loadu_pd(grad + i));
+        __m256d mi = _mm256_fmadd_pd(b1, _mm256_loadu_pd(m + i), _mm256_mul_pd(b1c, g));
+        __m256d vi = _mm256_fmadd_pd(b2, _mm256_loadu_pd(v + i), _mm256_mul_pd(b2c, _mm256_mul_pd(g, g)));
+        __m256d denom = _mm256_add_pd(_mm256_sqrt_pd(_mm256_mul_pd(vi, c2)), eps);
+        _mm256_storeu_pd(m + i, mi);
+        _mm256_storeu_pd(v + i, vi);
+        _mm256_storeu_pd(param + i, _mm256_fnmadd_pd(lr, _mm256_div_pd(mi, denom), p));
+        _mm256_storeu_pd(grad + i, _mm256_setzero_pd());
+    }
+    adam_scalar(param + i, grad + i, m + i, v + i, n - i, step);
+}
+
+__attribute__((target("avx2,fma")))
+static void rmsprop_avx2(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m256d lr = _mm256_set1_pd(step->learning_rate);
+    const __m256d decay = _mm256_set1_pd(step->weight_decay);
+    const __m256d rho = _mm256_set1_pd(step->rho);
+    const __m256d rhoc = _mm256_set1_pd(1.0 - step->rho);
+    const __m256d eps = _mm256_set1_pd(step->epsilon);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d p = _mm256_loadu_pd(param + i);
+        __m256d g = _mm256_fmadd_pd(decay, p, _mm256_loadu_pd(grad + i));
+        __m256d vi = _mm256_fmadd_pd(rho, _mm256_loadu_pd(v + i), _mm256_mul_pd(rhoc, _mm256_mul_pd(g, g)));
+        _mm256_storeu_pd(v + i, vi);
+        _mm256_storeu_pd(param + i, _mm256_fnmadd_pd(lr, _mm256_div_pd(g, _mm256_add_pd(_mm256_sqrt_pd(vi), eps)), p));
+        _mm256_storeu_pd(grad + i, _mm256_setzero_pd());
+    }
+    rmsprop_scalar(param + i, grad + i, v + i, n - i, step);
+}
+
+__attribute__((target("avx2,fma")))
+static void adagrad_avx2(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m256d lr = _mm256_set1_pd(step->learning_rate);
+    const __m256d decay = _mm256_set1_pd(step->weight_decay);
+    const __m256d eps = _mm256_set1_pd(step->epsilon);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d p = _mm256_loadu_pd(param + i);
+        __m256d g = _mm256_fmadd_pd(decay, p, _mm256_loadu_pd(grad + i));
+        __m256d vi = _mm256_fmadd_pd(g, g, _mm256_loadu_pd(v + i));
+        _mm256_storeu_pd(v + i, vi);
+        _mm256_storeu_pd(param + i, _mm256_fnmadd_pd(lr, _mm256_div_pd(g, _mm256_add_pd(_mm256_sqrt_pd(vi), eps)), p));
+        _mm256_storeu_pd(grad + i, _mm256_setzero_pd());
+    }
+    adagrad_scalar(param + i, grad + i, v + i, n - i, step);
+}
+
+static const KernelTable avx2_kernels = {NN_ISA_AVX2, gemv_avx2, sigmoid_avx2, tanh_avx2,
+                                         dot_avx2, gemm_tile_avx2, 2, 4,
+                                         dot_lp_avx2<float>, gemm_tile_lp_avx2<float>,
+                                         dot_lp_avx2<uint16_t>, gemm_tile_lp_avx2<uint16_t>,
+                                         dot_u8s8_avx2, gemm_tile_u8s8_avx2, 2, 4,
+                                         gemm_tn_tile_avx2, 4,
+                                         sgd_avx2, adam_avx2, rmsprop_avx2, adagrad_avx2};
+
+// AVX-512F kernels (8 doubles per vector, masked tails)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"  // GCC trips over the intrinsics' internal undefined-vector operands
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+static inline __m512d exp_avx512(__m512d x) {
+    x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(EXP_MIN)), _mm512_set1_pd(EXP_MAX));
+    __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_HI), x);
+    r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_LO), r);
+
+    __m512d p = _mm512_set1_pd(1.0 / 479001600.0);
+    static const double coefficients[12] = {1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0,
+                                            1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0};
+    for (int k = 0; k < 12; k++) p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(coefficients[k]));
+    return _mm512_scalef_pd(p, n);                                     // p * 2^n
+}
+
+__attribute__((target("avx512f")))
+static void gemv_avx512(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols) {
+    size_t tail = cols & 7;
+    __mmask8 tail_mask = (__mmask8)((1u << tail) - 1);
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const double* w0 = W + r * cols;
+        const double* w1 = w0 + cols;
+        const double* w2 = w1 + cols;
+        const double* w3 = w2 + cols;
+        __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+        size_t c = 0;
+        for (; c + 8 <= cols; c += 8) {
+            __m512d xv = _mm512_loadu_pd(x + c);
+            acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(w0 + c), xv, acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(w1 + c), xv, acc1);
+            acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(w2 + c), xv, acc2);
+            acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(w3 + c), xv, acc3);
+        }
+        if (tail) {
+            __m512d xv = _mm512_maskz_loadu_pd(tail_mask, x + c);
+            acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail_mask, w0 + c), xv, acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail_mask, w1 + c), xv, acc1);
+            acc2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail_mask, w2 + c), xv, acc2);
+            acc3 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail_mask, w3 + c), xv, acc3);
+        }
+        y[r] = _mm512_reduce_add_pd(acc0) + (bias ? bias[r] : 0.0);
+        y[r + 1] = _mm512_reduce_add_pd(acc1) + (bias ? bias[r + 1] : 0.0);
+        y[r + 2] = _mm512_reduce_add_pd(acc2) + (bias ? bias[r + 2] : 0.0);
+        y[r + 3] = _mm512_reduce_add_pd(acc3) + (bias ? bias[r + 3] : 0.0);
+    }
+    for (; r < rows; r++) {
+        const double* w = W + r * cols;
+        __m512d acc = _mm512_setzero_pd();
+        size_t c = 0;
+        for (; c + 8 <= cols; c += 8) acc = _mm512_fmadd_pd(_mm512_loadu_pd(w + c), _mm512_loadu_pd(x + c), acc);
+        if (tail) acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail_mask, w + c), _mm512_maskz_loadu_pd(tail_mask, x + c), acc);
+        y[r] = _mm512_reduce_add_pd(acc) + (bias ? bias[r] : 0.0);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void sigmoid_avx512(double* x, size_t n) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d e = exp_avx512(_mm512_sub_pd(_mm512_setzero_pd(), _mm512_maskz_loadu_pd(mask, x + i)));
+        _mm512_mask_storeu_pd(x + i, mask, _mm512_div_pd(one, _mm512_add_pd(one, e)));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void tanh_avx512(double* x, size_t n) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d two = _mm512_set1_pd(2.0);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d e = exp_avx512(_mm512_mul_pd(two, _mm512_maskz_loadu_pd(mask, x + i)));
+        _mm512_mask_storeu_pd(x + i, mask, _mm512_sub_pd(one, _mm512_div_pd(two, _mm512_add_pd(e, one))));
+    }
+}
+
+__attribute__((target("avx512f")))
+static double dot_avx512(const double* a, const double* b, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc);
+    if (i < n) {
+        __mmask8 mask = (__mmask8)((1u << (n - i)) - 1);
+        acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i), acc);
+    }
+    return _mm512_reduce_add_pd(acc);
+}
+
+__attribute__((target("avx512f")))
+static inline void tile_step_avx512(__m512d x0, __m512d x1, __m512d x2, __m512d x3, __m512d w, __m512d& c0, __m512d& c1,
+                                    __m512d& c2, __m512d& c3) {        // One weight vector against four sample vectors
+    c0 = _mm512_fmadd_pd(x0, w, c0);
+    c1 = _mm512_fmadd_pd(x1, w, c1);
+    c2 = _mm512_fmadd_pd(x2, w, c2);
+    c3 = _mm512_fmadd_pd(x3, w, c3);
+}
+
+__attribute__((target("avx512f")))
+static void gemm_tile_avx512(const double* A, size_t lda, const double* W, size_t ldw,  // 4 samples x 4 units: 16 accumulators plus 5 operands of the 32 zmm registers
+                             double* C, size_t ldc, size_t kc) {
+    const double* a0 = A;
+    const double* a1 = A + lda;
+    const double* a2 = A + 2 * lda;
+    const double* a3 = A + 3 * lda;
+    const double* w0 = W;
+    const double* w1 = W + ldw;
+    const double* w2 = W + 2 * ldw;
+    const double* w3 = W + 3 * ldw;
+    __m512d c00 = _mm512_setzero_pd(), c10 = _mm512_setzero_pd(), c20 = _mm512_setzero_pd(), c30 = _mm512_setzero_pd();
+    __m512d c01 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c02 = _mm512_setzero_pd(), c12 = _mm512_setzero_pd(), c22 = _mm512_setzero_pd(), c32 = _mm512_setzero_pd();
+    __m512d c03 = _mm512_setzero_pd(), c13 = _mm512_setzero_pd(), c23 = _mm512_setzero_pd(), c33 = _mm512_setzero_pd();
+    size_t k = 0;
+    for (; k + 8 <= kc; k += 8) {
+        __m512d x0 = _mm512_loadu_pd(a0 + k), x1 = _mm512_loadu_pd(a1 + k);
+        __m512d x2 = _mm512_loadu_pd(a2 + k), x3 = _mm512_loadu_pd(a3 + k);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_loadu_pd(w0 + k), c00, c10, c20, c30);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_loadu_pd(w1 + k), c01, c11, c21, c31);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_loadu_pd(w2 + k), c02, c12, c22, c32);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_loadu_pd(w3 + k), c03, c13, c23, c33);
+    }
+    if (k < kc) {                                                      // Masked tail contributes zeros past kc
+        __mmask8 mask = (__mmask8)((1u << (kc - k)) - 1);
+        __m512d x0 = _mm512_maskz_loadu_pd(mask, a0 + k), x1 = _mm512_maskz_loadu_pd(mask, a1 + k);
+        __m512d x2 = _mm512_maskz_loadu_pd(mask, a2 + k), x3 = _mm512_maskz_loadu_pd(mask, a3 + k);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_maskz_loadu_pd(mask, w0 + k), c00, c10, c20, c30);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_maskz_loadu_pd(mask, w1 + k), c01, c11, c21, c31);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_maskz_loadu_pd(mask, w2 + k), c02, c12, c22, c32);
+        tile_step_avx512(x0, x1, x2, x3, _mm512_maskz_loadu_pd(mask, w3 + k), c03, c13, c23, c33);
+    }
+    C[0] += _mm512_reduce_add_pd(c00); C[1] += _mm512_reduce_add_pd(c01);
+    C[2] += _mm512_reduce_add_pd(c02); C[3] += _mm512_reduce_add_pd(c03);
+    C += ldc;
+    C[0] += _mm512_reduce_add_pd(c10); C[1] += _mm512_reduce_add_pd(c11);
+    C[2] += _mm512_reduce_add_pd(c12); C[3] += _mm512_reduce_add_pd(c13);
+    C += ldc;
+    C[0] += _mm512_reduce_add_pd(c20); C[1] += _mm512_reduce_add_pd(c21);
+    C[2] += _mm512_reduce_add_pd(c22); C[3] += _mm512_reduce_add_pd(c23);
+    C += ldc;
+    C[0] += _mm512_reduce_add_pd(c30); C[1] += _mm512_reduce_add_pd(c31);
+    C[2] += _mm512_reduce_add_pd(c32); C[3] += _mm512_reduce_add_pd(c33);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 load_weights_avx512(const float* p) { return _mm512_loadu_ps(p); }
+
+__attribute__((target("avx512f")))
+static inline __m512 load_weights_avx512(const uint16_t* p) {
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)p)), 16));
+}
+
+template <typename WT>
+__attribute__((target("avx512f")))
+static double dot_lp_avx512(const float* a, const WT* b, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), load_weights_avx512(b + i), acc);
+    float sum = _mm512_reduce_add_ps(acc);
+    for (; i < n; i++) sum += a[i] * weight_value(b, i);
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static inline void tile_step_ps_avx512(__m512 x0, __m512 x1, __m512 x2, __m512 x3, __m512 w, __m512& c0, __m512& c1,
+                                       __m512& c2, __m512& c3) {
+    c0 = _mm512_fmadd_ps(x0, w, c0);
+    c1 = _mm512_fmadd_ps(x1, w, c1);
+    c2 = _mm512_fmadd_ps(x2, w, c2);
+    c3 = _mm512_fmadd_ps(x3, w, c3);
+}
+
+template <typename WT>
+__attribute__((target("avx512f")))
+static void gemm_tile_lp_avx512(const float* A, size_t lda, const WT* W, size_t ldw,  // 4 samples x 4 units, 16 floats per lane
+                                double* C, size_t ldc, size_t kc) {
+    const float* a[4] = {A, A + lda, A + 2 * lda, A + 3 * lda};
+    const WT* w[4] = {W, W + ldw, W + 2 * ldw, W + 3 * ldw};
+    __m512 c00 = _mm512_setzero_ps(), c10 = _mm512_setzero_ps(), c20 = _mm512_setzero_ps(), c30 = _mm512_setzero_ps();
+    __m512 c01 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c02 = _mm512_setzero_ps(), c12 = _mm512_setzero_ps(), c22 = _mm512_setzero_ps(), c32 = _mm512_setzero_ps();
+    __m512 c03 = _mm512_setzero_ps(), c13 = _mm512_setzero_ps(), c23 = _mm512_setzero_ps(), c33 = _mm512_setzero_ps();
+    size_t k = 0;
+    for (; k + 16 <= kc; k += 16) {
+        __m512 x0 = _mm512_loadu_ps(a[0] + k), x1 = _mm512_loadu_ps(a[1] + k);
+        __m512 x2 = _mm512_loadu_ps(a[2] + k), x3 = _mm512_loadu_ps(a[3] + k);
+        tile_step_ps_avx512(x0, x1, x2, x3, load_weights_avx512(w[0] + k), c00, c10, c20, c30);
+        tile_step_ps_avx512(x0, x1, x2, x3, load_weights_avx512(w[1] + k), c01, c11, c21, c31);
+        tile_step_ps_avx512(x0, x1, x2, x3, load_weights_avx512(w[2] + k), c02, c12, c22, c32);
+        tile_step_ps_avx512(x0, x1, x2, x3, load_weights_avx512(w[3] + k), c03, c13, c23, c33);
+    }
+    float s[4][4] = {{_mm512_reduce_add_ps(c00), _mm512_reduce_add_ps(c01), _mm512_reduce_add_ps(c02), _mm512_reduce_add_ps(c03)},
+                     {_mm512_reduce_add_ps(c10), _mm512_reduce_add_ps(c11), _mm512_reduce_add_ps(c12), _mm512_reduce_add_ps(c13)},
+                     {_mm512_reduce_add_ps(c20), _mm512_reduce_add_ps(c21), _mm512_reduce_add_ps(c22), _mm512_reduce_add_ps(c23)},
+                     {_mm512_reduce_add_ps(c30), _mm512_reduce_add_ps(c31), _mm512_reduce_add_ps(c32), _mm512_reduce_add_ps(c33)}};
+    for (; k < kc; k++) {                                              // Remainder below one vector
+        for (int j = 0; j < 4; j++) {
+            float wv = weight_value(w[j], k);
+            for (int i = 0; i < 4; i++) s[i][j] += a[i][k] * wv;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) C[i * ldc + j] += s[i][j];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void gemm_tn_tile_avx512(const double* D, size_t ldd, const double* X, size_t ldx,  // 4 rows x 16 columns, masked column tail
+                                double* G, size_t ldg, size_t M, size_t kc) {
+    for (size_t k = 0; k < kc; k += 16) {
+        size_t left = kc - k;
+        __mmask8 mask0 = left >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1);
+        __mmask8 mask1 = left >= 16 ? (__mmask8)0xFF : left > 8 ? (__mmask8)((1u << (left - 8)) - 1) : (__mmask8)0;
+        __m512d c[4][2];
+        for (int j = 0; j < 4; j++) c[j][0] = c[j][1] = _mm512_setzero_pd();
+        for (size_t m = 0; m < M; m++) {
+            const double* x = X + m * ldx + k;
+            const double* d = D + m * ldd;
+            __m512d x0 = _mm512_maskz_loadu_pd(mask0, x);
+            __m512d x1 = _mm512_maskz_loadu_pd(mask1, x + 8);
+            for (int j = 0; j < 4; j++) {
+                __m512d dj = _mm512_set1_pd(d[j]);
+                c[j][0] = _mm512_fmadd_pd(dj, x0, c[j][0]);
+                c[j][1] = _mm512_fmadd_pd(dj, x1, c[j][1]);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            double* g = G + j * ldg + k;
+            _mm512_mask_storeu_pd(g, mask0, _mm512_add_pd(_mm512_maskz_loadu_pd(mask0, g), c[j][0]));
+            _mm512_mask_storeu_pd(g + 8, mask1, _mm512_add_pd(_mm512_maskz_loadu_pd(mask1, g + 8), c[j][1]));
+        }
+    }
+}
+
+// Optimizer sweeps with masked tails
+__attribute__((target("avx512f")))
+static void sgd_avx512(double* param, double* grad, double* velocity, size_t n, const NNOptimizerStep* step) {
+    const __m512d lr = _mm512_set1_pd(step->learning_rate);
+    const __m512d decay = _mm512_set1_pd(step->weight_decay);
+    const __m512d mu = _mm512_set1_pd(step->momentum);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d p = _mm512_maskz_loadu_pd(mask, param + i);
+        __m512d g = _mm512_fmadd_pd(decay, p, _mm512_maskz_loadu_pd(mask, grad + i));
+        if (velocity) {
+            g = _mm512_fmadd_pd(mu, _mm512_maskz_loadu_pd(mask, velocity + i), g);
+            _mm512_mask_storeu_pd(velocity + i, mask, g);
+        }
+        _mm512_mask_storeu_pd(param + i, mask, _mm512_fnmadd_pd(lr, g, p));
+        _mm512_mask_storeu_pd(grad + i, mask, _mm512_setzero_pd());
+    }
+}
+
+__attribute__((target("avx512f")))
+static void adam_avx512(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m512d lr = _mm512_set1_pd(step->learning_rate / step->correction1);
+    const __m512d decay = _mm512_set1_pd(step->weight_decay);
+    const __m512d b1 = _mm512_set1_pd(step->beta1);
+    const __m512d b1c = _mm512_set1_pd(1.0 - step->beta1);
+    const __m512d b2 = _mm512_set1_pd(step->beta2);
+    const __m512d b2c = _mm512_set1_pd(1.0 - step->beta2);
+    const __m512d c2 = _mm512_set1_pd(1.0 / step->correction2);
+    const __m512d eps = _mm512_set1_pd(step->epsilon);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d p = _mm512_maskz_loadu_pd(mask, param + i);
+        __m512d g = _mm512_fmadd_pd(decay, p, _mm512_maskz_loadu_pd(mask, grad + i));
+        __m512d mi = _mm512_fmadd_pd(b1, _mm512_maskz_loadu_pd(mask, m + i), _mm512_mul_pd(b1c, g));
+        __m512d vi = _mm512_fmadd_pd(b2, _mm512_maskz_loadu_pd(mask, v + i), _mm512_mul_pd(b2c, _mm512_mul_pd(g, g)));
+        __m512d denom = _mm512_add_pd(_mm512_sqrt_pd(_mm512_mul_pd(vi, c2)), eps);
+        _mm512_mask_storeu_pd(m + i, mask, mi);
+        _mm512_mask_storeu_pd(v + i, mask, vi);
+        _mm512_mask_storeu_pd(param + i, mask, _mm512_fnmadd_pd(lr, _mm512_div_pd(mi, denom), p));
+        _mm512_mask_storeu_pd(grad + i, mask, _mm512_setzero_pd());
+    }
+}
+
+__attribute__((target("avx512f")))
+static void rmsprop_avx512(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m512d lr = _mm512_set1_pd(step->learning_rate);
+    const __m512d decay = _mm512_set1_pd(step->weight_decay);
+    const __m512d rho = _mm512_set1_pd(step->rho);
+    const __m512d rhoc = _mm512_set1_pd(1.0 - step->rho);
+    const __m512d eps = _mm512_set1_pd(step->epsilon);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d p = _mm512_maskz_loadu_pd(mask, param + i);
+        __m512d g = _mm512_fmadd_pd(decay, p, _mm512_maskz_loadu_pd(mask, grad + i));
+        __m512d vi = _mm512_fmadd_pd(rho, _mm512_maskz_loadu_pd(mask, v + i), _mm512_mul_pd(rhoc, _mm512_mul_pd(g, g)));
+        _mm512_mask_storeu_pd(v + i, mask, vi);
+        _mm512_mask_storeu_pd(param + i, mask, _mm512_fnmadd_pd(lr, _mm512_div_pd(g, _mm512_add_pd(_mm512_sqrt_pd(vi), eps)), p));
+        _mm512_mask_storeu_pd(grad + i, mask, _mm512_setzero_pd());
+    }
+}
+
+__attribute__((target("avx512f")))
+static void adagrad_avx512(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    const __m512d lr = _mm512_set1_pd(step->learning_rate);
+    const __m512d decay = _mm512_set1_pd(step->weight_decay);
+    const __m512d eps = _mm512_set1_pd(step->epsilon);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d p = _mm512_maskz_loadu_pd(mask, param + i);
+        __m512d g = _mm512_fmadd_pd(decay, p, _mm512_maskz_loadu_pd(mask, grad + i));
+        __m512d vi = _mm512_fmadd_pd(g, g, _mm512_maskz_loadu_pd(mask, v + i));
+        _mm512_mask_storeu_pd(v + i, mask, vi);
+        _mm512_mask_storeu_pd(param + i, mask, _mm512_fnmadd_pd(lr, _mm512_div_pd(g, _mm512_add_pd(_mm512_sqrt_pd(vi), eps)), p));
+        _mm512_mask_storeu_pd(grad + i, mask, _mm512_setzero_pd());
+    }
+}
+
+static const KernelTable avx512_kernels = {NN_ISA_AVX512, gemv_avx512, sigmoid_avx512, tanh_avx512,
+                                           dot_avx512, gemm_tile_avx512, 4, 4,
+                                           dot_lp_avx512<float>, gemm_tile_lp_avx512<float>,
+                                           dot_lp_avx512<uint16_t>, gemm_tile_lp_avx512<uint16_t>,
+                                           dot_u8s8_avx2, gemm_tile_u8s8_avx2, 2, 4,
+                                           gemm_tn_tile_avx512, 4,
+                                         sgd_avx2, adam_avx2, rmsprop_avx2, adagrad_avx2};  // Integer products need BW/VNNI
+
+// AVX-512 VNNI: vpdpbusd multiplies and accumulates 64 u8 x s8 pairs per instruction without int16 saturation
+#define VNNI_TARGET "avx512f,avx512bw,avx512vnni"
+
+__attribute__((target(VNNI_TARGET)))
+static inline __m512i load_tail_epi8(const void* p, size_t n) {       // First n < 64 bytes, rest zero
+    return _mm512_maskz_loadu_epi8(n ? (__mmask64)(~0ULL >> (64 - n)) : (__mmask64)0, p);
+}
+
+__attribute__((target(VNNI_TARGET)))
+static int32_t dot_u8s8_vnni(const uint8_t* a, const int8_t* b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        acc = _mm512_dpbusd_epi32(acc, _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    }
+    if (i < n) acc = _mm512_dpbusd_epi32(acc, load_tail_epi8(a + i, n - i), load_tail_epi8(b + i, n - i));
+    return _mm512_reduce_add_epi32(acc);
+}
+
+__attribute__((target(VNNI_TARGET)))
+static inline void tile_step_vnni(__m512i x0, __m512i x1, __m512i x2, __m512i x3, __m512i w, __m512i& c0, __m512i& c1,
+                                  __m512i& c2, __m512i& c3) {
+    c0 = _mm512_dpbusd_epi32(c0, x0, w);
+    c1 = _mm512_dpbusd_epi32(c1, x1, w);
+    c2 = _mm512_dpbusd_epi32(c2, x2, w);
+    c3 = _mm512_dpbusd_epi32(c3, x3, w);
+}
+
+__attribute__((target(VNNI_TARGET)))
+static void gemm_tile_u8s8_vnni(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw,  // 4 samples x 4 units, 64 bytes per step
+                                int32_t* C, size_t ldc, size_t kc) {
+    const uint8_t* a[4] = {A, A + lda, A + 2 * lda, A + 3 * lda};
+    const int8_t* w[4] = {W, W + ldw, W + 2 * ldw, W + 3 * ldw};
+    __m512i c00 = _mm512_setzero_si512(), c10 = _mm512_setzero_si512(), c20 = _mm512_setzero_si512(), c30 = _mm512_setzero_si512();
+    __m512i c01 = _mm512_setzero_si512(), c11 = _mm512_setzero_si512(), c21 = _mm512_setzero_si512(), c31 = _mm512_setzero_si512();
+    __m512i c02 = _mm512_setzero_si512(), c12 = _mm512_setzero_si512(), c22 = _mm512_setzero_si512(), c32 = _mm512_setzero_si512();
+    __m512i c03 = _mm512_setzero_si512(), c13 = _mm512_setzero_si512(), c23 = _mm512_setzero_si512(), c33 = _mm512_setzero_si512();
+    size_t k = 0;
+    for (; k + 64 <= kc; k += 64) {
+        __m512i x0 = _mm512_loadu_si512(a[0] + k), x1 = _mm512_loadu_si512(a[1] + k);
+        __m512i x2 = _mm512_loadu_si512(a[2] + k), x3 = _mm512_loadu_si512(a[3] + k);
+        tile_step_vnni(x0, x1, x2, x3, _mm512_loadu_si512(w[0] + k), c00, c10, c20, c30);
+        tile_step_vnni(x0, x1, x2, x3, _mm512_loadu_si512(w[1] + k), c01, c11, c21, c31);
+        tile_step_vnni(x0, x1, x2, x3, _mm512_loadu_si512(w[2] + k), c02, c12, c22, c32);
+        tile_step_vnni(x0, x1, x2, x3, _mm512_loadu_si512(w[3] + k), c03, c13, c23, c33);
+    }
+    if (k < kc) {                                                      // One zero-padded step covers the remainder
+        size_t n = kc - k;
+        __m512i x0 = load_tail_epi8(a[0] + k, n), x1 = load_tail_epi8(a[1] + k, n);
+        __m512i x2 = load_tail_epi8(a[2] + k, n), x3 = load_tail_epi8(a[3] + k, n);
+        tile_step_vnni(x0, x1, x2, x3, load_tail_epi8(w[0] + k, n), c00, c10, c20, c30);
+        tile_step_vnni(x0, x1, x2, x3, load_tail_epi8(w[1] + k, n), c01, c11, c21, c31);
+        tile_step_vnni(x0, x1, x2, x3, load_tail_epi8(w[2] + k, n), c02, c12, c22, c32);
+        tile_step_vnni(x0, x1, x2, x3, load_tail_epi8(w[3] + k, n), c03, c13, c23, c33);
+    }
+    C[0] += _mm512_reduce_add_epi32(c00);
+    C[1] += _mm512_reduce_add_epi32(c01);
+    C[2] += _mm512_reduce_add_epi32(c02);
+    C[3] += _mm512_reduce_add_epi32(c03);
+    C[ldc] += _mm512_reduce_add_epi32(c10);
+    C[ldc + 1] += _mm512_reduce_add_epi32(c11);
+    C[ldc + 2] += _mm512_reduce_add_epi32(c12);
+    C[ldc + 3] += _mm512_reduce_add_epi32(c13);
+    C[2 * ldc] += _mm512_reduce_add_epi32(c20);
+    C[2 * ldc + 1] += _mm512_reduce_add_epi32(c21);
+    C[2 * ldc + 2] += _mm512_reduce_add_epi32(c22);
+    C[2 * ldc + 3] += _mm512_reduce_add_epi32(c23);
+    C[3 * ldc] += _mm512_reduce_add_epi32(c30);
+    C[3 * ldc + 1] += _mm512_reduce_add_epi32(c31);
+    C[3 * ldc + 2] += _mm512_reduce_add_epi32(c32);
+    C[3 * ldc + 3] += _mm512_reduce_add_epi32(c33);
+}
+
+static const KernelTable avx512_vnni_kernels = {NN_ISA_AVX512_VNNI, gemv_avx512, sigmoid_avx512, tanh_avx512,
+                                                dot_avx512, gemm_tile_avx512, 4, 4,
+                                                dot_lp_avx512<float>, gemm_tile_lp_avx512<float>,
+                                                dot_lp_avx512<uint16_t>, gemm_tile_lp_avx512<uint16_t>,
+                                                dot_u8s8_vnni, gemm_tile_u8s8_vnni, 4, 4,
+                                                gemm_tn_tile_avx512, 4,
+                                                sgd_avx512, adam_avx512, rmsprop_avx512, adagrad_avx512};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // NN_KERNELS_X86
+
+static NNKernelISA supported_isa(void) {                               // Widest instruction set this CPU can run
+#ifdef NN_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni")) {
+        return NN_ISA_AVX512_VNNI;
+    }
+    if (__builtin_cpu_supports("avx512f")) return NN_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return NN_ISA_AVX2;
+#endif
+    return NN_ISA_SCALAR;
+}
+
+static const KernelTable* table_for(NNKernelISA isa) {
+#ifdef NN_KERNELS_X86
+    if (isa == NN_ISA_AVX512_VNNI) return &avx512_vnni_kernels;
+    if (isa == NN_ISA_AVX512) return &avx512_kernels;
+    if (isa == NN_ISA_AVX2) return &avx2_kernels;
+#endif
+    (void)isa;
+    return &scalar_kernels;
+}
+
+static std::atomic<const KernelTable*> active_kernels(nullptr);
+
+static inline const KernelTable* kernels(void) {                      // Dispatch table, resolved on first use
+    const KernelTable* table = active_kernels.load(std::memory_order_acquire);
+    if (!table) {
+        table = table_for(supported_isa());
+        active_kernels.store(table, std::memory_order_release);
+    }
+    return table;
+}
+
+NNKernelISA nn_kernels_isa(void) {
+    return kernels()->isa;
+}
+
+NNKernelISA nn_kernels_select(NNKernelISA isa) {
+    NNKernelISA best = supported_isa();
+    const KernelTable* table = table_for(isa < best ? isa : best);
+    active_kernels.store(table, std::memory_order_release);
+    return table->isa;
+}
+
+const char* nn_kernels_isa_name(NNKernelISA isa) {
+    switch (isa) {
+        case NN_ISA_AVX512_VNNI: return "avx512-vnni";
+        case NN_ISA_AVX512: return "avx512";
+        case NN_ISA_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void nn_kernel_gemv(const double* W, const double* x, const double* bias, double* y, size_t rows, size_t cols) {
+    kernels()->gemv(W, x, bias, y, rows, cols);
+}
+
+// Cache-blocked, register-tiled C = A W^T + bias shared by all weight types
+template <typename AT, typename WT, typename CT, typename DT>
+static void gemm_blocked(const AT* A, size_t lda, const WT* W, size_t ldw, const double* bias, CT* C, size_t ldc,
+                         size_t M, size_t N, size_t K, size_t kc_block, size_t mr, size_t nr,
+                         void (*tile)(const AT*, size_t, const WT*, size_t, CT*, size_t, size_t),
+                         DT (*dot)(const AT*, const WT*, size_t)) {
+    for (size_t m = 0; m < M; m++) {                                   // Start from bias; K blocks accumulate on top
+        for (size_t n = 0; n < N; n++) C[m * ldc + n] = bias ? (CT)bias[n] : (CT)0;
+    }
+    
+    for (size_t k0 = 0; k0 < K; k0 += kc_block) {
+        size_t kc = K - k0 < kc_block ? K - k0 : kc_block;
+        for (size_t n0 = 0; n0 < N; n0 += GEMM_NC) {                   // W panel reused by every sample while cache resident
+            size_t n_end = N - n0 < GEMM_NC ? N : n0 + GEMM_NC;
+            for (size_t m0 = 0; m0 < M; m0 += mr) {
+                size_t mb = M - m0 < mr ? M - m0 : mr;
+                const AT* a = A + m0 * lda + k0;
+                for (size_t n1 = n0; n1 < n_end; n1 += nr) {
+                    size_t nb = n_end - n1 < nr ? n_end - n1 : nr;
+                    const WT* w = W + n1 * ldw + k0;
+                    CT* c = C + m0 * ldc + n1;
+                    if (mb == mr && nb == nr) {
+                        tile(a, lda, w, ldw, c, ldc, kc);
+                    } else {                                           // Ragged edge: one dot product per element
+                        for (size_t i = 0; i < mb; i++) {
+                            for (size_t j = 0; j < nb; j++) c[i * ldc + j] += dot(a + i * lda, w + j * ldw, kc);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void nn_kernel_gemm(const double* A, size_t lda, const double* W, size_t ldw, const double* bias,
+                    double* C, size_t ldc, size_t M, size_t N, size_t K) {
+    const KernelTable* kt = kernels();
+    gemm_blocked(A, lda, W, ldw, bias, C, ldc, M, N, K, GEMM_KC, kt->gemm_mr, kt->gemm_nr, kt->gemm_tile, kt->dot);
+}
+
+void nn_kernel_gemm_f32(const float* A, size_t lda, const float* W, size_t ldw, const double* bias,
+                        double* C, size_t ldc, size_t M, size_t N, size_t K) {
+    const KernelTable* kt = kernels();
+    gemm_blocked(A, lda, W, ldw, bias, C, ldc, M, N, K, GEMM_KC_F32, kt->gemm_mr, kt->gemm_nr, kt->gemm_tile_f32, kt->dot_f32);
+}
+
+void nn_kernel_gemm_bf16(const float* A, size_t lda, const uint16_t* W, size_t ldw, const double* bias,
+                         double* C, size_t ldc, size_t M, size_t N, size_t K) {
+    const KernelTable* kt = kernels();
+    gemm_blocked(A, lda, W, ldw, bias, C, ldc, M, N, K, GEMM_KC_F32, kt->gemm_mr, kt->gemm_nr, kt->gemm_tile_bf16, kt->dot_bf16);
+}
+
+void nn_kernel_gemm_u8s8(const uint8_t* A, size_t lda, const int8_t* W, size_t ldw,
+                         int32_t* C, size_t ldc, size_t M, size_t N, size_t K) {
+    const KernelTable* kt = kernels();
+    gemm_blocked(A, lda, W, ldw, nullptr, C, ldc, M, N, K, GEMM_KC_I8, kt->u8s8_mr, kt->u8s8_nr, kt->gemm_tile_u8s8, kt->dot_u8s8);
+}
+
+void nn_kernel_gemm_tn_acc(const double* D, size_t ldd, const double* X, size_t ldx,
+                           double* G, size_t ldg, size_t M, size_t N, size_t K) {
+    const KernelTable* kt = kernels();
+    size_t nr = kt->gemm_tn_nr;
+    for (size_t k0 = 0; k0 < K; k0 += GEMM_NC) {                       // A GEMM_NC-column strip of X stays cached while every row of G passes
+        size_t kc = K - k0 < GEMM_NC ? K - k0 : GEMM_NC;
+        size_t n = 0;
+        for (; n + nr <= N; n += nr) kt->gemm_tn_tile(D + n, ldd, X + k0, ldx, G + n * ldg + k0, ldg, M, kc);
+        for (; n < N; n++) gemm_tn_tile_scalar(D + n, ldd, X + k0, ldx, G + n * ldg + k0, ldg, M, kc);
+    }
+}
+
+void nn_kernel_sigmoid(double* x, size_t n) {
+    kernels()->sigmoid(x, n);
+}
+
+void nn_kernel_tanh(double* x, size_t n) {
+    kernels()->tanh(x, n);
+}
+
+void nn_kernel_sgd(double* param, double* grad, double* velocity, size_t n, const NNOptimizerStep* step) {
+    kernels()->sgd(param, grad, velocity, n, step);
+}
+
+void nn_kernel_adam(double* param, double* grad, double* m, double* v, size_t n, const NNOptimizerStep* step) {
+    kernels()->adam(param, grad, m, v, n, step);
+}
+
+void nn_kernel_rmsprop(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    kernels()->rmsprop(param, grad, v, n, step);
+}
+
+void nn_kernel_adagrad(double* param, double* grad, double* v, size_t n, const NNOptimizerStep* step) {
+    kernels()->adagrad(param, grad, v, n, step);
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/search.h"
+#include <chrono>
+#include <cstring>
+#include <cmath>
+
+#define SEARCH_INFINITY 4.0
+#define SEARCH_MATE_BOUND (SEARCH_MATE_SCORE - SEARCH_MAX_PLY * SEARCH_MATE_PLY_STEP)
+#define SEARCH_ASPIRATION_WINDOW 0.05
+#define SEARCH_NULL_WINDOW (1.0 / 8192.0)  // One transposition table quantum
+
+// Move ordering tiers: TT move, then captures/promotions by MVV-LVA, then killers, then history
+#define ORDER_TT_MOVE 1000000000
+#define ORDER_CAPTURE 100000000
+#define ORDER_KILLER_1 90000000
+#define ORDER_KILLER_2 80000000
+#define HISTORY_LIMIT 50000000
+
+static const int piece_order_value[7] = {0, 100, 500, 300, 300, 900, 10000};  // Indexed by PieceType
+
+struct SearchContext {
+    ChessPosition* pos;
+    TranspositionTable* tt;
+    SearchEvaluator evaluate;
+    void* eval_context;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point start;
+    uint64_t nodes;
+    bool stopped;
+
+    uint16_t killers[SEARCH_MAX_PLY][2];
+    int history[2][64][64];
+    ChessMove pv[SEARCH_MAX_PLY][SEARCH_MAX_PLY];
+    size_t pv_length[SEARCH_MAX_PLY];
+};
+
+bool search_is_mate_score(double score) {
+    return fabs(score) >= SEARCH_MATE_BOUND;
+}
+
+// Mate scores are stored relative to the node so they stay valid when reached at another ply
+static inline double score_to_tt(double score, size_t ply) {
+    if (score >= SEARCH_MATE_BOUND) return score + ply * SEARCH_MATE_PLY_STEP;
+    if (score <= -SEARCH_MATE_BOUND) return score - ply * SEARCH_MATE_PLY_STEP;
+    return score;
+}
+
+static inline double score_from_tt(double score, size_t ply) {
+    if (score >= SEARCH_MATE_BOUND) return score - ply * SEARCH_MATE_PLY_STEP;
+    if (score <= -SEARCH_MATE_BOUND) return score + ply * SEARCH_MATE_PLY_STEP;
+    return score;
+}
+
+static bool should_stop(SearchContext* ctx) {                          // Check node and time limits, polled every 1024 nodes
+    if (ctx->stopped) return true;
+    if (ctx->limits.max_nodes && ctx->nodes >= ctx->limits.max_nodes) ctx->stopped = true;
+    if (ctx->limits.max_time_ms > 0.0 && (ctx->nodes & 1023) == 0) {
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ctx->start).count();
+        if (elapsed >= ctx->limits.max_time_ms) ctx->stopped = true;
+    }
+    return ctx->stopped;
+}
+
+static inline double static_eval(SearchContext* ctx) {                 // Network evaluation from side-to-move's point of view
+    double eval = ctx->evaluate(ctx->eval_context, ctx->pos);
+    return chess_position_get_side_to_move(ctx->pos) == COLOR_WHITE ? eval : -eval;
+}
+
+static void score_moves(SearchContext* ctx, const ChessMove* moves, int* scores, size_t num_moves,
+                        uint16_t tt_move, size_t ply) {               // Assign ordering score to every move
+    Color us = chess_position_get_side_to_move(ctx->pos);
+    for (size_t i = 0; i < num_moves; i++) {
+        const ChessMove* move = &moves[i];
+        uint16_t packed = transposition_table_pack_move(move);
+        if (packed == tt_move) {
+            scores[i] = ORDER_TT_MOVE;                                 // Best move from earlier search first
+        } else if (move->is_capture || move->promotion != PIECE_NONE) {
+            PieceType victim = move->is_en_passant ? PIECE_PAWN : chess_position_get_piece(ctx->pos, move->to);
+            scores[i] = ORDER_CAPTURE + piece_order_value[victim] * 16 + piece_order_value[move->promotion] * 16 -
+                        piece_order_value[move->piece] / 16;           // Most valuable victim, least valuable attacker
+        } else if (packed == ctx->killers[ply][0]) {
+            scores[i] = ORDER_KILLER_1;
+        } else if (packed == ctx->killers[ply][1]) {
+            scores[i] = ORDER_KILLER_2;
+        } else {
+            scores[i] = ctx->history[us][move->from][move->to];        // Quiet moves by cutoff history
+        }
+    }
+}
+
+static inline void pick_move(ChessMove* moves, int* scores, size_t count, size_t index) {  // Selection sort step: bring best remaining move to index
+    size_t best = index;
+    for (size_t i = index + 1; i < count; i++) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    if (best != index) {
+        ChessMove move = moves[index]; moves[index] = moves[best]; moves[best] = move;
+        int score = scores[index]; scores[index] = scores[best]; scores[best] = score;
+    }
+}
+
+static void update_pv(SearchContext* ctx, size_t ply, const ChessMove* move) {  // Prepend move to child principal variation
+    ctx->pv[ply][0] = *move;
+    size_t child_length = ply + 1 < SEARCH_MAX_PLY ? ctx->pv_length[ply + 1] : 0;
+    if (child_length > SEARCH_MAX_PLY - ply - 1) child_length = SEARCH_MAX_PLY - ply - 1;
+    memcpy(&ctx->pv[ply][1], ctx->pv[ply + 1], child_length * sizeof(ChessMove));
+    ctx->pv_length[ply] = child_length + 1;
+}
+
+static double quiescence(SearchContext* ctx, double alpha, double beta, size_t ply) {  // Resolve captures so leaf evaluations are quiet
+    ctx->nodes++;
+    ctx->pv_length[ply] = 0;
+    if (should_stop(ctx)) return 0.0;
+
+    Color us = chess_position_get_side_to_move(ctx->pos);
+    bool in_check = chess_position_is_check(ctx->pos, us);
+    if (ply >= SEARCH_MAX_PLY - 1) return in_check ? 0.0 : static_eval(ctx);
+
+    double best = -SEARCH_INFINITY;
+    if (!in_check) {                                                   // Side not in check may stand pat on static evaluation
+        best = static_eval(ctx);
+        if (best >= beta) return best;
+        if (best > alpha) alpha = best;
+    }
+
+    ChessMove moves[CHESS_MAX_MOVES];
+    int scores[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(ctx->pos, us, moves, &num_moves);
+    if (num_moves == 0) return in_check ? -SEARCH_MATE_SCORE + ply * SEARCH_MATE_PLY_STEP : 0.0;
+
+    if (!in_check) {                                                   // Keep only captures and promotions outside of check
+        size_t kept = 0;
+        for (size_t i = 0; i < num_moves; i++) {
+            if (moves[i].is_capture || moves[i].promotion != PIECE_NONE) moves[kept++] = moves[i];
+        }
+        num_moves = kept;
+    }
+    score_moves(ctx, moves, scores, num_moves, 0, ply);
+
+    for (size_t i = 0; i < num_moves; i++) {
+        pick_move(moves, scores, num_moves, i);
+        chess_position_make_move(ctx->pos, &moves[i]);
+        double score = -quiescence(ctx, -beta, -alpha, ply + 1);
+        chess_position_unmake_move(ctx->pos);
+        if (ctx->stopped) return 0.0;
+
+        if (score > best) best = score;
+        if (score > alpha) {
+            alpha = score;
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+static double negamax(SearchContext* ctx, double alpha, double beta, int depth, size_t ply) {  // Principal variation search node
+    if (depth <= 0) return quiescence(ctx, alpha, beta, ply);
+
+    ctx->nodes++;
+    ctx->pv_length[ply] = 0;
+    if (should_stop(ctx)) return 0.0;
+
+    bool pv_node = beta - alpha > 1.5 * SEARCH_NULL_WINDOW;
+    if (ply > 0) {
+        if (chess_position_is_repetition(ctx->pos)) return 0.0;        // Repetition scores as draw
+        alpha = fmax(alpha, -SEARCH_MATE_SCORE + ply * SEARCH_MATE_PLY_STEP);  // Mate distance pruning
+        beta = fmin(beta, SEARCH_MATE_SCORE - (ply + 1) * SEARCH_MATE_PLY_STEP);
+        if (alpha >= beta) return alpha;
+    }
+    if (ply >= SEARCH_MAX_PLY - 1) return static_eval(ctx);
+
+    uint64_t key = chess_position_get_hash(ctx->pos);
+    uint16_t tt_move = 0;
+    TTEntry entry;
+    if (ctx->tt && transposition_table_probe(ctx->tt, key, &entry) && entry.bound != TT_BOUND_NONE) {
+        tt_move = entry.move;
+        double tt_score = score_from_tt(entry.score, ply);
+        if (!pv_node && entry.depth >= depth) {                        // Cut off with sufficiently deep stored bound
+            if (entry.bound == TT_BOUND_EXACT ||
+                (entry.bound == TT_BOUND_LOWER && tt_score >= beta) ||
+                (entry.bound == TT_BOUND_UPPER && tt_score <= alpha)) {
+                return tt_score;
+            }
+        }
+    }
+
+    Color us = chess_position_get_side_to_move(ctx->pos);
+    ChessMove moves[CHESS_MAX_MOVES];
+    int scores[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(ctx->pos, us, moves, &num_moves);
+    if (num_moves == 0) {                                              // Checkmate or stalemate
+        return chess_position_is_check(ctx->pos, us) ? -SEARCH_MATE_SCORE + ply * SEARCH_MATE_PLY_STEP : 0.0;
+    }
+    if (ply > 0 && chess_position_get_halfmove_clock(ctx->pos) >= 100) return 0.0;  // Fifty move rule
+    score_moves(ctx, moves, scores, num_moves, tt_move, ply);
+
+    double original_alpha = alpha;
+    double best_score = -SEARCH_INFINITY;
+    uint16_t best_move = 0;
+
+    for (size_t i = 0; i < num_moves; i++) {
+        pick_move(moves, scores, num_moves, i);
+        const ChessMove* move = &moves[i];
+
+        chess_position_make_move(ctx->pos, move);
+        double score;
+        if (i == 0) {
+            score = -negamax(ctx, -beta, -alpha, depth - 1, ply + 1); // Full window for expected best move
+        } else {
+            score = -negamax(ctx, -alpha - SEARCH_NULL_WINDOW, -alpha, depth - 1, ply + 1);  // Null window proves move is no better
+            if (score > alpha && score < beta) {
+                score = -negamax(ctx, -beta, -alpha, depth - 1, ply + 1);  // Re-search with full window when it might be
+            }
+        }
+        chess_position_unmake_move(ctx->pos);
+        if (ctx->stopped) return 0.0;
+
+        if (score > best_score) {
+            best_score = score;
+            best_move = transposition_table_pack_move(move);
+            if (score > alpha) {
+                alpha = score;
+                update_pv(ctx, ply, move);
+                if (alpha >= beta) {                                   // Beta cutoff: remember quiet refutation
+                    if (!move->is_capture && move->promotion == PIECE_NONE) {
+                        if (ctx->killers[ply][0] != best_move) {
+                            ctx->killers[ply][1] = ctx->killers[ply][0];
+                            ctx->killers[ply][0] = best_move;
+                        }
+                        int* h = &ctx->history[us][move->from][move->to];
+                        *h += depth * depth;
+                        if (*h > HISTORY_LIMIT) {                      // Age table so counts stay below killer tier
+                            for (int c = 0; c < 2; c++)
+                                for (int f = 0; f < 64; f++)
+                                    for (int t = 0; t < 64; t++) ctx->history[c][f][t] /= 2;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (ctx->tt) {
+        TTBound bound = best_score >= beta ? TT_BOUND_LOWER : (best_score > original_alpha ? TT_BOUND_EXACT : TT_BOUND_UPPER);
+        transposition_table_store(ctx->tt, key, best_move, score_to_tt(best_score, ply), depth, bound);
+    }
+    return best_score;
+}
+
+void search_run(ChessPosition* pos, const SearchLimits* limits, TranspositionTable* tt,  // Iterative deepening driver with aspiration windows
+                SearchEvaluator evaluate, void* context, SearchResult* result) {
+    SearchContext* ctx = new SearchContext;                            // Heap allocate large PV and history tables
+    memset(ctx->killers, 0, sizeof(ctx->killers));
+    memset(ctx->history, 0, sizeof(ctx->history));
+    memset(ctx->pv_length, 0, sizeof(ctx->pv_length));
+    ctx->pos = pos;
+    ctx->tt = tt;
+    ctx->evaluate = evaluate;
+    ctx->eval_context = context;
+    ctx->limits = *limits;
+    ctx->start = std::chrono::steady_clock::now();
+    ctx->nodes = 0;
+    ctx->stopped = false;
+
+    size_t max_depth = limits->max_depth;
+    if (max_depth == 0 || max_depth > SEARCH_MAX_PLY - 1) max_depth = SEARCH_MAX_PLY - 1;
+
+    memset(result, 0, sizeof(*result));
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+    if (num_moves == 0) {                                              // No legal moves: report mate or stalemate score
+        result->score = chess_position_is_check(pos, chess_position_get_side_to_move(pos)) ? -SEARCH_MATE_SCORE : 0.0;
+        delete ctx;
+        return;
+    }
+    result->best_move = moves[0];                                      // Fallback if even depth one is interrupted
+    result->has_move = true;
+    if (tt) transposition_table_new_search(tt);
+
+    double previous = 0.0;
+    for (size_t depth = 1; depth <= max_depth; depth++) {              // Deepen one ply at a time reusing TT and history
+        double window = SEARCH_ASPIRATION_WINDOW;
+        double alpha = -SEARCH_INFINITY, beta = SEARCH_INFINITY;
+        if (depth >= 2 && !search_is_mate_score(previous)) {           // Narrow window around previous score
+            alpha = previous - window;
+            beta = previous + window;
+        }
+
+        double score;
+        while (true) {
+            score = negamax(ctx, alpha, beta, (int)depth, 0);
+            if (ctx->stopped) break;
+            if (score <= alpha) {                                      // Fail low: widen downward
+                alpha = fmax(score - window, -SEARCH_INFINITY);
+            } else if (score >= beta) {                                // Fail high: widen upward
+                beta = fmin(score + window, SEARCH_INFINITY);
+            } else {
+                break;
+            }
+            window *= 4.0;
+            if (window > 1.0) {                                        // Give up on aspiration after repeated failures
+                alpha = -SEARCH_INFINITY;
+                beta = SEARCH_INFINITY;
+            }
+        }
+        if (ctx->stopped || ctx->pv_length[0] == 0) break;            // Keep last completed iteration
+
+        previous = score;
+        result->score = score;
+        result->depth = depth;
+        result->best_move = ctx->pv[0][0];
+        result->pv_length = ctx->pv_length[0];
+        memcpy(result->pv, ctx->pv[0], ctx->pv_length[0] * sizeof(ChessMove));
+        if (search_is_mate_score(score) && SEARCH_MATE_SCORE - fabs(score) < (depth + 0.5) * SEARCH_MATE_PLY_STEP) break;  // Mate found within horizon
+    }
+
+    result->nodes = ctx->nodes;
+    delete ctx;
+}
@@ -8,6 +8,16 @@
 #include <cmath>
 #include <ctime>
 #include <cstdio>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 // Forward declare internal curriculum structures
 struct DifficultyLevel {
@@ -28,6 +38,305 @@ struct CurriculumImpl {
     size_t examples_per_level;
 };
 
+// Persistent data-parallel workers. The calling thread is worker 0; pool_run hands every worker
+// the same job and returns once all of them have finished it.
+struct TrainingPool {
+    TrainingEngine* engine;
+    size_t num_workers;
+    NNWorkspace** workspaces;   // Activation caches and gradient replica of each worker
+    double* losses;             // Each worker's share of the current mini-batch loss
+    size_t count;               // Rows staged for the current mini-batch
+    const NNSparseTargets* sparse;  // Non-null: the staged rows' targets, batch_targets is not read
+    
+    // Hogwild epochs: every worker stages and trains its own mini-batches
+    double** inputs;            // batch_size x input_size per worker
+    double** targets;
+    double** outputs;
+    size_t* correct;            // Per-worker accuracy count for the epoch
+    std::atomic<size_t> next;   // First example of the next unclaimed mini-batch
+    std::mutex dense_mutex;     // Serializes dense-layer steps; forward passes still read the dense weights unlocked
+    
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    void (*job)(TrainingPool* pool, size_t worker);
+    size_t generation;          // Bumped once per job
+    size_t running;             // Helper threads still working on the current job
+    bool stopping;
+};
+
+static void pool_worker(TrainingPool* pool, size_t worker) {
+    size_t seen = 0;
+    for (;;) {
+        void (*job)(TrainingPool*, size_t);
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wake.wait(lock, [&] { return pool->stopping || pool->generation != seen; });
+            if (pool->stopping) return;
+            seen = pool->generation;
+            job = pool->job;
+        }
+        job(pool, worker);
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (--pool->running == 0) pool->finished.notify_one();
+    }
+}
+
+static void pool_run(TrainingPool* pool, void (*job)(TrainingPool*, size_t)) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->job = job;
+        pool->running = pool->num_workers - 1;
+        pool->generation++;
+    }
+    pool->wake.notify_all();
+    job(pool, 0);
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    pool->finished.wait(lock, [&] { return pool->running == 0; });
+}
+
+static TrainingPool* pool_create(TrainingEngine* engine, size_t num_workers) {
+    TrainingPool* pool = new TrainingPool;
+    pool->engine = engine;
+    pool->num_workers = num_workers;
+    pool->workspaces = new NNWorkspace*[num_workers];
+    for (size_t w = 0; w < num_workers; w++) pool->workspaces[w] = nn_workspace_create(engine->network);
+    pool->losses = new double[num_workers];
+    pool->count = 0;
+    pool->sparse = nullptr;
+    pool->inputs = new double*[num_workers];
+    pool->targets = new double*[num_workers];
+    pool->outputs = new double*[num_workers];
+    pool->correct = new size_t[num_workers];
+    size_t batch = engine->config.batch_size;
+    for (size_t w = 0; w < num_workers; w++) {
+        bool staging = engine->config.hogwild;                         // Synchronous epochs share the engine's staging rows
+        pool->inputs[w] = staging ? new double[batch * nn_get_input_size(engine->network)] : nullptr;
+        pool->targets[w] = staging ? new double[batch * nn_get_output_size(engine->network)] : nullptr;
+        pool->outputs[w] = staging ? new double[batch * nn_get_output_size(engine->network)] : nullptr;
+    }
+    pool->next = 0;
+    pool->job = nullptr;
+    pool->generation = 0;
+    pool->running = 0;
+    pool->stopping = false;
+    for (size_t w = 1; w < num_workers; w++) pool->threads.emplace_back(pool_worker, pool, w);
+    return pool;
+}
+
+static void pool_destroy(TrainingPool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+    for (std::thread& thread : pool->threads) thread.join();
+    for (size_t w = 0; w < pool->num_workers; w++) {
+        nn_workspace_destroy(pool->workspaces[w]);
+        delete[] pool->inputs[w];
+        delete[] pool->targets[w];
+        delete[] pool->outputs[w];
+    }
+    delete[] pool->workspaces;
+    delete[] pool->losses;
+    delete[] pool->inputs;
+    delete[] pool->targets;
+    delete[] pool->outputs;
+    delete[] pool->correct;
+    delete pool;
+}
+
+static void backward_shard(TrainingPool* pool, size_t worker) {      // Contiguous rows of the staged batch; shard bounds depend only on the thread count
+    TrainingEngine* engine = pool->engine;
+    size_t input_size = nn_get_input_size(engine->network);
+    size_t output_size = nn_get_output_size(engine->network);
+    size_t lo = pool->count * worker / pool->num_workers;
+    size_t hi = pool->count * (worker + 1) / pool->num_workers;
+    if (pool->sparse) {                                                // Row offsets are absolute, so a shard starts at its first offset
+        NNSparseTargets rows = {pool->sparse->offsets + lo, pool->sparse->indices, pool->sparse->values};
+        pool->losses[worker] = nn_workspace_backward_batch_sparse(pool->workspaces[worker],
+                                                                  engine->batch_inputs + lo * input_size, input_size,
+                                                                  &rows, hi - lo, pool->count,
+                                                                  engine->batch_outputs + lo * output_size, output_size);
+        return;
+    }
+    pool->losses[worker] = nn_workspace_backward_batch(pool->workspaces[worker],
+                                                       engine->batch_inputs + lo * input_size, input_size,
+                                                       engine->batch_targets + lo * output_size, output_size,
+                                                       hi - lo, pool->count,
+                                                       engine->batch_outputs + lo * output_size, output_size);
+}
+
+static void reduce_slice(TrainingPool* pool, size_t worker) {        // All-reduce, one parameter slice per worker
+    size_t count;
+    double* target = nn_get_gradients(pool->engine->network, &count);
+    size_t lo = count * worker / pool->num_workers;
+    size_t hi = count * (worker + 1) / pool->num_workers;
+    size_t n = pool->num_workers;
+    for (size_t stride = 1; stride < n; stride *= 2) {                 // Pairwise tree: the summation order is fixed by the worker count
+        for (size_t w = 0; w + stride < n; w += 2 * stride) {
+            double* dst = nn_workspace_get_gradients(pool->workspaces[w], nullptr);
+            const double* src = nn_workspace_get_gradients(pool->workspaces[w + stride], nullptr);
+            for (size_t i = lo; i < hi; i++) dst[i] += src[i];
+        }
+    }
+    const double* sum = nn_workspace_get_gradients(pool->workspaces[0], nullptr);
+    for (size_t i = lo; i < hi; i++) target[i] += sum[i];
+    for (size_t w = 0; w < n; w++) {                                   // Replicas start the next mini-batch from zero
+        memset(nn_workspace_get_gradients(pool->workspaces[w], nullptr) + lo, 0, (hi - lo) * sizeof(double));
+    }
+}
+
+static double train_staged_batch(TrainingEngine* engine, size_t count, const NNSparseTargets* sparse) {  // Backward over the staged rows and one optimizer step; returns the batch-mean loss
+    NeuralNetwork* nn = engine->network;                               // Targets come from batch_targets unless sparse rows are given
+    size_t input_size = nn_get_input_size(nn);
+    size_t output_size = nn_get_output_size(nn);
+    double loss = 0.0;
+    if (!engine->pool) {
+        loss = sparse ? nn_backward_batch_sparse(nn, engine->batch_inputs, input_size, sparse, count, engine->batch_outputs, output_size)
+                      : nn_backward_batch(nn, engine->batch_inputs, input_size, engine->batch_targets, output_size,
+                                          count, engine->batch_outputs, output_size);
+    } else {
+        TrainingPool* pool = engine->pool;
+        pool->count = count;
+        pool->sparse = sparse;
+        pool_run(pool, backward_shard);                                // Shards accumulate into their own replicas
+        pool_run(pool, reduce_slice);                                  // Then every worker sums one slice of all replicas
+        for (size_t w = 0; w < pool->num_workers; w++) loss += pool->losses[w];
+    }
+    optimizer_update(engine->optimizer, nn);                          // One optimizer step per mini-batch
+    engine->stats.examples_seen += count;
+    return loss;
+}
+
+static size_t count_correct(const double* outputs, const double* targets, size_t count, size_t width) {  // Rows within 0.1 of their target everywhere
+    size_t correct = 0;
+    for (size_t b = 0; b < count; b++) {
+        bool is_correct = true;
+        for (size_t j = 0; j < width && is_correct; j++) is_correct = fabs(outputs[b * width + j] - targets[b * width + j]) <= 0.1;
+        if (is_correct) correct++;
+    }
+    return correct;
+}
+
+static size_t count_correct_sparse(const double* outputs, const NNSparseTargets* targets, size_t count, size_t width,  // count_correct on sparse
+                                   size_t live, double* row) {                                                      // rows; outputs past live are zero
+    size_t correct = 0;
+    for (size_t b = 0; b < count; b++) {
+        bool is_correct = true;
+        memset(row, 0, live * sizeof(double));                         // Dense target of the live outputs
+        for (size_t k = targets->offsets[b]; k < targets->offsets[b + 1]; k++) {
+            if (targets->indices[k] < live) row[targets->indices[k]] = targets->values[k];
+            else is_correct = is_correct && fabs(targets->values[k]) <= 0.1;
+        }
+        for (size_t j = 0; j < live && is_correct; j++) is_correct = fabs(outputs[b * width + j] - row[j]) <= 0.1;
+        if (is_correct) correct++;
+    }
+    return correct;
+}
+
+static size_t live_outputs(const NeuralNetwork* nn) {               // Outputs at or past this index are always zero (see nn_backward_batch_sparse)
+    return std::min(nn_get_hidden_size(nn), nn_get_output_size(nn));
+}
+
+static bool example_correct(const TrainingExample* ex, const double* output, size_t width, size_t live) {  // Dense: every output within 0.1 of its target;
+    if (!ex->sparse_target) {                                          // sparse: the best listed output is the most probable entry.
+        size_t n = std::min(ex->target_size, width);                   // Sparse checks read only the first live outputs
+        for (size_t j = 0; j < n; j++) {
+            if (fabs(output[j] - ex->target[j]) > 0.1) return false;
+        }
+        return true;
+    }
+    const SparseTargetEntry* best = nullptr;
+    const SparseTargetEntry* predicted = nullptr;
+    double predicted_output = 0.0;
+    for (size_t k = 0; k < ex->num_sparse; k++) {
+        const SparseTargetEntry* entry = &ex->sparse_target[k];
+        if (entry->index >= width) continue;
+        double y = entry->index < live ? output[entry->index] : 0.0;
+        if (!best || entry->probability > best->probability) best = entry;
+        if (!predicted || y > predicted_output) {
+            predicted = entry;
+            predicted_output = y;
+        }
+    }
+    return best == predicted;
+}
+
+static double example_loss(const TrainingExample* ex, const double* output, size_t width, size_t live) {  // Squared error over the width, as in training
+    if (!ex->sparse_target) {
+        double loss = 0.0;
+        for (size_t j = 0; j < width; j++) {
+            double diff = output[j] - (j < ex->target_size ? ex->target[j] : 0.0);
+            loss += diff * diff;
+        }
+        return loss;
+    }
+    double loss = 0.0;                                                 // Zero targets cost output^2 on the live outputs; correct the listed entries
+    for (size_t j = 0; j < live; j++) loss += output[j] * output[j];
+    for (size_t k = 0; k < ex->num_sparse; k++) {
+        uint32_t j = ex->sparse_target[k].index;
+        double t = ex->sparse_target[k].probability;
+        if (j >= width) continue;
+        loss += j < live ? (output[j] - t) * (output[j] - t) - output[j] * output[j] : t * t;
+    }
+    return loss;
+}
+
+static void hogwild_worker(TrainingPool* pool, size_t worker) {     // Claim mini-batches until the epoch runs out, updating the shared weights after each
+    TrainingEngine* engine = pool->engine;
+    size_t input_size = nn_get_input_size(engine->network);
+    size_t output_size = nn_get_output_size(engine->network);
+    size_t batch = engine->config.batch_size;
+    pool->losses[worker] = 0.0;
+    pool->correct[worker] = 0;
+    for (;;) {
+        size_t start = pool->next.fetch_add(batch, std::memory_order_relaxed);
+        if (start >= engine->data_size) break;
+        size_t count = std::min(batch, engine->data_size - start);
+        for (size_t b = 0; b < count; b++) {
+            size_t index = engine->data_order[start + b];
+            memcpy(pool->inputs[worker] + b * input_size, engine->data_inputs + index * input_size, input_size * sizeof(double));
+            memcpy(pool->targets[worker] + b * output_size, engine->data_targets + index * output_size, output_size * sizeof(double));
+        }
+        double loss = nn_workspace_backward_batch(pool->workspaces[worker], pool->inputs[worker], input_size,
+                                                  pool->targets[worker], output_size, count, count,
+                                                  pool->outputs[worker], output_size);
+        nn_workspace_apply_sparse_sgd(pool->workspaces[worker], engine->config.learning_rate, engine->config.weight_decay);
+        std::unique_lock<std::mutex> dense(pool->dense_mutex, std::try_to_lock);  // Busy: keep accumulating, retry after the next batch
+        if (dense.owns_lock()) nn_workspace_apply_dense_sgd(pool->workspaces[worker], engine->config.learning_rate, engine->config.weight_decay);
+        pool->losses[worker] += loss * count;
+        pool->correct[worker] += count_correct(pool->outputs[worker], pool->targets[worker], count, output_size);
+    }
+    std::lock_guard<std::mutex> dense(pool->dense_mutex);              // Flush deferred dense gradients before the epoch ends
+    nn_workspace_apply_dense_sgd(pool->workspaces[worker], engine->config.learning_rate, engine->config.weight_decay);
+}
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void checkpoint_writer_destroy(CheckpointWriter* writer);  // With the checkpoint code below
+
+void training_config_init(TrainingConfig* config) {
+    *config = TrainingConfig();                                       // Zero (false, null) everything not set below
+    config->optimizer_type = OPTIMIZER_ADAM;
+    config->learning_rate = 0.001;
+    config->momentum = 0.9;
+    config->weight_decay = 0.0001;
+    config->batch_size = 32;
+    config->max_epochs = 100;
+    config->early_stopping_threshold = 0.001;
+    config->mastery_threshold = 0.85;
+    config->patience = 10;
+    config->num_threads = 1;
+    config->seed = 1;
+}
+
 TrainingEngine* training_engine_create(NeuralNetwork* nn, TrainingConfig* config) {  // Create training engine with neural network and configuration
     TrainingEngine* engine = new TrainingEngine;                       // Allocate memory for new training engine structure
     engine->network = nn;                                             // Store pointer to neural network being trained
@@ -53,6 +362,22 @@ TrainingEngine* training_engine_create(NeuralNetwork* nn, TrainingConfig* config
     }
     
     engine->optimizer = optimizer_create(config->optimizer_type, config->learning_rate);  // Create optimizer with specified type and rate
+    optimizer_set_momentum(engine->optimizer, config->momentum);      // Velocity decay for SGD
+    optimizer_set_weight_decay(engine->optimizer, config->weight_decay);  // L2 penalty folded into every update
+    
+    size_t batch = config->batch_size > 0 ? config->batch_size : 1;   // Staging rows for one mini-batch
+    engine->config.batch_size = batch;
+    engine->batch_inputs = new double[batch * nn_get_input_size(nn)];
+    engine->batch_targets = new double[batch * nn_get_output_size(nn)];
+    engine->batch_outputs = new double[batch * nn_get_output_size(nn)];
+    engine->pool = config->num_threads > 1 || config->hogwild                      // Hogwild workers need their own workspaces even alone
+                   ? pool_create(engine, std::max<size_t>(config->num_threads, 1)) : nullptr;
+    engine->data_inputs = nullptr;
+    engine->data_targets = nullptr;
+    engine->data_size = 0;
+    engine->data_order = nullptr;
+    engine->shuffle_state = config->seed;
+    engine->checkpoint_writer = nullptr;                              // Started by the first asynchronous checkpoint
     
     engine->stats.current_loss = 0.0;                                // Initialize current loss value to zero
     engine->stats.average_loss = 0.0;                                // Initialize average loss value to zero
@@ -62,28 +387,118 @@ TrainingEngine* training_engine_create(NeuralNetwork* nn, TrainingConfig* config
     engine->stats.current_level = LEVEL_PRESCHOOL;                  // Initialize current difficulty level to preschool
     engine->stats.training_time = 0.0;                              // Initialize training time accumulator to zero
     engine->stats.validation_accuracy = 0.0;                          // Initialize validation accuracy to zero
+    engine->stats.validation_loss = 0.0;
+    engine->stats.checkpoint_latency = 0.0;
+    engine->stats.checkpoint_write_time = 0.0;
+    engine->stats.checkpoints_written = 0;
+    engine->stats.checkpoint_bytes_copied = 0;
     
     return engine;                                                    // Return pointer to initialized training engine
 }
 
 void training_engine_destroy(TrainingEngine* engine) {
     if (engine) {
+        if (engine->checkpoint_writer) checkpoint_writer_destroy(engine->checkpoint_writer);  // Finishes queued writes first
         if (engine->curriculum) curriculum_destroy(engine->curriculum);
         if (engine->pavlovian_learner) pavlovian_learner_destroy(engine->pavlovian_learner);
         if (engine->spaced_repetition) spaced_repetition_destroy(engine->spaced_repetition);
+        if (engine->pool) pool_destroy(engine->pool);
         if (engine->optimizer) optimizer_destroy(engine->optimizer);
+        delete[] engine->batch_inputs;
+        delete[] engine->batch_targets;
+        delete[] engine->batch_outputs;
+        delete[] engine->data_order;
         delete engine;
     }
 }
 
-void training_engine_train_epoch(TrainingEngine* engine) {
+void training_engine_set_data(TrainingEngine* engine, const double* inputs, const double* targets, size_t num_examples) {
+    delete[] engine->data_order;
+    engine->data_inputs = inputs;
+    engine->data_targets = targets;
+    engine->data_size = num_examples;
+    engine->data_order = new size_t[num_examples];
+    for (size_t i = 0; i < num_examples; i++) engine->data_order[i] = i;
+}
+
+void training_engine_train_epoch(TrainingEngine* engine) {            // One shuffled pass over the dataset, one optimizer step per mini-batch
     engine->is_training = true;
     engine->stats.epoch++;
     
-    // Training logic here
-    // This would iterate through training examples and update the network
+    size_t n = engine->data_size;
+    if (n > 0) {
+        NeuralNetwork* nn = engine->network;
+        size_t input_size = nn_get_input_size(nn);
+        size_t output_size = nn_get_output_size(nn);
+        size_t* order = engine->data_order;
+        for (size_t i = n - 1; i > 0; i--) {                           // Fisher-Yates from the seeded generator
+            size_t j = (size_t)(splitmix64(&engine->shuffle_state) % (i + 1));
+            std::swap(order[i], order[j]);
+        }
+        
+        double total_loss = 0.0;
+        size_t correct = 0;
+        if (engine->config.hogwild) {                                  // Workers race through the shuffled order without barriers
+            TrainingPool* pool = engine->pool;
+            pool->next = 0;
+            nn_hogwild_begin(nn);                                      // First layer trains in its column-major copy
+            pool_run(pool, hogwild_worker);
+            nn_hogwild_end(nn);
+            for (size_t w = 0; w < pool->num_workers; w++) {
+                total_loss += pool->losses[w];
+                correct += pool->correct[w];
+            }
+            engine->stats.examples_seen += n;
+        } else {
+            for (size_t start = 0; start < n; start += engine->config.batch_size) {
+                size_t count = std::min(engine->config.batch_size, n - start);
+                for (size_t b = 0; b < count; b++) {                   // Stage the shuffled rows contiguously
+                    memcpy(engine->batch_inputs + b * input_size, engine->data_inputs + order[start + b] * input_size,
+                           input_size * sizeof(double));
+                    memcpy(engine->batch_targets + b * output_size, engine->data_targets + order[start + b] * output_size,
+                           output_size * sizeof(double));
+                }
+                total_loss += train_staged_batch(engine, count, nullptr) * count;
+                correct += count_correct(engine->batch_outputs, engine->batch_targets, count, output_size);
+            }
+        }
+        engine->stats.current_loss = total_loss / n;
+        engine->stats.accuracy = (double)correct / n;
+    }
+    
+    engine->is_training = false;
+}
+
+bool training_engine_train_shard(TrainingEngine* engine, ShardReader* shard) {  // One streamed pass over a shard, one optimizer step per mini-batch
+    NeuralNetwork* nn = engine->network;
+    size_t input_size = nn_get_input_size(nn);
+    size_t output_size = nn_get_output_size(nn);
+    if (!shard || shard_reader_input_size(shard) != input_size || shard_reader_output_size(shard) != output_size) return false;
     
+    engine->is_training = true;
+    engine->stats.epoch++;
+    double total_loss = 0.0;
+    size_t correct = 0;
+    size_t seen = 0;
+    size_t batch_size = engine->config.batch_size;
+    std::vector<size_t> offsets(batch_size + 1);                      // Records stay sparse: value plus their listed moves
+    std::vector<uint32_t> indices(batch_size * (SHARD_MAX_MOVES + 1));
+    std::vector<double> values(indices.size());
+    NNSparseTargets sparse = {offsets.data(), indices.data(), values.data()};
+    shard_reader_rewind(shard);
+    size_t count;
+    while ((count = shard_reader_next_batch_sparse(shard, batch_size, engine->batch_inputs, input_size,
+                                                   offsets.data(), indices.data(), values.data())) > 0) {
+        total_loss += train_staged_batch(engine, count, &sparse) * count;
+        correct += count_correct_sparse(engine->batch_outputs, &sparse, count, output_size, live_outputs(nn), engine->batch_targets);
+        seen += count;
+    }
+    if (seen > 0) {
+        engine->stats.current_loss = total_loss / seen;
+        engine->stats.accuracy = (double)correct / seen;
+    }
     engine->is_training = false;
+    return true;
 }
 
 void training_engine_train_full(TrainingEngine* engine) {
@@ -92,6 +507,10 @@ void training_engine_train_full(TrainingEngine* engine) {
     
     for (size_t epoch = 0; epoch < engine->config.max_epochs; epoch++) {
         training_engine_train_epoch(engine);
+        if (engine->config.checkpoint_path && engine->config.checkpoint_interval > 0 &&
+            (epoch + 1) % engine->config.checkpoint_interval == 0) {
+            training_engine_checkpoint(engine, engine->config.checkpoint_path);
+        }
         
         // Check early stopping
         if (engine->stats.current_loss < engine->config.early_stopping_threshold) {
@@ -100,6 +519,7 @@ void training_engine_train_full(TrainingEngine* engine) {
     }
     
     engine->stats.training_time = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+    training_engine_wait_checkpoints(engine);                         // The last checkpoint is on disk when the run returns
     engine->is_training = false;
 }
 
@@ -112,30 +532,48 @@ void training_engine_train_with_curriculum(TrainingEngine* engine) {  // Train n
     CurriculumImpl* impl = (CurriculumImpl*)engine->curriculum;
     DifficultyLevel* level = &impl->levels[current_level];  // Get pointer to current difficulty level structure
     
+    NeuralNetwork* nn = engine->network;
+    size_t input_size = nn_get_input_size(nn);
+    size_t output_size = nn_get_output_size(nn);
+    size_t live = live_outputs(nn);
     double total_loss = 0.0;                                         // Initialize loss accumulator for averaging
     size_t correct = 0;                                               // Initialize correct prediction counter
+    std::vector<size_t> offsets;                                     // Targets of an all-sparse batch as rows of (index, value)
+    std::vector<uint32_t> indices;
+    std::vector<double> values;
     
-    for (size_t i = 0; i < level->num_examples; i++) {              // Iterate through all examples at current difficulty level
-        TrainingExample* ex = &level->examples[i];                   // Get pointer to current training example
-        
-        double output[1000];                                         // Allocate output buffer for network prediction
-        nn_forward(engine->network, ex->input, output);               // Forward pass through network to get prediction
-        
-        double loss;                                                 // Variable to store computed loss value
-        nn_backward(engine->network, ex->target, &loss);              // Backward pass to compute gradients and loss
-        total_loss += loss;                                          // Accumulate loss for average computation
-        
-        bool is_correct = true;                                       // Initialize correctness flag to true
-        for (size_t j = 0; j < ex->target_size; j++) {               // Compare each output dimension with target
-            if (fabs(output[j] - ex->target[j]) > 0.1) {            // Check if prediction differs significantly from target
-                is_correct = false;                                  // Mark as incorrect if difference exceeds threshold
-                break;                                               // Exit loop early if incorrect prediction found
+    for (size_t start = 0; start < level->num_examples; start += engine->config.batch_size) {  // One optimizer step per mini-batch
+        size_t count = std::min(engine->config.batch_size, level->num_examples - start);
+        bool all_sparse = true;
+        for (size_t b = 0; b < count && all_sparse; b++) all_sparse = level->examples[start + b].sparse_target != nullptr;
+        offsets.assign(1, 0);
+        indices.clear();
+        values.clear();
+        for (size_t b = 0; b < count; b++) {                         // Pack examples into rows, zero-padding short vectors
+            const TrainingExample* ex = &level->examples[start + b];
+            double* input = engine->batch_inputs + b * input_size;
+            size_t n_in = std::min(ex->input_size, input_size);
+            memcpy(input, ex->input, n_in * sizeof(double));
+            memset(input + n_in, 0, (input_size - n_in) * sizeof(double));
+            if (!all_sparse) {                                         // Mixed batches scatter sparse targets into zeroed dense rows
+                training_example_get_target(ex, engine->batch_targets + b * output_size, output_size);
+                continue;
+            }
+            for (size_t k = 0; k < ex->num_sparse; k++) {
+                if (ex->sparse_target[k].index >= output_size) continue;
+                indices.push_back(ex->sparse_target[k].index);
+                values.push_back(ex->sparse_target[k].probability);
             }
+            offsets.push_back(indices.size());
         }
-        if (is_correct) correct++;                                   // Increment correct counter if prediction matches target
         
-        optimizer_update(engine->optimizer, engine->network);         // Update network weights using optimizer algorithm
-        engine->stats.examples_seen++;                               // Increment total examples processed counter
+        NNSparseTargets sparse = {offsets.data(), indices.data(), values.data()};
+        double loss = train_staged_batch(engine, count, all_sparse ? &sparse : nullptr);  // Batched forward and backward, gradients averaged over the batch
+        total_loss += loss * count;                                  // Accumulate loss for average computation
+        
+        for (size_t b = 0; b < count; b++) {                         // Compare each prediction with its target, sparse ones over their entries only
+            if (example_correct(&level->examples[start + b], engine->batch_outputs + b * output_size, output_size, live)) correct++;
+        }
     }
     
     engine->stats.current_loss = total_loss / level->num_examples;    // Compute average loss over all examples
@@ -175,17 +613,14 @@ void training_engine_train_with_spaced_repetition(TrainingEngine* engine) {
     TrainingExample* ex = spaced_repetition_get_next_review(engine->spaced_repetition);
     if (!ex) return;
     
-    double output[1000];
+    size_t output_size = nn_get_output_size(engine->network);
+    double* output = engine->batch_outputs;                          // Staging rows are sized to the network
+    double* target = engine->batch_targets;
     nn_forward(engine->network, ex->input, output);
+    training_example_get_target(ex, target, output_size);
     
     // Check if correct
-    bool is_correct = true;
-    for (size_t i = 0; i < ex->target_size; i++) {
-        if (fabs(output[i] - ex->target[i]) > 0.1) {
-            is_correct = false;
-            break;
-        }
-    }
+    bool is_correct = example_correct(ex, output, output_size, live_outputs(engine->network));
     
     // Find example index and update
     for (size_t i = 0; i < engine->spaced_repetition->num_examples; i++) {
@@ -197,7 +632,7 @@ void training_engine_train_with_spaced_repetition(TrainingEngine* engine) {
     
     // Train on this example
     double loss;
-    nn_backward(engine->network, ex->target, &loss);
+    nn_backward(engine->network, target, &loss);
     optimizer_update(engine->optimizer, engine->network);
 }
 
@@ -206,14 +641,14 @@ double training_engine_evaluate(TrainingEngine* engine,
                                const double* targets, 
                                size_t num_examples) {
     size_t correct = 0;
-    const size_t input_size = 768;  // Default chess input size
-    const size_t output_size = 4096;  // Default chess output size
+    const size_t input_size = nn_get_input_size(engine->network);
+    const size_t output_size = nn_get_output_size(engine->network);
+    double* output = engine->batch_outputs;
     
     for (size_t i = 0; i < num_examples; i++) {
         const double* input = inputs + i * input_size;
         const double* target = targets + i * output_size;
         
-        double output[4096];
         nn_forward(engine->network, input, output);
         
         bool is_correct = true;
@@ -229,30 +664,891 @@ double training_engine_evaluate(TrainingEngine* engine,
     return (double)correct / num_examples;
 }
 
+double training_engine_evaluate_examples(TrainingEngine* engine, const TrainingExample* examples, size_t num_examples) {  // Batched forward; targets read in place
+    NeuralNetwork* nn = engine->network;
+    size_t input_size = nn_get_input_size(nn);
+    size_t output_size = nn_get_output_size(nn);
+    size_t live = live_outputs(nn);
+    double total_loss = 0.0;
+    size_t correct = 0;
+    for (size_t start = 0; start < num_examples; start += engine->config.batch_size) {
+        size_t count = std::min(engine->config.batch_size, num_examples - start);
+        for (size_t b = 0; b < count; b++) {
+            const TrainingExample* ex = &examples[start + b];
+            double* input = engine->batch_inputs + b * input_size;
+            size_t n_in = std::min(ex->input_size, input_size);
+            memcpy(input, ex->input, n_in * sizeof(double));
+            memset(input + n_in, 0, (input_size - n_in) * sizeof(double));
+        }
+        nn_forward_batch(nn, engine->batch_inputs, input_size, count, engine->batch_outputs, output_size);
+        for (size_t b = 0; b < count; b++) {
+            const double* output = engine->batch_outputs + b * output_size;
+            total_loss += example_loss(&examples[start + b], output, output_size, live);
+            if (example_correct(&examples[start + b], output, output_size, live)) correct++;
+        }
+    }
+    if (num_examples == 0) return 0.0;
+    engine->stats.validation_loss = total_loss / ((double)output_size * (double)num_examples);
+    engine->stats.validation_accuracy = (double)correct / num_examples;
+    return engine->stats.validation_accuracy;
+}
+
 TrainingStats* training_engine_get_stats(TrainingEngine* engine) {
     return &engine->stats;
 }
 
-void training_engine_save_checkpoint(TrainingEngine* engine, const char* filepath) {
-    // Checkpoint saving (simplified - would serialize network weights)
-    FILE* f = fopen(filepath, "wb");
-    if (f) {
-        fwrite(&engine->stats, sizeof(TrainingStats), 1, f);
-        fclose(f);
+// Checkpoint files. The manifest lists one entry per section and every section lives in its own
+// file, named after the save that wrote it, so an incremental save can keep the files of sections
+// that did not change and a new manifest never names a file an older one still points to.
+#define CHECKPOINT_MAGIC "CCCKPT"
+#define CHECKPOINT_VERSION 4         // 2: examples may carry sparse targets; 3: config and stats stored field by field; 4: snapshot bytes in stats
+#define CHECKPOINT_CHUNK 65536       // Bytes hashed per read when verifying a section file
+
+enum CheckpointSection {
+    SECTION_ENGINE = 0,              // Config, stats, shuffle generator state and epoch order
+    SECTION_NETWORK,                 // Shape, precision and parameter arena
+    SECTION_OPTIMIZER,               // Step count and moment buffers
+    SECTION_CURRICULUM,              // Current level and per-level progress
+    SECTION_CURRICULUM_EXAMPLES,
+    SECTION_SCHEDULE,                // Review state of each spaced-repetition example
+    SECTION_SCHEDULE_EXAMPLES,
+    NUM_SECTIONS
+};
+
+static const char* const section_names[NUM_SECTIONS] = {
+    "engine", "network", "optimizer", "curriculum", "curriculum_examples", "schedule", "schedule_examples"
+};
+
+struct CheckpointEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t generation;             // Save that wrote the section file
+    uint64_t size;
+    uint64_t checksum;               // FNV-1a of the section file
+};
+
+struct CheckpointManifest {
+    char magic[8];                   // CHECKPOINT_MAGIC, NUL padded
+    uint32_t version;
+    uint32_t num_sections;
+    uint64_t generation;             // Bumped by every save
+    CheckpointEntry entries[NUM_SECTIONS];
+};
+
+struct CheckpointStream {            // One section file being written or read; every byte passing through is hashed
+    FILE* file;                      // Null when only hashing
+    std::vector<unsigned char>* memory;  // Snapshot buffer appended to instead of hashing or writing
+    uint64_t checksum;
+    uint64_t size;
+    bool ok;
+};
+
+static void stream_init(CheckpointStream* stream, FILE* file) {
+    stream->file = file;
+    stream->memory = nullptr;
+    stream->checksum = 0xCBF29CE484222325ULL;
+    stream->size = 0;
+    stream->ok = true;
+}
+
+static void stream_hash(CheckpointStream* stream, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = stream->checksum;
+    for (size_t i = 0; i < bytes; i++) h = (h ^ p[i]) * 0x100000001B3ULL;
+    stream->checksum = h;
+    stream->size += bytes;
+}
+
+static void put(CheckpointStream* stream, const void* data, size_t bytes) {
+    if (stream->memory) {                                              // Snapshots only copy; the writer thread hashes
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        stream->memory->insert(stream->memory->end(), p, p + bytes);
+        return;
+    }
+    stream_hash(stream, data, bytes);
+    if (stream->file && stream->ok) stream->ok = fwrite(data, 1, bytes, stream->file) == bytes;
+}
+
+static bool get(CheckpointStream* stream, void* data, size_t bytes) {
+    stream->ok = stream->ok && fread(data, 1, bytes, stream->file) == bytes;
+    if (stream->ok) stream_hash(stream, data, bytes);
+    return stream->ok;
+}
+
+static void put_u64(CheckpointStream* stream, uint64_t value) { put(stream, &value, sizeof(value)); }
+static void put_f64(CheckpointStream* stream, double value) { put(stream, &value, sizeof(value)); }
+static uint64_t get_u64(CheckpointStream* stream) { uint64_t value = 0; get(stream, &value, sizeof(value)); return value; }
+static double get_f64(CheckpointStream* stream) { double value = 0.0; get(stream, &value, sizeof(value)); return value; }
+
+static void put_config(CheckpointStream* stream, const TrainingConfig* config) {  // Field by field: no padding or layout, and never the path pointer
+    put_u64(stream, (uint64_t)config->optimizer_type);
+    put_f64(stream, config->learning_rate);
+    put_f64(stream, config->momentum);
+    put_f64(stream, config->weight_decay);
+    put_u64(stream, config->batch_size);
+    put_u64(stream, config->max_epochs);
+    put_f64(stream, config->early_stopping_threshold);
+    put_u64(stream, config->use_curriculum ? 1 : 0);
+    put_u64(stream, config->use_pavlovian ? 1 : 0);
+    put_u64(stream, config->use_spaced_repetition ? 1 : 0);
+    put_f64(stream, config->mastery_threshold);
+    put_u64(stream, config->patience);
+    put_u64(stream, config->num_threads);
+    put_u64(stream, config->seed);
+    put_u64(stream, config->hogwild ? 1 : 0);
+    put_u64(stream, config->incremental_checkpoints ? 1 : 0);
+    put_u64(stream, config->checkpoint_interval);
+    put_u64(stream, config->async_checkpoints ? 1 : 0);
+}
+
+static void get_config(CheckpointStream* stream, TrainingConfig* config) {  // checkpoint_path is left as it was
+    config->optimizer_type = (OptimizerType)get_u64(stream);
+    config->learning_rate = get_f64(stream);
+    config->momentum = get_f64(stream);
+    config->weight_decay = get_f64(stream);
+    config->batch_size = get_u64(stream);
+    config->max_epochs = get_u64(stream);
+    config->early_stopping_threshold = get_f64(stream);
+    config->use_curriculum = get_u64(stream) != 0;
+    config->use_pavlovian = get_u64(stream) != 0;
+    config->use_spaced_repetition = get_u64(stream) != 0;
+    config->mastery_threshold = get_f64(stream);
+    config->patience = get_u64(stream);
+    config->num_threads = get_u64(stream);
+    config->seed = get_u64(stream);
+    config->hogwild = get_u64(stream) != 0;
+    config->incremental_checkpoints = get_u64(stream) != 0;
+    config->checkpoint_interval = get_u64(stream);
+    config->async_checkpoints = get_u64(stream) != 0;
+}
+
+static void put_stats(CheckpointStream* stream, const TrainingStats* stats) {
+    put_f64(stream, stats->current_loss);
+    put_f64(stream, stats->average_loss);
+    put_f64(stream, stats->accuracy);
+    put_u64(stream, stats->epoch);
+    put_u64(stream, stats->examples_seen);
+    put_u64(stream, (uint64_t)stats->current_level);
+    put_f64(stream, stats->training_time);
+    put_f64(stream, stats->validation_accuracy);
+    put_f64(stream, stats->validation_loss);
+    put_f64(stream, stats->checkpoint_latency);
+    put_f64(stream, stats->checkpoint_write_time);
+    put_u64(stream, stats->checkpoints_written);
+    put_u64(stream, stats->checkpoint_bytes_copied);
+}
+
+static void get_stats(CheckpointStream* stream, TrainingStats* stats) {
+    stats->current_loss = get_f64(stream);
+    stats->average_loss = get_f64(stream);
+    stats->accuracy = get_f64(stream);
+    stats->epoch = get_u64(stream);
+    stats->examples_seen = get_u64(stream);
+    stats->current_level = (DifficultyLevelEnum)get_u64(stream);
+    stats->training_time = get_f64(stream);
+    stats->validation_accuracy = get_f64(stream);
+    stats->validation_loss = get_f64(stream);
+    stats->checkpoint_latency = get_f64(stream);
+    stats->checkpoint_write_time = get_f64(stream);
+    stats->checkpoints_written = get_u64(stream);
+    stats->checkpoint_bytes_copied = get_u64(stream);
+}
+
+static void put_example_data(CheckpointStream* stream, const TrainingExample* ex) {
+    put_u64(stream, ex->input_size);
+    put_u64(stream, ex->target_size);
+    put_f64(stream, ex->difficulty);
+    put_u64(stream, ex->sparse_target ? 1 : 0);
+    put_u64(stream, ex->num_sparse);
+    put(stream, ex->input, ex->input_size * sizeof(double));
+    if (ex->sparse_target) put(stream, ex->sparse_target, ex->num_sparse * sizeof(SparseTargetEntry));
+    else put(stream, ex->target, ex->target_size * sizeof(double));
+}
+
+static void put_example_schedule(CheckpointStream* stream, const TrainingExample* ex) {
+    put_u64(stream, ex->is_correct ? 1 : 0);
+    put_u64(stream, ex->attempts);
+    put_u64(stream, ex->correct_streak);
+    put_f64(stream, ex->last_reviewed);
+    put_f64(stream, ex->next_review);
+}
+
+static bool get_example_data(CheckpointStream* stream, TrainingExample* ex) {  // Fills input and the dense or sparse target with new arrays
+    ex->input_size = get_u64(stream);
+    ex->target_size = get_u64(stream);
+    ex->difficulty = get_f64(stream);
+    bool sparse = get_u64(stream) != 0;
+    ex->num_sparse = get_u64(stream);
+    if (!stream->ok) return false;
+    ex->input = new double[ex->input_size];
+    get(stream, ex->input, ex->input_size * sizeof(double));
+    if (sparse) {
+        ex->sparse_target = new SparseTargetEntry[ex->num_sparse];
+        get(stream, ex->sparse_target, ex->num_sparse * sizeof(SparseTargetEntry));
+    } else {
+        ex->target = new double[ex->target_size];
+        get(stream, ex->target, ex->target_size * sizeof(double));
+    }
+    return stream->ok;
+}
+
+static void get_example_schedule(CheckpointStream* stream, TrainingExample* ex) {
+    ex->is_correct = get_u64(stream) != 0;
+    ex->attempts = get_u64(stream);
+    ex->correct_streak = get_u64(stream);
+    ex->last_reviewed = get_f64(stream);
+    ex->next_review = get_f64(stream);
+}
+
+static bool section_present(const TrainingEngine* engine, uint32_t id) {  // Components the engine was configured without have no section
+    switch (id) {
+        case SECTION_CURRICULUM:
+        case SECTION_CURRICULUM_EXAMPLES: return engine->curriculum != nullptr;
+        case SECTION_SCHEDULE:
+        case SECTION_SCHEDULE_EXAMPLES: return engine->spaced_repetition != nullptr;
+        default: return true;
+    }
+}
+
+static bool section_stamp(const TrainingEngine* engine, uint32_t id, uint64_t* stamp) {  // Cheap value that changes whenever a large section does
+    switch (id) {
+        case SECTION_NETWORK: *stamp = nn_get_weight_version(engine->network); return true;
+        case SECTION_OPTIMIZER: {
+            size_t step;
+            optimizer_get_state(engine->optimizer, nullptr, nullptr, &step);
+            *stamp = step;
+            return true;
+        }
+        case SECTION_CURRICULUM_EXAMPLES: {                            // Examples are only ever appended
+            CurriculumImpl* impl = (CurriculumImpl*)engine->curriculum;
+            *stamp = 0;
+            for (size_t l = 0; l < impl->num_levels; l++) *stamp += impl->levels[l].num_examples;
+            return true;
+        }
+        case SECTION_SCHEDULE_EXAMPLES: *stamp = engine->spaced_repetition->num_examples; return true;
+        default: return false;                                         // Engine, curriculum levels and schedule are small: always copied
     }
 }
 
-TrainingEngine* training_engine_load_checkpoint(const char* filepath) {
-    // Checkpoint loading (simplified)
+static void put_section(TrainingEngine* engine, uint32_t id, CheckpointStream* stream) {  // Serialize one section of the engine's state
+    switch (id) {
+        case SECTION_ENGINE: {
+            put_config(stream, &engine->config);
+            put_stats(stream, &engine->stats);
+            put_u64(stream, engine->shuffle_state);
+            put_u64(stream, engine->data_order ? engine->data_size : 0);
+            for (size_t i = 0; engine->data_order && i < engine->data_size; i++) put_u64(stream, engine->data_order[i]);
+            break;
+        }
+        case SECTION_NETWORK: {
+            size_t count = nn_get_parameter_count(engine->network);
+            put_u64(stream, nn_get_input_size(engine->network));
+            put_u64(stream, nn_get_hidden_size(engine->network));
+            put_u64(stream, nn_get_output_size(engine->network));
+            put_u64(stream, count);
+            put_u64(stream, (uint64_t)nn_get_precision(engine->network));
+            double chunk[512];                                         // Read through the network so mapped weights stay mapped
+            for (size_t first = 0; first < count; first += 512) {
+                size_t n = std::min<size_t>(512, count - first);
+                nn_read_parameters(engine->network, first, n, chunk);
+                put(stream, chunk, n * sizeof(double));
+            }
+            break;
+        }
+        case SECTION_OPTIMIZER: {
+            const double* first;
+            const double* second;
+            size_t step;
+            size_t count = optimizer_get_state(engine->optimizer, &first, &second, &step);
+            put_u64(stream, count);
+            put_u64(stream, step);
+            put_u64(stream, (first ? 1 : 0) | (second ? 2 : 0));
+            if (first) put(stream, first, count * sizeof(double));
+            if (second) put(stream, second, count * sizeof(double));
+            break;
+        }
+        case SECTION_CURRICULUM: {
+            CurriculumImpl* impl = (CurriculumImpl*)engine->curriculum;
+            put_u64(stream, impl->num_levels);
+            put_u64(stream, impl->current_level);
+            put_f64(stream, impl->mastery_threshold);
+            for (size_t l = 0; l < impl->num_levels; l++) {
+                put_f64(stream, impl->levels[l].mastery_threshold);
+                put_f64(stream, impl->levels[l].current_accuracy);
+                put_u64(stream, impl->levels[l].examples_seen);
+            }
+            break;
+        }
+        case SECTION_CURRICULUM_EXAMPLES: {
+            CurriculumImpl* impl = (CurriculumImpl*)engine->curriculum;
+            for (size_t l = 0; l < impl->num_levels; l++) {
+                put_u64(stream, impl->levels[l].num_examples);
+                for (size_t i = 0; i < impl->levels[l].num_examples; i++) {
+                    put_example_data(stream, &impl->levels[l].examples[i]);
+                    put_example_schedule(stream, &impl->levels[l].examples[i]);
+                }
+            }
+            break;
+        }
+        case SECTION_SCHEDULE:
+        case SECTION_SCHEDULE_EXAMPLES: {
+            SpacedRepetition* sr = engine->spaced_repetition;
+            put_u64(stream, sr->num_examples);
+            for (size_t i = 0; i < sr->num_examples; i++) {
+                if (id == SECTION_SCHEDULE) put_example_schedule(stream, &sr->examples[i]);
+                else put_example_data(stream, &sr->examples[i]);
+            }
+            break;
+        }
+    }
+}
+
+// Everything a restore would change, read from the section files before any of it is applied
+struct CheckpointRestore {
+    bool present[NUM_SECTIONS];
+    TrainingStats stats;
+    uint64_t shuffle_state;
+    std::vector<size_t> order;       // Empty unless it matches the engine's dataset
+    NNPrecision precision;
+    std::vector<double> parameters;
+    size_t optimizer_count;
+    size_t optimizer_step;
+    uint64_t optimizer_flags;        // Bit 0: first moments saved, bit 1: second moments
+    std::vector<double> first;
+    std::vector<double> second;
+    Curriculum* curriculum;          // Fresh copies, swapped in on commit
+    SpacedRepetition* spaced_repetition;
+};
+
+static void restore_init(CheckpointRestore* restore, const TrainingEngine* engine) {
+    for (int i = 0; i < NUM_SECTIONS; i++) restore->present[i] = false;
+    restore->curriculum = engine->curriculum ? curriculum_create(engine->curriculum->num_levels) : nullptr;
+    restore->spaced_repetition = engine->spaced_repetition ?
+        spaced_repetition_create(engine->spaced_repetition->capacity, engine->spaced_repetition->ltm_threshold) : nullptr;
+}
+
+static void restore_free(CheckpointRestore* restore) {            // Frees whatever was not swapped into the engine
+    curriculum_destroy(restore->curriculum);
+    spaced_repetition_destroy(restore->spaced_repetition);
+}
+
+static bool get_section(const TrainingEngine* engine, CheckpointRestore* restore, uint32_t id, CheckpointStream* stream) {  // Read one verified section into the restore
+    switch (id) {
+        case SECTION_ENGINE: {
+            TrainingConfig config;                                     // The engine keeps the config it was built with
+            get_config(stream, &config);
+            get_stats(stream, &restore->stats);
+            restore->shuffle_state = get_u64(stream);
+            size_t size = get_u64(stream);
+            if (size == engine->data_size && engine->data_order) {     // Epoch order only means something for the same dataset
+                restore->order.resize(size);
+                for (size_t i = 0; i < size; i++) restore->order[i] = get_u64(stream);
+            }
+            break;
+        }
+        case SECTION_NETWORK: {
+            for (int i = 0; i < 3; i++) get_u64(stream);               // Shape was checked before anything was read
+            size_t count = get_u64(stream);
+            restore->precision = (NNPrecision)get_u64(stream);
+            restore->parameters.resize(count);
+            get(stream, restore->parameters.data(), count * sizeof(double));
+            break;
+        }
+        case SECTION_OPTIMIZER: {
+            restore->optimizer_count = get_u64(stream);
+            restore->optimizer_step = get_u64(stream);
+            restore->optimizer_flags = get_u64(stream);
+            if (!stream->ok) break;
+            restore->first.resize((restore->optimizer_flags & 1) ? restore->optimizer_count : 0);
+            restore->second.resize((restore->optimizer_flags & 2) ? restore->optimizer_count : 0);
+            get(stream, restore->first.data(), restore->first.size() * sizeof(double));
+            get(stream, restore->second.data(), restore->second.size() * sizeof(double));
+            break;
+        }
+        case SECTION_CURRICULUM: {
+            CurriculumImpl* impl = (CurriculumImpl*)restore->curriculum;
+            get_u64(stream);                                           // Level count was checked up front
+            impl->current_level = get_u64(stream);
+            impl->mastery_threshold = get_f64(stream);
+            for (size_t l = 0; l < impl->num_levels; l++) {
+                impl->levels[l].mastery_threshold = get_f64(stream);
+                impl->levels[l].current_accuracy = get_f64(stream);
+                impl->levels[l].examples_seen = get_u64(stream);
+            }
+            if (impl->current_level >= impl->num_levels) stream->ok = false;
+            break;
+        }
+        case SECTION_CURRICULUM_EXAMPLES: {
+            CurriculumImpl* impl = (CurriculumImpl*)restore->curriculum;
+            for (size_t l = 0; l < impl->num_levels && stream->ok; l++) {
+                DifficultyLevel* level = &impl->levels[l];
+                size_t count = get_u64(stream);
+                for (size_t i = 0; i < count && stream->ok; i++) {
+                    TrainingExample ex;
+                    training_example_init(&ex);
+                    bool ok = get_example_data(stream, &ex);
+                    if (ok) {
+                        curriculum_add_example(restore->curriculum, &ex, (DifficultyLevelEnum)l);
+                        get_example_schedule(stream, &level->examples[level->num_examples - 1]);
+                    }
+                    training_example_release(&ex);
+                    if (!ok) break;
+                }
+            }
+            break;
+        }
+        case SECTION_SCHEDULE: {
+            SpacedRepetition* sr = restore->spaced_repetition;
+            size_t count = get_u64(stream);
+            for (size_t i = 0; i < count && stream->ok; i++) {
+                TrainingExample schedule;
+                get_example_schedule(stream, &schedule);
+                if (i < sr->num_examples) {                            // Examples section was read first
+                    sr->examples[i].is_correct = schedule.is_correct;
+                    sr->examples[i].attempts = schedule.attempts;
+                    sr->examples[i].correct_streak = schedule.correct_streak;
+                    sr->examples[i].last_reviewed = schedule.last_reviewed;
+                    sr->examples[i].next_review = schedule.next_review;
+                }
+            }
+            break;
+        }
+        case SECTION_SCHEDULE_EXAMPLES: {
+            SpacedRepetition* sr = restore->spaced_repetition;
+            size_t count = get_u64(stream);
+            for (size_t i = 0; i < count && stream->ok; i++) {
+                TrainingExample ex;
+                training_example_init(&ex);
+                bool ok = get_example_data(stream, &ex);
+                if (ok) spaced_repetition_add_example(sr, &ex);
+                training_example_release(&ex);
+                if (!ok) break;
+            }
+            break;
+        }
+    }
+    if (stream->ok) restore->present[id] = true;
+    return stream->ok;
+}
+
+static void commit_restore(TrainingEngine* engine, CheckpointRestore* restore) {  // Apply a fully read restore; cannot fail
+    if (restore->present[SECTION_ENGINE]) {
+        engine->stats = restore->stats;
+        engine->shuffle_state = restore->shuffle_state;
+        if (!restore->order.empty()) std::copy(restore->order.begin(), restore->order.end(), engine->data_order);
+    }
+    if (restore->present[SECTION_NETWORK]) {
+        nn_set_precision(engine->network, NN_PRECISION_FP64);      // Drop reduced-precision copies of the old weights
+        double* parameters = nn_get_parameters(engine->network, nullptr);  // A mapped model file is copied out first
+        std::copy(restore->parameters.begin(), restore->parameters.end(), parameters);
+        nn_set_precision(engine->network, restore->precision);
+    }
+    if (restore->present[SECTION_OPTIMIZER]) {
+        optimizer_set_state(engine->optimizer, restore->optimizer_count,
+                            (restore->optimizer_flags & 1) ? restore->first.data() : nullptr,
+                            (restore->optimizer_flags & 2) ? restore->second.data() : nullptr, restore->optimizer_step);
+    }
+    if (restore->present[SECTION_CURRICULUM] || restore->present[SECTION_CURRICULUM_EXAMPLES]) {
+        std::swap(engine->curriculum, restore->curriculum);           // The old curriculum is freed with the restore
+    }
+    if (restore->present[SECTION_SCHEDULE] || restore->present[SECTION_SCHEDULE_EXAMPLES]) {
+        std::swap(engine->spaced_repetition, restore->spaced_repetition);
+    }
+}
+
+static std::string section_path(const char* filepath, uint32_t id, uint64_t generation) {
+    return std::string(filepath) + "." + section_names[id] + "." + std::to_string(generation);
+}
+
+static bool read_manifest(const char* filepath, CheckpointManifest* manifest) {
     FILE* f = fopen(filepath, "rb");
-    if (!f) return nullptr;
+    if (!f) return false;
+    memset(manifest, 0, sizeof(*manifest));
+    bool ok = fread(manifest, 1, offsetof(CheckpointManifest, entries), f) == offsetof(CheckpointManifest, entries) &&
+              memcmp(manifest->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+              manifest->version == CHECKPOINT_VERSION &&
+              manifest->num_sections <= NUM_SECTIONS &&
+              fread(manifest->entries, sizeof(CheckpointEntry), manifest->num_sections, f) == manifest->num_sections;
+    fclose(f);
+    for (uint32_t i = 0; ok && i < manifest->num_sections; i++) ok = manifest->entries[i].id < NUM_SECTIONS;
+    return ok;
+}
+
+static const CheckpointEntry* find_entry(const CheckpointManifest* manifest, uint32_t id) {
+    for (uint32_t i = 0; i < manifest->num_sections; i++) {
+        if (manifest->entries[i].id == id) return &manifest->entries[i];
+    }
+    return nullptr;
+}
+
+static bool sync_and_close(FILE* f) {                                 // Flush to disk before any rename can publish the file
+    bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    return fclose(f) == 0 && ok;
+}
+
+// State of every section copied out of the engine, so a background thread can write it while training
+// mutates the originals. Buffers keep their capacity, so steady-state snapshots do not allocate
+struct CheckpointSnapshot {
+    std::vector<unsigned char> sections[NUM_SECTIONS];
+    bool present[NUM_SECTIONS];
+    bool stamped[NUM_SECTIONS];         // stamps[id] is the section's section_stamp
+    bool reused[NUM_SECTIONS];          // Unchanged since the last write to path: not copied, its file is kept
+    uint64_t stamps[NUM_SECTIONS];
+    std::string path;
+    bool incremental;
+};
+
+// Stamps of the sections the checkpoint at path holds, as last written by the background writer
+struct CheckpointWritten {
+    std::string path;                   // Empty: nothing known about the files on disk
+    bool stamped[NUM_SECTIONS];
+    uint64_t stamps[NUM_SECTIONS];
+};
+
+static size_t snapshot_fill(CheckpointSnapshot* snapshot, TrainingEngine* engine, const char* filepath,  // Copy the sections changed since
+                            const CheckpointWritten* written) {                                        // written; returns bytes copied
+    bool incremental = engine->config.incremental_checkpoints && written->path == filepath;
+    size_t bytes = 0;
+    for (uint32_t id = 0; id < NUM_SECTIONS; id++) {
+        snapshot->sections[id].clear();
+        snapshot->present[id] = section_present(engine, id);
+        snapshot->stamped[id] = snapshot->present[id] && section_stamp(engine, id, &snapshot->stamps[id]);
+        snapshot->reused[id] = incremental && snapshot->stamped[id] && written->stamped[id] &&
+                               written->stamps[id] == snapshot->stamps[id];
+        if (!snapshot->present[id] || snapshot->reused[id]) continue;
+        CheckpointStream stream;
+        stream_init(&stream, nullptr);
+        stream.memory = &snapshot->sections[id];
+        put_section(engine, id, &stream);
+        bytes += snapshot->sections[id].size();
+    }
+    snapshot->path = filepath;
+    snapshot->incremental = engine->config.incremental_checkpoints;
+    return bytes;
+}
+
+static void emit_section(TrainingEngine* engine, const CheckpointSnapshot* snapshot, uint32_t id, CheckpointStream* stream) {
+    if (snapshot) {
+        put(stream, snapshot->sections[id].data(), snapshot->sections[id].size());
+    } else {
+        put_section(engine, id, stream);
+    }
+}
+
+static bool write_checkpoint(TrainingEngine* engine, const CheckpointSnapshot* snapshot,  // Write changed sections of the live engine or a snapshot,
+                             const char* filepath, bool incremental) {                   // then publish them with one rename
+    CheckpointManifest previous;
+    bool have_previous = read_manifest(filepath, &previous);
+    CheckpointManifest manifest;
+    memset(&manifest, 0, sizeof(manifest));
+    memcpy(manifest.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    manifest.version = CHECKPOINT_VERSION;
+    manifest.generation = have_previous ? previous.generation + 1 : 1;
     
-    TrainingStats stats;
-    fread(&stats, sizeof(TrainingStats), 1, f);
+    bool ok = true;
+    for (uint32_t id = 0; id < NUM_SECTIONS && ok; id++) {
+        if (snapshot ? !snapshot->present[id] : !section_present(engine, id)) continue;
+        const CheckpointEntry* old = have_previous ? find_entry(&previous, id) : nullptr;
+        if (snapshot && snapshot->reused[id]) {                        // Not copied: the last write's file still holds it
+            ok = old && access(section_path(filepath, id, old->generation).c_str(), F_OK) == 0;
+            if (ok) manifest.entries[manifest.num_sections++] = *old;
+            continue;
+        }
+        if (incremental && old) {                                      // Keep the old file when the contents hash the same
+            CheckpointStream hash;
+            stream_init(&hash, nullptr);
+            emit_section(engine, snapshot, id, &hash);
+            if (hash.size == old->size && hash.checksum == old->checksum &&
+                access(section_path(filepath, id, old->generation).c_str(), F_OK) == 0) {
+                manifest.entries[manifest.num_sections++] = *old;
+                continue;
+            }
+        }
+        FILE* f = fopen(section_path(filepath, id, manifest.generation).c_str(), "wb");
+        if (!f) {
+            ok = false;
+            break;
+        }
+        CheckpointStream stream;
+        stream_init(&stream, f);
+        emit_section(engine, snapshot, id, &stream);
+        ok = sync_and_close(f) && stream.ok;
+        CheckpointEntry entry = {id, 0, manifest.generation, stream.size, stream.checksum};
+        manifest.entries[manifest.num_sections++] = entry;
+    }
+    
+    if (ok) {                                                          // Readers see the old manifest or the new one, never a torn one
+        std::string temp = std::string(filepath) + ".tmp";
+        FILE* f = fopen(temp.c_str(), "wb");
+        ok = f != nullptr;
+        if (f) {
+            size_t bytes = offsetof(CheckpointManifest, entries) + manifest.num_sections * sizeof(CheckpointEntry);
+            ok = fwrite(&manifest, 1, bytes, f) == bytes;
+            ok = sync_and_close(f) && ok;
+            ok = ok && rename(temp.c_str(), filepath) == 0;
+            if (!ok) remove(temp.c_str());
+        }
+    }
+    
+    if (ok) {                                                          // Files only the previous manifest named are unreachable now
+        for (uint32_t i = 0; have_previous && i < previous.num_sections; i++) {
+            const CheckpointEntry* entry = &previous.entries[i];
+            const CheckpointEntry* live = find_entry(&manifest, entry->id);
+            if (!live || live->generation != entry->generation) remove(section_path(filepath, entry->id, entry->generation).c_str());
+        }
+    } else {                                                           // Drop what this save wrote; the previous checkpoint is untouched
+        for (uint32_t i = 0; i < manifest.num_sections; i++) {
+            const CheckpointEntry* entry = &manifest.entries[i];
+            if (entry->generation == manifest.generation) remove(section_path(filepath, entry->id, entry->generation).c_str());
+        }
+    }
+    return ok;
+}
+
+// Background checkpoint writer. Each of the two snapshot slots is free, being filled by the training
+// thread, pending, or being written; with a single writer one slot is always free or pending, so the
+// training thread can always take one without waiting.
+enum SnapshotState { SNAPSHOT_FREE, SNAPSHOT_FILLING, SNAPSHOT_PENDING, SNAPSHOT_WRITING };
+
+struct CheckpointWriter {
+    TrainingEngine* engine;
+    CheckpointSnapshot slots[2];
+    SnapshotState states[2];
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;       // A snapshot is pending or the writer should stop
+    std::condition_variable idle;       // A write finished
+    CheckpointWritten last;             // Section stamps of the last successful write
+    double write_time;                  // Seconds the last finished write took
+    size_t written;                     // Writes finished since the engine last collected them
+    bool failed;                        // Some write failed since the last wait
+    bool stopping;
+};
+
+static void checkpoint_writer_run(CheckpointWriter* writer) {
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    for (;;) {
+        int slot = writer->states[0] == SNAPSHOT_PENDING ? 0 : writer->states[1] == SNAPSHOT_PENDING ? 1 : -1;
+        if (slot < 0) {
+            if (writer->stopping) return;                              // Pending snapshots are written before stopping
+            writer->wake.wait(lock);
+            continue;
+        }
+        writer->states[slot] = SNAPSHOT_WRITING;
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        const CheckpointSnapshot* snapshot = &writer->slots[slot];
+        bool ok = write_checkpoint(writer->engine, snapshot, snapshot->path.c_str(), snapshot->incremental);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+        writer->states[slot] = SNAPSHOT_FREE;
+        writer->write_time = elapsed;
+        if (ok) {                                                      // A failed write leaves the previous files in place
+            writer->last.path = snapshot->path;
+            std::copy(snapshot->stamped, snapshot->stamped + NUM_SECTIONS, writer->last.stamped);
+            std::copy(snapshot->stamps, snapshot->stamps + NUM_SECTIONS, writer->last.stamps);
+            writer->written++;
+        }
+        writer->failed = writer->failed || !ok;
+        writer->idle.notify_all();
+    }
+}
+
+static CheckpointWriter* checkpoint_writer_create(TrainingEngine* engine) {
+    CheckpointWriter* writer = new CheckpointWriter;
+    writer->engine = engine;
+    writer->states[0] = writer->states[1] = SNAPSHOT_FREE;
+    writer->write_time = 0.0;
+    writer->written = 0;
+    writer->failed = false;
+    writer->stopping = false;
+    writer->thread = std::thread(checkpoint_writer_run, writer);
+    return writer;
+}
+
+static void checkpoint_writer_destroy(CheckpointWriter* writer) {
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        writer->stopping = true;
+    }
+    writer->wake.notify_one();
+    writer->thread.join();
+    delete writer;
+}
+
+static void forget_written_checkpoint(TrainingEngine* engine) {       // Files or engine state changed behind the writer's back
+    CheckpointWriter* writer = engine->checkpoint_writer;
+    if (!writer) return;
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    writer->last.path.clear();
+}
+
+static void collect_checkpoint_stats(TrainingEngine* engine) {        // Fold finished background writes into the stats (caller holds the lock)
+    CheckpointWriter* writer = engine->checkpoint_writer;
+    if (writer->written > 0) engine->stats.checkpoint_write_time = writer->write_time;
+    engine->stats.checkpoints_written += writer->written;
+    writer->written = 0;
+}
+
+bool training_engine_wait_checkpoints(TrainingEngine* engine) {
+    CheckpointWriter* writer = engine->checkpoint_writer;
+    if (!writer) return true;
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    writer->idle.wait(lock, [&] {
+        return writer->states[0] == SNAPSHOT_FREE && writer->states[1] == SNAPSHOT_FREE;
+    });
+    collect_checkpoint_stats(engine);
+    bool ok = !writer->failed;
+    writer->failed = false;
+    return ok;
+}
+
+bool training_engine_save_checkpoint(TrainingEngine* engine, const char* filepath) {  // Synchronous save straight from the live engine
+    training_engine_wait_checkpoints(engine);                         // Background writes to the same manifest go first
+    auto start = std::chrono::steady_clock::now();
+    forget_written_checkpoint(engine);
+    bool ok = write_checkpoint(engine, nullptr, filepath, engine->config.incremental_checkpoints);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    engine->stats.checkpoint_latency = elapsed;                       // Training waited for the whole write
+    engine->stats.checkpoint_bytes_copied = 0;
+    if (ok) {
+        engine->stats.checkpoint_write_time = elapsed;
+        engine->stats.checkpoints_written++;
+    }
+    return ok;
+}
+
+bool training_engine_checkpoint(TrainingEngine* engine, const char* filepath) {  // Synchronous save, or snapshot and hand off to the writer thread
+    if (!engine->config.async_checkpoints) return training_engine_save_checkpoint(engine, filepath);
+    if (!engine->checkpoint_writer) engine->checkpoint_writer = checkpoint_writer_create(engine);
+    CheckpointWriter* writer = engine->checkpoint_writer;
+    
+    auto start = std::chrono::steady_clock::now();
+    int slot;
+    CheckpointWritten written;                                         // Only what reached disk counts: pending snapshots may be replaced
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        collect_checkpoint_stats(engine);                              // Stats go into the snapshot too
+        slot = writer->states[0] == SNAPSHOT_PENDING ? 0 : writer->states[1] == SNAPSHOT_PENDING ? 1 :  // A newer snapshot replaces
+               writer->states[0] == SNAPSHOT_FREE ? 0 : 1;                                           // one not yet written
+        writer->states[slot] = SNAPSHOT_FILLING;
+        written = writer->last;
+    }
+    engine->stats.checkpoint_bytes_copied = snapshot_fill(&writer->slots[slot], engine, filepath, &written);
+    engine->stats.checkpoint_latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        writer->states[slot] = SNAPSHOT_PENDING;
+    }
+    writer->wake.notify_one();
+    return true;
+}
+
+static bool verify_section(const char* filepath, const CheckpointEntry* entry) {  // Size and checksum of a section file, without applying it
+    FILE* f = fopen(section_path(filepath, entry->id, entry->generation).c_str(), "rb");
+    if (!f) return false;
+    CheckpointStream stream;
+    stream_init(&stream, nullptr);
+    std::vector<unsigned char> chunk(CHECKPOINT_CHUNK);
+    size_t bytes;
+    while ((bytes = fread(chunk.data(), 1, chunk.size(), f)) > 0) stream_hash(&stream, chunk.data(), bytes);
+    fclose(f);
+    return stream.size == entry->size && stream.checksum == entry->checksum;
+}
+
+static bool read_section_header(const char* filepath, const CheckpointEntry* entry, void* data, size_t bytes) {  // Leading bytes of a section
+    FILE* f = fopen(section_path(filepath, entry->id, entry->generation).c_str(), "rb");
+    if (!f) return false;
+    bool ok = fread(data, 1, bytes, f) == bytes;
+    fclose(f);
+    return ok;
+}
+
+bool training_engine_restore_checkpoint(TrainingEngine* engine, const char* filepath) {  // Verify every section, then apply them in order
+    training_engine_wait_checkpoints(engine);                         // The writer reads the state this replaces
+    CheckpointManifest manifest;
+    if (!read_manifest(filepath, &manifest)) return false;
+    for (uint32_t i = 0; i < manifest.num_sections; i++) {
+        if (!verify_section(filepath, &manifest.entries[i])) return false;
+    }
+    
+    const CheckpointEntry* network = find_entry(&manifest, SECTION_NETWORK);
+    uint64_t shape[4];                                                 // Input, hidden and output sizes, parameter count
+    size_t count = nn_get_parameter_count(engine->network);
+    if (!network || !read_section_header(filepath, network, shape, sizeof(shape)) ||
+        shape[0] != nn_get_input_size(engine->network) || shape[1] != nn_get_hidden_size(engine->network) ||
+        shape[2] != nn_get_output_size(engine->network) || shape[3] != count) {
+        return false;
+    }
+    const CheckpointEntry* curriculum = find_entry(&manifest, SECTION_CURRICULUM);
+    uint64_t num_levels;
+    if (curriculum && engine->curriculum &&
+        (!read_section_header(filepath, curriculum, &num_levels, sizeof(num_levels)) || num_levels != engine->curriculum->num_levels)) {
+        return false;
+    }
+    
+    static const uint32_t order[NUM_SECTIONS] = {                      // Schedules apply to examples read before them
+        SECTION_ENGINE, SECTION_NETWORK, SECTION_OPTIMIZER, SECTION_CURRICULUM, SECTION_CURRICULUM_EXAMPLES,
+        SECTION_SCHEDULE_EXAMPLES, SECTION_SCHEDULE
+    };
+    CheckpointRestore restore;
+    restore_init(&restore, engine);
+    bool ok = true;
+    for (uint32_t k = 0; k < NUM_SECTIONS && ok; k++) {               // Read everything first, so a failure leaves the engine as it was
+        const CheckpointEntry* entry = find_entry(&manifest, order[k]);
+        if (!entry || !section_present(engine, entry->id)) continue;
+        FILE* f = fopen(section_path(filepath, entry->id, entry->generation).c_str(), "rb");
+        ok = f != nullptr;
+        if (!f) break;
+        CheckpointStream stream;
+        stream_init(&stream, f);
+        ok = get_section(engine, &restore, entry->id, &stream);
+        fclose(f);
+    }
+    if (ok) {
+        commit_restore(engine, &restore);
+        forget_written_checkpoint(engine);                             // Stamps of the replaced state may repeat
+    }
+    restore_free(&restore);
+    return ok;
+}
+
+bool training_engine_remove_checkpoint(const char* filepath) {         // Sections first: a manifest left behind fails verification
+    CheckpointManifest manifest;
+    if (!read_manifest(filepath, &manifest)) return false;
+    bool ok = true;
+    for (uint32_t i = 0; i < manifest.num_sections; i++) {
+        const CheckpointEntry* entry = &manifest.entries[i];
+        ok = remove(section_path(filepath, entry->id, entry->generation).c_str()) == 0 && ok;
+    }
+    return remove(filepath) == 0 && ok;
+}
+
+TrainingEngine* training_engine_load_checkpoint(const char* filepath) {  // Rebuild network and engine from a checkpoint alone
+    CheckpointManifest manifest;
+    if (!read_manifest(filepath, &manifest)) return nullptr;
+    const CheckpointEntry* state = find_entry(&manifest, SECTION_ENGINE);
+    const CheckpointEntry* network = find_entry(&manifest, SECTION_NETWORK);
+    TrainingConfig config;
+    training_config_init(&config);                                    // No checkpoint path: it is never saved
+    uint64_t shape[3];
+    if (!state || !network || !read_section_header(filepath, network, shape, sizeof(shape))) return nullptr;
+    FILE* f = fopen(section_path(filepath, state->id, state->generation).c_str(), "rb");
+    if (!f) return nullptr;
+    CheckpointStream stream;
+    stream_init(&stream, f);
+    get_config(&stream, &config);
     fclose(f);
+    if (!stream.ok) return nullptr;
     
-    // Would reconstruct engine from checkpoint
-    return nullptr;
+    NeuralNetwork* nn = nn_create_hybrid(shape[0], shape[1], shape[2]);  // Weights come from the checkpoint
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    if (!training_engine_restore_checkpoint(engine, filepath)) {
+        training_engine_destroy(engine);
+        nn_destroy(nn);
+        return nullptr;
+    }
+    return engine;
 }
 
 void training_engine_train_progressive(TrainingEngine* engine, 
@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/training_shard.h"
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHARD_MAGIC "CCSHARD"
+#define SHARD_VERSION 1u
+#define SHARD_BYTE_ORDER 0x01020304u                 // Reads back swapped on a machine of the other endianness
+#define SHARD_PROBABILITY_SCALE 65535.0
+
+struct ShardHeader {
+    char magic[8];                   // SHARD_MAGIC, NUL padded
+    uint32_t version;
+    uint32_t header_size;            // Records start right after the header
+    uint32_t byte_order;
+    uint32_t reserved0;
+    uint32_t input_size;             // Network shape the feature and move indices address
+    uint32_t output_size;
+    uint64_t num_records;
+    uint64_t index_offset;           // num_records uint64 record offsets, 8-byte aligned, ending the file
+    uint64_t checksum;               // FNV-1a of everything after the header
+    uint64_t reserved1;
+};
+static_assert(sizeof(ShardHeader) == 64, "shard header layout is part of the file format");
+
+// Record: uint8 num_features, uint8 num_moves, uint16 zero, float value, then uint16 features[num_features],
+// uint16 moves[num_moves] and uint16 probabilities[num_moves] (scaled by 65535). Records start 2-byte aligned.
+struct ShardRecordHeader {
+    uint8_t num_features;
+    uint8_t num_moves;
+    uint16_t reserved;
+    float value;
+};
+static_assert(sizeof(ShardRecordHeader) == 8, "shard record layout is part of the file format");
+
+struct ShardWriter {
+    FILE* file;
+    char* path;
+    char* temp_path;
+    uint32_t input_size;
+    uint32_t output_size;
+    std::vector<uint64_t> offsets;   // Record offsets for the index
+    uint64_t position;               // Bytes written so far, header included
+    uint64_t checksum;
+    bool ok;
+};
+
+struct ShardReader {
+    void* mapping;
+    size_t mapping_size;
+    const ShardHeader* header;
+    const unsigned char* base;
+    const uint64_t* index;
+    size_t cursor;                   // Next record for shard_reader_next_batch
+};
+
+static uint64_t shard_hash(uint64_t h, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) h = (h ^ p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+static void writer_put(ShardWriter* writer, const void* data, size_t bytes) {
+    writer->checksum = shard_hash(writer->checksum, data, bytes);
+    writer->position += bytes;
+    if (writer->ok) writer->ok = fwrite(data, 1, bytes, writer->file) == bytes;
+}
+
+ShardWriter* shard_writer_create(const char* path, size_t input_size, size_t output_size) {
+    if (input_size == 0 || output_size == 0 || input_size > 65536 || output_size > 65536) return nullptr;  // Indices are stored as uint16
+    size_t path_length = strlen(path);
+    ShardWriter* writer = new ShardWriter();
+    writer->path = new char[path_length + 1];
+    memcpy(writer->path, path, path_length + 1);
+    writer->temp_path = new char[path_length + 5];
+    memcpy(writer->temp_path, path, path_length);
+    memcpy(writer->temp_path + path_length, ".tmp", 5);
+    writer->file = fopen(writer->temp_path, "wb");
+    if (!writer->file) {
+        delete[] writer->path;
+        delete[] writer->temp_path;
+        delete writer;
+        return nullptr;
+    }
+    writer->input_size = (uint32_t)input_size;
+    writer->output_size = (uint32_t)output_size;
+    writer->position = sizeof(ShardHeader);
+    writer->checksum = 0xCBF29CE484222325ULL;
+    ShardHeader placeholder = {};                                     // Filled in by shard_writer_close
+    writer->ok = fwrite(&placeholder, sizeof(placeholder), 1, writer->file) == 1;
+    return writer;
+}
+
+bool shard_writer_add(ShardWriter* writer, const uint16_t* features, size_t num_features,  // Append one packed record
+                      const uint16_t* moves, const double* probabilities, size_t num_moves,
+                      double value) {
+    if (!writer || num_features > SHARD_MAX_FEATURES || num_moves > SHARD_MAX_MOVES) return false;
+    for (size_t i = 0; i < num_features; i++) {
+        if (features[i] >= writer->input_size) return false;
+    }
+    for (size_t i = 0; i < num_moves; i++) {
+        if (moves[i] == 0 || moves[i] >= writer->output_size) return false;  // Output 0 holds the value
+        for (size_t j = 0; j < i; j++) {
+            if (moves[j] == moves[i]) return false;                    // Sparse rows list each output once
+        }
+    }
+
+    uint16_t quantized[SHARD_MAX_MOVES];
+    for (size_t i = 0; i < num_moves; i++) {
+        double p = std::min(1.0, std::max(0.0, probabilities[i]));
+        quantized[i] = (uint16_t)(p * SHARD_PROBABILITY_SCALE + 0.5);
+    }
+    ShardRecordHeader record = {};
+    record.num_features = (uint8_t)num_features;
+    record.num_moves = (uint8_t)num_moves;
+    record.value = (float)value;
+
+    writer->offsets.push_back(writer->position);
+    writer_put(writer, &record, sizeof(record));
+    writer_put(writer, features, num_features * sizeof(uint16_t));
+    writer_put(writer, moves, num_moves * sizeof(uint16_t));
+    writer_put(writer, quantized, num_moves * sizeof(uint16_t));
+    return writer->ok;
+}
+
+bool shard_writer_add_position(ShardWriter* writer, const ChessPosition* pos,  // Record with the position's active features
+                               const uint16_t* moves, const double* probabilities, size_t num_moves, double value) {
+    uint16_t features[64];
+    size_t num_features = chess_position_get_features(pos, features);
+    return shard_writer_add(writer, features, num_features, moves, probabilities, num_moves, value);
+}
+
+size_t shard_writer_size(const ShardWriter* writer) {
+    return writer ? writer->offsets.size() : 0;
+}
+
+bool shard_writer_close(ShardWriter* writer) {                        // Append the index, fill in the header, sync and rename into place
+    if (!writer) return false;
+    static const unsigned char padding[8] = {};
+    writer_put(writer, padding, (8 - writer->position % 8) % 8);
+
+    ShardHeader header = {};
+    memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    header.version = SHARD_VERSION;
+    header.header_size = sizeof(ShardHeader);
+    header.byte_order = SHARD_BYTE_ORDER;
+    header.input_size = writer->input_size;
+    header.output_size = writer->output_size;
+    header.num_records = writer->offsets.size();
+    header.index_offset = writer->position;
+    writer_put(writer, writer->offsets.data(), writer->offsets.size() * sizeof(uint64_t));
+    header.checksum = writer->checksum;
+
+    bool ok = writer->ok && fseek(writer->file, 0, SEEK_SET) == 0 &&
+              fwrite(&header, sizeof(header), 1, writer->file) == 1 &&
+              fflush(writer->file) == 0 && fsync(fileno(writer->file)) == 0;
+    ok = fclose(writer->file) == 0 && ok;
+    ok = ok && rename(writer->temp_path, writer->path) == 0;          // Readers never see a shard without its index
+    if (!ok) remove(writer->temp_path);
+    delete[] writer->path;
+    delete[] writer->temp_path;
+    delete writer;
+    return ok;
+}
+
+static bool shard_header_valid(const ShardHeader* header, size_t file_size) {
+    return memcmp(header->magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) == 0 &&
+           header->version == SHARD_VERSION &&
+           header->header_size == sizeof(ShardHeader) &&
+           header->byte_order == SHARD_BYTE_ORDER &&
+           header->input_size > 0 && header->input_size <= 65536 &&
+           header->output_size > 0 && header->output_size <= 65536 &&
+           header->index_offset % 8 == 0 &&
+           header->index_offset >= sizeof(ShardHeader) &&
+           header->index_offset <= file_size &&
+           (file_size - header->index_offset) / sizeof(uint64_t) == header->num_records;
+}
+
+ShardReader* shard_reader_open(const char* path) {                    // Map a shard read-only for sequential streaming
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ShardHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = (size_t)info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);                                                        // The mapping keeps the file open
+    if (mapping == MAP_FAILED) return nullptr;
+
+    const ShardHeader* header = static_cast<const ShardHeader*>(mapping);
+    if (!shard_header_valid(header, size)) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);                         // Read ahead aggressively, drop pages behind the cursor
+
+    ShardReader* reader = new ShardReader();
+    reader->mapping = mapping;
+    reader->mapping_size = size;
+    reader->header = header;
+    reader->base = static_cast<const unsigned char*>(mapping);
+    reader->index = reinterpret_cast<const uint64_t*>(reader->base + header->index_offset);
+    reader->cursor = 0;
+    return reader;
+}
+
+void shard_reader_close(ShardReader* reader) {
+    if (!reader) return;
+    munmap(reader->mapping, reader->mapping_size);
+    delete reader;
+}
+
+bool shard_reader_verify(ShardReader* reader) {
+    if (!reader) return false;
+    uint64_t checksum = shard_hash(0xCBF29CE484222325ULL, reader->base + sizeof(ShardHeader),
+                                   reader->mapping_size - sizeof(ShardHeader));
+    return checksum == reader->header->checksum;
+}
+
+size_t shard_reader_size(const ShardReader* reader) {
+    return reader ? (size_t)reader->header->num_records : 0;
+}
+
+size_t shard_reader_input_size(const ShardReader* reader) {
+    return reader ? reader->header->input_size : 0;
+}
+
+size_t shard_reader_output_size(const ShardReader* reader) {
+    return reader ? reader->header->output_size : 0;
+}
+
+static const uint16_t* record_entries(const ShardReader* reader, size_t i, ShardRecordHeader* record) {  // Features, moves, probabilities; null if malformed
+    const ShardHeader* header = reader->header;
+    uint64_t offset = reader->index[i];
+    if (offset < sizeof(ShardHeader) || offset % 2 != 0 || offset + sizeof(ShardRecordHeader) > header->index_offset) return nullptr;
+    memcpy(record, reader->base + offset, sizeof(*record));
+    size_t entries = record->num_features + 2 * (size_t)record->num_moves;
+    if (offset + sizeof(*record) + entries * sizeof(uint16_t) > header->index_offset) return nullptr;
+    return reinterpret_cast<const uint16_t*>(reader->base + offset + sizeof(*record));
+}
+
+static void decode_input(const ShardReader* reader, const ShardRecordHeader* record, const uint16_t* features, double* input) {
+    for (size_t f = 0; f < record->num_features; f++) {
+        if (features[f] < reader->header->input_size) input[features[f]] = 1.0;
+    }
+}
+
+static bool decode_record(const ShardReader* reader, size_t i, double* input, double* target) {  // Scatter one record into zeroed rows
+    const ShardHeader* header = reader->header;
+    ShardRecordHeader record;
+    const uint16_t* features = record_entries(reader, i, &record);
+    if (!features) return false;
+    const uint16_t* moves = features + record.num_features;
+    const uint16_t* probabilities = moves + record.num_moves;
+    decode_input(reader, &record, features, input);
+    target[0] = record.value;
+    for (size_t m = 0; m < record.num_moves; m++) {
+        if (moves[m] < header->output_size) target[moves[m]] = probabilities[m] / SHARD_PROBABILITY_SCALE;
+    }
+    return true;
+}
+
+size_t shard_reader_decode(ShardReader* reader, size_t first, size_t count,  // Stops early at the end of the shard or a malformed record
+                           double* inputs, size_t input_stride, double* targets, size_t target_stride) {
+    if (!reader || first >= reader->header->num_records) return 0;
+    count = std::min(count, (size_t)reader->header->num_records - first);
+    size_t input_size = reader->header->input_size;
+    size_t output_size = reader->header->output_size;
+    for (size_t b = 0; b < count; b++) {
+        double* input = inputs + b * input_stride;
+        double* target = targets + b * target_stride;
+        memset(input, 0, input_size * sizeof(double));
+        memset(target, 0, output_size * sizeof(double));
+        if (!decode_record(reader, first + b, input, target)) return b;
+    }
+    return count;
+}
+
+size_t shard_reader_next_batch(ShardReader* reader, size_t batch_size,
+                               double* inputs, size_t input_stride, double* targets, size_t target_stride) {
+    if (!reader) return 0;
+    size_t count = shard_reader_decode(reader, reader->cursor, batch_size, inputs, input_stride, targets, target_stride);
+    reader->cursor += count;
+    if (count < batch_size) reader->cursor = reader->header->num_records;  // A malformed record ends the stream
+    return count;
+}
+
+size_t shard_reader_next_batch_sparse(ShardReader* reader, size_t batch_size, double* inputs, size_t input_stride,  // Stops early like decode
+                                      size_t* offsets, uint32_t* indices, double* values) {
+    if (!reader) return 0;
+    const ShardHeader* header = reader->header;
+    size_t count = std::min(batch_size, (size_t)header->num_records - reader->cursor);
+    size_t b = 0;
+    offsets[0] = 0;
+    for (; b < count; b++) {
+        ShardRecordHeader record;
+        const uint16_t* features = record_entries(reader, reader->cursor + b, &record);
+        if (!features) break;
+        const uint16_t* moves = features + record.num_features;
+        const uint16_t* probabilities = moves + record.num_moves;
+        double* input = inputs + b * input_stride;
+        memset(input, 0, header->input_size * sizeof(double));
+        decode_input(reader, &record, features, input);
+        size_t n = offsets[b];
+        indices[n] = 0;
+        values[n++] = record.value;
+        for (size_t m = 0; m < record.num_moves; m++) {
+            if (moves[m] == 0 || moves[m] >= header->output_size) continue;
+            indices[n] = moves[m];
+            values[n++] = probabilities[m] / SHARD_PROBABILITY_SCALE;
+        }
+        offsets[b + 1] = n;
+    }
+    reader->cursor += b;
+    if (b < batch_size) reader->cursor = header->num_records;         // A malformed record ends the stream
+    return b;
+}
+
+void shard_reader_rewind(ShardReader* reader) {
+    if (reader) reader->cursor = 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2025, Shyamal Suhana Chandra
+ * All rights reserved.
+ */
+#include "../include/transposition_table.h"
+#include <atomic>
+#include <cmath>
+
+// Entry data word layout (64 bits):
+//   bits  0-15 packed move      bits 16-31 score (int16, 1/8192 units)
+//   bits 32-47 eval (int16, EVAL_NONE if absent)
+//   bits 48-55 depth            bits 56-57 bound       bits 58-62 generation
+//   bit  63 valid: set in every stored entry, so none packs to the empty word 0
+#define TT_SCALE 8192.0
+#define TT_LIMIT 3.99
+#define TT_EVAL_NONE ((int16_t)-32768)
+#define TT_ENTRIES_PER_BUCKET 4
+#define TT_DEPTH_SLOTS 2
+#define TT_GENERATION_MASK 31
+#define TT_VALID (1ULL << 63)
+
+struct alignas(64) TTBucket {
+    std::atomic<uint64_t> words[TT_ENTRIES_PER_BUCKET * 2];  // (key ^ data, data) pairs
+};
+
+struct TranspositionTable {
+    TTBucket* buckets;
+    size_t num_buckets;
+    size_t size_mb;
+    std::atomic<unsigned> generation;
+};
+
+static inline int16_t quantize(double value) {
+    if (value > TT_LIMIT) value = TT_LIMIT;
+    if (value < -TT_LIMIT) value = -TT_LIMIT;
+    return (int16_t)lround(value * TT_SCALE);
+}
+
+static inline uint64_t pack_data(uint16_t move, int16_t score, int16_t eval, int depth, TTBound bound, unsigned gen) {
+    if (depth < 0) depth = 0;
+    if (depth > 255) depth = 255;
+    return (uint64_t)move | ((uint64_t)(uint16_t)score << 16) | ((uint64_t)(uint16_t)eval << 32) |
+           ((uint64_t)depth << 48) | ((uint64_t)bound << 56) | ((uint64_t)(gen & TT_GENERATION_MASK) << 58) | TT_VALID;
+}
+
+static inline uint16_t data_move(uint64_t d) { return (uint16_t)d; }
+static inline int16_t data_score(uint64_t d) { return (int16_t)(uint16_t)(d >> 16); }
+static inline int16_t data_eval(uint64_t d) { return (int16_t)(uint16_t)(d >> 32); }
+static inline int data_depth(uint64_t d) { return (int)((d >> 48) & 0xFF); }
+static inline TTBound data_bound(uint64_t d) { return (TTBound)((d >> 56) & 3); }
+static inline unsigned data_gen(uint64_t d) { return (unsigned)(d >> 58) & TT_GENERATION_MASK; }
+
+static inline TTBucket* bucket_for(const TranspositionTable* tt, uint64_t key) {  // Map key onto bucket range without modulo bias
+    return &tt->buckets[(size_t)(((unsigned __int128)key * tt->num_buckets) >> 64)];
+}
+
+static inline uint64_t load_entry(const TTBucket* bucket, int slot, uint64_t key) {  // Return data word if slot verifiably holds key, else zero
+    uint64_t data = bucket->words[slot * 2 + 1].load(std::memory_order_relaxed);
+    uint64_t check = bucket->words[slot * 2].load(std::memory_order_relaxed);
+    return (data != 0 && (check ^ data) == key) ? data : 0;
+}
+
+static inline void write_entry(TTBucket* bucket, int slot, uint64_t key, uint64_t data) {
+    bucket->words[slot * 2].store(key ^ data, std::memory_order_relaxed);
+    bucket->words[slot * 2 + 1].store(data, std::memory_order_relaxed);
+}
+
+TranspositionTable* transposition_table_create(size_t size_mb) {        // Allocate zeroed table of cache-line buckets totalling size_mb megabytes
+    TranspositionTable* tt = new TranspositionTable;                   // Allocate table header
+    tt->size_mb = size_mb > 0 ? size_mb : 1;                           // Never allocate an empty table
+    tt->num_buckets = tt->size_mb * 1024 * 1024 / sizeof(TTBucket);    // Number of 64-byte buckets fitting in requested memory
+    tt->buckets = new TTBucket[tt->num_buckets];                       // Over-aligned new keeps every bucket on its own cache line
+    tt->generation.store(0, std::memory_order_relaxed);
+    transposition_table_clear(tt);                                     // Zero all entries so empty slots fail verification
+    return tt;
+}
+
+void transposition_table_destroy(TranspositionTable* tt) {
+    if (tt) {
+        delete[] tt->buckets;
+        delete tt;
+    }
+}
+
+void transposition_table_clear(TranspositionTable* tt) {
+    for (size_t i = 0; i < tt->num_buckets; i++) {
+        for (int w = 0; w < TT_ENTRIES_PER_BUCKET * 2; w++) {
+            tt->buckets[i].words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t transposition_table_size_mb(const TranspositionTable* tt) {
+    return tt->size_mb;
+}
+
+void transposition_table_new_search(TranspositionTable* tt) {
+    tt->generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool transposition_table_probe(TranspositionTable* tt, uint64_t key, TTEntry* entry) {  // Look up key in its bucket and decode verified entry
+    const TTBucket* bucket = bucket_for(tt, key);                      // Locate bucket for key
+    for (int slot = 0; slot < TT_ENTRIES_PER_BUCKET; slot++) {         // Scan all four entries of bucket
+        uint64_t data = load_entry(bucket, slot, key);                 // Verify entry against key to reject torn or foreign data
+        if (!data) continue;
+        entry->move = data_move(data);
+        entry->score = data_score(data) / TT_SCALE;
+        entry->has_eval = data_eval(data) != TT_EVAL_NONE;
+        entry->eval = entry->has_eval ? data_eval(data) / TT_SCALE : 0.0;
+        entry->depth = data_depth(data);
+        entry->bound = data_bound(data);
+        return true;
+    }
+    return false;
+}
+
+static inline unsigned entry_age(const TranspositionTable* tt, uint64_t data) {
+    return (tt->generation.load(std::memory_order_relaxed) - data_gen(data)) & TT_GENERATION_MASK;
+}
+
+// Picks the always-replace slot to overwrite: an empty one, else the older, else the shallower
+static int always_replace_slot(const TranspositionTable* tt, const TTBucket* bucket) {
+    uint64_t a = bucket->words[TT_DEPTH_SLOTS * 2 + 1].load(std::memory_order_relaxed);
+    uint64_t b = bucket->words[TT_DEPTH_SLOTS * 2 + 3].load(std::memory_order_relaxed);
+    if (!a) return TT_DEPTH_SLOTS;
+    if (!b) return TT_DEPTH_SLOTS + 1;
+    if (entry_age(tt, a) != entry_age(tt, b)) return entry_age(tt, a) > entry_age(tt, b) ? TT_DEPTH_SLOTS : TT_DEPTH_SLOTS + 1;
+    return data_depth(a) <= data_depth(b) ? TT_DEPTH_SLOTS : TT_DEPTH_SLOTS + 1;
+}
+
+static void store_data(TranspositionTable* tt, uint64_t key, uint64_t data) {  // Place new entry using depth-preferred then always-replace policy
+    TTBucket* bucket = bucket_for(tt, key);                            // Locate bucket for key
+
+    int victim = 0;                                                    // Depth-preferred slot holding least valuable entry
+    int victim_worth = 1 << 30;
+    for (int slot = 0; slot < TT_DEPTH_SLOTS; slot++) {
+        uint64_t old = bucket->words[slot * 2 + 1].load(std::memory_order_relaxed);
+        int worth = old ? data_depth(old) - 8 * (int)entry_age(tt, old) : -1;  // Empty beats stale beats shallow
+        if (worth < victim_worth) {
+            victim = slot;
+            victim_worth = worth;
+        }
+    }
+
+    if (data_depth(data) >= victim_worth) {                            // Deep enough to claim depth-preferred slot
+        uint64_t displaced = bucket->words[victim * 2 + 1].load(std::memory_order_relaxed);
+        uint64_t displaced_key = bucket->words[victim * 2].load(std::memory_order_relaxed) ^ displaced;
+        write_entry(bucket, victim, key, data);
+        if (displaced && entry_age(tt, displaced) == 0) {              // Keep evicted current-search entry in always-replace slot
+            write_entry(bucket, always_replace_slot(tt, bucket), displaced_key, displaced);
+        }
+    } else {
+        write_entry(bucket, always_replace_slot(tt, bucket), key, data);
+    }
+}
+
+void transposition_table_store(TranspositionTable* tt, uint64_t key, uint16_t move,  // Record search result merging with any entry for same key
+                               double score, int depth, TTBound bound) {
+    TTBucket* bucket = bucket_for(tt, key);                            // Locate bucket for key
+    unsigned gen = tt->generation.load(std::memory_order_relaxed);     // Tag entry with current search generation
+
+    for (int slot = 0; slot < TT_ENTRIES_PER_BUCKET; slot++) {         // Update existing entry for key in place
+        uint64_t old = load_entry(bucket, slot, key);
+        if (!old) continue;
+        if (move == 0) move = data_move(old);                          // Keep known best move when new result has none
+        if (bound != TT_BOUND_EXACT && depth < data_depth(old) - 2 && entry_age(tt, old) == 0) {  // Keep deeper result of this search
+            write_entry(bucket, slot, key, pack_data(move, data_score(old), data_eval(old), data_depth(old), data_bound(old), gen));
+        } else {
+            write_entry(bucket, slot, key, pack_data(move, quantize(score), data_eval(old), depth, bound, gen));
+        }
+        return;
+    }
+
+    store_data(tt, key, pack_data(move, quantize(score), TT_EVAL_NONE, depth, bound, gen));
+}
+
+void transposition_table_store_eval(TranspositionTable* tt, uint64_t key, double eval) {  // Cache network evaluation alongside any search data for key
+    TTBucket* bucket = bucket_for(tt, key);                            // Locate bucket for key
+    unsigned gen = tt->generation.load(std::memory_order_relaxed);
+
+    for (int slot = 0; slot < TT_ENTRIES_PER_BUCKET; slot++) {         // Attach evaluation to existing entry for key
+        uint64_t old = load_entry(bucket, slot, key);
+        if (!old) continue;
+        write_entry(bucket, slot, key, pack_data(data_move(old), data_score(old), quantize(eval),
+                                                 data_depth(old), data_bound(old), gen));
+        return;
+    }
+
+    store_data(tt, key, pack_data(0, 0, quantize(eval), 0, TT_BOUND_NONE, gen));
+}
+
+size_t transposition_table_hashfull(const TranspositionTable* tt) {   // Estimate table fill from a fixed sample of buckets
+    size_t sample = tt->num_buckets < 250 ? tt->num_buckets : 250;
+    size_t used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (int slot = 0; slot < TT_ENTRIES_PER_BUCKET; slot++) {
+            uint64_t data = tt->buckets[i].words[slot * 2 + 1].load(std::memory_order_relaxed);
+            if (data && entry_age(tt, data) == 0) used++;
+        }
+    }
+    return sample ? used * 1000 / (sample * TT_ENTRIES_PER_BUCKET) : 0;
+}
@@ -16,6 +16,8 @@ char* test_optimizer_comparison(void) {
     NeuralNetwork* nn2 = nn_create_hybrid(100, 50, 10);
     
     TrainingConfig config1, config2;
+    training_config_init(&config1);
+    training_config_init(&config2);
     config1.optimizer_type = OPTIMIZER_SGD;
     config1.learning_rate = 0.01;
     config1.use_curriculum = false;
@@ -52,6 +54,8 @@ char* test_curriculum_vs_no_curriculum(void) {
     NeuralNetwork* nn2 = nn_create_hybrid(100, 50, 10);
     
     TrainingConfig config1, config2;
+    training_config_init(&config1);
+    training_config_init(&config2);
     config1.optimizer_type = OPTIMIZER_ADAM;
     config1.learning_rate = 0.001;
     config1.use_curriculum = true;
@@ -87,6 +91,8 @@ char* test_pavlovian_vs_no_pavlovian(void) {
     NeuralNetwork* nn2 = nn_create_hybrid(100, 50, 10);
     
     TrainingConfig config1, config2;
+    training_config_init(&config1);
+    training_config_init(&config2);
     config1.optimizer_type = OPTIMIZER_ADAM;
     config1.learning_rate = 0.001;
     config1.use_curriculum = false;
@@ -133,6 +139,8 @@ char* test_learning_rate_comparison(void) {
     NeuralNetwork* nn2 = nn_create_hybrid(100, 50, 10);
     
     TrainingConfig config1, config2;
+    training_config_init(&config1);
+    training_config_init(&config2);
     config1.optimizer_type = OPTIMIZER_ADAM;
     config1.learning_rate = 0.001;
     config1.use_curriculum = false;
@@ -188,6 +196,8 @@ char* test_spaced_repetition_comparison(void) {
     NeuralNetwork* nn2 = nn_create_hybrid(100, 50, 10);
     
     TrainingConfig config1, config2;
+    training_config_init(&config1);
+    training_config_init(&config2);
     config1.optimizer_type = OPTIMIZER_ADAM;
     config1.learning_rate = 0.001;
     config1.use_curriculum = false;
@@ -205,6 +215,7 @@ char* test_spaced_repetition_comparison(void) {
     // Test spaced repetition
     if (engine1->spaced_repetition) {
         TrainingExample example;
+        training_example_init(&example);
         example.input_size = 100;
         example.target_size = 10;
         example.difficulty = 0.5;
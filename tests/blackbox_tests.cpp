@@ -16,6 +16,7 @@ char* test_end_to_end_training_inference(void) {
     
     // Train
     TrainingConfig config;
+    training_config_init(&config);
     config.optimizer_type = OPTIMIZER_ADAM;
     config.learning_rate = 0.001;
     config.use_curriculum = true;
@@ -80,6 +81,7 @@ char* test_curriculum_progression_blackbox(void) {
     NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
     
     TrainingConfig config;
+    training_config_init(&config);
     config.optimizer_type = OPTIMIZER_ADAM;
     config.learning_rate = 0.001;
     config.use_curriculum = true;
@@ -158,6 +160,7 @@ char* test_full_feature_training(void) {
     NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
     
     TrainingConfig config;
+    training_config_init(&config);
     config.optimizer_type = OPTIMIZER_ADAM;
     config.learning_rate = 0.001;
     config.use_curriculum = true;
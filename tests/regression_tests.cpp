@@ -65,6 +65,7 @@ char* test_spaced_repetition_intervals(void) {
     SpacedRepetition* sr = spaced_repetition_create(100, 5.0);
     
     TrainingExample example;
+    training_example_init(&example);
     example.input_size = 10;
     example.target_size = 5;
     example.difficulty = 0.5;
@@ -117,6 +118,7 @@ char* test_fen_roundtrip(void) {
 char* test_training_stats_regression(void) {
     NeuralNetwork* nn = nn_create_hybrid(100, 50, 10);
     TrainingConfig config;
+    training_config_init(&config);
     config.optimizer_type = OPTIMIZER_SGD;
     config.learning_rate = 0.01;
     config.use_curriculum = true;
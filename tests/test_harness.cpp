@@ -8,6 +8,31 @@
 #include <cstring>
 #include <ctime>
 #include <cstdio>
+#include <atomic>
+#include <new>
+
+// Counting replacements for the global allocation functions
+static std::atomic<size_t> allocation_count(0);
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { free(ptr); }
+
+size_t test_allocation_count(void) {
+    return allocation_count.load(std::memory_order_relaxed);
+}
 
 TestSuite* test_suite_create(const char* name) {
     TestSuite* suite = new TestSuite;
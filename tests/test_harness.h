@@ -98,6 +98,10 @@ void test_suite_add_test(TestSuite* suite, const char* test_name, TestFunction t
 void test_suite_run(TestSuite* suite);
 void test_suite_print_results(TestSuite* suite);
 
+// Number of operator new calls made by the test binary so far; the difference
+// across a block of code shows whether it allocated
+size_t test_allocation_count(void);
+
 // Test runner
 void run_all_tests(void);
 
@@ -6,11 +6,22 @@
 #include "../include/neural_network.h"
 #include "../include/curriculum_learning.h"
 #include "../include/chess_representation.h"
+#include "../include/bitboard.h"
 #include "../include/pavlovian_learning.h"
 #include "../include/training_engine.h"
+#include "../include/training_shard.h"
 #include "../include/inference_engine.h"
+#include "../include/transposition_table.h"
+#include "../include/search.h"
+#include "../include/mcts.h"
+#include "../include/nn_kernels.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Unit Test: Neural Network Creation
 char* test_nn_create_hybrid(void) {
@@ -52,6 +63,551 @@ char* test_nn_backward_pass(void) {
     return nullptr;
 }
 
+// Unit Test: Forward/Backward Passes Do Not Allocate
+char* test_nn_no_allocation(void) {
+    NeuralNetwork* nn = nn_create_hybrid(64, 16, 32);
+    Optimizer* opt = optimizer_create(OPTIMIZER_SGD, 0.01);
+    double input[64];
+    double target[32];
+    double output[32];
+    for (size_t i = 0; i < 64; i++) input[i] = 0.01 * (double)i;
+    for (size_t i = 0; i < 32; i++) target[i] = 0.5;
+    for (size_t i = 0; i < 32; i++) output[i] = NAN;
+    
+    nn_forward(nn, input, output);                                     // Warm up before counting
+    double loss;
+    nn_backward(nn, target, &loss);
+    optimizer_update(opt, nn);                                         // First update allocates the optimizer state
+    nn_train_batch(nn, opt, input, target, 1, 1);                      // First mini-batch allocates its workspace
+    for (size_t i = 16; i < 32; i++) ASSERT(output[i] == 0.0, "Outputs past the hidden state should be zeroed");
+    
+    size_t before = test_allocation_count();
+    for (int i = 0; i < 100; i++) {
+        nn_forward(nn, input, output);
+        nn_backward(nn, target, &loss);
+    }
+    nn_train_batch(nn, opt, input, target, 1, 10);
+    ASSERT_EQ(test_allocation_count() - before, 0, "Steady-state forward/backward should not allocate");
+    
+    optimizer_destroy(opt);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Mini-Batch Gradients Match Per-Sample Backward Passes
+char* test_nn_backward_batch(void) {
+    const size_t I = 20, H = 6, O = 4, B = 70;                         // Crosses a batch chunk; hidden wider than the output
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    double inputs[B * I], targets[B * O], outputs[B * O], expected_out[B * O], output[O];
+    for (size_t i = 0; i < B * I; i++) inputs[i] = (i * 7) % 5 == 0 ? 1.0 : 0.1 * sin((double)i);
+    for (size_t i = 0; i < B * O; i++) targets[i] = 0.5 * cos(0.3 * (double)i);
+    nn_forward_batch(nn, inputs, I, B, expected_out, O);
+    
+    size_t count;
+    double* grads = nn_get_gradients(nn, &count);
+    double* expected = new double[count]();
+    double expected_loss = 0.0;
+    for (size_t b = 0; b < B; b++) {                                   // Reference: mean of the single-sample gradients
+        nn_zero_gradients(nn);
+        nn_forward(nn, inputs + b * I, output);
+        double loss;
+        nn_backward(nn, targets + b * O, &loss);
+        expected_loss += loss / B;
+        for (size_t i = 0; i < count; i++) expected[i] += grads[i] / B;
+    }
+    
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        nn_kernels_select((NNKernelISA)isa);
+        nn_zero_gradients(nn);
+        double loss = nn_backward_batch(nn, inputs, I, targets, O, B, outputs, O);
+        ASSERT_FLOAT_EQ(loss, expected_loss, 1e-12, "Mini-batch loss should be the mean sample loss");
+        for (size_t i = 0; i < B * O; i++) {
+            ASSERT_FLOAT_EQ(outputs[i], expected_out[i], 1e-12, "Mini-batch outputs should match the batched forward");
+        }
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_FLOAT_EQ(grads[i], expected[i], 1e-12, "Mini-batch gradient should average the sample gradients");
+        }
+    }
+    nn_kernels_select(best);
+    
+    Optimizer* opt = optimizer_create(OPTIMIZER_ADAM, 0.01);           // One step per epoch should fit the batch
+    nn_zero_gradients(nn);
+    double before = nn_backward_batch(nn, inputs, I, targets, O, B, nullptr, 0);
+    nn_zero_gradients(nn);
+    nn_train_batch(nn, opt, inputs, targets, B, 50);
+    double after = nn_backward_batch(nn, inputs, I, targets, O, B, nullptr, 0);
+    ASSERT(after < before, "Mini-batch training should reduce the loss");
+    
+    optimizer_destroy(opt);
+    delete[] expected;
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Sparse-Target Backward Matches The Zero-Filled Dense Targets
+char* test_nn_backward_batch_sparse(void) {
+    const size_t I = 20, H = 6, O = 16, B = 70, E = 3;                 // Output wider than hidden: some entries land on always-zero outputs
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    double inputs[B * I], targets[B * O] = {}, dense_out[B * O], sparse_out[B * O], values[B * E];
+    size_t offsets[B + 1];
+    uint32_t indices[B * E];
+    for (size_t i = 0; i < B * I; i++) inputs[i] = (i * 7) % 5 == 0 ? 1.0 : 0.1 * sin((double)i);
+    for (size_t b = 0; b <= B; b++) offsets[b] = b * E;
+    for (size_t b = 0; b < B; b++) {
+        for (size_t k = 0; k < E; k++) {
+            indices[b * E + k] = (uint32_t)((b + 5 * k) % O);            // Increasing and distinct within the row
+            values[b * E + k] = 0.2 + 0.1 * (double)k;
+            targets[b * O + indices[b * E + k]] = values[b * E + k];
+        }
+        std::sort(indices + b * E, indices + (b + 1) * E);
+        for (size_t k = 0; k < E; k++) values[b * E + k] = targets[b * O + indices[b * E + k]];
+    }
+    
+    size_t count;
+    double* grads = nn_get_gradients(nn, &count);
+    nn_zero_gradients(nn);
+    double dense_loss = nn_backward_batch(nn, inputs, I, targets, O, B, dense_out, O);
+    double* expected = new double[count];
+    memcpy(expected, grads, count * sizeof(double));
+    
+    nn_zero_gradients(nn);
+    NNSparseTargets sparse = {offsets, indices, values};
+    double sparse_loss = nn_backward_batch_sparse(nn, inputs, I, &sparse, B, sparse_out, O);
+    ASSERT_FLOAT_EQ(sparse_loss, dense_loss, 1e-12, "Sparse targets should give the dense loss");
+    for (size_t b = 0; b < B; b++) {
+        for (size_t i = 0; i < H; i++) {
+            ASSERT_FLOAT_EQ(sparse_out[b * O + i], dense_out[b * O + i], 1e-12, "Sparse backward should write the live outputs");
+        }
+        for (size_t i = H; i < O; i++) ASSERT(dense_out[b * O + i] == 0.0, "Outputs past the hidden size should be zero");
+    }
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_FLOAT_EQ(grads[i], expected[i], 1e-12, "Sparse targets should give the dense gradients");
+    }
+    
+    delete[] expected;
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: SIMD Kernels Match Scalar Reference On Every Supported ISA
+char* test_nn_kernels(void) {
+    const size_t rows = 13, cols = 37;                                 // Odd sizes exercise remainder rows and masked tails
+    double W[rows * cols], x[cols], bias[rows], y[rows], expected[rows];
+    for (size_t i = 0; i < rows * cols; i++) W[i] = sin(0.37 * (double)i);
+    for (size_t i = 0; i < cols; i++) x[i] = cos(0.11 * (double)i);
+    for (size_t r = 0; r < rows; r++) {
+        bias[r] = 0.01 * (double)r;
+        expected[r] = bias[r];
+        for (size_t c = 0; c < cols; c++) expected[r] += W[r * cols + c] * x[c];
+    }
+    
+    const size_t n = 203;
+    double act[n], sig[n], th[n];
+    
+    NeuralNetwork* nn = nn_create_hybrid(64, 32, 32);
+    double input[64], reference[32], output[32];
+    for (size_t i = 0; i < 64; i++) input[i] = 0.02 * (double)i - 0.5;
+    nn_kernels_select(NN_ISA_SCALAR);
+    nn_forward(nn, input, reference);
+    
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        ASSERT(nn_kernels_select((NNKernelISA)isa) == (NNKernelISA)isa, "Supported ISA should be selectable");
+        nn_kernel_gemv(W, x, bias, y, rows, cols);
+        for (size_t r = 0; r < rows; r++) ASSERT_FLOAT_EQ(y[r], expected[r], 1e-12, "GEMV should match reference");
+        
+        for (size_t i = 0; i < n; i++) sig[i] = th[i] = act[i] = -40.0 + 0.4 * (double)i;
+        nn_kernel_sigmoid(sig, n);
+        nn_kernel_tanh(th, n);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_FLOAT_EQ(sig[i], 1.0 / (1.0 + exp(-act[i])), 1e-13, "Sigmoid should match libm");
+            ASSERT_FLOAT_EQ(th[i], tanh(act[i]), 1e-13, "Tanh should match libm");
+        }
+        
+        nn_forward(nn, input, output);
+        for (size_t i = 0; i < 32; i++) ASSERT_FLOAT_EQ(output[i], reference[i], 1e-12, "Forward pass should not depend on ISA");
+    }
+    ASSERT(nn_kernels_isa() == best, "Last selection should be active");
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Batched GEMM Forward Matches Per-Sample Forward
+char* test_nn_forward_batch(void) {
+    const size_t M = 7, N = 70, K = 301;                               // Crosses the K and N cache blocks and leaves ragged tiles
+    double* A = new double[M * K];
+    double* W = new double[N * K];
+    double bias[N], C[M * N];
+    for (size_t i = 0; i < M * K; i++) A[i] = sin(0.13 * (double)i);
+    for (size_t i = 0; i < N * K; i++) W[i] = cos(0.07 * (double)i);
+    for (size_t n = 0; n < N; n++) bias[n] = 0.1 * (double)n;
+    
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        nn_kernels_select((NNKernelISA)isa);
+        nn_kernel_gemm(A, K, W, K, bias, C, N, M, N, K);
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                double expected = bias[n];
+                for (size_t k = 0; k < K; k++) expected += A[m * K + k] * W[n * K + k];
+                ASSERT_FLOAT_EQ(C[m * N + n], expected, 1e-10, "GEMM should match reference");
+            }
+        }
+    }
+    nn_kernels_select(best);
+    delete[] A;
+    delete[] W;
+    
+    const size_t batch = 70, in = 48, out = 40, stride = 44;           // More samples than one chunk; outputs past hidden are zero
+    NeuralNetwork* nn = nn_create_hybrid(in, 24, out);
+    double* inputs = new double[batch * in];
+    double* outputs = new double[batch * stride];
+    double single[out];
+    for (size_t i = 0; i < batch * in; i++) inputs[i] = sin(0.05 * (double)i);
+    nn_forward_batch(nn, inputs, in, batch, outputs, stride);
+    for (size_t b = 0; b < batch; b++) {
+        nn_forward(nn, inputs + b * in, single);
+        for (size_t i = 0; i < out; i++) {
+            ASSERT_FLOAT_EQ(outputs[b * stride + i], single[i], 1e-12, "Batched forward should match nn_forward");
+        }
+    }
+    
+    size_t before = test_allocation_count();
+    nn_forward_batch(nn, inputs, in, batch, outputs, stride);
+    ASSERT_EQ(test_allocation_count() - before, 0, "Batched forward should not allocate");
+    
+    NNWorkspace* ws = nn_workspace_create(nn);                         // Private scratch gives the same outputs
+    double* ws_outputs = new double[batch * stride];
+    nn_workspace_forward_batch(ws, inputs, in, batch, ws_outputs, stride);
+    for (size_t b = 0; b < batch; b++) {
+        for (size_t i = 0; i < out; i++) {
+            ASSERT_FLOAT_EQ(ws_outputs[b * stride + i], outputs[b * stride + i], 1e-12, "Workspace forward should match nn_forward_batch");
+        }
+    }
+    nn_workspace_destroy(ws);
+    
+    delete[] ws_outputs;
+    delete[] inputs;
+    delete[] outputs;
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Sparse Feature Input Matches Dense Forward
+char* test_nn_forward_sparse(void) {
+    NeuralNetwork* nn = nn_create_hybrid(768, 48, 64);
+    ChessPosition* pos = chess_position_from_fen("r1bqk2r/ppp2ppp/2n2n2/2bpp3/4P3/2PP1N2/PP3PPP/RNBQKB1R w KQkq - 0 6");
+    double input[768], dense[64], sparse[64];
+    uint16_t features[64];
+    chess_position_to_matrix(pos, input);
+    size_t count = chess_position_get_features(pos, features);
+    ASSERT_EQ(count, 32, "Every piece should be one feature");
+    
+    nn_forward(nn, input, dense);
+    nn_forward_sparse(nn, features, count, sparse);
+    for (size_t i = 0; i < 64; i++) ASSERT_FLOAT_EQ(sparse[i], dense[i], 1e-12, "Sparse forward should match dense forward");
+    
+    size_t before = test_allocation_count();
+    nn_forward_sparse(nn, features, count, sparse);
+    ASSERT_EQ(test_allocation_count() - before, 0, "Sparse forward should not allocate once columns exist");
+    
+    nn_set_precision(nn, NN_PRECISION_FP32);                           // Column copy follows the rounded weights
+    nn_forward(nn, input, dense);
+    nn_forward_sparse(nn, features, count, sparse);
+    for (size_t i = 0; i < 64; i++) ASSERT_FLOAT_EQ(sparse[i], dense[i], 1e-5, "Sparse forward should follow precision changes");
+    
+    chess_position_destroy(pos);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: FP32/BF16 Weight Storage Tracks Double Precision
+char* test_nn_reduced_precision(void) {
+    const size_t M = 5, N = 9, K = 531;                                // Crosses the float K block and leaves vector tails
+    float* A = new float[M * K];
+    float* W32 = new float[N * K];
+    uint16_t* W16 = new uint16_t[N * K];
+    double bias[N], C[M * N];
+    for (size_t i = 0; i < M * K; i++) A[i] = (float)sin(0.13 * (double)i);
+    for (size_t i = 0; i < N * K; i++) {
+        W32[i] = (float)cos(0.07 * (double)i);
+        W16[i] = nn_float_to_bf16(W32[i]);
+    }
+    for (size_t n = 0; n < N; n++) bias[n] = 0.1 * (double)n;
+    ASSERT(nn_bf16_to_float(nn_float_to_bf16(1.0f + 1.0f / 256.0f)) == 1.0f, "bf16 rounding should be to nearest even");
+    
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        nn_kernels_select((NNKernelISA)isa);
+        nn_kernel_gemm_f32(A, K, W32, K, bias, C, N, M, N, K);
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                double expected = bias[n];
+                for (size_t k = 0; k < K; k++) expected += (double)A[m * K + k] * (double)W32[n * K + k];
+                ASSERT_FLOAT_EQ(C[m * N + n], expected, 1e-3, "FP32 GEMM should match reference");
+            }
+        }
+        nn_kernel_gemm_bf16(A, K, W16, K, bias, C, N, M, N, K);
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                double expected = bias[n];
+                for (size_t k = 0; k < K; k++) expected += (double)A[m * K + k] * (double)nn_bf16_to_float(W16[n * K + k]);
+                ASSERT_FLOAT_EQ(C[m * N + n], expected, 1e-3, "BF16 GEMM should match reference");
+            }
+        }
+    }
+    nn_kernels_select(best);
+    delete[] A;
+    delete[] W32;
+    delete[] W16;
+    
+    const size_t batch = 20, in = 64, hidden = 32;
+    NeuralNetwork* nn = nn_create_hybrid(in, hidden, hidden);
+    double* inputs = new double[batch * in];
+    double* reference = new double[batch * hidden];
+    double* outputs = new double[batch * hidden];
+    double single[hidden];
+    for (size_t i = 0; i < batch * in; i++) inputs[i] = sin(0.05 * (double)i);
+    for (size_t b = 0; b < batch; b++) nn_forward(nn, inputs + b * in, reference + b * hidden);
+    size_t fp64_bytes = nn_get_parameter_bytes(nn);
+    
+    const NNPrecision modes[2] = {NN_PRECISION_FP32, NN_PRECISION_BF16};
+    const double tolerance[2] = {1e-5, 2e-2};
+    for (int mode = 0; mode < 2; mode++) {
+        nn_set_precision(nn, modes[mode]);
+        ASSERT(nn_get_precision(nn) == modes[mode], "Precision should be reported");
+        ASSERT(nn_get_parameter_bytes(nn) < fp64_bytes * (mode == 0 ? 6 : 4) / 10, "Reduced precision should shrink the weights");
+        nn_forward_batch(nn, inputs, in, batch, outputs, hidden);
+        for (size_t b = 0; b < batch; b++) {
+            nn_forward(nn, inputs + b * in, single);
+            for (size_t i = 0; i < hidden; i++) {
+                ASSERT_FLOAT_EQ(single[i], reference[b * hidden + i], tolerance[mode], "Reduced precision should track double precision");
+                ASSERT_FLOAT_EQ(outputs[b * hidden + i], single[i], 1e-6, "Batched forward should match nn_forward");
+            }
+        }
+    }
+    size_t before = test_allocation_count();
+    nn_forward(nn, inputs, single);
+    nn_forward_batch(nn, inputs, in, batch, outputs, hidden);
+    ASSERT_EQ(test_allocation_count() - before, 0, "Reduced-precision forward should not allocate");
+    
+    nn_set_precision(nn, NN_PRECISION_FP64);
+    ASSERT_EQ(nn_get_parameter_bytes(nn), fp64_bytes, "Widening should restore the double footprint");
+    nn_destroy(nn);
+    
+    nn = nn_create_hybrid_with_precision(in, hidden, hidden, NN_PRECISION_BF16);
+    ASSERT(nn_get_precision(nn) == NN_PRECISION_BF16, "Precision should be selectable at creation");
+    nn_forward(nn, inputs, single);
+    for (size_t i = 0; i < hidden; i++) ASSERT(std::isfinite(single[i]), "BF16 forward should be finite");
+    nn_destroy(nn);
+    
+    delete[] inputs;
+    delete[] reference;
+    delete[] outputs;
+    return nullptr;
+}
+
+static double lstm_weighted_output(LSTMLayer* layer, const double* inputs, const double* weights,  // Sum of weights . h_t over a sequence from zero state
+                                   size_t steps, size_t input_size, size_t hidden_size) {
+    double hidden[8], output[8], sum = 0.0;
+    lstm_layer_reset(layer);
+    memset(hidden, 0, sizeof(hidden));
+    for (size_t t = 0; t < steps; t++) {
+        lstm_layer_forward(layer, inputs + t * input_size, output, hidden);
+        for (size_t i = 0; i < hidden_size; i++) sum += weights[t * hidden_size + i] * output[i];
+    }
+    return sum;
+}
+
+// Unit Test: Backpropagation Through Time Matches Finite Differences
+char* test_nn_bptt(void) {
+    const size_t I = 4, H = 3, T = 5;
+    const double eps = 1e-6;
+    double inputs[T * I], weights[T * H], input_gradient[T * I];
+    for (size_t i = 0; i < T * I; i++) inputs[i] = sin(0.7 * (double)i + 0.3);
+    for (size_t i = 0; i < T * H; i++) weights[i] = cos(0.5 * (double)i);
+    
+    LSTMLayer* lstm = lstm_layer_create(I, H);
+    lstm_weighted_output(lstm, inputs, weights, T, I, H);
+    lstm_layer_backward(lstm, weights, input_gradient);               // d(sum)/dh_t is the weight row of step t
+    for (size_t i = 0; i < T * I; i++) {                               // Early inputs reach the loss only through the recurrence
+        double saved = inputs[i];
+        inputs[i] = saved + eps;
+        double up = lstm_weighted_output(lstm, inputs, weights, T, I, H);
+        inputs[i] = saved - eps;
+        double down = lstm_weighted_output(lstm, inputs, weights, T, I, H);
+        inputs[i] = saved;
+        ASSERT_FLOAT_EQ(input_gradient[i], (up - down) / (2.0 * eps), 1e-7, "LSTM input gradient should match finite difference");
+    }
+    lstm_layer_destroy(lstm);
+    
+    BayesianLayer* layer = bayesian_layer_create(H, I);
+    double output[H], gradient[I];
+    bayesian_layer_forward(layer, inputs, output);
+    bayesian_layer_backward(layer, weights, gradient);
+    for (size_t j = 0; j < I; j++) {
+        double saved = inputs[j], up = 0.0, down = 0.0;
+        inputs[j] = saved + eps;
+        bayesian_layer_forward(layer, inputs, output);
+        for (size_t i = 0; i < H; i++) up += weights[i] * output[i];
+        inputs[j] = saved - eps;
+        bayesian_layer_forward(layer, inputs, output);
+        for (size_t i = 0; i < H; i++) down += weights[i] * output[i];
+        inputs[j] = saved;
+        ASSERT_FLOAT_EQ(gradient[j], (up - down) / (2.0 * eps), 1e-8, "Bayesian input gradient should match finite difference");
+    }
+    bayesian_layer_destroy(layer);
+    
+    NeuralNetwork* nn = nn_create_hybrid(I, 8, H);                     // Targets depend on earlier steps, so learning needs gradients through time
+    Optimizer* opt = optimizer_create(OPTIMIZER_SGD, 2.0);
+    optimizer_set_momentum(opt, 0.0);
+    double targets[T * H], loss = 0.0, first = 0.0;
+    for (size_t t = 0; t < T; t++) {
+        for (size_t i = 0; i < H; i++) targets[t * H + i] = t > 0 ? 0.3 * inputs[(t - 1) * I + i] : 0.0;
+    }
+    for (int iter = 0; iter < 300; iter++) {
+        nn_forward_sequence(nn, inputs, T, nullptr);
+        nn_backward_sequence(nn, targets, &loss);
+        if (iter == 0) first = loss;
+        optimizer_update(opt, nn);
+    }
+    ASSERT(loss < 0.25 * first, "Sequence training should reduce the loss");
+    optimizer_destroy(opt);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Parameter Arena Views And Weight Gradients
+char* test_nn_parameter_arena(void) {
+    const size_t I = 6, H = 4, O = 3, T = 3;
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    size_t count = 0, grad_count = 0;
+    double* params = nn_get_parameters(nn, &count);
+    double* grads = nn_get_gradients(nn, &grad_count);
+    ASSERT_EQ(count, H * I + H + 4 * H * (H + H) + 4 * H, "Arena should hold every weight and bias");
+    ASSERT_EQ(grad_count, count, "Gradient arena should match the parameter arena");
+    ASSERT(((uintptr_t)params & 63) == 0 && ((uintptr_t)grads & 63) == 0, "Arenas should be cache-line aligned");
+    
+    double inputs[T * I], targets[T * O], outputs[T * O], reference[T * O], loss;
+    for (size_t i = 0; i < T * I; i++) inputs[i] = cos(0.9 * (double)i);
+    for (size_t i = 0; i < T * O; i++) targets[i] = 0.2 * sin((double)i);
+    nn_zero_gradients(nn);
+    nn_forward_sequence(nn, inputs, T, reference);
+    nn_backward_sequence(nn, targets, &loss);
+    double* analytic = new double[count];
+    memcpy(analytic, grads, count * sizeof(double));
+    const double eps = 1e-6;
+    for (size_t i = 0; i < count; i += 3) {                            // Every third parameter across both layers
+        double saved = params[i], up, down;
+        params[i] = saved + eps;
+        nn_forward_sequence(nn, inputs, T, nullptr);
+        nn_backward_sequence(nn, targets, &up);
+        params[i] = saved - eps;
+        nn_forward_sequence(nn, inputs, T, nullptr);
+        nn_backward_sequence(nn, targets, &down);
+        params[i] = saved;
+        ASSERT_FLOAT_EQ(analytic[i], (up - down) / (2.0 * eps), 1e-8, "Weight gradient should match finite difference");
+    }
+    delete[] analytic;
+    
+    NeuralNetwork* copy = nn_create_hybrid(I, H, O);                   // One memcpy moves a whole model
+    memcpy(nn_get_parameters(copy, nullptr), params, count * sizeof(double));
+    nn_forward_sequence(copy, inputs, T, outputs);
+    for (size_t i = 0; i < T * O; i++) ASSERT(outputs[i] == reference[i], "Copied arena should reproduce the outputs");
+    nn_destroy(copy);
+    
+    Optimizer* opt = optimizer_create(OPTIMIZER_ADAM, 0.01);
+    optimizer_update(opt, nn);
+    for (size_t i = 0; i < count; i++) ASSERT(grads[i] == 0.0, "Update should consume the gradient arena");
+    optimizer_destroy(opt);
+    
+    memset(params, 0, count * sizeof(double));                         // Zero weights: cell candidate is 0, so hidden state is 0
+    nn_forward(nn, inputs, outputs);
+    for (size_t i = 0; i < O; i++) ASSERT(outputs[i] == 0.0, "Writes through the view should reach the forward pass");
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Fused Optimizer Kernels And Update Rules
+char* test_nn_optimizers(void) {
+    const size_t n = 37;                                               // Odd length exercises vector tails
+    NNOptimizerStep step = {0.01, 0.001, 0.9, 0.9, 0.999, 0.9, 1e-8, 1.0 - 0.9 * 0.9, 1.0 - 0.999 * 0.999};
+    double p0[n], g0[n], m0[n], v0[n];
+    for (size_t i = 0; i < n; i++) {
+        p0[i] = sin(0.3 * (double)i);
+        g0[i] = cos(0.7 * (double)i);
+        m0[i] = 0.1 * sin((double)i);
+        v0[i] = 0.01 * (1.0 + cos((double)i));
+    }
+    
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        nn_kernels_select((NNKernelISA)isa);
+        for (int rule = 0; rule < 4; rule++) {
+            double p[n], g[n], m[n], v[n];
+            memcpy(p, p0, sizeof(p));
+            memcpy(g, g0, sizeof(g));
+            memcpy(m, m0, sizeof(m));
+            memcpy(v, v0, sizeof(v));
+            if (rule == 0) nn_kernel_sgd(p, g, m, n, &step);
+            if (rule == 1) nn_kernel_adam(p, g, m, v, n, &step);
+            if (rule == 2) nn_kernel_rmsprop(p, g, v, n, &step);
+            if (rule == 3) nn_kernel_adagrad(p, g, v, n, &step);
+            for (size_t i = 0; i < n; i++) {                           // Reference update written out per rule
+                double grad = g0[i] + step.weight_decay * p0[i], expected;
+                if (rule == 0) {
+                    double vel = step.momentum * m0[i] + grad;
+                    ASSERT_FLOAT_EQ(m[i], vel, 1e-14, "SGD velocity should match reference");
+                    expected = p0[i] - step.learning_rate * vel;
+                } else if (rule == 1) {
+                    double mi = step.beta1 * m0[i] + (1.0 - step.beta1) * grad;
+                    double vi = step.beta2 * v0[i] + (1.0 - step.beta2) * grad * grad;
+                    ASSERT_FLOAT_EQ(m[i], mi, 1e-14, "Adam first moment should match reference");
+                    ASSERT_FLOAT_EQ(v[i], vi, 1e-14, "Adam second moment should match reference");
+                    expected = p0[i] - step.learning_rate * (mi / step.correction1) / (sqrt(vi / step.correction2) + step.epsilon);
+                } else if (rule == 2) {
+                    double vi = step.rho * v0[i] + (1.0 - step.rho) * grad * grad;
+                    ASSERT_FLOAT_EQ(v[i], vi, 1e-14, "RMSProp average should match reference");
+                    expected = p0[i] - step.learning_rate * grad / (sqrt(vi) + step.epsilon);
+                } else {
+                    double vi = v0[i] + grad * grad;
+                    ASSERT_FLOAT_EQ(v[i], vi, 1e-14, "Adagrad sum should match reference");
+                    expected = p0[i] - step.learning_rate * grad / (sqrt(vi) + step.epsilon);
+                }
+                ASSERT_FLOAT_EQ(p[i], expected, 1e-12, "Fused update should match reference");
+                ASSERT(g[i] == 0.0, "Fused update should clear the gradient");
+            }
+        }
+    }
+    nn_kernels_select(best);
+    
+    const size_t I = 4, H = 3, T = 5;                                  // Every rule should make progress on a small sequence task
+    const OptimizerType types[4] = {OPTIMIZER_SGD, OPTIMIZER_ADAM, OPTIMIZER_RMSPROP, OPTIMIZER_ADAGRAD};
+    const double rates[4] = {0.2, 0.01, 0.01, 0.1};
+    double inputs[T * I], targets[T * H];
+    for (size_t i = 0; i < T * I; i++) inputs[i] = sin(0.7 * (double)i + 0.3);
+    for (size_t t = 0; t < T; t++) {
+        for (size_t i = 0; i < H; i++) targets[t * H + i] = t > 0 ? 0.3 * inputs[(t - 1) * I + i] : 0.0;
+    }
+    for (size_t k = 0; k < 4; k++) {
+        NeuralNetwork* nn = nn_create_hybrid(I, 8, H);
+        Optimizer* opt = optimizer_create(types[k], rates[k]);
+        optimizer_set_weight_decay(opt, 1e-4);
+        double loss = 0.0, first = 0.0;
+        for (int iter = 0; iter < 300; iter++) {
+            nn_forward_sequence(nn, inputs, T, nullptr);
+            nn_backward_sequence(nn, targets, &loss);
+            if (iter == 0) first = loss;
+            optimizer_update(opt, nn);
+        }
+        ASSERT(loss < 0.5 * first, "Each optimizer should reduce the training loss");
+        optimizer_destroy(opt);
+        nn_destroy(nn);
+    }
+    return nullptr;
+}
+
 // Unit Test: Optimizer Creation
 char* test_optimizer_create(void) {
     Optimizer* opt = optimizer_create(OPTIMIZER_ADAM, 0.001);
@@ -85,6 +641,7 @@ char* test_curriculum_create(void) {
 char* test_curriculum_add_example(void) {
     Curriculum* curriculum = curriculum_create(5);
     TrainingExample example;
+    training_example_init(&example);
     example.input_size = 10;
     example.target_size = 5;
     example.difficulty = 0.3;
@@ -105,6 +662,99 @@ char* test_curriculum_add_example(void) {
     return nullptr;
 }
 
+// Unit Test: Sparse Policy Targets
+char* test_curriculum_sparse_targets(void) {
+    Curriculum* curriculum = curriculum_create(10);
+    PuzzleGenerator* generator = puzzle_generator_create(curriculum);
+    TrainingExample* puzzle = puzzle_generator_create_puzzle(generator, LEVEL_MIDDLE_SCHOOL);
+    ASSERT(puzzle->target == nullptr && puzzle->sparse_target != nullptr, "Puzzles should carry sparse targets");
+    ASSERT_EQ(puzzle->target_size, 4096, "Sparse target should keep the dense width");
+    double total = 0.0;
+    for (size_t k = 0; k < puzzle->num_sparse; k++) {
+        total += puzzle->sparse_target[k].probability;
+        ASSERT(puzzle->sparse_target[k].index < 4096, "Entries should address outputs");
+        ASSERT(k == 0 || puzzle->sparse_target[k - 1].index < puzzle->sparse_target[k].index, "Entries should be sorted and distinct");
+    }
+    ASSERT_FLOAT_EQ(total, 1.0, 1e-5, "Move probabilities should sum to one");
+    std::vector<double> dense(4096);
+    training_example_get_target(puzzle, dense.data(), dense.size());
+    size_t nonzero = 0;
+    for (double x : dense) nonzero += x != 0.0;
+    ASSERT_EQ(nonzero, puzzle->num_sparse, "Densified target should hold exactly the entries");
+    training_example_release(puzzle);
+    delete puzzle;
+    
+    const size_t N = 12;                                               // Preschool puzzles: 64 inputs, 8 outputs, 4 candidates
+    TrainingExample sparse[N], dense_copies[N];
+    for (size_t i = 0; i < N; i++) {
+        TrainingExample* p = puzzle_generator_create_puzzle(generator, LEVEL_PRESCHOOL);
+        sparse[i] = *p;
+        delete p;
+        dense_copies[i] = sparse[i];
+        dense_copies[i].sparse_target = nullptr;
+        dense_copies[i].num_sparse = 0;
+        dense_copies[i].input = new double[sparse[i].input_size];
+        memcpy(dense_copies[i].input, sparse[i].input, sparse[i].input_size * sizeof(double));
+        dense_copies[i].target = new double[sparse[i].target_size];
+        training_example_get_target(&sparse[i], dense_copies[i].target, sparse[i].target_size);
+    }
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.01;
+    config.batch_size = 4;
+    config.use_curriculum = true;
+    config.num_threads = 3;                                            // Each worker's shard starts partway into the sparse rows
+    NeuralNetwork* nn = nn_create_hybrid(64, 4, 8);                    // Outputs 4..7 stay zero, so some entries are never reachable
+    NeuralNetwork* dense_nn = nn_create_hybrid(64, 4, 8);
+    size_t count;
+    double* params = nn_get_parameters(nn, &count);
+    memcpy(nn_get_parameters(dense_nn, nullptr), params, count * sizeof(double));
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    TrainingEngine* dense_engine = training_engine_create(dense_nn, &config);
+    for (size_t i = 0; i < N; i++) {
+        curriculum_add_example(engine->curriculum, &sparse[i], LEVEL_PRESCHOOL);
+        curriculum_add_example(dense_engine->curriculum, &dense_copies[i], LEVEL_PRESCHOOL);
+    }
+    training_engine_train_with_curriculum(engine);
+    training_engine_train_with_curriculum(dense_engine);
+    TrainingStats* stats = training_engine_get_stats(engine);
+    ASSERT(stats->current_loss > 0.0 && stats->accuracy >= 0.0 && stats->accuracy <= 1.0, "Curriculum should train on sparse targets");
+    ASSERT_FLOAT_EQ(stats->current_loss, training_engine_get_stats(dense_engine)->current_loss, 1e-12, "Sparse batches should report the dense loss");
+    const double* dense_params = nn_get_parameters(dense_nn, nullptr);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_FLOAT_EQ(params[i], dense_params[i], 1e-12, "Sparse batches should train like their dense rows");
+    }
+    training_engine_destroy(dense_engine);
+    nn_destroy(dense_nn);
+    
+    training_engine_evaluate_examples(engine, dense_copies, N);
+    double dense_loss = stats->validation_loss;
+    double accuracy = training_engine_evaluate_examples(engine, sparse, N);
+    ASSERT_FLOAT_EQ(stats->validation_loss, dense_loss, 1e-12, "Sparse loss should match the dense loss");
+    ASSERT(accuracy >= 0.0 && accuracy <= 1.0, "Sparse accuracy should be a fraction");
+    
+    const char* path = "test_sparse.bin";                              // Checkpoints keep the targets sparse
+    ASSERT(training_engine_save_checkpoint(engine, path), "Saving sparse examples should succeed");
+    NeuralNetwork* restored_nn = nn_create_hybrid(64, 4, 8);
+    TrainingEngine* restored = training_engine_create(restored_nn, &config);
+    ASSERT(training_engine_restore_checkpoint(restored, path), "Restoring sparse examples should succeed");
+    training_engine_evaluate_examples(restored, sparse, N);
+    ASSERT_FLOAT_EQ(training_engine_get_stats(restored)->validation_loss, dense_loss, 1e-12, "Restored engine should score the same");
+    ASSERT(training_engine_remove_checkpoint(path), "Checkpoint files should be removed");
+    training_engine_destroy(restored);
+    nn_destroy(restored_nn);
+    training_engine_destroy(engine);
+    nn_destroy(nn);
+    for (size_t i = 0; i < N; i++) {
+        training_example_release(&sparse[i]);
+        training_example_release(&dense_copies[i]);
+    }
+    puzzle_generator_destroy(generator);
+    curriculum_destroy(curriculum);
+    return nullptr;
+}
+
 // Unit Test: Curriculum Advancement
 char* test_curriculum_advancement(void) {
     Curriculum* curriculum = curriculum_create(5);
@@ -173,6 +823,339 @@ char* test_chess_position_to_matrix(void) {
     return nullptr;
 }
 
+// Reference ray walk used to cross-check the magic lookup tables
+static Bitboard reference_slider_attacks(int sq, Bitboard occupied, bool diagonal) {
+    static const int rook_dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static const int bishop_dirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    const int (*dirs)[2] = diagonal ? bishop_dirs : rook_dirs;
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int file = sq % 8 + dirs[d][0];
+        int rank = sq / 8 + dirs[d][1];
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+            attacks |= BITBOARD_SQUARE(rank * 8 + file);
+            if (occupied & BITBOARD_SQUARE(rank * 8 + file)) break;
+            file += dirs[d][0];
+            rank += dirs[d][1];
+        }
+    }
+    return attacks;
+}
+
+// Unit Test: Bitboard Sliding Attacks
+char* test_bitboard_sliding_attacks(void) {
+    bitboard_init();
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t trial = 0; trial < 2000; trial++) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        Bitboard occupied = state & (state >> 3);
+        Square sq = (Square)(trial % 64);
+        ASSERT(bitboard_rook_attacks(sq, occupied) == reference_slider_attacks(sq, occupied, false),
+               "Rook magic lookup should match ray walk");
+        ASSERT(bitboard_bishop_attacks(sq, occupied) == reference_slider_attacks(sq, occupied, true),
+               "Bishop magic lookup should match ray walk");
+    }
+    ASSERT_EQ(bitboard_popcount(bitboard_knight_attacks(0)), 2, "Corner knight should attack two squares");
+    ASSERT_EQ(bitboard_popcount(bitboard_between(0, 63)), 6, "a1-h8 should have six squares between");
+    return nullptr;
+}
+
+// Unit Test: Chess Position Bitboard Sync
+char* test_chess_position_bitboards(void) {
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    ASSERT_EQ(chess_position_get_piece(pos, 4), PIECE_KING, "e1 should hold white king");
+    ASSERT_EQ(chess_position_get_color(pos, 60), COLOR_BLACK, "e8 should hold black piece");
+    ASSERT(chess_position_get_pieces(pos, COLOR_WHITE, PIECE_PAWN) == 0x000000000000FF00ULL, "White pawns on rank 2");
+    ASSERT_EQ(bitboard_popcount(chess_position_get_occupancy(pos)), 32, "Start position has 32 pieces");
+    
+    ChessMove move = {};
+    move.from = 12;  // e2
+    move.to = 28;    // e4
+    move.piece = PIECE_PAWN;
+    chess_position_make_move(pos, &move);
+    ASSERT_EQ(chess_position_get_piece(pos, 28), PIECE_PAWN, "e4 should hold pawn after move");
+    ASSERT_EQ(chess_position_get_piece(pos, 12), PIECE_NONE, "e2 should be empty after move");
+    ASSERT(chess_position_is_square_attacked(pos, 37, COLOR_WHITE), "Pawn on e4 should attack f5");
+    chess_position_unmake_move(pos);
+    ASSERT(chess_position_get_pieces(pos, COLOR_WHITE, PIECE_PAWN) == 0x000000000000FF00ULL, "Unmake should restore pawns");
+    ASSERT(!chess_position_is_check(pos, COLOR_WHITE), "Start position is not check");
+    
+    chess_position_destroy(pos);
+    return nullptr;
+}
+
+// Unit Test: Perft Node Counts
+char* test_chess_position_perft(void) {
+    static const struct { const char* fen; size_t depth; uint64_t nodes; } cases[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, 8902ULL},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2, 2039ULL},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3, 2812ULL},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 2, 264ULL},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 2, 1486ULL},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ChessPosition* pos = chess_position_from_fen(cases[i].fen);
+        FENString before, after;
+        chess_position_to_fen(pos, &before);
+        ASSERT(chess_position_perft(pos, cases[i].depth) == cases[i].nodes, "Perft node count mismatch");
+        chess_position_to_fen(pos, &after);
+        ASSERT(strcmp(before.fen_string, after.fen_string) == 0, "Make/unmake should restore position exactly");
+        chess_position_destroy(pos);
+    }
+    
+    ChessPosition* mate = chess_position_from_fen("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3");
+    ASSERT(chess_position_is_checkmate(mate, COLOR_WHITE), "Fool's mate should be checkmate");
+    chess_position_destroy(mate);
+    ChessPosition* stale = chess_position_from_fen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    ASSERT(chess_position_is_stalemate(stale), "Cornered king with no moves should be stalemate");
+    chess_position_destroy(stale);
+    return nullptr;
+}
+
+// Walks the move tree checking the incremental key against a full recompute
+static bool zobrist_tree_consistent(ChessPosition* pos, size_t depth) {
+    if (chess_position_get_hash(pos) != chess_position_compute_hash(pos)) return false;
+    if (depth == 0) return true;
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+    uint64_t before = chess_position_get_hash(pos);
+    for (size_t i = 0; i < num_moves; i++) {
+        chess_position_make_move(pos, &moves[i]);
+        bool ok = zobrist_tree_consistent(pos, depth - 1);
+        chess_position_unmake_move(pos);
+        if (!ok || chess_position_get_hash(pos) != before) return false;
+    }
+    return true;
+}
+
+static void play_moves(ChessPosition* pos, const Square (*moves)[2], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        ChessMove move = {};
+        move.from = moves[i][0];
+        move.to = moves[i][1];
+        chess_position_make_move(pos, &move);
+    }
+}
+
+// Unit Test: Zobrist Hashing
+char* test_chess_position_zobrist(void) {
+    ChessPosition* kiwipete = chess_position_from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    ASSERT(zobrist_tree_consistent(kiwipete, 3), "Incremental key should match full recompute on every node");
+    chess_position_destroy(kiwipete);
+    
+    // e4 e5 Nf3 and Nf3 e5 e4 transpose into the same position
+    static const Square order_a[3][2] = {{12, 28}, {52, 36}, {6, 21}};
+    static const Square order_b[3][2] = {{6, 21}, {52, 36}, {12, 28}};
+    ChessPosition* a = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    ChessPosition* b = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    uint64_t start = chess_position_get_hash(a);
+    play_moves(a, order_a, 3);
+    play_moves(b, order_b, 3);
+    ASSERT(chess_position_get_hash(a) == chess_position_get_hash(b), "Transposed move orders should hash equally");
+    ASSERT(chess_position_get_hash(a) != start, "Different positions should hash differently");
+    chess_position_destroy(b);
+    
+    // Knights out and back repeats the start position
+    ChessPosition* c = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    static const Square shuffle[4][2] = {{6, 21}, {62, 45}, {21, 6}, {45, 62}};
+    play_moves(c, shuffle, 3);
+    ASSERT(!chess_position_is_repetition(c), "Position should not repeat before knights return");
+    play_moves(c, shuffle + 3, 1);
+    ASSERT(chess_position_get_hash(c) == start, "Returning knights should restore start key");
+    ASSERT(chess_position_is_repetition(c), "Returned position should be a repetition");
+    
+    for (int cycle = 0; cycle < 300; cycle++) play_moves(c, shuffle, 4);  // 1204 plies: history grows past any fixed size
+    ASSERT_EQ(chess_position_get_ply(c), 1204, "Every move of a long game should be recorded");
+    ASSERT(chess_position_get_hash(c) == start, "Long shuffle should end on the start key");
+    ChessPosition* copy = chess_position_clone(c);
+    for (size_t ply = 0; ply < 1204; ply++) chess_position_unmake_move(copy);
+    ASSERT_EQ(chess_position_get_ply(copy), 0, "Clone should carry the whole history");
+    ASSERT(chess_position_get_hash(copy) == start, "Unmaking the whole game should restore the start key");
+    ASSERT_EQ(chess_position_get_ply(c), 1204, "Clone history should be independent");
+    chess_position_destroy(copy);
+    chess_position_destroy(c);
+    chess_position_destroy(a);
+    return nullptr;
+}
+
+// Material count in pawns/10 from white's point of view, for deterministic search tests
+static double material_evaluator(void* context, const ChessPosition* pos) {
+    static const double values[7] = {0.0, 0.1, 0.5, 0.3, 0.3, 0.9, 0.0};
+    (void)context;
+    double score = 0.0;
+    for (int piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+        score += values[piece] * bitboard_popcount(chess_position_get_pieces((ChessPosition*)pos, COLOR_WHITE, (PieceType)piece));
+        score -= values[piece] * bitboard_popcount(chess_position_get_pieces((ChessPosition*)pos, COLOR_BLACK, (PieceType)piece));
+    }
+    return score;
+}
+
+// Unit Test: Principal Variation Search
+char* test_search_pvs(void) {
+    TranspositionTable* tt = transposition_table_create(1);
+    SearchLimits limits = {4, 0, 0.0};
+    SearchResult result;
+    
+    // Back rank mate in one
+    ChessPosition* mate = chess_position_from_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    uint64_t key = chess_position_get_hash(mate);
+    search_run(mate, &limits, tt, material_evaluator, nullptr, &result);
+    ASSERT(result.has_move, "Search should find a move");
+    ASSERT(result.best_move.from == 0 && result.best_move.to == 56, "Search should play Ra8 mate");
+    ASSERT(search_is_mate_score(result.score) && result.score > 0, "Mate should get a winning mate score");
+    ASSERT(chess_position_get_hash(mate) == key, "Search should restore the position");
+    chess_position_destroy(mate);
+    
+    // Black to move wins the undefended queen; PV must be a legal line
+    ChessPosition* pos = chess_position_from_fen("4k3/8/8/3Q4/8/8/3r4/4K3 b - - 0 1");
+    transposition_table_clear(tt);
+    search_run(pos, &limits, tt, material_evaluator, nullptr, &result);
+    ASSERT(result.depth == 4, "All iterations should complete without limits");
+    ASSERT(result.best_move.from == 11 && result.best_move.to == 35, "Search should play Rxd5");
+    ASSERT(result.score > 0.4, "Winning the queen should score as a rook up for black");
+    ASSERT(result.pv_length >= 1, "Search should return a principal variation");
+    for (size_t i = 0; i < result.pv_length; i++) {
+        ASSERT(chess_position_is_legal_move(pos, &result.pv[i]), "PV moves should be legal in sequence");
+        chess_position_make_move(pos, &result.pv[i]);
+    }
+    for (size_t i = 0; i < result.pv_length; i++) chess_position_unmake_move(pos);
+    
+    // Node limit stops the search but still reports a legal move
+    SearchLimits tiny = {10, 200, 0.0};
+    search_run(pos, &tiny, tt, material_evaluator, nullptr, &result);
+    ASSERT(result.has_move && chess_position_is_legal_move(pos, &result.best_move), "Limited search should return a legal move");
+    ASSERT(result.nodes <= 201, "Node limit should be respected");
+    chess_position_destroy(pos);
+    
+    // Stalemated side reports no move and a draw score
+    ChessPosition* stale = chess_position_from_fen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    search_run(stale, &limits, tt, material_evaluator, nullptr, &result);
+    ASSERT(!result.has_move && result.score == 0.0, "Stalemate should have no move and draw score");
+    chess_position_destroy(stale);
+    transposition_table_destroy(tt);
+    return nullptr;
+}
+
+// Uniform priors with squashed material value, for deterministic MCTS tests
+static double material_mcts_evaluator(void* context, ChessPosition* pos, const ChessMove* moves, size_t num_moves, double* priors) {
+    (void)moves;
+    for (size_t i = 0; i < num_moves; i++) priors[i] = 1.0;
+    double value = tanh(material_evaluator(context, pos));
+    return chess_position_get_side_to_move(pos) == COLOR_WHITE ? value : -value;
+}
+
+// Unit Test: Monte Carlo Tree Search
+char* test_mcts_search(void) {
+    MCTSTree* tree = mcts_tree_create();
+    MCTSConfig config = {400, 1.5, 0.0, 1, 1, 1.0};
+    MCTSResult result;
+    
+    ChessPosition* mate = chess_position_from_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    uint64_t key = chess_position_get_hash(mate);
+    mcts_search(tree, mate, &config, material_mcts_evaluator, nullptr, &result);
+    ASSERT(result.has_move, "MCTS should return a move");
+    ASSERT(result.best_move.from == 0 && result.best_move.to == 56, "MCTS should find Ra8 mate");
+    ASSERT(result.value > 0.5, "Root value should reflect the forced win");
+    ASSERT(chess_position_get_hash(mate) == key, "MCTS should restore the position");
+    
+    double policy[64 * 64];
+    mcts_get_visit_distribution(tree, policy);
+    double total = 0.0;
+    for (size_t i = 0; i < 64 * 64; i++) total += policy[i];
+    ASSERT_FLOAT_EQ(total, 1.0, 1e-9, "Visit distribution should sum to one");
+    ASSERT(policy[0 * 64 + 56] > 0.5, "Mating move should receive most visits");
+    chess_position_destroy(mate);
+    
+    // Subtree below the move actually played is reused by the next search
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    mcts_tree_clear(tree);
+    config.simulations = 200;
+    mcts_search(tree, pos, &config, material_mcts_evaluator, nullptr, &result);
+    ASSERT_EQ(result.root_visits, 200, "Fresh tree should only count this search");
+    chess_position_make_move(pos, &result.best_move);
+    mcts_search(tree, pos, &config, material_mcts_evaluator, nullptr, &result);
+    ASSERT(result.root_visits > 200, "Second search should reuse visits below the played move");
+    ASSERT(chess_position_is_legal_move(pos, &result.best_move), "Reused tree should return a legal move");
+    chess_position_destroy(pos);
+    mcts_tree_destroy(tree);
+    
+    // Engine path uses network priors and value
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 64);
+    InferenceEngine* engine = inference_engine_create(nn);
+    engine->temperature = 0.0;
+    ChessPosition* start = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    ChessMove* move = inference_engine_mcts_search(engine, start, 32);
+    ASSERT_NOT_NULL(move, "Engine MCTS should return a move");
+    ASSERT(chess_position_is_legal_move(start, move), "Engine MCTS move should be legal");
+    delete move;
+    chess_position_destroy(start);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Batched evaluator over a one-value encoding: material as the white-relative value, flat policy
+static void material_encode(void* context, ChessPosition* pos, double* input) {
+    (void)context;
+    input[0] = tanh(material_evaluator(nullptr, pos));
+}
+
+static void material_evaluate_batch(void* context, void* workspace, const double* inputs, size_t count, double* outputs) {
+    (void)workspace;
+    std::atomic<size_t>* batches = (std::atomic<size_t>*)context;      // Workers evaluate concurrently
+    batches->fetch_add(1);
+    for (size_t i = 0; i < count; i++) outputs[i * 64 * 64] = inputs[i];
+}
+
+// Unit Test: Multi-threaded MCTS with virtual loss and batched leaves
+char* test_mcts_parallel(void) {
+    MCTSTree* tree = mcts_tree_create();
+    MCTSConfig config = {800, 1.5, 0.0, 4, 8, 1.0};
+    MCTSResult result;
+    std::atomic<size_t> batches(0);
+    MCTSBatchEvaluator evaluator = {1, 64 * 64, material_encode, material_evaluate_batch, &batches, nullptr, nullptr};
+    
+    ChessPosition* mate = chess_position_from_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    uint64_t key = chess_position_get_hash(mate);
+    mcts_search_batched(tree, mate, &config, &evaluator, &result);
+    ASSERT(result.has_move, "Parallel MCTS should return a move");
+    ASSERT(result.best_move.from == 0 && result.best_move.to == 56, "Parallel MCTS should find Ra8 mate");
+    ASSERT_EQ(result.root_visits, 800, "Every simulation should be backed up exactly once");
+    ASSERT(result.batches == batches && batches > 0, "Leaves should be evaluated through the batch callback");
+    ASSERT(batches < 800, "Leaves should be grouped into batches");
+    ASSERT(chess_position_get_hash(mate) == key, "Parallel MCTS should restore the position");
+    
+    double policy[64 * 64];
+    mcts_get_visit_distribution(tree, policy);
+    double total = 0.0;
+    for (size_t i = 0; i < 64 * 64; i++) total += policy[i];
+    ASSERT_FLOAT_EQ(total, 1.0, 1e-9, "Visit distribution should sum to one with no virtual loss left");
+    chess_position_destroy(mate);
+    
+    // Threads with immediate evaluation, then the engine's batched path
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    mcts_tree_clear(tree);
+    config.batch_size = 1;
+    mcts_search(tree, pos, &config, material_mcts_evaluator, nullptr, &result);
+    ASSERT_EQ(result.root_visits, 800, "Threaded search should count every simulation");
+    ASSERT(chess_position_is_legal_move(pos, &result.best_move), "Threaded search should return a legal move");
+    mcts_tree_destroy(tree);
+    
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 64);
+    InferenceEngine* engine = inference_engine_create(nn);
+    engine->temperature = 0.0;
+    engine->mcts_threads = 2;
+    engine->mcts_batch_size = 4;
+    inference_engine_run_mcts(engine, pos, 64, &result);
+    ASSERT(result.has_move && chess_position_is_legal_move(pos, &result.best_move), "Engine parallel MCTS move should be legal");
+    ASSERT(result.batches < 64, "Engine should evaluate leaves in batches");
+    chess_position_destroy(pos);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
 // Unit Test: Pavlovian Learner Creation
 char* test_pavlovian_learner_create(void) {
     PavlovianLearner* learner = pavlovian_learner_create(PAVLOVIAN_HYBRID, 0.1);
@@ -208,6 +1191,7 @@ char* test_pavlovian_pair_stimuli(void) {
 char* test_training_engine_create(void) {
     NeuralNetwork* nn = nn_create_hybrid(100, 50, 10);
     TrainingConfig config;
+    training_config_init(&config);
     config.optimizer_type = OPTIMIZER_ADAM;
     config.learning_rate = 0.001;
     config.use_curriculum = true;
@@ -222,7 +1206,503 @@ char* test_training_engine_create(void) {
     TrainingStats* stats = training_engine_get_stats(engine);
     ASSERT_NOT_NULL(stats, "Stats should be accessible");
     
+    TrainingConfig defaults;
+    memset(&defaults, 0xA5, sizeof(defaults));                         // Stack garbage must not survive
+    training_config_init(&defaults);
+    ASSERT_EQ(defaults.num_threads, 1, "Defaults should train on the calling thread");
+    ASSERT(!defaults.hogwild && !defaults.async_checkpoints && defaults.checkpoint_path == nullptr && defaults.checkpoint_interval == 0,
+           "Defaults should not enable Hogwild or checkpointing");
+    ASSERT_EQ(defaults.batch_size, 32, "Default batch size");
+    
+    training_engine_destroy(engine);
+    return nullptr;
+}
+
+// Fixture for the parallel training tests: every run starts from the same weights and data
+struct TrainingRun {
+    double* params;           // Final parameters (delete[])
+    double first_loss;        // Loss of the first and last epochs
+    double last_loss;
+    size_t examples_seen;
+};
+
+static TrainingRun train_from_weights(const double* initial, size_t I, size_t H, size_t O, const TrainingConfig* config,
+                                      const double* inputs, const double* targets, size_t N, int epochs) {
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    size_t count;
+    double* params = nn_get_parameters(nn, &count);
+    memcpy(params, initial, count * sizeof(double));
+    TrainingConfig run_config = *config;
+    TrainingEngine* engine = training_engine_create(nn, &run_config);
+    training_engine_set_data(engine, inputs, targets, N);
+    TrainingRun run;
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        training_engine_train_epoch(engine);
+        if (epoch == 0) run.first_loss = training_engine_get_stats(engine)->current_loss;
+    }
+    run.last_loss = training_engine_get_stats(engine)->current_loss;
+    run.examples_seen = training_engine_get_stats(engine)->examples_seen;
+    run.params = new double[count];
+    memcpy(run.params, nn_get_parameters(nn, nullptr), count * sizeof(double));
+    training_engine_destroy(engine);
+    nn_destroy(nn);
+    return run;
+}
+
+// Unit Test: Data-Parallel Epochs Are Deterministic And Match Single-Threaded Training
+char* test_training_data_parallel(void) {
+    const size_t I = 24, H = 8, O = 5, N = 150;
+    double* inputs = new double[N * I];
+    double* targets = new double[N * O];
+    for (size_t i = 0; i < N * I; i++) inputs[i] = (i * 11) % 7 == 0 ? 1.0 : 0.0;
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.4 * sin(0.9 * (double)i);
+    NeuralNetwork* reference = nn_create_hybrid(I, H, O);
+    size_t count;
+    double* initial = nn_get_parameters(reference, &count);
+    
+    const size_t thread_counts[3] = {1, 4, 4};                         // The second 4-thread run must repeat the first bit for bit
+    TrainingRun runs[3];
+    for (size_t r = 0; r < 3; r++) {
+        TrainingConfig config;
+        training_config_init(&config);
+        config.optimizer_type = OPTIMIZER_ADAM;
+        config.learning_rate = 0.01;
+        config.batch_size = 32;
+        config.num_threads = thread_counts[r];
+        config.seed = 7;
+        runs[r] = train_from_weights(initial, I, H, O, &config, inputs, targets, N, 20);
+        ASSERT_EQ(runs[r].examples_seen, 20 * N, "Every example should be seen once per epoch");
+    }
+    
+    ASSERT(runs[0].last_loss < runs[0].first_loss, "Training epochs should reduce the loss");
+    ASSERT(memcmp(runs[1].params, runs[2].params, count * sizeof(double)) == 0, "Fixed seed and thread count should reproduce the weights exactly");
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_FLOAT_EQ(runs[1].params[i], runs[0].params[i], 1e-6, "Sharded gradients should match single-threaded training");
+    }
+    
+    for (size_t r = 0; r < 3; r++) delete[] runs[r].params;
+    nn_destroy(reference);
+    delete[] inputs;
+    delete[] targets;
+    return nullptr;
+}
+
+// Unit Test: Hogwild Epochs Match Synchronous SGD On One Thread And Learn On Several
+char* test_training_hogwild(void) {
+    const size_t I = 32, H = 8, O = 4, N = 120;
+    double* inputs = new double[N * I]();
+    double* targets = new double[N * O];
+    for (size_t i = 0; i < N; i++) {                                   // Sparse one-hot rows, as for board encodings
+        for (size_t k = 0; k < 3; k++) inputs[i * I + (i * 7 + k * 5) % I] = 1.0;
+    }
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.3 * cos(0.5 * (double)i);
+    NeuralNetwork* reference = nn_create_hybrid(I, H, O);
+    size_t count;
+    double* initial = nn_get_parameters(reference, &count);
+    
+    const size_t thread_counts[3] = {1, 1, 4};
+    const bool hogwild[3] = {false, true, true};
+    TrainingRun runs[3];
+    for (size_t r = 0; r < 3; r++) {
+        TrainingConfig config;
+        training_config_init(&config);
+        config.optimizer_type = OPTIMIZER_SGD;                         // Plain SGD: the synchronous rule Hogwild applies
+        config.momentum = 0.0;
+        config.weight_decay = 0.0;                                     // Hogwild decays only the columns a step touches
+        config.learning_rate = 0.5;
+        config.batch_size = 8;
+        config.num_threads = thread_counts[r];
+        config.seed = 3;
+        config.hogwild = hogwild[r];
+        runs[r] = train_from_weights(initial, I, H, O, &config, inputs, targets, N, 30);
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_FLOAT_EQ(runs[1].params[i], runs[0].params[i], 1e-9, "Single-threaded Hogwild should be synchronous SGD");
+    }
+    ASSERT(runs[2].last_loss < runs[2].first_loss, "Concurrent Hogwild workers should reduce the loss");
+    ASSERT_EQ(runs[2].examples_seen, 30 * N, "Hogwild workers should share out every example");
+    
+    for (size_t r = 0; r < 3; r++) delete[] runs[r].params;
+    nn_destroy(reference);
+    delete[] inputs;
+    delete[] targets;
+    return nullptr;
+}
+
+// Unit Test: Checkpoints Resume Training Exactly And Rewrite Only Changed Sections
+char* test_training_checkpoint(void) {
+    const size_t I = 20, H = 8, O = 6, N = 30;
+    const char* path = "test_resume.bin";
+    double inputs[N * I], targets[N * O];
+    for (size_t i = 0; i < N * I; i++) inputs[i] = (i * 7) % 5 == 0 ? 1.0 : 0.0;
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.3 * cos(0.7 * (double)i);
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.01;
+    config.batch_size = 8;
+    config.use_curriculum = true;
+    config.use_spaced_repetition = true;
+    config.seed = 3;
+    
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    training_engine_set_data(engine, inputs, targets, N);
+    for (size_t i = 0; i < 3; i++) {
+        TrainingExample ex;
+        training_example_init(&ex);
+        ex.input = inputs + i * I;
+        ex.target = targets + i * O;
+        ex.input_size = I;
+        ex.target_size = O;
+        ex.difficulty = 0.1 * (double)i;
+        curriculum_add_example(engine->curriculum, &ex, LEVEL_KINDERGARTEN);
+        spaced_repetition_add_example(engine->spaced_repetition, &ex);
+    }
+    curriculum_advance_level(engine->curriculum);
+    spaced_repetition_update_example(engine->spaced_repetition, 1, true);
+    for (int epoch = 0; epoch < 3; epoch++) training_engine_train_epoch(engine);
+    ASSERT(training_engine_save_checkpoint(engine, path), "Saving a checkpoint should succeed");
+    
+    NeuralNetwork* resumed_nn = nn_create_hybrid(I, H, O);              // Fresh weights, moments and schedule
+    TrainingEngine* resumed = training_engine_create(resumed_nn, &config);
+    training_engine_set_data(resumed, inputs, targets, N);
+    ASSERT(!training_engine_restore_checkpoint(resumed, "missing_checkpoint.bin"), "Missing checkpoint should fail");
+    ASSERT(training_engine_restore_checkpoint(resumed, path), "Restoring the checkpoint should succeed");
+    ASSERT_EQ(training_engine_get_stats(resumed)->epoch, 3, "Stats should be restored");
+    ASSERT_EQ(curriculum_get_current_level(resumed->curriculum), LEVEL_KINDERGARTEN, "Curriculum level should be restored");
+    ASSERT_EQ(resumed->spaced_repetition->num_examples, 3, "Spaced-repetition examples should be restored");
+    ASSERT_EQ(resumed->spaced_repetition->examples[1].correct_streak, 1, "Review schedule should be restored");
+    ASSERT_FLOAT_EQ(resumed->spaced_repetition->examples[1].next_review, engine->spaced_repetition->examples[1].next_review, 0.0,
+                    "Review times should be restored");
+    
+    size_t count;
+    double* params = nn_get_parameters(nn, &count);
+    double* resumed_params = nn_get_parameters(resumed_nn, nullptr);
+    ASSERT(memcmp(params, resumed_params, count * sizeof(double)) == 0, "Parameters should be restored exactly");
+    for (int epoch = 0; epoch < 2; epoch++) {                          // Same moments, shuffle state and order: same next epochs
+        training_engine_train_epoch(engine);
+        training_engine_train_epoch(resumed);
+    }
+    ASSERT(memcmp(params, resumed_params, count * sizeof(double)) == 0, "Resumed training should continue bit for bit");
+    
+    engine->config.incremental_checkpoints = true;                     // Examples did not change: their files stay
+    ASSERT(training_engine_save_checkpoint(engine, path), "Incremental save should succeed");
+    FILE* kept = fopen("test_resume.bin.curriculum_examples.1", "rb");
+    FILE* replaced = fopen("test_resume.bin.network.1", "rb");
+    FILE* written = fopen("test_resume.bin.network.2", "rb");
+    ASSERT(kept && written && !replaced, "Only changed sections should be rewritten");
+    fclose(kept);
+    fclose(written);
+    ASSERT(training_engine_restore_checkpoint(resumed, path), "Incremental checkpoint should restore");
+    ASSERT(memcmp(params, resumed_params, count * sizeof(double)) == 0, "Incremental checkpoint should hold the new parameters");
+    
+    TrainingEngine* loaded = training_engine_load_checkpoint(path);    // Network and engine from the checkpoint alone
+    ASSERT_NOT_NULL(loaded, "Loading the checkpoint should build an engine");
+    ASSERT_EQ(nn_get_hidden_size(loaded->network), H, "Loaded network should have the saved shape");
+    ASSERT(loaded->config.batch_size == config.batch_size && loaded->config.seed == config.seed &&
+           loaded->config.checkpoint_path == nullptr, "Loaded config should hold the saved fields but no path");
+    ASSERT(memcmp(params, nn_get_parameters(loaded->network, nullptr), count * sizeof(double)) == 0, "Loaded parameters should match");
+    NeuralNetwork* loaded_nn = loaded->network;
+    training_engine_destroy(loaded);
+    nn_destroy(loaded_nn);
+    
+    FILE* section = fopen("test_resume.bin.network.2", "r+b");         // Corrupt one parameter byte
+    fseek(section, 100, SEEK_SET);
+    int byte = fgetc(section);
+    fseek(section, 100, SEEK_SET);
+    fputc(byte ^ 0x01, section);
+    fclose(section);
+    training_engine_train_epoch(resumed);
+    double before = resumed_params[0];
+    ASSERT(!training_engine_restore_checkpoint(resumed, path), "Corrupt checkpoint should fail its checksum");
+    ASSERT_FLOAT_EQ(resumed_params[0], before, 0.0, "Failed restore should leave the engine unchanged");
+    
+    ASSERT(training_engine_remove_checkpoint(path), "Checkpoint files should be removed");
+    training_engine_destroy(resumed);
+    training_engine_destroy(engine);
+    nn_destroy(resumed_nn);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Asynchronous Checkpoints Write The Snapshot Taken, Not Later State
+char* test_training_async_checkpoint(void) {
+    const size_t I = 16, H = 8, O = 4, N = 40;
+    const char* path = "test_async.bin";
+    double inputs[N * I], targets[N * O];
+    for (size_t i = 0; i < N * I; i++) inputs[i] = (i * 5) % 3 == 0 ? 1.0 : 0.0;
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.2 * sin(1.3 * (double)i);
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.01;
+    config.batch_size = 8;
+    config.max_epochs = 4;
+    config.seed = 5;
+    config.checkpoint_path = path;
+    config.checkpoint_interval = 2;
+    config.async_checkpoints = true;
+    config.incremental_checkpoints = true;
+    
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    training_engine_set_data(engine, inputs, targets, N);
+    training_engine_train_full(engine);                                // Checkpoints after epochs 2 and 4, waited for on return
+    TrainingStats* stats = training_engine_get_stats(engine);
+    ASSERT(stats->checkpoints_written >= 1, "Background writer should finish the run's checkpoints");
+    ASSERT(stats->checkpoint_latency > 0.0 && stats->checkpoint_write_time > 0.0, "Checkpoint timings should be recorded");
+    
+    size_t count;
+    double* params = nn_get_parameters(nn, &count);
+    double* snapshot = new double[count];
+    memcpy(snapshot, params, count * sizeof(double));
+    ASSERT(training_engine_checkpoint(engine, path), "Asynchronous checkpoint should be queued");
+    training_engine_train_epoch(engine);                               // Training moves on while the snapshot is written
+    ASSERT(memcmp(snapshot, params, count * sizeof(double)) != 0, "Training should change the live parameters");
+    ASSERT(training_engine_wait_checkpoints(engine), "Background write should succeed");
+    
+    NeuralNetwork* restored_nn = nn_create_hybrid(I, H, O);
+    TrainingConfig sync_config = config;
+    sync_config.async_checkpoints = false;
+    TrainingEngine* restored = training_engine_create(restored_nn, &sync_config);
+    ASSERT(training_engine_restore_checkpoint(restored, path), "Asynchronous checkpoint should restore");
+    ASSERT(memcmp(snapshot, nn_get_parameters(restored_nn, nullptr), count * sizeof(double)) == 0,
+           "Checkpoint should hold the parameters at snapshot time");
+    ASSERT_EQ(training_engine_get_stats(restored)->epoch, 4, "Checkpoint should hold the stats at snapshot time");
+    
+    ASSERT(training_engine_remove_checkpoint(path), "Checkpoint files should be removed");
+    delete[] snapshot;
+    training_engine_destroy(restored);
+    training_engine_destroy(engine);
+    nn_destroy(restored_nn);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Asynchronous Snapshots Copy Only Sections Changed Since The Last Write
+char* test_training_async_checkpoint_dirty(void) {
+    const size_t I = 16, H = 8, O = 4, N = 24, E = 32;
+    const char* path = "test_async_dirty.bin";
+    double inputs[N * I], targets[N * O];
+    for (size_t i = 0; i < N * I; i++) inputs[i] = (i * 7) % 5 == 0 ? 1.0 : 0.0;
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.3 * cos(0.7 * (double)i);
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.01;
+    config.batch_size = 8;
+    config.seed = 9;
+    config.use_spaced_repetition = true;
+    config.async_checkpoints = true;
+    config.incremental_checkpoints = true;
+    
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    training_engine_set_data(engine, inputs, targets, N);
+    TrainingExample example;
+    training_example_init(&example);
+    example.input_size = 256;                                          // Examples dominate the checkpoint
+    example.target_size = O;
+    example.input = new double[256]();
+    example.target = new double[O]();
+    for (size_t e = 0; e < E; e++) spaced_repetition_add_example(engine->spaced_repetition, &example);
+    
+    training_engine_train_epoch(engine);
+    ASSERT(training_engine_checkpoint(engine, path) && training_engine_wait_checkpoints(engine), "First checkpoint should be written");
+    TrainingStats* stats = training_engine_get_stats(engine);
+    size_t first = stats->checkpoint_bytes_copied;
+    ASSERT(first > E * 256 * sizeof(double), "First snapshot should copy the examples");
+    
+    training_engine_train_epoch(engine);                               // Weights and moments change, examples do not
+    ASSERT(training_engine_checkpoint(engine, path) && training_engine_wait_checkpoints(engine), "Second checkpoint should be written");
+    ASSERT(stats->checkpoint_bytes_copied + E * 256 * sizeof(double) < first, "Unchanged examples should not be copied again");
+    
+    spaced_repetition_add_example(engine->spaced_repetition, &example);
+    ASSERT(training_engine_checkpoint(engine, path) && training_engine_wait_checkpoints(engine), "Third checkpoint should be written");
+    ASSERT(stats->checkpoint_bytes_copied > E * 256 * sizeof(double), "A new example should copy the examples again");
+    training_engine_train_epoch(engine);
+    ASSERT(training_engine_checkpoint(engine, path) && training_engine_wait_checkpoints(engine), "Fourth checkpoint should be written");
+    
+    size_t count;
+    const double* params = nn_get_parameters(nn, &count);
+    NeuralNetwork* restored_nn = nn_create_hybrid(I, H, O);
+    TrainingConfig sync_config = config;
+    sync_config.async_checkpoints = false;
+    TrainingEngine* restored = training_engine_create(restored_nn, &sync_config);
+    ASSERT(training_engine_restore_checkpoint(restored, path), "Checkpoint with kept sections should restore");
+    ASSERT_EQ(restored->spaced_repetition->num_examples, E + 1, "Kept examples section should hold every example");
+    ASSERT(memcmp(params, nn_get_parameters(restored_nn, nullptr), count * sizeof(double)) == 0,
+           "Changed network section should be the latest");
+    
+    ASSERT(training_engine_remove_checkpoint(path), "Checkpoint files should be removed");
+    delete[] example.input;
+    delete[] example.target;
+    training_engine_destroy(restored);
+    training_engine_destroy(engine);
+    nn_destroy(restored_nn);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Restoring Into A Network Mapped From A Model File
+char* test_training_restore_mapped(void) {
+    const size_t I = 16, H = 8, O = 4, N = 24;
+    const char* path = "test_mapped_resume.bin";
+    const char* model_path = "test_mapped_resume.model";
+    double inputs[N * I], targets[N * O];
+    for (size_t i = 0; i < N * I; i++) inputs[i] = (i * 3) % 7 == 0 ? 1.0 : 0.0;
+    for (size_t i = 0; i < N * O; i++) targets[i] = 0.25 * sin(0.9 * (double)i);
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.01;
+    config.batch_size = 8;
+    config.seed = 7;
+    
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    training_engine_set_data(engine, inputs, targets, N);
+    training_engine_train_epoch(engine);
+    size_t count;
+    double* params = nn_get_parameters(nn, &count);
+    std::vector<double> saved(params, params + count);
+    ASSERT(training_engine_save_checkpoint(engine, path), "Saving the checkpoint should succeed");
+    training_engine_train_epoch(engine);                               // Later weights go into the model file
+    ASSERT(nn_save_model(nn, model_path), "Saving the model should succeed");
+    ASSERT(nn_map_model(nn, model_path), "Mapping the model should succeed");
+    
+    ASSERT(training_engine_restore_checkpoint(engine, path), "Restoring over mapped weights should succeed");
+    params = nn_get_parameters(nn, nullptr);
+    ASSERT(memcmp(params, saved.data(), count * sizeof(double)) == 0, "Restore should replace the mapped weights");
+    training_engine_train_epoch(engine);                               // The restored weights are private and trainable
+    ASSERT(memcmp(params, saved.data(), count * sizeof(double)) != 0, "Restored weights should train");
+    
+    ASSERT(training_engine_remove_checkpoint(path), "Checkpoint files should be removed");
+    remove(model_path);
     training_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Packed Training Shards
+char* test_training_shard(void) {
+    const size_t I = 24, H = 8, O = 6, N = 20;
+    const char* path = "test_shard.bin";
+    ShardWriter* writer = shard_writer_create(path, I, O);
+    ASSERT_NOT_NULL(writer, "Shard writer creation failed");
+    for (size_t i = 0; i < N; i++) {
+        uint16_t features[3] = {(uint16_t)(i % I), (uint16_t)((i * 5 + 1) % I), (uint16_t)((i * 7 + 2) % I)};
+        uint16_t moves[2] = {(uint16_t)(1 + i % 3), (uint16_t)(4 + i % 2)};
+        double probabilities[2] = {0.75, 0.25};
+        ASSERT(shard_writer_add(writer, features, 3, moves, probabilities, 2, i % 2 ? 0.5 : -0.5), "Adding a record should succeed");
+    }
+    uint16_t bad_move = 0;
+    double one = 1.0;
+    ASSERT(!shard_writer_add(writer, nullptr, 0, &bad_move, &one, 1, 0.0), "Output 0 is the value, not a move");
+    uint16_t repeated[2] = {2, 2};
+    double halves[2] = {0.5, 0.5};
+    ASSERT(!shard_writer_add(writer, nullptr, 0, repeated, halves, 2, 0.0), "A move should be listed once");
+    ASSERT_EQ(shard_writer_size(writer), N, "Rejected records should not be written");
+    ASSERT(shard_writer_close(writer), "Closing the shard should succeed");
+    
+    ShardReader* reader = shard_reader_open(path);
+    ASSERT_NOT_NULL(reader, "Shard should open");
+    ASSERT(shard_reader_verify(reader), "Shard checksum should match");
+    ASSERT_EQ(shard_reader_size(reader), N, "Record count should round-trip");
+    double inputs[N * I], targets[N * O];
+    ASSERT_EQ(shard_reader_decode(reader, 3, 1, inputs, I, targets, O), 1, "One record should decode");
+    size_t active = 0;
+    for (size_t j = 0; j < I; j++) active += inputs[j] == 1.0;
+    ASSERT(inputs[3] == 1.0 && inputs[16] == 1.0 && inputs[23] == 1.0 && active == 3, "Features should decode one-hot");
+    ASSERT_FLOAT_EQ(targets[0], 0.5, 0.0, "Value should decode at output 0");
+    ASSERT_FLOAT_EQ(targets[1], 0.75, 1e-4, "Move probabilities should decode at their index");
+    ASSERT_FLOAT_EQ(targets[5], 0.25, 1e-4, "Move probabilities should decode at their index");
+    
+    size_t total = 0, count;
+    while ((count = shard_reader_next_batch(reader, 8, inputs + total * I, I, targets + total * O, O)) > 0) total += count;
+    ASSERT_EQ(total, N, "Streaming should visit every record once");
+    
+    double sparse_inputs[N * I];                                       // Sparse stream lists exactly the dense rows' nonzero targets
+    size_t offsets[N + 1];
+    uint32_t indices[N * 3];
+    double values[N * 3];
+    shard_reader_rewind(reader);
+    ASSERT_EQ(shard_reader_next_batch_sparse(reader, N, sparse_inputs, I, offsets, indices, values), N, "Sparse stream should decode every record");
+    ASSERT_EQ(shard_reader_next_batch_sparse(reader, N, sparse_inputs, I, offsets, indices, values), 0, "Sparse stream should end");
+    ASSERT(memcmp(sparse_inputs, inputs, sizeof(sparse_inputs)) == 0, "Sparse stream inputs should match the dense decode");
+    for (size_t b = 0; b < N; b++) {
+        double row[O] = {};
+        for (size_t k = offsets[b]; k < offsets[b + 1]; k++) row[indices[k]] = values[k];
+        ASSERT(offsets[b + 1] - offsets[b] == 3 && indices[offsets[b]] == 0, "Row should list the value, then its moves");
+        ASSERT(memcmp(row, targets + b * O, sizeof(row)) == 0, "Sparse targets should match the dense decode");
+    }
+    
+    NeuralNetwork* dense_nn = nn_create_hybrid(I, H, O);              // One shard step equals a dense step on the decoded rows
+    NeuralNetwork* shard_nn = nn_create_hybrid(I, H, O);
+    size_t param_count;
+    memcpy(nn_get_parameters(shard_nn, &param_count), nn_get_parameters(dense_nn, nullptr), nn_get_parameter_count(dense_nn) * sizeof(double));
+    double dense_outputs[N * O];
+    nn_backward_batch(dense_nn, inputs, I, targets, O, N, dense_outputs, O);
+    Optimizer* sgd = optimizer_create(OPTIMIZER_SGD, 0.05);
+    optimizer_update(sgd, dense_nn);
+    TrainingConfig step_config;
+    training_config_init(&step_config);
+    step_config.optimizer_type = OPTIMIZER_SGD;
+    step_config.learning_rate = 0.05;
+    step_config.momentum = 0.0;                                        // Same rule as the reference optimizer
+    step_config.weight_decay = 0.0;
+    step_config.batch_size = N;
+    TrainingEngine* step_engine = training_engine_create(shard_nn, &step_config);
+    ASSERT(training_engine_train_shard(step_engine, reader), "Sparse shard step should run");
+    const double* dense_params = nn_get_parameters(dense_nn, nullptr);
+    const double* shard_params = nn_get_parameters(shard_nn, nullptr);
+    for (size_t p = 0; p < param_count; p++) {
+        ASSERT_FLOAT_EQ(shard_params[p], dense_params[p], 1e-12, "Sparse shard step should match the dense step");
+    }
+    training_engine_destroy(step_engine);
+    optimizer_destroy(sgd);
+    nn_destroy(shard_nn);
+    nn_destroy(dense_nn);
+    
+    TrainingConfig config;
+    training_config_init(&config);
+    config.optimizer_type = OPTIMIZER_ADAM;
+    config.learning_rate = 0.02;
+    config.batch_size = 4;
+    NeuralNetwork* nn = nn_create_hybrid(I, H, O);
+    TrainingEngine* engine = training_engine_create(nn, &config);
+    ASSERT(training_engine_train_shard(engine, reader), "Training on the shard should run");
+    double initial = training_engine_get_stats(engine)->current_loss;
+    for (int epoch = 0; epoch < 20; epoch++) training_engine_train_shard(engine, reader);
+    ASSERT(training_engine_get_stats(engine)->current_loss < initial, "Training on the shard should reduce the loss");
+    ASSERT_EQ(training_engine_get_stats(engine)->examples_seen, 21 * N, "Every epoch should stream the whole shard");
+    NeuralNetwork* other = nn_create_hybrid(I + 1, H, O);
+    TrainingEngine* mismatched = training_engine_create(other, &config);
+    ASSERT(!training_engine_train_shard(mismatched, reader), "A shard of another shape should be refused");
+    ASSERT(shard_reader_open("missing_shard.bin") == nullptr, "Missing shard should not open");
+    training_engine_destroy(mismatched);
+    training_engine_destroy(engine);
+    nn_destroy(other);
+    nn_destroy(nn);
+    shard_reader_close(reader);
+    
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    writer = shard_writer_create(path, 768, 4096);
+    uint16_t e2e4 = 12 * 64 + 28;
+    ASSERT(shard_writer_add_position(writer, pos, &e2e4, &one, 1, 0.1), "Adding a position should succeed");
+    ASSERT(shard_writer_close(writer), "Closing the shard should succeed");
+    reader = shard_reader_open(path);
+    std::vector<double> position_input(768), position_target(4096);
+    ASSERT_EQ(shard_reader_decode(reader, 0, 1, position_input.data(), 768, position_target.data(), 4096), 1, "Position should decode");
+    size_t pieces = 0;
+    for (double x : position_input) pieces += x == 1.0;
+    ASSERT_EQ(pieces, 32, "Every piece should be an active feature");
+    ASSERT_FLOAT_EQ(position_target[e2e4], 1.0, 0.0, "Policy target should land on the move");
+    shard_reader_close(reader);
+    chess_position_destroy(pos);
+    remove(path);
     return nullptr;
 }
 
@@ -257,6 +1737,293 @@ char* test_inference_evaluate_position(void) {
     return nullptr;
 }
 
+// Unit Test: Memory-Mapped Model Files
+char* test_inference_model_file(void) {
+    const char* path = "test_model.bin";
+    NeuralNetwork* source = nn_create_hybrid(768, 32, 4096);
+    NeuralNetwork* nn = nn_create_hybrid(768, 32, 4096);
+    InferenceEngine* saver = inference_engine_create(source);
+    InferenceEngine* engine = inference_engine_create(nn);
+    ChessPosition* pos = chess_position_from_fen("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    ASSERT(inference_engine_save_model(saver, path), "Saving the model should succeed");
+    ASSERT(!inference_engine_load_model(engine, "missing_model.bin"), "Loading a missing file should fail");
+    
+    double before = inference_engine_evaluate_position(engine, pos);   // Cached under the old weights
+    ASSERT(inference_engine_load_model(engine, path), "Mapping the model should succeed");
+    double expected = inference_engine_evaluate_position(saver, pos);
+    double mapped = inference_engine_evaluate_position(engine, pos);
+    ASSERT_FLOAT_EQ(mapped, expected, 1e-12, "Mapped weights should reproduce the saved network");
+    ASSERT(mapped != before, "Loading should clear evaluations cached under the old weights");
+    ASSERT(nn_verify_model(nn), "Mapped model should pass its checksum");
+    size_t count = nn_get_parameter_count(nn);
+    ASSERT_EQ(count, nn_get_parameter_count(source), "Parameter counts should match");
+    std::vector<double> parameters(count), source_parameters(count);
+    nn_read_parameters(nn, 0, count, parameters.data());               // Reads leave the weights mapped
+    nn_read_parameters(source, 0, count, source_parameters.data());
+    ASSERT(parameters == source_parameters, "Mapped parameters should be bit-exact");
+    
+    double input[768], output[4096], target[4096] = {};                // Mapped weights are read-only: training leaves them alone
+    for (size_t i = 0; i < 768; i++) input[i] = i % 11 == 0 ? 1.0 : 0.0;
+    Optimizer* opt = optimizer_create(OPTIMIZER_ADAM, 0.1);
+    nn_forward(nn, input, output);
+    double loss;
+    nn_backward(nn, target, &loss);
+    optimizer_update(opt, nn);
+    nn_read_parameters(nn, 0, count, parameters.data());
+    ASSERT(parameters == source_parameters, "Optimizer should not write mapped weights");
+    optimizer_destroy(opt);
+    
+    struct stat fp64_info, bf16_info;
+    ASSERT(stat(path, &fp64_info) == 0, "FP64 model file should exist");
+    nn_set_precision(source, NN_PRECISION_BF16);                       // Dtype travels with the file
+    ASSERT(nn_save_model(source, path), "Saving a BF16 model should succeed");
+    ASSERT(stat(path, &bf16_info) == 0 && bf16_info.st_size < fp64_info.st_size / 2, "BF16 weights should be stored as BF16");
+    ASSERT(nn_map_model(nn, path), "Remapping should succeed");
+    ASSERT(nn_get_precision(nn) == NN_PRECISION_BF16, "Mapped model should take the file's dtype");
+    nn_forward(source, input, target);
+    nn_forward(nn, input, output);
+    for (size_t i = 0; i < 4096; i++) ASSERT_FLOAT_EQ(output[i], target[i], 1e-12, "BF16 mapped model should match its source");
+    ASSERT(nn_verify_model(nn), "BF16 model should pass its checksum");
+    
+    FILE* file = fopen(path, "r+b");                                   // Flip one weight byte past the header page
+    ASSERT_NOT_NULL(file, "Model file should exist");
+    fseek(file, 4096 + 1000, SEEK_SET);
+    int byte = fgetc(file);
+    fseek(file, 4096 + 1000, SEEK_SET);
+    fputc(byte ^ 0x10, file);
+    fclose(file);
+    NeuralNetwork* fresh = nn_create_hybrid(768, 32, 4096);
+    ASSERT(nn_map_model(fresh, path), "Mapping checks only the header");
+    ASSERT(!nn_verify_model(fresh), "Corrupted model should fail its checksum");
+    nn_destroy(fresh);
+    fresh = nn_create_hybrid(768, 32, 4096);
+    ASSERT(truncate(path, bf16_info.st_size - 64) == 0, "Truncating the model should succeed");
+    double* fresh_parameters = nn_get_parameters(fresh, nullptr);
+    ASSERT(!nn_map_model(fresh, path), "Truncated model should be rejected");
+    ASSERT(nn_get_parameters(fresh, nullptr) == fresh_parameters, "Failed load should leave the network unchanged");
+    NeuralNetwork* other = nn_create_hybrid(768, 16, 4096);
+    ASSERT(nn_save_model(source, path), "Rewriting the model should succeed");
+    ASSERT(!nn_map_model(other, path), "Model of another shape should be rejected");
+    
+    remove(path);
+    nn_destroy(other);
+    nn_destroy(fresh);
+    chess_position_destroy(pos);
+    inference_engine_destroy(saver);
+    inference_engine_destroy(engine);
+    nn_destroy(source);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Int8 Quantized Inference Tracks The Network
+char* test_inference_quantize(void) {
+    const size_t M = 6, N = 11, K = 1100;                              // Crosses the int8 K block and leaves ragged tiles
+    uint8_t* A = new uint8_t[M * K];
+    int8_t* W = new int8_t[N * K];
+    int32_t C[M * N];
+    for (size_t i = 0; i < M * K; i++) A[i] = (uint8_t)((i * 37) % 128);
+    for (size_t i = 0; i < N * K; i++) W[i] = (int8_t)((int)((i * 53) % 255) - 127);
+    NNKernelISA best = nn_kernels_select(NN_ISA_AVX512_VNNI);
+    for (int isa = NN_ISA_SCALAR; isa <= (int)best; isa++) {
+        nn_kernels_select((NNKernelISA)isa);
+        nn_kernel_gemm_u8s8(A, K, W, K, C, N, M, N, K);
+        for (size_t m = 0; m < M; m++) {
+            for (size_t n = 0; n < N; n++) {
+                int32_t expected = 0;
+                for (size_t k = 0; k < K; k++) expected += (int32_t)A[m * K + k] * (int32_t)W[n * K + k];
+                ASSERT_EQ(C[m * N + n], expected, "Integer GEMM should be exact");
+            }
+        }
+    }
+    nn_kernels_select(best);
+    delete[] A;
+    delete[] W;
+    
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 4096);
+    InferenceEngine* engine = inference_engine_create(nn);
+    ChessPosition* pos = chess_position_from_fen("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    ChessMove moves[CHESS_MAX_MOVES];
+    size_t num_moves = 0;
+    chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+    ChessPosition* sample[CHESS_MAX_MOVES];
+    for (size_t i = 0; i < num_moves; i++) {
+        sample[i] = chess_position_clone(pos);
+        chess_position_make_move(sample[i], &moves[i]);
+    }
+    
+    double reference = inference_engine_evaluate_position(engine, pos);
+    QuantizationReport report;
+    ASSERT(!inference_engine_quantize(engine, sample, 0, &report), "Quantizing without positions should fail");
+    ASSERT(inference_engine_quantize(engine, sample, num_moves, &report), "Quantization should succeed");
+    ASSERT_EQ(report.samples, num_moves, "Report should cover every calibration position");
+    ASSERT(report.output_max_error < 0.05, "Int8 outputs should stay close to the network");
+    ASSERT(report.value_mean_error <= report.value_max_error, "Mean error should not exceed max error");
+    ASSERT(report.quantized_bytes * 6 < report.network_bytes, "Int8 weights should be far smaller than doubles");
+    
+    double quantized = inference_engine_evaluate_position(engine, pos);  // Root was not calibrated on; cache was cleared
+    ASSERT_FLOAT_EQ(quantized, reference, 0.05, "Int8 evaluation should track the network");
+    double batch_inputs[2 * 768], batch_outputs[2 * 4096], single[4096];
+    chess_position_to_matrix(pos, batch_inputs);
+    chess_position_to_matrix(sample[0], batch_inputs + 768);
+    inference_engine_batch_predict(engine, batch_inputs, 2, 768, batch_outputs, 4096);
+    inference_engine_evaluate_position_vector(engine, batch_inputs + 768, 768, single, 4096);
+    for (size_t i = 0; i < 4096; i++) ASSERT_FLOAT_EQ(batch_outputs[4096 + i], single[i], 1e-12, "Batched int8 should match single");
+    
+    for (size_t i = 0; i < num_moves; i++) chess_position_destroy(sample[i]);
+    chess_position_destroy(pos);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Incremental First Layer Follows Make/Unmake
+char* test_inference_accumulator(void) {
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 64);
+    InferenceEngine* engine = inference_engine_create(nn);
+    engine->tt_size_mb = 0;                                            // Every call evaluates instead of hitting the cache
+    ChessPosition* pos = chess_position_from_fen("r3k2r/pPpp1ppp/8/3Pp3/8/8/PPP2PPP/R3K2R w KQkq e6 0 1");
+    double input[768], expected[64];
+    
+    // Castling, en passant, capture-promotion and quiet moves, each checked going down and coming back up
+    const char* line[] = {"d5e6", "e8g8", "b7a8q", "f8a8", "e1c1", "a7a5"};
+    const size_t plies = sizeof(line) / sizeof(line[0]);
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i <= plies; i++) {
+            chess_position_to_matrix(pos, input);
+            uint16_t features[64];
+            size_t count = chess_position_get_features(pos, features);
+            size_t nonzero = 0;
+            for (size_t j = 0; j < 768; j++) nonzero += input[j] != 0.0;
+            ASSERT_EQ(count, nonzero, "Sparse features should match the matrix");
+            for (size_t j = 0; j < count; j++) ASSERT(input[features[j]] == 1.0, "Feature should be set in the matrix");
+            
+            nn_forward(nn, input, expected);
+            ASSERT_FLOAT_EQ(inference_engine_evaluate_position(engine, pos), expected[0], 1e-12,
+                            "Incremental evaluation should match a full forward pass");
+            if (i == plies) break;
+            
+            ChessMove moves[CHESS_MAX_MOVES];
+            size_t num_moves = 0;
+            chess_position_generate_moves(pos, chess_position_get_side_to_move(pos), moves, &num_moves);
+            bool found = false;
+            for (size_t m = 0; m < num_moves && !found; m++) {
+                char uci[6];
+                chess_move_to_uci(&moves[m], uci);
+                if (strcmp(uci, line[i]) == 0) {
+                    chess_position_make_move(pos, &moves[m]);
+                    found = true;
+                }
+            }
+            ASSERT(found, "Scripted move should be legal");
+        }
+        for (size_t i = 0; i < plies; i++) {
+            chess_position_unmake_move(pos);
+            chess_position_to_matrix(pos, input);
+            nn_forward(nn, input, expected);
+            ASSERT_FLOAT_EQ(inference_engine_evaluate_position(engine, pos), expected[0], 1e-12,
+                            "Evaluation after unmake should match a full forward pass");
+        }
+    }
+    
+    ChessPosition* other = chess_position_from_fen("8/8/4k3/8/8/4K3/4P3/8 w - - 0 1");  // Unrelated position refreshes
+    chess_position_to_matrix(other, input);
+    nn_forward(nn, input, expected);
+    ASSERT_FLOAT_EQ(inference_engine_evaluate_position(engine, other), expected[0], 1e-12, "Refresh should match a full forward pass");
+    
+    chess_position_destroy(other);
+    chess_position_destroy(pos);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Inference caches follow weight updates
+char* test_inference_weight_update(void) {
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 64);
+    InferenceEngine* engine = inference_engine_create(nn);            // Table and accumulator both enabled
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    double before = inference_engine_evaluate_position(engine, pos);
+    
+    double input[768], output[64], target[64];
+    chess_position_to_matrix(pos, input);
+    nn_forward(nn, input, output);
+    for (size_t i = 0; i < 64; i++) target[i] = output[i] + 1.0;
+    double loss;
+    nn_backward(nn, target, &loss);
+    uint64_t version = nn_get_weight_version(nn);
+    Optimizer* opt = optimizer_create(OPTIMIZER_SGD, 0.1);
+    optimizer_update(opt, nn);
+    ASSERT(nn_get_weight_version(nn) != version, "Optimizer step should bump the weight version");
+    
+    nn_forward(nn, input, output);
+    double after = inference_engine_evaluate_position(engine, pos);
+    ASSERT(fabs(after - before) > 1e-3, "Evaluation should not come from the stale cache");
+    ASSERT_FLOAT_EQ(after, output[0], 1e-3, "Evaluation should match the updated network");
+    
+    optimizer_destroy(opt);
+    chess_position_destroy(pos);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
+// Unit Test: Transposition Table
+char* test_transposition_table(void) {
+    TranspositionTable* tt = transposition_table_create(1);
+    TTEntry entry;
+    ASSERT(!transposition_table_probe(tt, 0x1234ULL, &entry), "Empty table should miss");
+    
+    transposition_table_store(tt, 0x1234ULL, 0x0A1C, 0.5, 6, TT_BOUND_LOWER);
+    transposition_table_store_eval(tt, 0x1234ULL, -0.25);
+    ASSERT(transposition_table_probe(tt, 0x1234ULL, &entry), "Stored key should hit");
+    ASSERT_EQ(entry.move, 0x0A1C, "Move should round-trip");
+    ASSERT_EQ(entry.depth, 6, "Depth should round-trip");
+    ASSERT_EQ(entry.bound, TT_BOUND_LOWER, "Bound should round-trip");
+    ASSERT_FLOAT_EQ(entry.score, 0.5, 1e-3, "Score should round-trip");
+    ASSERT(entry.has_eval, "Eval should be merged into existing entry");
+    ASSERT_FLOAT_EQ(entry.eval, -0.25, 1e-3, "Eval should round-trip");
+    
+    // A shallow non-exact result must not overwrite a deeper one from the same search
+    transposition_table_store(tt, 0x1234ULL, 0, 0.1, 1, TT_BOUND_UPPER);
+    transposition_table_probe(tt, 0x1234ULL, &entry);
+    ASSERT_EQ(entry.depth, 6, "Deeper entry should be preserved");
+    
+    // Flood one bucket: the deep entry sits in a depth-preferred slot and survives
+    uint64_t same_bucket = 0x1234ULL;
+    for (uint64_t i = 1; i <= 16; i++) {
+        transposition_table_store_eval(tt, same_bucket + i, 0.0);
+    }
+    ASSERT(transposition_table_probe(tt, 0x1234ULL, &entry) && entry.depth == 6, "Depth-preferred entry should survive churn");
+    
+    transposition_table_clear(tt);
+    ASSERT(!transposition_table_probe(tt, 0x1234ULL, &entry), "Cleared table should miss");
+    
+    // A zero eval with no move in generation 0 is still an entry, not an empty slot
+    transposition_table_store_eval(tt, 0x5678ULL, 0.0);
+    ASSERT(transposition_table_probe(tt, 0x5678ULL, &entry), "Zero eval should hit");
+    ASSERT(entry.has_eval && entry.eval == 0.0, "Zero eval should round-trip");
+    ASSERT_EQ(entry.bound, TT_BOUND_NONE, "Eval-only entry should carry no bound");
+    transposition_table_destroy(tt);
+    
+    // Engine evaluations are cached and identical for transposed positions
+    NeuralNetwork* nn = nn_create_hybrid(768, 64, 64);
+    InferenceEngine* engine = inference_engine_create(nn);
+    ChessPosition* pos = chess_position_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    double first = inference_engine_evaluate_position(engine, pos);
+    double second = inference_engine_evaluate_position(engine, pos);
+    ASSERT(first == second, "Cached evaluation should match fresh one");
+    ASSERT_NOT_NULL(engine->tt, "Engine should allocate its table on first use");
+    ChessMove* move = inference_engine_search_move(engine, pos, 1);
+    ASSERT_NOT_NULL(move, "Search should return a move");
+    ASSERT(chess_position_is_legal_move(pos, move), "Searched move should be legal");
+    delete move;
+    chess_position_destroy(pos);
+    inference_engine_destroy(engine);
+    nn_destroy(nn);
+    return nullptr;
+}
+
 // Unit Test: Inference Engine Move Prediction
 char* test_inference_predict_move(void) {
     NeuralNetwork* nn = nn_create_hybrid(768, 512, 4096);
@@ -284,19 +2051,49 @@ TestSuite* create_unit_test_suite(void) {
     test_suite_add_test(suite, "Neural Network Creation", test_nn_create_hybrid);
     test_suite_add_test(suite, "Neural Network Forward Pass", test_nn_forward_pass);
     test_suite_add_test(suite, "Neural Network Backward Pass", test_nn_backward_pass);
+    test_suite_add_test(suite, "Neural Network Allocation Free", test_nn_no_allocation);
+    test_suite_add_test(suite, "Neural Network SIMD Kernels", test_nn_kernels);
+    test_suite_add_test(suite, "Neural Network Batched Forward", test_nn_forward_batch);
+    test_suite_add_test(suite, "Neural Network Sparse Input", test_nn_forward_sparse);
+    test_suite_add_test(suite, "Neural Network Reduced Precision", test_nn_reduced_precision);
+    test_suite_add_test(suite, "Neural Network Backpropagation Through Time", test_nn_bptt);
+    test_suite_add_test(suite, "Neural Network Parameter Arena", test_nn_parameter_arena);
+    test_suite_add_test(suite, "Neural Network Mini-Batch Backward", test_nn_backward_batch);
+    test_suite_add_test(suite, "Neural Network Sparse-Target Backward", test_nn_backward_batch_sparse);
     test_suite_add_test(suite, "Optimizer Creation", test_optimizer_create);
+    test_suite_add_test(suite, "Fused Optimizer Updates", test_nn_optimizers);
     test_suite_add_test(suite, "Curriculum Creation", test_curriculum_create);
     test_suite_add_test(suite, "Curriculum Add Example", test_curriculum_add_example);
+    test_suite_add_test(suite, "Sparse Policy Targets", test_curriculum_sparse_targets);
     test_suite_add_test(suite, "Curriculum Advancement", test_curriculum_advancement);
     test_suite_add_test(suite, "Spaced Repetition Creation", test_spaced_repetition_create);
     test_suite_add_test(suite, "Chess Position Creation", test_chess_position_create);
     test_suite_add_test(suite, "Chess Position from FEN", test_chess_position_from_fen);
     test_suite_add_test(suite, "Chess Position to Matrix", test_chess_position_to_matrix);
+    test_suite_add_test(suite, "Bitboard Sliding Attacks", test_bitboard_sliding_attacks);
+    test_suite_add_test(suite, "Chess Position Bitboards", test_chess_position_bitboards);
+    test_suite_add_test(suite, "Chess Position Perft", test_chess_position_perft);
+    test_suite_add_test(suite, "Chess Position Zobrist", test_chess_position_zobrist);
+    test_suite_add_test(suite, "Principal Variation Search", test_search_pvs);
+    test_suite_add_test(suite, "Monte Carlo Tree Search", test_mcts_search);
+    test_suite_add_test(suite, "Parallel Batched MCTS", test_mcts_parallel);
     test_suite_add_test(suite, "Pavlovian Learner Creation", test_pavlovian_learner_create);
     test_suite_add_test(suite, "Pavlovian Stimulus Pairing", test_pavlovian_pair_stimuli);
     test_suite_add_test(suite, "Training Engine Creation", test_training_engine_create);
+    test_suite_add_test(suite, "Data-Parallel Training", test_training_data_parallel);
+    test_suite_add_test(suite, "Hogwild Training", test_training_hogwild);
+    test_suite_add_test(suite, "Training Checkpoints", test_training_checkpoint);
+    test_suite_add_test(suite, "Asynchronous Checkpoints", test_training_async_checkpoint);
+    test_suite_add_test(suite, "Asynchronous Checkpoints Copy Changes Only", test_training_async_checkpoint_dirty);
+    test_suite_add_test(suite, "Restore Into Mapped Weights", test_training_restore_mapped);
+    test_suite_add_test(suite, "Packed Training Shards", test_training_shard);
     test_suite_add_test(suite, "Inference Engine Creation", test_inference_engine_create);
     test_suite_add_test(suite, "Inference Position Evaluation", test_inference_evaluate_position);
+    test_suite_add_test(suite, "Inference Memory-Mapped Model", test_inference_model_file);
+    test_suite_add_test(suite, "Inference Int8 Quantization", test_inference_quantize);
+    test_suite_add_test(suite, "Inference Incremental Accumulator", test_inference_accumulator);
+    test_suite_add_test(suite, "Inference Weight Updates", test_inference_weight_update);
+    test_suite_add_test(suite, "Transposition Table", test_transposition_table);
     test_suite_add_test(suite, "Inference Move Prediction", test_inference_predict_move);
     
     return suite;